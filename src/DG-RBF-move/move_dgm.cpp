@@ -2,15 +2,15 @@
 #include <adgm.hpp>
 
 using namespace amat;
+using namespace amc;
 using namespace std;
 
 int main()
 {
 	string confile = "move_dgm.control";
-	string inp, outp, outdg, jacs, dum, anglestr;
-	double suprad, tol;
+	string inp, outp, outdg, jacs, dum, anglestr, mapfile = "none";
 	int nmarks;		// number of boundary markers to read
-	int nrbfsteps, maxiter;
+	int nsteps = 1;	// number of steps in which the rotation is carried out
 	vector<double> centre(2);
 	Matrix<int> n_rot;
 
@@ -26,11 +26,13 @@ int main()
 	n_rot.setup(nmarks,1);
 	for(int i = 0; i < nmarks; i++)
 		conf >> n_rot(i);
-	
+
+	// optional: the number of steps, and a file the DG mapping is read from if it exists, or written to otherwise
+	if(!(conf >> dum >> nsteps) || nsteps < 1) nsteps = 1;
+	if(!(conf >> dum >> mapfile)) mapfile = "none";
 	conf.close();
 
 	double angle = stod(anglestr)*PI/180.0;			// convert to radians
-	cout << "support radius is " << suprad << endl;
 	cout << "Centre is " << centre[0] << " " << centre[1] << endl;
 
 	// read mesh
@@ -44,10 +46,6 @@ int main()
 		for(int j = 0; j < m.gnnofa(); j++)
 			flags(m.gbface(i,j)) = 1;
 
-	//calculate boundary displacement
-	MRotation2d rot(&m, angle, centre[0], centre[1], n_rot);
-	Matrix<double> bc = rot.rhsvect_rotate();
-
 	// get number of interior points and boundary points
 	int n_bpoin=0, n_inpoin=0;
 	for(int i = 0; i < m.gnpoin(); i++)
@@ -57,7 +55,6 @@ int main()
 	// Split interior data and boundary data
 	Matrix<double> inpoints(n_inpoin, m.gndim());
 	Matrix<double> bpoints(n_bpoin, m.gndim());
-	Matrix<double> bcb(n_bpoin, m.gndim());
 	int k = 0;
 	for(int i = 0; i < flags.rows(); i++)
 		if(flags(i) == 0)
@@ -71,20 +68,43 @@ int main()
 	for(int i = 0; i < flags.rows(); i++)
 		if(flags(i) == 1)
 		{
-			for(int j = 0; j < m.gndim(); j++){
+			for(int j = 0; j < m.gndim(); j++)
 				bpoints(k,j) = m.gcoords(i,j);
-				bcb(k,j) = bc.get(i,j);
-			}
 			k++;
 		}
 
-	// carry out DG mapping procedure
-	DGmove d;
-	d.setup(2,&inpoints, &bpoints, &bcb);
-	d.generateDG();
-	d.movemesh();
-	inpoints = d.getInteriorPoints();
-	bpoints = d.getBoundaryPoints();
+	// the DG and the location of the interior points in it are computed once, or read from a previous run
+	DGMapping dgmap;
+	if(mapfile == "none" || !dgmap.read(mapfile) || dgmap.gnbpoin() != n_bpoin || dgmap.gninpoin() != n_inpoin)
+	{
+		if(!dgmap.build(bpoints, inpoints))
+			cout << "! Some interior points could not be located in the DG; they will not be moved." << endl;
+		if(mapfile != "none")
+			dgmap.write(mapfile);
+	}
+	else
+		cout << "Read the DG mapping from " << mapfile << endl;
+	cout << "DG has " << dgmap.gnelem() << " elements" << endl;
+
+	// each step only maps the interior points to the rotated DG
+	Matrix<double> newbpoints(n_bpoin, m.gndim());
+	for(int istep = 1; istep <= nsteps; istep++)
+	{
+		MRotation2d rot(&m, angle*istep/nsteps, centre[0], centre[1], n_rot);
+		Matrix<double> bc = rot.rhsvect_rotate();
+		k = 0;
+		for(int i = 0; i < flags.rows(); i++)
+			if(flags(i) == 1)
+			{
+				for(int j = 0; j < m.gndim(); j++)
+					newbpoints(k,j) = bpoints.get(k,j) + bc.get(i,j);
+				k++;
+			}
+
+		const int nbad = dgmap.update(newbpoints, inpoints);
+		cout << "Step " << istep << ": " << (nbad > 0 ? "DG mapping is invalid!" : "DG mapping is valid.") << endl;
+	}
+	bpoints = newbpoints;
 
 	// create a coords matrix with same point numbering as initial matrix and return it
 	Matrix<double> newcoords(m.gnpoin(),m.gndim());
@@ -99,7 +99,10 @@ int main(int argc, char* argv[])
 	// carry out DG mapping procedure
 	RBFmove d;
 	d.setup(&inpoints, &bpoints, &bcb, 2, suprad, nrbfsteps, tol, maxiter,solver);
-	d.move();
+	if(!d.move()) {
+		cout << "! RBF mesh movement failed!" << endl;
+		return -1;
+	}
 	inpoints = d.getInteriorPoints();
 	bpoints = d.getBoundaryPoints();
 
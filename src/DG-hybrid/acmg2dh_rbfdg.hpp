@@ -67,7 +67,8 @@ public:
 
 	void compute_boundary_displacements();
 
-	void generate_curved_mesh();
+	/// Curves the mesh; returns false, leaving the mesh unchanged, if the mesh movement fails
+	bool generate_curved_mesh();
 };
 
 void Curvedmeshgen2d::setup(UMesh2dh* const mesh, UMesh2dh* const meshq, const int num_parts, const vector<vector<int>> boundarymarkers, const double angle_threshold, 
@@ -134,7 +135,7 @@ void Curvedmeshgen2d::compute_boundary_displacements()
 }
 
 /// Uses the previously computed displacements of the face midpoints to curve the mesh
-void Curvedmeshgen2d::generate_curved_mesh()
+bool Curvedmeshgen2d::generate_curved_mesh()
 {
 	/** Note that this function works with the straight quadratic mesh.
 	 * We assume that the face numberings of the linear mesh and the quadratic mesh are the same.
@@ -191,7 +192,10 @@ void Curvedmeshgen2d::generate_curved_mesh()
 
 	mmv->setup(m, mq, &allpoint_disps, nlayers, suprad, mmtol, mmmaxiter, mmsolver);
 	mmv->compute_backmesh_points();
-	mmv->generate_backmesh_and_compute_displacements();
+	if(!mmv->generate_backmesh_and_compute_displacements()) {
+		cout << "! Curvedmeshgen2d: generate_curved_mesh(): Mesh movement failed!" << endl;
+		return false;
+	}
 	mmv->movemesh();
 
 	/*bounpoints = mmv->getBoundaryPoints();
@@ -217,6 +221,7 @@ void Curvedmeshgen2d::generate_curved_mesh()
 
 	// set it in mesh mq
 	mq->setcoords(&newcoords);*/
+	return true;
 }
 
 // ------------ end --------------------
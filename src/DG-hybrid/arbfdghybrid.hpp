@@ -74,7 +74,8 @@ public:
 	void setup(UMesh2dh* const mesh, UMesh2dh* qmesh, const amat::Matrix<double>* boundary_motion_quadratic, const int num_layers, 
 			const double supp_rad, const double tol, const int maxiter, const std::string solver);
 	void compute_backmesh_points();
-	void generate_backmesh_and_compute_displacements();
+	/// Returns false if the RBF solve for the motion of the background mesh fails
+	bool generate_backmesh_and_compute_displacements();
 	void movemesh();
 };
 
@@ -208,8 +209,8 @@ void DGhybrid::compute_backmesh_points()
 	std::cout << "DGhybrid: compute_backmesh_points(): Backmesh has " << nbackp << " points." << std::endl;
 }
 
-/// Generates the background mesh and computes displacements of its nodes using linear elasticity
-void DGhybrid::generate_backmesh_and_compute_displacements()
+/// Generates the background mesh and computes displacements of its nodes using RBF mesh movement
+bool DGhybrid::generate_backmesh_and_compute_displacements()
 {
 	// make a list of interior points of the quadratic mesh
 	
@@ -276,7 +277,10 @@ void DGhybrid::generate_backmesh_and_compute_displacements()
 	// setup and solve the RBF equations to get displacement of the background mesh
 	std::cout << "Starting RBF" << std::endl;
 	rm.setup(&bm_interior_points, &bm_boun_points, &bm_boun_disp, 2, srad, 1, tol, maxiter, solver);
-	rm.move();
+	if(!rm.move()) {
+		std::cout << "! DGhybrid: generate_backmesh_and_compute_displacements(): RBF mesh movement failed!" << std::endl;
+		return false;
+	}
 
 	amat::Matrix<double> movedInteriorPoints = rm.getInteriorPoints();
 
@@ -284,6 +288,7 @@ void DGhybrid::generate_backmesh_and_compute_displacements()
 	for(ip = nbpoin_q; ip < nbackp; ip++)
 		for(idim = 0; idim < m->gndim(); idim++)
 			motion_b(ip,idim) = movedInteriorPoints.get(ip-nbpoin_q,idim) - bm_interior_points.get(ip-nbpoin_q,idim);
+	return true;
 }
 
 void DGhybrid::movemesh()
@@ -62,7 +62,8 @@ int main(int argc, char* argv[])
 	Curvedmeshgen2d cmg;
 	cmg.setup(&m, &mq, nsplineparts, splineflags, PI/180.0*cornerangle, spltol, splmaxiter, rbftol, rbfmaxiter, rbf_solver, supportradius, nlayers);
 	cmg.compute_boundary_displacements();
-	cmg.generate_curved_mesh();
+	if(!cmg.generate_curved_mesh())
+		return -1;
 	
 	mq.writeGmsh2(str_curvedmesh);
 
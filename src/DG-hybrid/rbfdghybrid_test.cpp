@@ -44,7 +44,8 @@ int main(int argc, char* argv[])
 
 	DGhybrid dgh(&m,&mq,&bounmotion, nlayers, suprad, tolerance, maxiter, solver);
 	dgh.compute_backmesh_points();
-	dgh.generate_backmesh_and_compute_displacements();
+	if(!dgh.generate_backmesh_and_compute_displacements())
+		return -1;
 	dgh.movemesh();
 
 	mq.writeGmsh2(outmesh);
@@ -48,6 +48,9 @@ int main(int argc, char* argv[])
 	fin >> dum; fin >> numbins[0];
 	fin >> dum; fin >> numbins[1];
 	fin >> dum; fin >> numbins[2];
+	// optional: order of insertion of points - 0 : as given (after bin sort), 1 : Hilbert curve, 2 : BRIO
+	int ordering = ORDER_HILBERT;
+	if(fin >> dum) fin >> ordering;
 	fin.close();
 	
 	amc_int npoints;
@@ -69,6 +72,7 @@ int main(int argc, char* argv[])
 	}
 	
 	Delaunay3d d3(sortedpoints);
+	d3.set_ordering((PointOrdering)ordering);
 	d3.bowyer_watson();
 
 	//d3.compute_jacobians();
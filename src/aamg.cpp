@@ -0,0 +1,551 @@
+#include "aamg.hpp"
+
+#ifndef _GLIBCXX_ALGORITHM
+#include <algorithm>
+#endif
+
+namespace amat {
+
+/// Computes C := A B for sparse matrices in compressed row storage; the rows of C are sorted
+static void spgemm(const MatrixCSR<amc_real>& A, const MatrixCSR<amc_real>& B, MatrixCSR<amc_real>& C)
+{
+	const int n = A.rows(), m = B.cols();
+	const int* const arp = A.growptr(); const int* const aci = A.gcolind(); const amc_real* const av = A.gval();
+	const int* const brp = B.growptr(); const int* const bci = B.gcolind(); const amc_real* const bv = B.gval();
+	std::vector<int> rp(n+1,0);
+	int* const crp = rp.data();
+
+	// count the non-zeros of each row
+	#pragma omp parallel default(none) shared(n, m, arp, aci, brp, bci, crp)
+	{
+		std::vector<int> marker(m,-1);
+		#pragma omp for schedule(dynamic,256)
+		for(int i = 0; i < n; i++)
+		{
+			int count = 0;
+			for(int ka = arp[i]; ka < arp[i+1]; ka++)
+				for(int kb = brp[aci[ka]]; kb < brp[aci[ka]+1]; kb++)
+					if(marker[bci[kb]] != i) {
+						marker[bci[kb]] = i;
+						count++;
+					}
+			crp[i+1] = count;
+		}
+	}
+	for(int i = 0; i < n; i++)
+		rp[i+1] += rp[i];
+
+	std::vector<int> ci(rp[n]);
+	std::vector<amc_real> cv(rp[n]);
+	int* const cci = ci.data(); amc_real* const ccv = cv.data();
+
+	#pragma omp parallel default(none) shared(n, m, arp, aci, av, brp, bci, bv, crp, cci, ccv)
+	{
+		std::vector<int> marker(m,-1), pos(m);
+		std::vector<std::pair<int,amc_real>> row;
+		#pragma omp for schedule(dynamic,256)
+		for(int i = 0; i < n; i++)
+		{
+			int k = crp[i];
+			for(int ka = arp[i]; ka < arp[i+1]; ka++)
+				for(int kb = brp[aci[ka]]; kb < brp[aci[ka]+1]; kb++)
+				{
+					const int j = bci[kb];
+					if(marker[j] != i) {
+						marker[j] = i;
+						pos[j] = k;
+						cci[k] = j;
+						ccv[k] = av[ka]*bv[kb];
+						k++;
+					}
+					else
+						ccv[pos[j]] += av[ka]*bv[kb];
+				}
+
+			row.resize(crp[i+1]-crp[i]);
+			for(int kk = crp[i]; kk < crp[i+1]; kk++)
+				row[kk-crp[i]] = std::make_pair(cci[kk], ccv[kk]);
+			std::sort(row.begin(), row.end(), [](const std::pair<int,amc_real>& a, const std::pair<int,amc_real>& b) { return a.first < b.first; });
+			for(int kk = crp[i]; kk < crp[i+1]; kk++) {
+				cci[kk] = row[kk-crp[i]].first;
+				ccv[kk] = row[kk-crp[i]].second;
+			}
+		}
+	}
+
+	C.assign(n, m, rp.data(), ci.data(), cv.data());
+}
+
+/// Computes T := A^T for a sparse matrix in compressed row storage
+static void transpose(const MatrixCSR<amc_real>& A, MatrixCSR<amc_real>& T)
+{
+	const int n = A.rows(), m = A.cols();
+	const int* const rp = A.growptr(); const int* const ci = A.gcolind(); const amc_real* const v = A.gval();
+	std::vector<int> trp(m+1,0), tci(rp[n]);
+	std::vector<amc_real> tv(rp[n]);
+	for(int k = 0; k < rp[n]; k++)
+		trp[ci[k]+1]++;
+	for(int j = 0; j < m; j++)
+		trp[j+1] += trp[j];
+	std::vector<int> next(trp.begin(), trp.end()-1);
+	for(int i = 0; i < n; i++)
+		for(int k = rp[i]; k < rp[i+1]; k++) {
+			tci[next[ci[k]]] = i;
+			tv[next[ci[k]]++] = v[k];
+		}
+	T.assign(m, n, trp.data(), tci.data(), tv.data());
+}
+
+/// Groups the nodes of a level into aggregates of strongly connected neighbourhoods
+/** \param nodeptr and nodedofs list the unknowns of each node, in compressed storage
+ * \param[out] agg is the aggregate each node belongs to, or -1 for nodes without strong connections
+ * \return the number of aggregates
+ */
+static int aggregate(const MatrixCSR<amc_real>& A, const std::vector<int>& nodeptr, const std::vector<int>& nodedofs, const amc_real theta,
+		std::vector<int>& agg)
+{
+	const int nnode = nodeptr.size()-1;
+	const int* const rp = A.growptr(); const int* const ci = A.gcolind(); const amc_real* const v = A.gval();
+	std::vector<int> dofnode(A.rows());
+	for(int i = 0; i < nnode; i++)
+		for(int k = nodeptr[i]; k < nodeptr[i+1]; k++)
+			dofnode[nodedofs[k]] = i;
+
+	// squared Frobenius norms of the diagonal blocks
+	std::vector<amc_real> dnorm(nnode,0);
+	for(int i = 0; i < nnode; i++)
+		for(int kd = nodeptr[i]; kd < nodeptr[i+1]; kd++)
+			for(int k = rp[nodedofs[kd]]; k < rp[nodedofs[kd]+1]; k++)
+				if(dofnode[ci[k]] == i)
+					dnorm[i] += v[k]*v[k];
+
+	// strong connections: ||A_ij|| > theta sqrt(||A_ii|| ||A_jj||)
+	std::vector<int> sptr(nnode+1,0), sadj;
+	std::vector<int> marker(nnode,-1), nbrs;
+	std::vector<amc_real> acc(nnode);
+	for(int i = 0; i < nnode; i++)
+	{
+		nbrs.clear();
+		for(int kd = nodeptr[i]; kd < nodeptr[i+1]; kd++)
+			for(int k = rp[nodedofs[kd]]; k < rp[nodedofs[kd]+1]; k++)
+			{
+				const int j = dofnode[ci[k]];
+				if(j == i) continue;
+				if(marker[j] != i) {
+					marker[j] = i;
+					acc[j] = 0;
+					nbrs.push_back(j);
+				}
+				acc[j] += v[k]*v[k];
+			}
+		for(size_t jj = 0; jj < nbrs.size(); jj++)
+			if(acc[nbrs[jj]] > theta*theta*sqrt(dnorm[i]*dnorm[nbrs[jj]]))
+				sadj.push_back(nbrs[jj]);
+		sptr[i+1] = sadj.size();
+	}
+
+	// phase 1: nodes whose strong neighbours are all free form aggregates with them
+	agg.assign(nnode,-1);
+	int nagg = 0;
+	for(int i = 0; i < nnode; i++)
+	{
+		if(agg[i] >= 0 || sptr[i+1] == sptr[i]) continue;
+		bool free = true;
+		for(int k = sptr[i]; k < sptr[i+1] && free; k++)
+			if(agg[sadj[k]] >= 0)
+				free = false;
+		if(!free) continue;
+		agg[i] = nagg;
+		for(int k = sptr[i]; k < sptr[i+1]; k++)
+			agg[sadj[k]] = nagg;
+		nagg++;
+	}
+
+	// phase 2: remaining nodes join an aggregate of phase 1 that they are strongly connected to
+	const std::vector<int> agg1(agg);
+	for(int i = 0; i < nnode; i++)
+	{
+		if(agg[i] >= 0) continue;
+		for(int k = sptr[i]; k < sptr[i+1]; k++)
+			if(agg1[sadj[k]] >= 0) {
+				agg[i] = agg1[sadj[k]];
+				break;
+			}
+	}
+
+	// phase 3: nodes that are still left over form aggregates with their free strong neighbours
+	for(int i = 0; i < nnode; i++)
+	{
+		if(agg[i] >= 0 || sptr[i+1] == sptr[i]) continue;
+		agg[i] = nagg;
+		for(int k = sptr[i]; k < sptr[i+1]; k++)
+			if(agg[sadj[k]] < 0)
+				agg[sadj[k]] = nagg;
+		nagg++;
+	}
+
+	return nagg;
+}
+
+/// Estimates the spectral radius of D^(-1) A by power iterations
+static amc_real spectral_radius(const MatrixCSR<amc_real>& A, const std::vector<amc_real>& invdiag)
+{
+	const int n = A.rows();
+	const amc_int* const rp = A.growptr();
+	const amc_real* const v = A.gval();
+
+	// Gershgorin bound, which is safe but usually pessimistic
+	amc_real gersh = 0;
+	for(int i = 0; i < n; i++)
+	{
+		amc_real rowsum = 0;
+		for(amc_int j = rp[i]; j < rp[i+1]; j++)
+			rowsum += fabs(v[j]);
+		gersh = std::max(gersh, rowsum*fabs(invdiag[i]));
+	}
+
+	// power iterations, started from an oscillatory vector so that the largest eigenvalues are well represented
+	Matrix<amc_real> x(n,1), y(n,1);
+	unsigned int seed = 12345;
+	for(int i = 0; i < n; i++) {
+		seed = seed*1103515245u + 12345u;
+		x(i) = (amc_real)((seed >> 16) & 0x7fff)/32768.0 - 0.5;
+	}
+	x.scal(1.0/x.l2norm());
+	amc_real rho = 0;
+	for(int it = 0; it < 30; it++)
+	{
+		A.multiply(x, &y);
+		for(int i = 0; i < n; i++)
+			y(i) *= invdiag[i];
+		rho = y.l2norm();
+		if(rho == 0) break;
+		y.scal(1.0/rho);
+		x = y;
+	}
+
+	// power iterations approach the spectral radius from below
+	return std::min(1.1*rho, gersh);
+}
+
+AMG::AMG(const amc_real strength_threshold, const int smoother_degree) : densecoarse(true), theta(strength_threshold), degree(smoother_degree)
+{ }
+
+bool AMG::setup(const SpMatrix& A, const Matrix<amc_real>& coords, const int nvar)
+{
+	const MatrixCSR<amc_real> Af(A);
+	return setup(Af, coords, nvar);
+}
+
+bool AMG::setup(const MatrixCSR<amc_real>& A, const Matrix<amc_real>& coords, const int nvar)
+{
+	const int npoin = coords.rows(), ndim = coords.cols();
+	if(A.rows() != nvar*npoin || A.cols() != A.rows()) {
+		std::cout << "! AMG: setup(): The size of the matrix does not match the number of points and variables!" << std::endl;
+		return false;
+	}
+
+	// near-nullspace: rigid body modes about the centroid, or constants
+	const int nnull = (nvar == ndim && ndim == 2) ? 3 : ((nvar == ndim && ndim == 3) ? 6 : nvar);
+	Matrix<amc_real> B(A.rows(), nnull);
+	B.zeros();
+	amc_real c[3] = {0,0,0};
+	for(int ip = 0; ip < npoin; ip++)
+		for(int idim = 0; idim < ndim && idim < 3; idim++)
+			c[idim] += coords.get(ip,idim)/npoin;
+	for(int ip = 0; ip < npoin; ip++)
+	{
+		for(int iv = 0; iv < nvar; iv++)
+			B(iv*npoin+ip, iv) = 1.0;
+		if(nnull == 3) {
+			B(ip, 2) = -(coords.get(ip,1)-c[1]);
+			B(npoin+ip, 2) = coords.get(ip,0)-c[0];
+		}
+		else if(nnull == 6) {
+			const amc_real x = coords.get(ip,0)-c[0], y = coords.get(ip,1)-c[1], z = coords.get(ip,2)-c[2];
+			B(npoin+ip, 3) = -z; B(2*npoin+ip, 3) = y;
+			B(ip, 4) = z; B(2*npoin+ip, 4) = -x;
+			B(ip, 5) = -y; B(npoin+ip, 5) = x;
+		}
+	}
+
+	// the nodes of the finest level are the points
+	std::vector<int> nodeptr(npoin+1), nodedofs(A.rows());
+	for(int ip = 0; ip <= npoin; ip++)
+		nodeptr[ip] = ip*nvar;
+	for(int ip = 0; ip < npoin; ip++)
+		for(int iv = 0; iv < nvar; iv++)
+			nodedofs[ip*nvar+iv] = iv*npoin+ip;
+
+	levels.clear();
+	levels.push_back(Level());
+	levels[0].A = A;
+	std::vector<int> agg;
+
+	while(true)
+	{
+		const int l = levels.size()-1;
+		Level& L = levels[l];
+		const int n = L.A.rows();
+		const int* const rp = L.A.growptr(); const int* const ci = L.A.gcolind(); const amc_real* const v = L.A.gval();
+
+		L.invdiag.assign(n, 0.0);
+		for(int i = 0; i < n; i++)
+		{
+			const int* const pos = std::lower_bound(ci+rp[i], ci+rp[i+1], i);
+			if(pos == ci+rp[i+1] || *pos != i || v[pos-ci] == 0) {
+				std::cout << "! AMG: setup(): Zero diagonal entry in row " << i << " of level " << l << "!" << std::endl;
+				return false;
+			}
+			L.invdiag[i] = 1.0/v[pos-ci];
+		}
+		L.rho = spectral_radius(L.A, L.invdiag);
+		L.b.setup(n,1); L.x.setup(n,1); L.r.setup(n,1); L.d.setup(n,1); L.t.setup(n,1);
+
+		if(n <= AMG_COARSEST_SIZE || l+1 >= AMG_MAX_LEVELS)
+			break;
+
+		const int nagg = aggregate(L.A, nodeptr, nodedofs, theta, agg);
+		if(nagg == 0)
+			break;
+
+		// unknowns of each aggregate
+		std::vector<int> aggptr(nagg+1,0), aggdofs;
+		for(size_t i = 0; i < agg.size(); i++)
+			if(agg[i] >= 0)
+				aggptr[agg[i]+1] += nodeptr[i+1]-nodeptr[i];
+		for(int a = 0; a < nagg; a++)
+			aggptr[a+1] += aggptr[a];
+		aggdofs.resize(aggptr[nagg]);
+		std::vector<int> next(aggptr.begin(), aggptr.end()-1);
+		for(size_t i = 0; i < agg.size(); i++)
+			if(agg[i] >= 0)
+				for(int k = nodeptr[i]; k < nodeptr[i+1]; k++)
+					aggdofs[next[agg[i]]++] = nodedofs[k];
+
+		// orthonormalize the near-nullspace on each aggregate by modified Gram-Schmidt; columns that become dependent are dropped
+		std::vector<int> cptr(nagg+1,0);
+		std::vector<amc_real> q(aggptr[nagg]*nnull), rfac((size_t)nagg*nnull*nnull, 0.0);
+		for(int a = 0; a < nagg; a++)
+		{
+			const int m = aggptr[a+1]-aggptr[a];
+			amc_real* const qa = &q[(size_t)aggptr[a]*nnull];			// column kq of the local Q starts at qa + kq*m
+			amc_real* const ra = &rfac[(size_t)a*nnull*nnull];			// row-major nnull x nnull
+			int kq = 0;
+			for(int jc = 0; jc < nnull; jc++)
+			{
+				amc_real* const w = qa + kq*m;
+				amc_real norm0 = 0;
+				for(int t = 0; t < m; t++) {
+					w[t] = B.get(aggdofs[aggptr[a]+t], jc);
+					norm0 += w[t]*w[t];
+				}
+				norm0 = sqrt(norm0);
+				for(int iq = 0; iq < kq; iq++)
+				{
+					amc_real dot = 0;
+					for(int t = 0; t < m; t++)
+						dot += qa[iq*m+t]*w[t];
+					for(int t = 0; t < m; t++)
+						w[t] -= dot*qa[iq*m+t];
+					ra[iq*nnull+jc] = dot;
+				}
+				amc_real norm = 0;
+				for(int t = 0; t < m; t++)
+					norm += w[t]*w[t];
+				norm = sqrt(norm);
+				if(norm0 > 0 && norm > 1e-8*norm0 && kq < m) {
+					for(int t = 0; t < m; t++)
+						w[t] /= norm;
+					ra[kq*nnull+jc] = norm;
+					kq++;
+				}
+			}
+			cptr[a+1] = cptr[a] + kq;
+		}
+		const int nc = cptr[nagg];
+
+		// stop if coarsening has stagnated
+		if(nc > 0.8*n) {
+			std::cout << "AMG: setup(): Coarsening stagnated at level " << l << std::endl;
+			break;
+		}
+
+		// tentative prolongation operator: each fine unknown is connected to the coarse unknowns of its aggregate
+		std::vector<int> dofagg(n,-1), dofloc(n);
+		for(int a = 0; a < nagg; a++)
+			for(int k = aggptr[a]; k < aggptr[a+1]; k++) {
+				dofagg[aggdofs[k]] = a;
+				dofloc[aggdofs[k]] = k-aggptr[a];
+			}
+		std::vector<int> p0ptr(n+1,0), p0col;
+		std::vector<amc_real> p0val;
+		for(int i = 0; i < n; i++)
+		{
+			const int a = dofagg[i];
+			if(a >= 0) {
+				const int m = aggptr[a+1]-aggptr[a];
+				for(int iq = 0; iq < cptr[a+1]-cptr[a]; iq++) {
+					p0col.push_back(cptr[a]+iq);
+					p0val.push_back(q[(size_t)aggptr[a]*nnull + iq*m + dofloc[i]]);
+				}
+			}
+			p0ptr[i+1] = p0col.size();
+		}
+		MatrixCSR<amc_real> P0;
+		P0.assign(n, nc, p0ptr.data(), p0col.data(), p0val.data());
+
+		// coarse near-nullspace and nodes
+		Matrix<amc_real> Bc(nc, nnull);
+		for(int a = 0; a < nagg; a++)
+			for(int iq = 0; iq < cptr[a+1]-cptr[a]; iq++)
+				for(int jc = 0; jc < nnull; jc++)
+					Bc(cptr[a]+iq, jc) = rfac[(size_t)a*nnull*nnull + iq*nnull + jc];
+
+		// smoothed prolongation P = (I - omega D^(-1) A) P0
+		const amc_real omega = 4.0/3.0/L.rho;
+		std::vector<amc_real> sv(v, v+rp[n]);
+		for(int i = 0; i < n; i++)
+			for(int k = rp[i]; k < rp[i+1]; k++)
+				sv[k] = (ci[k] == i ? 1.0 : 0.0) - omega*L.invdiag[i]*v[k];
+		MatrixCSR<amc_real> S;
+		S.assign(n, n, rp, ci, sv.data());
+		spgemm(S, P0, L.P);
+		transpose(L.P, L.R);
+
+		// Galerkin coarse matrix
+		MatrixCSR<amc_real> AP;
+		spgemm(L.A, L.P, AP);
+		Level C;
+		spgemm(L.R, AP, C.A);
+		levels.push_back(C);
+
+		B = Bc;
+		nodeptr = cptr;
+		nodedofs.resize(nc);
+		for(int i = 0; i < nc; i++)
+			nodedofs[i] = i;
+	}
+
+	// factor the coarsest matrix, unless coarsening stalled while it was still large
+	const Level& Lc = levels.back();
+	const int nc = Lc.A.rows();
+	densecoarse = nc <= AMG_MAX_DENSE_COARSE_SIZE;
+	if(densecoarse)
+	{
+		coarsefactor.setup(nc,nc);
+		coarsefactor.zeros();
+		for(int i = 0; i < nc; i++)
+			for(int k = Lc.A.growptr()[i]; k < Lc.A.growptr()[i+1]; k++)
+				coarsefactor(i, Lc.A.gcolind()[k]) = Lc.A.gval()[k];
+		if(!cholfactor(coarsefactor)) {
+			std::cout << "! AMG: setup(): The coarsest matrix is not positive definite!" << std::endl;
+			return false;
+		}
+	}
+	else
+		std::cout << "AMG: setup(): The coarsest level has " << nc << " unknowns, too many to factor; it is solved by "
+			<< AMG_COARSE_SMOOTHING_SWEEPS << " smoother sweeps." << std::endl;
+
+	double opcomplexity = 0;
+	for(size_t l = 0; l < levels.size(); l++) {
+		std::cout << "AMG: setup(): Level " << l << ": " << levels[l].A.rows() << " unknowns, " << levels[l].A.getnnz() << " non-zeros" << std::endl;
+		opcomplexity += levels[l].A.getnnz();
+	}
+	std::cout << "AMG: setup(): Operator complexity = " << opcomplexity/levels[0].A.getnnz() << std::endl;
+	return true;
+}
+
+/** Chebyshev polynomial of D^(-1) A that is small on [lmax/30, lmax], where lmax is a little larger than the estimate of
+ * the spectral radius of D^(-1) A. See Adams, Brezina, Hu and Tuminaro, J. Comput. Phys. 188 (2003).
+ */
+void AMG::smooth(const int l, const Matrix<amc_real>& b, Matrix<amc_real>& x) const
+{
+	const Level& L = levels[l];
+	const int n = L.A.rows();
+	Matrix<amc_real>& r = L.r;
+	Matrix<amc_real>& d = L.d;
+	const amc_real lmax = L.rho, lmin = lmax/30.0;
+	const amc_real th = 0.5*(lmax+lmin), delta = 0.5*(lmax-lmin), sigma = th/delta;
+	amc_real cr = 1.0/sigma;
+
+	L.A.multiply(x, &r);
+	r.aypx(-1.0, b);					// r := b - A x
+	for(int i = 0; i < n; i++)
+		d(i) = L.invdiag[i]*r(i)/th;
+	x += d;
+
+	for(int k = 1; k < degree; k++)
+	{
+		L.A.multiply(d, &L.t);
+		r -= L.t;				// r := b - A x for the updated x
+		const amc_real crnew = 1.0/(2.0*sigma - cr);
+		for(int i = 0; i < n; i++)
+			d(i) = crnew*cr*d(i) + 2.0*crnew/delta*L.invdiag[i]*r(i);
+		x += d;
+		cr = crnew;
+	}
+}
+
+void AMG::vcycle(const int l, const Matrix<amc_real>& b, Matrix<amc_real>& x) const
+{
+	if(l == (int)levels.size()-1) {
+		// smoothing repeatedly from zero applies a fixed polynomial in A to b, so the V-cycle stays a symmetric preconditioner
+		if(densecoarse)
+			cholsolve(coarsefactor, b, x);
+		else
+			for(int is = 0; is < AMG_COARSE_SMOOTHING_SWEEPS; is++)
+				smooth(l, b, x);
+		return;
+	}
+
+	const Level& L = levels[l];
+	const Level& C = levels[l+1];
+
+	smooth(l, b, x);
+
+	L.A.multiply(x, &L.r);
+	L.r.aypx(-1.0, b);
+	L.R.multiply(L.r, &C.b);
+	C.x.zeros();
+	vcycle(l+1, C.b, C.x);
+	L.P.multiply(C.x, &L.d);
+	x += L.d;
+
+	smooth(l, b, x);
+}
+
+void AMG::apply(const Matrix<amc_real>& r, Matrix<amc_real>& z) const
+{
+	z.zeros();
+	vcycle(0, r, z);
+}
+
+Matrix<amc_real> AMG::solve(const Matrix<amc_real>& b, const Matrix<amc_real>& xold, const double tol, const int maxiter) const
+{
+	const Level& L = levels[0];
+	Matrix<amc_real> x(xold);
+	Matrix<amc_real> r(b.rows(),1);
+	const amc_real normalizer = b.l2norm();
+
+	L.A.multiply(x, &r);
+	r.aypx(-1.0, b);
+	amc_real resnorm = r.l2norm()/normalizer;
+	int steps = 0;
+	while(resnorm > tol && steps < maxiter)
+	{
+		if(steps % 10 == 0)
+			std::cout << "AMG: solve(): Iteration " << steps << ", relative residual = " << resnorm << std::endl;
+		vcycle(0, b, x);
+		L.A.multiply(x, &r);
+		r.aypx(-1.0, b);
+		resnorm = r.l2norm()/normalizer;
+		steps++;
+	}
+	if(resnorm > tol)
+		std::cout << "! AMG: solve(): Max iterations reached!" << std::endl;
+	std::cout << "AMG: solve(): Done. Number of V-cycles: " << steps << "; final residual " << resnorm << std::endl;
+	return x;
+}
+
+}
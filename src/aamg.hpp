@@ -0,0 +1,95 @@
+/** \file aamg.hpp
+ * \brief Smoothed-aggregation algebraic multigrid, as a solver and as a preconditioner for CG.
+ * \author Aditya Kashi
+ *
+ * The hierarchy is built as follows (Vanek, Mandel and Brezina, 1996).
+ * - The unknowns are grouped into nodes (mesh points on the finest level). Two nodes are strongly connected if the
+ *   Frobenius norm of the block of the matrix coupling them is large compared to their diagonal blocks.
+ * - Nodes are grouped into aggregates of strongly connected neighbourhoods. Nodes without strong connections, such as those with
+ *   Dirichlet conditions imposed by penalty, are left out; the smoother takes care of them.
+ * - The near-nullspace (the rigid body modes, for elasticity) is restricted to each aggregate and orthonormalized, giving the
+ *   tentative prolongation operator; the triangular factors become the near-nullspace of the coarse level.
+ * - The tentative prolongation is smoothed by one damped Jacobi step, and the coarse matrix is the Galerkin product R A P with R = P^T.
+ *
+ * The smoother is a Jacobi-preconditioned Chebyshev polynomial, which is symmetric and computed with matrix-vector products only,
+ * so that the V-cycle is a symmetric preconditioner and runs in parallel. The coarsest level is solved by dense Cholesky factorization,
+ * unless coarsening stalled before it became small enough for that; it is then solved approximately by a fixed number of smoother sweeps.
+ * Each level has several times fewer unknowns than the one above, so the cost of setup and of a V-cycle is proportional to the number of unknowns.
+ */
+
+#ifndef __AAMG_H
+
+#ifndef __ALINALG_H
+#include <alinalg.hpp>
+#endif
+
+#ifndef _GLIBCXX_VECTOR
+#include <vector>
+#endif
+
+#define __AAMG_H 1
+
+/// The hierarchy is not coarsened further once a level has this many unknowns or fewer
+#define AMG_COARSEST_SIZE 300
+#define AMG_MAX_LEVELS 12
+/// The coarsest level is only factored densely if it has at most this many unknowns
+#define AMG_MAX_DENSE_COARSE_SIZE 2000
+/// Number of smoother applications used as the solve on a coarsest level that is too large to be factored densely
+#define AMG_COARSE_SMOOTHING_SWEEPS 10
+
+namespace amat {
+
+/// Smoothed-aggregation algebraic multigrid for symmetric positive definite systems, such as those of linear elasticity ("AMG", "AMGCG")
+class AMG : public Preconditioner
+{
+	/// One level of the multigrid hierarchy
+	struct Level
+	{
+		MatrixCSR<amc_real> A;
+		std::vector<amc_real> invdiag;			///< Inverse of the diagonal of A
+		amc_real rho;							///< Upper estimate of the spectral radius of D^(-1) A
+		MatrixCSR<amc_real> P;					///< Prolongation from the next coarser level
+		MatrixCSR<amc_real> R;					///< Restriction to the next coarser level
+		mutable Matrix<amc_real> b, x, r, d, t;	///< Work vectors for the V-cycle
+	};
+
+	std::vector<Level> levels;
+	Matrix<amc_real> coarsefactor;				///< Cholesky factor of the matrix of the coarsest level
+	bool densecoarse;							///< False if the coarsest level is solved by smoother sweeps instead of coarsefactor
+	amc_real theta;								///< Threshold for strong connections
+	int degree;									///< Degree of the Chebyshev smoother
+
+	/// Applies the Chebyshev smoother to the system of level l, improving x in place
+	void smooth(const int l, const Matrix<amc_real>& b, Matrix<amc_real>& x) const;
+
+	/// Carries out one V-cycle for the system of level l, improving x in place
+	void vcycle(const int l, const Matrix<amc_real>& b, Matrix<amc_real>& x) const;
+
+public:
+	/** \param strength_threshold is the threshold for strong connections between nodes
+	 * \param smoother_degree is the degree of the Chebyshev polynomial used for pre- and post-smoothing
+	 */
+	AMG(const amc_real strength_threshold = 0.08, const int smoother_degree = 2);
+
+	/// Builds the multigrid hierarchy for the matrix A of a problem with nvar unknowns at each of the points with coordinates coords
+	/** The unknowns must be ordered variable by variable: unknown ivar of point ipoin is number ivar*npoin + ipoin, as in LinElastP1 and LinElastP2.
+	 * If nvar equals the number of dimensions, the near-nullspace is the set of rigid body modes of the points (3 in 2D, 6 in 3D);
+	 * otherwise, it consists of a constant for each variable.
+	 * \return false if the matrix has a zero diagonal entry, or the coarsest matrix could not be factored
+	 */
+	bool setup(const MatrixCSR<amc_real>& A, const Matrix<amc_real>& coords, const int nvar);
+
+	/// Builds the multigrid hierarchy from a MatrixCRS; see the other overload
+	bool setup(const SpMatrix& A, const Matrix<amc_real>& coords, const int nvar);
+
+	int gnlevels() const { return (int)levels.size(); }
+
+	/// Applies one V-cycle, starting from zero, to r
+	void apply(const Matrix<amc_real>& r, Matrix<amc_real>& z) const;
+
+	/// Solves Ax = b by V-cycle iterations, starting from xold, until the residual decreases by a factor tol
+	Matrix<amc_real> solve(const Matrix<amc_real>& b, const Matrix<amc_real>& xold, const double tol, const int maxiter) const;
+};
+
+}
+#endif
@@ -28,6 +28,9 @@
 #ifndef __AMATRIX_H
 #include <amatrix.hpp>
 #endif
+#ifndef __ASFCSORT_H
+#include <asfcsort.hpp>
+#endif
 
 #define __ABOWYERWATSON_H 1
 
@@ -66,12 +69,17 @@ struct Walkdata
 };
 
 /// Delaunay triangulation of a set of 2D points
+/** Points are inserted in the order given by [ordering](@ref ordering) (by default, along a Hilbert curve),
+ * but node i+3 during triangulation (and node i after it) is always input point i.
+ */
 class Delaunay2D
 {
 	int cap;
 	int badcap;
 	double tol;
 	int nnode;
+	PointOrdering ordering;			///< Order in which points are inserted; see asfcsort.hpp
+	std::vector<amc_int> insorder;	///< Indices of points in the order in which they are inserted
 public:
 	amat::Matrix<double> points;
 	std::vector<Point2> nodes;
@@ -83,7 +91,7 @@ public:
 
 	int npoints;
 
-	Delaunay2D() {}
+	Delaunay2D() : ordering(ORDER_HILBERT) {}
 
 	Delaunay2D(amat::Matrix<double>* _points)
 	{
@@ -91,6 +99,7 @@ public:
 		cap = 1000;
 		badcap = 50;
 		tol = A_SMALL_NUMBER;
+		ordering = ORDER_HILBERT;
 		elems.reserve(cap);
 		faces.reserve(cap);
 		//nelem = 0;
@@ -105,6 +114,7 @@ public:
 		badcap = other.badcap;
 		tol = other.tol;
 		nnode = other.nnode;
+		ordering = other.ordering;
 		points = other.points;
 		nodes = other.nodes;
 		elems = other.elems;
@@ -119,6 +129,7 @@ public:
 		badcap = other.badcap;
 		tol = other.tol;
 		nnode = other.nnode;
+		ordering = other.ordering;
 		points = other.points;
 		nodes = other.nodes;
 		elems = other.elems;
@@ -134,6 +145,7 @@ public:
 		cap = 1000;
 		badcap = 50;
 		tol = A_SMALL_NUMBER;
+		ordering = ORDER_HILBERT;
 		elems.reserve(cap);
 		faces.reserve(cap);
 		points = *_points;
@@ -141,6 +153,9 @@ public:
 		nodes.reserve(npoints+3);
 	}
 
+	/// Sets the order in which points are inserted by [bowyer_watson](@ref bowyer_watson)
+	void set_ordering(const PointOrdering order) { ordering = order; }
+
 	/// Walk through the mesh from element to element, until the element containing a given point is found.
 	/** NOTE: It will be better to find the minimum of the area coordinates and move to the next element according to that, as done in the 3D code.
 	 */
@@ -245,15 +260,22 @@ public:
 			faces.push_back(f[i]);
 		}
 
-		// iterate through points
-		std::cout << "Delaunay2D: Starting iteration over points\n";
+		// all nodes are added first, so that node numbers do not depend on the order of insertion
 		for(int ipoin = 0; ipoin < npoints; ipoin++)
 		{
 			Point2 newpoin; newpoin.x = points(ipoin,0); newpoin.y = points(ipoin,1);
 			nodes.push_back(newpoin);
-			int newpoinnum = nodes.size()-1;
+		}
+		compute_insertion_order(points, ordering, insorder);
+
+		// iterate through points
+		std::cout << "Delaunay2D: Starting iteration over points\n";
+		for(int iord = 0; iord < npoints; iord++)
+		{
+			const int ipoin = insorder[iord];
+			int newpoinnum = ipoin+3;
 
-			/// First, find the element containing the new point
+			/// First, find the element containing the new point, starting from the element created last
 			int contelem = find_containing_triangle(points(ipoin,0),points(ipoin,1), elems.size()-1);
 
 #if DEBUG==1
@@ -25,6 +25,7 @@ Delaunay3d::Delaunay3d()
 	cap = 1000;
 	badcap = 50;
 	tol = 1e-10;
+	ordering = ORDER_HILBERT;
 	elems.reserve(cap);
 	faces.reserve(cap);
 	std::cout << std::setprecision(12);
@@ -38,6 +39,7 @@ Delaunay3d::Delaunay3d(amat::Matrix<double>* _points)
 	cap = 1000;
 	badcap = 50;
 	tol = 1e-10;
+	ordering = ORDER_HILBERT;
 	elems.reserve(cap);
 	faces.reserve(cap);
 	points = *_points;
@@ -55,6 +57,7 @@ Delaunay3d::Delaunay3d(const Delaunay3d& other)
 	tol = other.tol;
 	nnode = other.nnode;
 	ndim = other.ndim;
+	ordering = other.ordering;
 	points = other.points;
 	nodes = other.nodes;
 	elems = other.elems;
@@ -71,6 +74,7 @@ Delaunay3d& Delaunay3d::operator=(const Delaunay3d& other)
 	tol = other.tol;
 	nnode = other.nnode;
 	ndim = other.ndim;
+	ordering = other.ordering;
 	points = other.points;
 	nodes = other.nodes;
 	elems = other.elems;
@@ -88,6 +92,7 @@ void Delaunay3d::setup(amat::Matrix<double>* _points)
 	cap = 1000;
 	badcap = 50;
 	tol = 1e-10;
+	ordering = ORDER_HILBERT;
 	elems.reserve(cap);
 	faces.reserve(cap);
 	points = *_points;
@@ -119,9 +124,10 @@ double Delaunay3d::tetvol(const std::vector<double>& a, const std::vector<double
 }
 
 /// Computes 6*volume, ie the Jacobian of any tetrahedron.
+/// The sign of the jacobian is exact, so that slivers with a jacobian that rounds to zero are still recognized as positive
 void Delaunay3d::compute_jacobian(Tet& elem)
 {	
-	elem.D = tetvol(nodes[elem.p[0]],nodes[elem.p[1]],nodes[elem.p[2]],nodes[elem.p[3]]);
+	elem.D = orient3d(nodes[elem.p[1]].data(),nodes[elem.p[0]].data(),nodes[elem.p[2]].data(),nodes[elem.p[3]].data());
 }
 
 /// Computes cross product c of two 3-std::vectors a and b; c = a x b
@@ -203,7 +209,8 @@ void Delaunay3d::compute_circumsphere(Tet& elem)
 		rc[k] = detnum/detdenom;
 	}
 
-	elem.centre = rc;
+	for(k = 0; k < ndim; k++)
+		elem.centre[k] = rc[k];
 	elem.radius = 0.0;
 	
 	// now calculate radius squared
@@ -307,6 +314,7 @@ void Delaunay3d::compute_circumsphere_contra(Tet& elem)
 
 ///	Calculates the jacobian of the tetrahedron formed by point r and a face of tetrahedron ielem.
 /** The face is selected by i between 0 and 3. Face i is the face opposite to local node i of the tetrahedron.
+ * The jacobian of abcd is orient3d(b,a,c,d), so its sign is exact.
 */
 double Delaunay3d::det4(const int ielem, const int i, const std::vector<double>& r) const
 {
@@ -317,13 +325,13 @@ double Delaunay3d::det4(const int ielem, const int i, const std::vector<double>&
 	}
 	#endif
 
-	Tet elem = elems[ielem];
+	const Tet& elem = elems[ielem];
 
-	std::vector<double> ta[4];
+	const double* ta[4];
 	for(int j = 0; j < nnode; j++)
-		ta[j] = nodes[elem.p[j]];
-	ta[i] = r;
-	return tetvol(ta[0],ta[1],ta[2],ta[3]);
+		ta[j] = nodes[elem.p[j]].data();
+	ta[i] = r.data();
+	return orient3d(ta[1],ta[0],ta[2],ta[3]);
 }
 
 /// Locates the Delaunay graph (DG) element which contains the input point.
@@ -389,20 +397,18 @@ int Delaunay3d::find_containing_tet(const std::vector<double>& xx, const int sta
 		return -1;
 	}
 	int ielem = startelement;
-	Tet super;
 	double l, minl; int minln, ii;
-	bool found = false;
 	
 	for(ii = 0; ii < elems.size()+3; ii++)
 	{
 		if(ielem < 0 || ielem >= elems.size()) { std::cout << "Delaunay3d:   !! Reached an element index that is out of bounds!! Index is " << ielem << "\n"; return ielem; }
-		super = elems[ielem];
+		const Tet& super = elems[ielem];
 		minl = 1.0;
 
 		for(int inode = 0; inode < nnode; inode++)
 		{
 			// get jacobian ratio
-			l = det4(ielem,inode,xx)/super.D;
+			l = det4(ielem,inode,xx);
 			if(minl > l)
 			{
 				minl = l;
@@ -478,42 +484,291 @@ inline int Delaunay3d::check_face_tet(const Tet& elem, const Face& face) const
 	return -1;
 }
 
-void Delaunay3d::bowyer_watson()
+bool Delaunay3d::try_lock(const int ielem, InsertionState& st)
 {
-	//	find minimum and maximum x and y of the point set
-	//	scalef contains scaling factors for each direction
-	std::vector<double> rmin(ndim,0), rmax(ndim,0), scalef(ndim);
-	for(int i = 0; i < npoints; i++)
+	if(lockowner.empty())
+		return true;
+	if(lockowner[ielem].load(std::memory_order_relaxed) == st.tid)
+		return true;
+	int expected = -1;
+	if(lockowner[ielem].compare_exchange_strong(expected, st.tid, std::memory_order_acquire))
 	{
-		for(int idim = 0; idim < ndim; idim++) 
+		st.held.push_back(ielem);
+		return true;
+	}
+	return false;
+}
+
+void Delaunay3d::release_locks(InsertionState& st)
+{
+	if(!lockowner.empty())
+		for(size_t i = 0; i < st.held.size(); i++)
+			lockowner[st.held[i]].store(-1, std::memory_order_release);
+	st.held.clear();
+}
+
+Delaunay3d::InsertionResult Delaunay3d::allocate_slots(const int n, InsertionState& st)
+{
+	st.slots.clear();
+	size_t ibe = 0;
+	for( ; ibe < st.badelems.size() && (int)st.slots.size() < n; ibe++)
+		st.slots.push_back(st.badelems[ibe]);
+
+	while((int)st.slots.size() < n)
+	{
+		int islot;
+		if(!st.freelist->empty())
 		{
-			if(points(i,idim) > rmax[idim]) rmax[idim] = points(i,idim);
-			if(points(i,idim) < rmin[idim]) rmin[idim] = points(i,idim);
+			islot = st.freelist->back();
+			st.freelist->pop_back();
+		}
+		else if(lockowner.empty())
+		{
+			islot = elems.size();
+			elems.push_back(Tet());
+			checked.push_back(-1);
+			isbad.push_back(-1);
+		}
+		else
+		{
+			islot = nalloc++;
+			if(islot >= (int)elems.size())
+			{
+				// give back the slots taken so far; the first ibe of them are bad elements
+				for(size_t i = ibe; i < st.slots.size(); i++)
+					st.freelist->push_back(st.slots[i]);
+				return INSERT_POOL_FULL;
+			}
+		}
+
+		st.slots.push_back(islot);
+		// another thread may be looking at this slot, if its walk started from an element that was since removed
+		if(!try_lock(islot, st))
+		{
+			for(size_t i = ibe; i < st.slots.size(); i++)
+				st.freelist->push_back(st.slots[i]);
+			return INSERT_CONFLICT;
 		}
 	}
-	
-	std::cout << "Bounds of the point set are ";
-	for(int idim = 0; idim < ndim; idim++)
-		std::cout << " " << rmin[idim] << " " << rmax[idim] << std::endl;
-	std::cout << "**\n";
 
-	// scale the point coordinates
-	
-	for(int idim = 0; idim < ndim; idim++)
+	// bad elements that are not re-used are freed
+	for( ; ibe < st.badelems.size(); ibe++)
 	{
-		scalef[idim] = (fabs(rmax[idim]) > fabs(rmin[idim])) ? fabs(rmax[idim]) : fabs(rmin[idim]);
+		elems[st.badelems[ibe]].p[0] = -1;
+		st.freelist->push_back(st.badelems[ibe]);
 	}
+	return INSERT_DONE;
+}
 
-	std::cout << "Scaling factors\n";
-	for(int idim = 0; idim < ndim; idim++)
-		std::cout << " " << scalef[idim];
-	std::cout << std::endl;
+Delaunay3d::InsertionResult Delaunay3d::insert_point(const int newpoinnum, InsertionState& st)
+{
+	const Point& newpoin = nodes[newpoinnum];
+	const int stamp = stampcount++;
+	st.held.clear();
+
+	/// First, find the element containing the new point, by a walk from the element created last.
+	/// During parallel insertion, the element being looked at is kept locked, and the previous one is released.
+	int cur = st.lastelem;
+	bool start = false;
+	for(int i = 0; i < (int)elems.size(); i++, cur = (cur+1) % elems.size())
+	{
+		if(!try_lock(cur,st))
+			continue;
+		// the starting element may have been removed by another thread
+		if(elems[cur].p[0] >= 0) {
+			start = true;
+			break;
+		}
+		release_locks(st);
+	}
+	if(!start) {
+		release_locks(st);
+		return INSERT_CONFLICT;
+	}
 
-	for(int i = 0; i < npoints; i++)
-		for(int idim = 0; idim < ndim; idim++)
-			points(i,idim) /= scalef[idim];
+	// the jacobians of all elements are positive, so the signs of det4 alone decide the direction of the walk
+	int contelem = -1;
+	for(int ii = 0; ii < (int)elems.size()+3; ii++)
+	{
+		const Tet& elem = elems[cur];
+		double minl = 0; int minln = -1;
+		for(int inode = 0; inode < nnode; inode++)
+		{
+			const double l = det4(cur,inode,newpoin);
+			if(l < minl)
+			{
+				minl = l;
+				minln = inode;
+			}
+		}
+		if(minln < 0) {
+			contelem = cur;
+			break;
+		}
+
+		const int next = elem.surr[minln];
+		if(next < 0 || !try_lock(next,st)) {
+			release_locks(st);
+			return INSERT_CONFLICT;
+		}
+		if(!lockowner.empty())
+		{
+			lockowner[cur].store(-1, std::memory_order_release);
+			st.held.clear();
+			st.held.push_back(next);
+		}
+		cur = next;
+	}
+	if(contelem < 0) {
+		std::cout << "Delaunay3d: insert_point(): ! Could not find host element!" << std::endl;
+		release_locks(st);
+		return INSERT_CONFLICT;
+	}
+
+	/// Second, search among neighbors for other tets whose circumspheres contain this point
+	st.stk.clear();
+	st.badelems.clear();
+	st.stk.push_back(contelem);
+	while(st.stk.empty() == false)
+	{
+		const int curelem = st.stk.back();
+		st.stk.pop_back();
+
+		if(!try_lock(curelem,st)) {
+			release_locks(st);
+			return INSERT_CONFLICT;
+		}
 
-	// now re-compute limits
+		// if this element has already been checked, just remove it and continue
+		if(checked[curelem] == stamp)
+			continue;
+		checked[curelem] = stamp;
+
+		// if point lies strictly inside circumsphere, ie, Delaunay criterion is violated;
+		// the containing element is always removed, even if the point is on its boundary.
+		// Elements have positive jacobians, so (p1,p0,p2,p3) is positively oriented for the predicates.
+		const Tet& elem = elems[curelem];
+		if(curelem == contelem || insphere(nodes[elem.p[1]].data(), nodes[elem.p[0]].data(), nodes[elem.p[2]].data(), nodes[elem.p[3]].data(), newpoin.data()) > 0)
+		{
+			st.badelems.push_back(curelem);
+			isbad[curelem] = stamp;
+			for(int j = 0; j < nnode; j++)
+				if(elem.surr[j] >= 0)		// add surrounding elements to "to be checked" stack
+					st.stk.push_back(elem.surr[j]);
+		}
+	}
+
+	/// Third, find the faces of the void formed by removing the bad elements.
+	/// These are the faces of bad elements across which the neighbouring element is not bad.
+	st.vfaces.clear();
+	for(size_t ibe = 0; ibe < st.badelems.size(); ibe++)
+	{
+		const Tet& bad = elems[st.badelems[ibe]];
+		for(int iface = 0; iface < nnode; iface++)
+		{
+			int nbor = bad.surr[iface];
+			if(nbor >= 0 && isbad[nbor] == stamp) continue;
+
+			VoidFace vf;
+			for(int j = 0; j < nnode-1; j++)
+				vf.p[j] = bad.p[lpofa.get(iface,j)];
+			vf.nbor = nbor;
+			vf.nborface = -1;
+			if(nbor >= 0)
+			{
+				for(int j = 0; j < nnode; j++)
+					if(elems[nbor].surr[j] == st.badelems[ibe]) {
+						vf.nborface = j;
+						break;
+					}
+				if(vf.nborface < 0) std::cout << "Delaunay3d: insert_point(): ! Error in locating void face on pre-existing element!" << std::endl;
+			}
+			st.vfaces.push_back(vf);
+		}
+	}
+
+	/// Fourth, get slots for the new elements; the bad elements' slots are re-used first.
+	/// Nothing has been modified so far, so the insertion can still be abandoned.
+	InsertionResult res = allocate_slots(st.vfaces.size(), st);
+	if(res != INSERT_DONE) {
+		release_locks(st);
+		return res;
+	}
+
+	/// Fifth, add new elements; these are formed by the faces of the void and the new point.
+	/// Neighbours across void faces are known from the old elements; neighbours among new elements are matched by their shared edge on the void boundary.
+	st.newfaces.clear();
+	for(size_t ifa = 0; ifa < st.vfaces.size(); ifa++)
+	{
+		const VoidFace& vf = st.vfaces[ifa];
+
+		// the void face is oriented outward from the void, so the new element has the same orientation as the face
+		const int inew = st.slots[ifa];
+		Tet& nw = elems[inew];
+		nw.p[0] = newpoinnum;
+		for(int j = 0; j < nnode-1; j++)
+			nw.p[j+1] = vf.p[j];
+
+		compute_jacobian(nw);
+
+		if(nw.D <= 0)
+		{
+			std::cout << "Delaunay3d: insert_point(): New elem is degenerate or inverted! Points are " << nw.p[0] << " " << nw.p[1] << " " << nw.p[2] << " " << nw.p[3] << ", " << nw.D << std::endl;
+		}
+
+		// Surrounding element of this new element - across the void face
+		nw.surr[0] = vf.nbor;
+		if(vf.nbor >= 0 && vf.nborface >= 0)
+			elems[vf.nbor].surr[vf.nborface] = inew;
+
+		// faces containing the new point
+		for(int iface = 1; iface < nnode; iface++)
+		{
+			int a = -1, b = -1;
+			for(int j = 1; j < nnode; j++)
+			{
+				if(j == iface) continue;
+				if(a < 0) a = nw.p[j];
+				else b = nw.p[j];
+			}
+			if(a > b) { int temp = a; a = b; b = temp; }
+
+			bool found = false;
+			for(size_t jfa = 0; jfa < st.newfaces.size(); jfa++)
+				if(st.newfaces[jfa].a == a && st.newfaces[jfa].b == b)
+				{
+					nw.surr[iface] = st.newfaces[jfa].elem;
+					elems[st.newfaces[jfa].elem].surr[st.newfaces[jfa].lface] = inew;
+
+					// each such face is shared by exactly two new elements
+					st.newfaces[jfa] = st.newfaces.back();
+					st.newfaces.pop_back();
+					found = true;
+					break;
+				}
+			if(!found)
+			{
+				NewFace nf;
+				nf.a = a; nf.b = b; nf.elem = inew; nf.lface = iface;
+				nw.surr[iface] = -5;
+				st.newfaces.push_back(nf);
+			}
+		}
+		st.lastelem = inew;
+	}
+
+	if(!st.newfaces.empty())
+		std::cout << "Delaunay3d: insert_point(): ! Error: " << st.newfaces.size() << " new faces were not matched while inserting node " << newpoinnum << "!" << std::endl;
+
+	release_locks(st);
+	return INSERT_DONE;
+}
+
+void Delaunay3d::bowyer_watson()
+{
+	//	find minimum and maximum x and y of the point set
+	//	the predicates are exact, so the points need not be scaled
+	std::vector<double> rmin(ndim,0), rmax(ndim,0);
 	for(int i = 0; i < npoints; i++)
 	{
 		for(int idim = 0; idim < ndim; idim++) 
@@ -522,6 +777,11 @@ void Delaunay3d::bowyer_watson()
 			if(points(i,idim) < rmin[idim]) rmin[idim] = points(i,idim);
 		}
 	}
+	
+	std::cout << "Bounds of the point set are ";
+	for(int idim = 0; idim < ndim; idim++)
+		std::cout << " " << rmin[idim] << " " << rmax[idim] << std::endl;
+	std::cout << "**\n";
 
 	// factor by which to scale rdelt, for providing a factor of safety.
 	double factor = 0.5;
@@ -533,7 +793,7 @@ void Delaunay3d::bowyer_watson()
 		rmin[idim] -= rdelt[idim];
 	}
 
-	std::cout << "Bounds of the extended cuboid (after scaling) are ";
+	std::cout << "Bounds of the extended cuboid are ";
 	for(int idim = 0; idim < ndim; idim++)
 		std::cout << " " << rmin[idim] << " " << rmax[idim] << std::endl;
 	std::cout << "**\n";
@@ -579,345 +839,182 @@ void Delaunay3d::bowyer_watson()
 
 	compute_jacobian(super);
 	if(super.D < ZERO_TOL) std::cout << "Delaunay3d: !!Error: super triangle has negative Jacobian!" << std::endl;
-	//compute_circumsphere_contra(super);
-	compute_circumsphere(super);
 
 	elems.push_back(super);			// add super to elems list
+	checked.assign(1,-1);
+	isbad.assign(1,-1);
+	stampcount = 0;
+	lockowner.clear();
+	freetets.clear();
 
-	// set up initial face list
-	//std::cout << "Delaunay3d: set up initial face list\n";
-	Face f[ndim+1];
-	f[0].p[0] = super.p[1]; f[0].p[1] = super.p[0]; f[0].p[2] = super.p[2];
-	f[1].p[0] = super.p[2]; f[1].p[1] = super.p[0]; f[1].p[2] = super.p[3];
-	f[2].p[0] = super.p[3]; f[2].p[1] = super.p[1]; f[2].p[2] = super.p[2];
-	f[3].p[0] = super.p[3]; f[3].p[1] = super.p[0]; f[3].p[2] = super.p[1];
-	for(int i = 0; i < nnode; i++)
-	{
-		f[i].elem[0] = 0;
-		f[i].elem[1] = -1;
-		faces.push_back(f[i]);
-	}
-
-	int newpoinnum, contelem;
+	// all nodes are added first, so that node numbers do not depend on the order of insertion
 	std::vector<double> newpoin(ndim);
-
-	//////////// may need to change this /////////////////
-	zero_scale = 1e5;
-	//////////////////////////////////////////////////////
-
-	// iterate through points
-	std::cout << "Delaunay3d: Starting iteration over points\n";
 	for(int ipoin = 0; ipoin < npoints; ipoin++)
 	{
-		//std::cout << "New point : " << ipoin  << "  " << points.get(ipoin,0) << " " << points.get(ipoin,1) << " " << points.get(ipoin,2) << std::endl;
 		for(int idim = 0; idim < ndim; idim++)
 			newpoin[idim] = points.get(ipoin,idim);
 		nodes.push_back(newpoin);
-		newpoinnum = nodes.size()-1;
-
-		/// First, find the element containing the new point
-		contelem = find_containing_tet(newpoin,elems.size()-1);
-
-		/// Second, search among neighbors for other triangles whose circumcircles contain this point
-		int curelem;
-		std::vector<int> stk;					// stack to hold the indices of tets to be checked
-		double dist;						// square of distance from point to circumcentre
-		stk.push_back(contelem);			// add the containing element to the list of bad elements
-		std::vector<int> flags(elems.size(),0);	// stores 1 at an index if the corresponding element has been checked for the Delaunay criterion
-		//std::cout << "No. of elements = " << elems.size() << std::endl;
-		
-		while(stk.empty() == false)
-		{
-			curelem = stk.back();			// access last element in stack of elements to be checked
+	}
+	compute_insertion_order(points, ordering, insorder);
 
-			// if this element has already been checked, just remove it and continue
-			if(flags[curelem] == 1)
-			{
-				stk.pop_back();
-				continue;
-			}
-			
-			//std::cout << ">" << curelem << " " << flush;
+	int nthreads = 1;
+#ifdef _OPENMP
+	nthreads = omp_get_max_threads();
+#endif
+	if(npoints < DELAUNAY_PARALLEL_MIN_POINTS)
+		nthreads = 1;
 
-			flags[curelem] = 1;				// curelem will now be checked
+	// state for serial insertion
+	InsertionState sst;
+	sst.tid = 0;
+	sst.lastelem = 0;
+	sst.freelist = &freetets;
 
-			// calculate square of distance between circumcentre and the point
-			dist = 0;
-			for(int idim = 0; idim < ndim; idim++)
-				dist += (newpoin[idim]-elems[curelem].centre[idim]) * (newpoin[idim]-elems[curelem].centre[idim]);
-			//dist = sqrt(dist);
+	// nodes to be inserted, in order
+	std::vector<int> pending;
 
-			#if DEBUG==1
-			//if(dabs(dist - elems[curelem].radius) < ZERO_TOL) std::cout << "Delaunay3D: Degenerate case (type 2)!!\n";
-			#endif
-			
-			if(dist < elems[curelem].radius - zero_scale*ZERO_TOL)		// if point lies inside circumsphere, ie, Delaunay criterion is violated
-			{
-				badelems.push_back(curelem);
-				stk.pop_back();
-				for(int j = 0; j < ndim+1; j++)
-					if(elems[curelem].surr[j] >= 0 && flags[elems[curelem].surr[j]] == 0)		// add surrounding elements (only which are not checked) to "to be checked" stack
-						stk.push_back(elems[curelem].surr[j]);
-			}
-			else
-			{
-				stk.pop_back();
-			}
-		}
-
-		/// Third, we store the faces that will be obtained after removal of bad elements
-		flags.assign(faces.size(),-1);
-
-		for(int ifa = 0; ifa < faces.size(); ifa++)
-		{
-			for(int itri = 0; itri < badelems.size(); itri++)
-			{
-				if(faces[ifa].elem[0] == badelems[itri])		//this face belongs to at least one bad element
-				{
-					if(flags[ifa] != 1)							// this face does not belong to two bad elements
-						flags[ifa] = 0;
-					else										// this face belongs to two bad elements
-						flags[ifa] = -10;
-				}
-				else if(faces[ifa].elem[1] == badelems[itri])	// this face belongs to at least one bad element
-				{
-					if(flags[ifa] != 0)							// this face is NOT shared by two bad elements
-						flags[ifa] = 1;
-					else										// this face is shared by two bad elements
-						flags[ifa] = -10;
-				}
-			}
-			if(flags[ifa] == 0)
-			{
-				faces[ifa].elem[0] = -2;		// -2 will be replaced by the index of a newly-formed element later
-				voidpoly.push_back(ifa);
-			}
-			if(flags[ifa] == 1)
-			{
-				faces[ifa].elem[1] = -2;
-				voidpoly.push_back(ifa);
-			}
-		}
-		
-		/** Delete faces which are between two bad elements.
-		*  NOTE: This is one place that is ineffecient because of use of array stacks (std::std::vectors) as it needs deletion of arbitrary members.
-		*/
-		for(int ifa = 0; ifa < faces.size(); ifa++)
+	if(nthreads > 1)
+	{
+		// insert an evenly spaced sample of the points serially, so that threads start out in different elements
+		const int nseed = npoints < DELAUNAY_PARALLEL_SEED_POINTS*nthreads ? npoints : DELAUNAY_PARALLEL_SEED_POINTS*nthreads;
+		std::vector<char> seeded(npoints,0);
+		for(int k = 0; k < nseed; k++)
 		{
-			if(flags[ifa] == -10)				// if face belongs to two bad elements, delete face
-			{
-				faces.erase(faces.begin()+ifa);
-				flags.erase(flags.begin()+ifa);
-				// now adjust voidpoly for the deleted face
-				for(int i = 0; i < voidpoly.size(); i++)
-				{
-					if(voidpoly[i] > ifa) voidpoly[i]--;
-				}
-				ifa--;
-			}
+			const int iord = (int)((long)k*npoints/nseed);
+			seeded[iord] = 1;
+			if(insert_point(insorder[iord]+nnode, sst) != INSERT_DONE)
+				std::cout << "Delaunay3d: bowyer_watson(): ! Could not insert point " << insorder[iord] << "!" << std::endl;
 		}
+		for(int iord = 0; iord < npoints; iord++)
+			if(!seeded[iord])
+				pending.push_back(insorder[iord]+nnode);
+	}
+	else
+		for(int iord = 0; iord < npoints; iord++)
+			pending.push_back(insorder[iord]+nnode);
 
-		/** Fourth, delete bad elements.
-		*  This is another place where array stacks (std::vectors) of elems, badelems etc make the program slower.
-		*/
-		//std::cout << "Delaunay2D:  Fourth, delete bad elements\n";
-		for(int ibe = 0; ibe < badelems.size(); ibe++)
-		{
-			elems.erase(elems.begin()+badelems[ibe]);
-
-			//scan badelems for elements with indices greater than the one just deleted
-			for(int i = ibe+1; i < badelems.size(); i++)
-				if(badelems[i] > badelems[ibe]) badelems[i]--;
-
-			//scan surrounding elements in elems -- probably not efficient
-			for(int i = 0; i < elems.size(); i++)
-			{
-				for(int j = 0; j < ndim+1; j++)
-				{
-					if(elems[i].surr[j] == badelems[ibe]) elems[i].surr[j] = -3;
-					if(elems[i].surr[j] > badelems[ibe]) elems[i].surr[j]--;
-				}
-			}
-
-			// adjust face data as well
-			for(int i = 0; i < faces.size(); i++)
-			{
-				if(faces[i].elem[0] > badelems[ibe]) faces[i].elem[0]--;
-				if(faces[i].elem[1] > badelems[ibe]) faces[i].elem[1]--;
-			}
-		}
+	std::cout << "Delaunay3d: Starting iteration over points with " << nthreads << " thread(s)\n";
 
-		// output voidpoly for debug purposes
-		/*std::cout << "Delaunay3d:  voidpoly:";
-		for(int i = 0; i < voidpoly.size(); i++)
-			std::cout << " " << voidpoly[i];
-		std::cout << std::endl;*/
+	std::vector<InsertionState> states(nthreads);
+	std::vector<std::vector<int>> deferred(nthreads);
+	for(int it = 0; it < nthreads; it++)
+	{
+		states[it].tid = it;
+		states[it].lastelem = sst.lastelem;
+		states[it].freelist = &states[it].localfree;
+	}
 
-		/// Fifth, add new elements; these are formed by the faces in voidpoly and the new point. Also correspondingly update 'faces'.
-		std::vector<int> newfaces;				// new faces formed from new elements created
-		int temp;
-		for(int ifa = 0; ifa < voidpoly.size(); ifa++)		// for each face in void polygon
+	// rounds of parallel insertion; points that could not be inserted in a round are tried again in the next
+	while(nthreads > 1 && pending.size() >= (size_t)DELAUNAY_PARALLEL_MIN_CHUNK*nthreads)
+	{
+		// grow the pool, so that no thread needs to re-allocate it
+		const int nused = elems.size();
+		const int poolsize = nused + 8*pending.size() + 1024;
+		elems.resize(poolsize, Tet());
+		for(int i = nused; i < poolsize; i++)
+			elems[i].p[0] = -1;
+		checked.resize(poolsize,-1);
+		isbad.resize(poolsize,-1);
+		std::vector<std::atomic<int>>(poolsize).swap(lockowner);
+		for(int i = 0; i < poolsize; i++)
+			lockowner[i] = -1;
+		nalloc = nused;
+
+		const int npend = pending.size();
+		const std::vector<int>& pend = pending;
+		std::vector<InsertionState>& sts = states;
+		std::vector<std::vector<int>>& defr = deferred;
+
+		#pragma omp parallel default(none) shared(pend, sts, defr, npend) num_threads(nthreads)
 		{
-			Tet nw;
-			nw.p[0] = newpoinnum;
-			if(faces[voidpoly[ifa]].elem[0] == -2)	
-			{	
-				// if the new element is to the left of this face, the orientation of the remaining points of the tet is same as the orientation of the face
-				nw.p[1] = faces[voidpoly[ifa]].p[0];
-				nw.p[2] = faces[voidpoly[ifa]].p[1];
-				nw.p[3] = faces[voidpoly[ifa]].p[2];
-				
-				// we also need to reverse the face's orientation to make it point to the new element
-				temp = faces[voidpoly[ifa]].elem[1];
-				faces[voidpoly[ifa]].elem[1] = elems.size();		// this new element has not been pushed into elems yet, so we need elems.size() - 1 + 1
-				faces[voidpoly[ifa]].elem[0] = temp;
-				faces[voidpoly[ifa]].p[0] = nw.p[1];
-				faces[voidpoly[ifa]].p[1] = nw.p[3];
-				faces[voidpoly[ifa]].p[2] = nw.p[2];
-			}
-			else if(faces[voidpoly[ifa]].elem[1] == -2)	// if the new element is to the right of the face
-			{
-				nw.p[1] = faces[voidpoly[ifa]].p[1];
-				nw.p[2] = faces[voidpoly[ifa]].p[0];
-				nw.p[3] = faces[voidpoly[ifa]].p[2];
-				faces[voidpoly[ifa]].elem[1] = elems.size();
-			}
-			else std::cout << "Delaunay2D: !! Error while creating new element - face " << voidpoly[ifa] << " in voidpoly does not have -2 as either left elem or right elem.\n";
-
-			// After the above, the right element of the current void face has the new element.
-
-			compute_jacobian(nw);
-			
-			//compute_circumsphere_contra(nw);
-			compute_circumsphere(nw);
-
-			//std::cout << "Delaunay3d: bowyer_watson(): New element jacobian and radius^2 : " << nw.D << " " << nw.radius << std::endl;
-
-			if(nw.D < ZERO_TOL)
-			{
-				std::cout << "Delaunay3d: bowyer_watson(): New elem is degenerate or inverted! Points are " << nw.p[0] << " " << nw.p[1] << " " << nw.p[2] << " " << nw.p[3] << ", " << nw.D << std::endl;
-				//elems.push_back(nw);
-				//return;
-			}
-
-			for(int i = 0; i < nnode; i++)
-				nw.surr[i] = -5;
-
-			// Push new element into the elements' list
-			elems.push_back(nw);
-
-			std::vector<bool> val(ndim+1, false);
-			//^ flag for each face of the new element - but we actually only need it for those faces that include the new point 0, ie faces 1, 2 and 3.
-			//^ val[i] contains true if a newface corresponding to the ith local face of nw has been found.
-
-			int localface, jface;
-			for(int jfa = 0; jfa < newfaces.size(); jfa++)
+			int tid = 0, nth = 1;
+#ifdef _OPENMP
+			tid = omp_get_thread_num();
+			nth = omp_get_num_threads();
+#endif
+			InsertionState& st = sts[tid];
+			std::vector<int>& dfr = defr[tid];
+			dfr.clear();
+			bool full = false;
+			const int start = (int)((long)tid*npend/nth), end = (int)((long)(tid+1)*npend/nth);
+			for(int i = start; i < end; i++)
 			{
-				// test whether the newface is part of the new tet.
-				localface = check_face_tet(nw, faces[newfaces[jfa]]);
-				
-				// If this newface does not match any face of the new element, go to the next newface.
-				if(localface == -1) continue;
-
-				// Face formed by new point and p[1]
-				else if(localface==0) {
-					std::cout << "Delaunay3d: bowyer_watson(): ! Error: A member of newfaces is not actually a new face!!" << std::endl;
+				if(full) {
+					dfr.push_back(pend[i]);
 					continue;
 				}
-
-				// if this newface has -4 as the right element, then replace this by the new element
-				
-				faces[newfaces[jfa]].elem[1] = elems.size()-1;
-				elems.back().surr[localface] = faces[newfaces[jfa]].elem[0];
-
-				// Also, find which local face of newfaces[jfa]'s left element is the same as newfaces[jfa].
-				// Set the new element as a surrounding element of the left element of newfaces[jfa].
-				jface = check_face_tet(elems[faces[newfaces[jfa]].elem[0]], faces[newfaces[jfa]]);
-				if(jface == -1) { std::cout << "Delaunay3d: bowyer_watson(): ! Error while setting surrounding element of a new element!" << std::endl; }
-				elems[faces[newfaces[jfa]].elem[0]].surr[jface] = elems.size()-1;
-
-				val[localface] = true;
-				
-				// if faces corresponding to all 3 new faces of the new element have been found, quit the jfa loop
-				/*bool brk = true;
-				for(int i = 1; i < ndim+1; i++)
-					if(!val[i]) brk = false;
-				if(brk) break;*/
-			}
-
-			Face fc;
-
-			for(int iface = 1; iface < ndim+1; iface++)
-			{
-				// if face corresponding to local node iface does not exist in newfaces, add the face.
-				if(val[iface] == false)
-				{
-					for(int j = 0; j < nnode-1; j++)	
-						fc.p[j] = nw.p[lpofa.get(iface,j)];
-
-					fc.elem[0] = elems.size()-1;
-					fc.elem[1] = -4;			// the element to the right of the new face is undefined as of now.
-					
-					// Add this new face to list of faces and the current list of newfaces.
-					faces.push_back(fc);
-					newfaces.push_back(faces.size()-1);
-				}
+				InsertionResult res = insert_point(pend[i], st);
+				if(res != INSERT_DONE)
+					dfr.push_back(pend[i]);
+				if(res == INSERT_POOL_FULL)
+					full = true;
 			}
+		}
 
-			// Surrounding element of this new element - across pre-existing face
-			elems.back().surr[0] = (faces[voidpoly[ifa]].elem[0] == elems.size()-1) ? faces[voidpoly[ifa]].elem[1] : faces[voidpoly[ifa]].elem[0];
-			//elems.back().surr[0] = faces[voidpoly[ifa]].elem[0];
+		// shrink the pool to the slots actually handed out
+		const int nalloced = nalloc < poolsize ? (int)nalloc : poolsize;
+		elems.resize(nalloced);
+		checked.resize(nalloced);
+		isbad.resize(nalloced);
+
+		pending.clear();
+		for(int it = 0; it < nthreads; it++)
+			pending.insert(pending.end(), deferred[it].begin(), deferred[it].end());
+		std::cout << "Delaunay3d: bowyer_watson(): " << npend-pending.size() << " points inserted in parallel, " << pending.size() << " deferred" << std::endl;
+		if(pending.size() == (size_t)npend)
+			break;
+	}
 
-			// Now to set the new element as a surrounding element of the element neighboring this void face
-			int nbor = elems.back().surr[0];
-			
-			if(nbor >= 0)
-			{
-				localface = check_face_tet(elems[nbor], faces[voidpoly[ifa]]);
-				if(localface < 0) std::cout << "Delaunay3d: bowyer_watson(): ! Error in locating void face on pre-existing element!" << std::endl;
-				elems[nbor].surr[localface] = elems.size()-1;
-			}
-		}
+	// serial insertion of the remaining points
+	lockowner.clear();
+	for(int it = 0; it < nthreads; it++)
+	{
+		freetets.insert(freetets.end(), states[it].localfree.begin(), states[it].localfree.end());
+		states[it].localfree.clear();
+	}
+	if(nthreads > 1)
+		sst.lastelem = states[0].lastelem;
 
-		//empty badelems and voidpoly
-		badelems.clear();
-		voidpoly.clear();
-	} 
+	for(size_t ipoin = 0; ipoin < pending.size(); ipoin++)
+	{
+		if(insert_point(pending[ipoin], sst) != INSERT_DONE)
+			std::cout << "Delaunay3d: bowyer_watson(): ! Could not insert point " << pending[ipoin]-nnode << "!" << std::endl;
+	}
 	
 	// end iteration over points
 	
-	std::cout << "Delaunay3d: bowyer_watson(): Number of elements before removing super points is " << elems.size() << std::endl;
-	// Remove super triangle
+	std::cout << "Delaunay3d: bowyer_watson(): Number of elements before removing super points is " << elems.size()-freetets.size() << std::endl;
+
+	// Compact the pool: remove the free slots, and the elements that contain one of the first 4 (super) nodes
+	std::vector<int> newindex(elems.size(),0);
+	for(size_t i = 0; i < freetets.size(); i++)
+		newindex[freetets[i]] = -1;
+	freetets.clear();
+
+	int nelem = 0;
 	for(int ielem = 0; ielem < elems.size(); ielem++)
 	{
-		//std::vector<bool> val(nnode,false);
+		if(newindex[ielem] < 0) continue;
 		bool finval = false;
 		for(int i = 0; i < nnode; i++)
-		{
-			if(elems[ielem].p[i] == 0 || elems[ielem].p[i] == 1 || elems[ielem].p[i] == 2 || elems[ielem].p[i] == 3) {
+			if(elems[ielem].p[i] < nnode) {
 				finval = true;
 				break;
 			}
-		}
-
-		// if finval is true, it means ielem contains one of the first 4 nodes
-		if(finval)
-		{
-			elems.erase(elems.begin()+ielem);
-			// re-adjust surr[] of each element. This is yet another place where we would benefit from a graph data structure.
-			for(int iel = 0; iel < elems.size(); iel++)
-			{
-				for(int j = 0; j < nnode; j++)
-				{
-					if(elems[iel].surr[j] == ielem) elems[iel].surr[j] = -1;
-					if(elems[iel].surr[j] > ielem) elems[iel].surr[j]--;
-				}
-			}
-			/// \note Perhaps we should readjust the two elems of each face while deleting elements containing the super nodes.
+		newindex[ielem] = finval ? -1 : nelem++;
+	}
 
-			ielem--;
-		}
+	for(int ielem = 0; ielem < (int)elems.size(); ielem++)
+	{
+		if(newindex[ielem] < 0) continue;
+		Tet& el = elems[newindex[ielem]];
+		if(newindex[ielem] != ielem)
+			el = elems[ielem];
+		for(int j = 0; j < nnode; j++)
+			if(el.surr[j] >= 0)
+				el.surr[j] = newindex[el.surr[j]];
 	}
+	elems.resize(nelem, Tet());
 	
 	// remove super nodes
 	nodes.erase(nodes.begin(),nodes.begin()+nnode);
@@ -929,13 +1026,31 @@ void Delaunay3d::bowyer_watson()
 			elems[ielem].p[i] = elems[ielem].p[i]-nnode;
 		}
 	}
-	// remove super faces - not needed
+
+	compute_faces();
+
+	for(int ielem = 0; ielem < (int)elems.size(); ielem++)
+		compute_circumsphere(elems[ielem]);
 	std::cout << "Delaunay3d: Triangulation done.\n";
+}
 
-	// re-scale points
-	for(int ip = 0; ip < nodes.size(); ip++)
-		for(int idim = 0; idim < ndim; idim++)
-			nodes[ip][idim] *= scalef[idim];
+void Delaunay3d::compute_faces()
+{
+	faces.clear();
+	for(int ielem = 0; ielem < (int)elems.size(); ielem++)
+		for(int iface = 0; iface < nnode; iface++)
+		{
+			// each interior face is added once, by the element with the smaller index
+			int nbor = elems[ielem].surr[iface];
+			if(nbor >= 0 && nbor < ielem) continue;
+
+			Face fc;
+			for(int j = 0; j < nnode-1; j++)
+				fc.p[j] = elems[ielem].p[lpofa.get(iface,j)];
+			fc.elem[0] = ielem;
+			fc.elem[1] = nbor;
+			faces.push_back(fc);
+		}
 }
 
 void Delaunay3d::clear()					// reset the Delaunay2D object, except for input data
@@ -943,8 +1058,9 @@ void Delaunay3d::clear()					// reset the Delaunay2D object, except for input da
 	nodes.clear();
 	elems.clear();
 	faces.clear();
-	badelems.clear();
-	voidpoly.clear();
+	freetets.clear();
+	checked.clear();
+	isbad.clear();
 }
 
 void Delaunay3d::writeGmsh2(const std::string mfile) const
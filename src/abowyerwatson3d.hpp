@@ -14,11 +14,30 @@
  * Notes:
  * \todo Change points to a pointer to const Matrix rather than a matrix itself, in the interest of efficiency.
  *
- * Currently uses a std::std::vector to store elements, faces etc. 
- * \todo Change the deletion and insertion of faces and elements such that we're not moving entire lists (easier said than done).
+ * Elements are stored in a pool: during triangulation, the elements removed while inserting a point are not erased from [elems](@ref elems),
+ * but they are marked as removed (by setting their first vertex to -1), and their slots are put on a free list ([freetets](@ref Delaunay3d::freetets))
+ * and re-used for the new elements. Element indices are therefore stable,
+ * and the neighbour information ([surr](@ref Tet::surr)) is updated only locally, around the cavity formed by the removed elements.
+ * The boundary of the cavity is found from the neighbours of the removed elements, so no global face list is needed during triangulation.
+ * The pool is compacted once at the end, when the elements containing the super-tetrahedron's vertices are removed.
  *
- * It might be better to use a std::list or std::forward_list instead.
- * \note A graph data structure should also be seriously considered for storing elements, faces, bad elements and the void polygon.
+ * Points are inserted in the order given by [ordering](@ref Delaunay3d::ordering) (by default, along a Hilbert curve),
+ * but node i+4 during triangulation (and node i after it) is always input point i.
+ *
+ * The point location walk and the Delaunay criterion use the robust [orientation](@ref orient3d) and [in-sphere](@ref insphere) predicates,
+ * so no tolerances are involved, and degenerate configurations such as co-spherical points are handled consistently:
+ * an element is removed only if the new point lies strictly inside its circumsphere.
+ * The input coordinates are used as they are; they are not scaled.
+ *
+ * If OpenMP provides more than one thread (see omp_set_num_threads or the OMP_NUM_THREADS environment variable)
+ * and there are at least [DELAUNAY_PARALLEL_MIN_POINTS](@ref DELAUNAY_PARALLEL_MIN_POINTS) points, points are inserted concurrently.
+ * A sample of the points, evenly spaced in the insertion order, is first inserted serially.
+ * The remaining points are then divided into contiguous chunks of the insertion order, one per thread; with the Hilbert ordering, each chunk occupies a compact region of space.
+ * Each thread locks every element it reads (the elements on its walk, the cavity and the elements around the cavity) using a try-lock,
+ * and if an element is locked by another thread, it releases all its locks and defers the point, without having modified anything.
+ * Deferred points are retried in further rounds, and the last few are inserted serially.
+ * Because the Delaunay triangulation of points in general position is unique, the result is the same as that of the serial insertion,
+ * except for the choice among equally valid tetrahedralizations of co-spherical points.
  */
 
 #ifndef __ABOWYERWATSON3D_H
@@ -38,12 +57,34 @@
 #ifndef _GLIBCXX_VECTOR
 #include <vector>
 #endif
+#ifndef _GLIBCXX_ATOMIC
+#include <atomic>
+#endif
 #ifndef __AMATRIX_H
 #include <amatrix.hpp>
 #endif
+#ifndef __ASFCSORT_H
+#include <asfcsort.hpp>
+#endif
+#ifndef __APREDICATES_H
+#include <apredicates.hpp>
+#endif
+
+#ifdef _OPENMP
+#ifndef OMP_H
+#include <omp.h>
+#endif
+#endif
 
 #define __ABOWYERWATSON3D_H 1
 
+/// Number of points below which the triangulation is always computed by a single thread
+#define DELAUNAY_PARALLEL_MIN_POINTS 10000
+/// Number of points per thread inserted serially before the parallel insertion starts
+#define DELAUNAY_PARALLEL_SEED_POINTS 256
+/// Number of remaining points per thread below which the parallel insertion stops and the rest are inserted serially
+#define DELAUNAY_PARALLEL_MIN_CHUNK 64
+
 namespace amc {
 
 typedef std::vector<double> Point;
@@ -61,24 +102,16 @@ class Tet
 {
 public:	
 	int p[4];			///< Indices of vertices.
-	Point centre;		///< Coords of circumcenter of the tet.
+	double centre[3];	///< Coords of circumcenter of the tet; computed for the final elements only, as it is not needed during triangulation.
 	int surr[4];		///< Indices of surrounding tets. Note that the neighbor corresponding to surr[3] is opposite the vertex p[3].
 	double D;			///< 6*volume of tet.
 	double radius;		///< Square of radius of circumcircle of tet.
 
-	Tet() {
-		centre.resize(3,0.0);
-	}
-
-	Tet(const Tet& other) {
+	/// The centre is stored inline, so that tets can be pooled and copied without heap allocation
+	Tet() : D(0.0), radius(0.0) {
 		for(int i = 0; i < 4; i++)
-		{
-			p[i] = other.p[i];
-			surr[i] = other.surr[i];
-		}
-		centre = other.centre;
-		D = other.D;
-		radius = other.radius;
+			p[i] = surr[i] = -1;
+		centre[0] = centre[1] = centre[2] = 0.0;
 	}
 };
 
@@ -100,23 +133,76 @@ class Delaunay3d
 	int nnode;
 	int ndim;
 
-	/// Value used to provide tolerance for the Delaunay criterion.
-	/** This value is multiplied by machine epsilon (approx. 2e-16), and the resulting value is used as a tolerance for the Delaunay criterion in \ref bowyer_watson .
-	 */
-	double zero_scale;
-
 	/// Stores the face-point relationship of a tetrahedron.
 	/** Row i contains the local node numbers of the face opposite to node i. The local node numbers are ordered so that the face points outwards. */
 	amat::Matrix<int> lpofa;
 	void setlpofa();
 
+	/// Order in which points are inserted; see asfcsort.hpp
+	PointOrdering ordering;
+	std::vector<amc_int> insorder;	///< Indices of points in the order in which they are inserted
+
+	/// Data of a face of the void polyhedron, copied before the bad elements are over-written
+	struct VoidFace
+	{
+		int p[3];			///< vertices of the face, oriented outward from the void
+		int nbor;			///< element outside the void across this face, or -1
+		int nborface;		///< local face number of this face in nbor
+	};
+
+	/// A face of a new element that contains the new point, identified by the other two vertices of the face
+	struct NewFace
+	{
+		int a, b;			///< the two vertices other than the new point, in ascending order
+		int elem;
+		int lface;
+	};
+
+	/// Working data of one thread for inserting points
+	struct InsertionState
+	{
+		int tid;							///< Thread number, used to identify the owner of locks
+		int lastelem;						///< The element created last, from which the search for the next point's containing element starts
+		std::vector<int>* freelist;			///< Free slots in the pool that this thread can re-use
+		std::vector<int> localfree;			///< Free slots owned by this thread during parallel insertion
+		std::vector<int> held;				///< Elements locked by this thread
+		std::vector<int> stk;				///< Stack of elements to be checked against the Delaunay criterion
+		std::vector<int> badelems;			///< Elements to be removed for the current point
+		std::vector<int> slots;				///< Slots in the pool for the new elements
+		std::vector<VoidFace> vfaces;
+		std::vector<NewFace> newfaces;
+	};
+
+	/// Result of [insert_point](@ref insert_point)
+	enum InsertionResult { INSERT_DONE, INSERT_CONFLICT, INSERT_POOL_FULL };
+
+	/// For each element in the pool, the last insertion attempt in which it was checked against the Delaunay criterion, and in which it was found to be bad
+	std::vector<int> checked, isbad;
+	std::atomic<int> stampcount;			///< Counter of insertion attempts
+	std::atomic<int> nalloc;				///< Number of slots of the pool handed out, during parallel insertion
+	/// For each element in the pool, the thread which has locked it, or -1; empty during serial insertion, when no locking is done
+	std::vector<std::atomic<int>> lockowner;
+
+	/// Locks an element for a thread, if it is not locked by another thread
+	bool try_lock(const int ielem, InsertionState& st);
+	/// Releases all elements locked by a thread
+	void release_locks(InsertionState& st);
+
+	/// Inserts a node into the triangulation
+	/** If the elements needed are locked by another thread, the triangulation is not modified and INSERT_CONFLICT is returned.
+	 * During parallel insertion, INSERT_POOL_FULL is returned if the pool has no room for the new elements; the triangulation is not modified in that case either.
+	 */
+	InsertionResult insert_point(const int newpoinnum, InsertionState& st);
+
+	/// Allocates pool slots for n new elements into st.slots, re-using the bad elements first
+	InsertionResult allocate_slots(const int n, InsertionState& st);
+
 public:
 	amat::Matrix<double> points;
 	std::vector<Point> nodes;		///< List of nodes in the Delaunay graph.
 	std::vector<Tet> elems;			///< List of all elements ([tetrahedra](@ref Tet)) in the Delaunay graph.
-	std::vector<int> badelems;		///< Collection of 'bad elements', that are to be removed while adding a point; its are integers that index members index [elems](@ref elems).
-	std::vector<Face> faces;		///< List of all [faces](@ref Face) in the Delaunay graph.
-	std::vector<int> voidpoly;		///< Collection of faces that bounds the void obtained after removing bad elements while adding a point; its members are integers that index [faces](@ref faces).
+	std::vector<Face> faces;		///< List of all [faces](@ref Face) in the Delaunay graph; computed from the elements at the end of [bowyer_watson](@ref bowyer_watson).
+	std::vector<int> freetets;		///< Indices of slots in [elems](@ref elems) that hold removed elements, available for re-use during triangulation
 	amat::Matrix<double> jacobians;
 
 	int npoints;
@@ -126,12 +212,17 @@ public:
 	Delaunay3d(const Delaunay3d& other);
 	Delaunay3d& operator=(const Delaunay3d& other);
 	void setup(amat::Matrix<double>* _points);
+
+	/// Sets the order in which points are inserted by [bowyer_watson](@ref bowyer_watson)
+	void set_ordering(const PointOrdering order) { ordering = order; }
 	
 	double l2norm(const std::vector<double>& a) const;
 	
 	double dot(const std::vector<double>& a, const std::vector<double>& b) const;
 	
 	/// Computes the jacobian of a tet formed from a point and a face of a tetrahedron.
+	/** The sign of the result is exact; see [orient3d](@ref orient3d).
+	 */
 	double det4(const int ielem, const int i, const std::vector<double>& r) const;
 	
 	void compute_jacobian(Tet& elem);
@@ -167,9 +258,12 @@ public:
 	int check_face_tet(const Tet& elem, const Face& face) const;
 
 	/// Computes the Delaunay triangulation (tetrahedralization, in this case).
-	/** We first scale the point set by the largest coordinate magnitudes in each direction, so as to non-dimensionalize it.
+	/** The point location for each new point starts from the element created last (by the same thread).
 	 */
 	void bowyer_watson();
+
+	/// Builds the list of [faces](@ref faces) from the elements and their neighbours
+	void compute_faces();
 	
 	void clear();					///< Reset the Delaunay3d object, except for input data
 	
@@ -117,6 +117,22 @@ public:
 	}
 };
 
+/// A contiguous range of entries of an array, such as the entries of one row of a compressed sparse row (CSR) structure
+/** Allows iteration over the range with range-based for loops, without bounds checks.
+ */
+template <class T>
+class ArrayRange
+{
+	const T* first;
+	const T* last;
+public:
+	ArrayRange(const T* const start, const T* const end) : first(start), last(end) { }
+	const T* begin() const { return first; }
+	const T* end() const { return last; }
+	size_t size() const { return last-first; }
+	const T& operator[](const size_t i) const { return first[i]; }
+};
+
 /// This function is a cyclic permutation of consecutive integers from 'start' to 'end' (inclusive). It returns the integer (between 'start' and 'end') that is 'off' integers away from 'n' in the cyclic order.
 int perm(int start, int end, int n, int off);
 
@@ -17,10 +17,139 @@
 #include <amesh2d.hpp>
 #endif
 
+#ifndef _GLIBCXX_STRING
+#include <string>
+#endif
+
+#ifdef _OPENMP
+#ifndef OMP_H
+#include <omp.h>
+#endif
+#endif
+
 #define __ADGM_H 1
 
+/// Average number of DG elements per cell of the grid used to find starting elements for point location
+#define DGM_ELEMS_PER_GRID_CELL 4
+
+/// Identification of binary files written by DGMapping
+#define DGM_MAPPING_FILE_MAGIC "AMCDGMAP"
+#define DGM_MAPPING_FILE_VERSION 1
+
 namespace amc {
 
+/// Finds the DG element containing each of a set of points, and the area coordinates of the point in that element
+/** The points are sorted along a Hilbert curve and divided among threads in contiguous chunks.
+ * Each walk starts from the element containing the previous point in the chunk;
+ * the first point of a chunk starts from an element found by a lookup in a coarse uniform grid of element centroids.
+ * Since the walk only stops in an element containing the point, the results do not depend on the starting elements,
+ * except for points lying exactly on a DG edge, for which either adjacent element may be returned (with the same mapped position).
+ * \param[in] dg is the triangulated Delaunay graph
+ * \param[in] dgpoints contains the coordinates of the DG points
+ * \param[in] pts contains the points to locate in its first two columns
+ * \param[out] host is the index of the element containing each point, or -1 if the point could not be located
+ * \param[out] area contains the three area coordinates of each point
+ * \return false if some point could not be located
+ */
+inline bool dg_locate_points(Delaunay2D& dg, const amat::Matrix<double>& dgpoints, const amat::Matrix<double>& pts, std::vector<int>& host, std::vector<double>* const area)
+{
+	const int nel = dg.elems.size();
+	const int np = pts.rows();
+	host.assign(np, -1);
+	for(int i = 0; i < 3; i++)
+		area[i].assign(np, 0.0);
+	if(nel == 0) return np == 0;
+
+	// coarse grid over the bounding box of the DG; each cell holds an element whose centroid lies in it, or -1
+	double rmin[2], rmax[2];
+	rmin[0] = rmax[0] = dgpoints.get(0,0);
+	rmin[1] = rmax[1] = dgpoints.get(0,1);
+	for(int i = 1; i < dgpoints.rows(); i++)
+		for(int j = 0; j < 2; j++)
+		{
+			if(dgpoints.get(i,j) < rmin[j]) rmin[j] = dgpoints.get(i,j);
+			if(dgpoints.get(i,j) > rmax[j]) rmax[j] = dgpoints.get(i,j);
+		}
+	int ng = (int)sqrt((double)nel/DGM_ELEMS_PER_GRID_CELL);
+	if(ng < 1) ng = 1;
+	double dx[2];
+	for(int j = 0; j < 2; j++)
+		dx[j] = rmax[j] > rmin[j] ? (rmax[j]-rmin[j])/ng : 1.0;
+
+	std::vector<int> grid(ng*ng, -1);
+	for(int iel = 0; iel < nel; iel++)
+	{
+		double c[2] = {0,0};
+		for(int i = 0; i < 3; i++)
+		{
+			c[0] += dg.nodes[dg.elems[iel].p[i]].x/3.0;
+			c[1] += dg.nodes[dg.elems[iel].p[i]].y/3.0;
+		}
+		int ic[2];
+		for(int j = 0; j < 2; j++)
+		{
+			ic[j] = (int)((c[j]-rmin[j])/dx[j]);
+			if(ic[j] < 0) ic[j] = 0;
+			if(ic[j] >= ng) ic[j] = ng-1;
+		}
+		grid[ic[1]*ng+ic[0]] = iel;
+	}
+
+	// sort the points along a Hilbert curve
+	amat::Matrix<double> xy(np, 2);
+	for(int ipoin = 0; ipoin < np; ipoin++)
+		for(int j = 0; j < 2; j++)
+			xy(ipoin,j) = pts.get(ipoin,j);
+	std::vector<amc_int> order;
+	compute_insertion_order(xy, ORDER_HILBERT, order);
+
+	const std::vector<int>& grd = grid;
+
+	#pragma omp parallel default(none) shared(dg, xy, grd, order, host, rmin, dx, ng, nel, np, area)
+	{
+		int tid = 0, nth = 1;
+#ifdef _OPENMP
+		tid = omp_get_thread_num();
+		nth = omp_get_num_threads();
+#endif
+		const int start = (int)((long)tid*np/nth), end = (int)((long)(tid+1)*np/nth);
+		int prev = -1;
+		for(int k = start; k < end; k++)
+		{
+			const int ipoin = order[k];
+			const double x = xy.get(ipoin,0), y = xy.get(ipoin,1);
+
+			int startelem = prev;
+			if(startelem < 0)
+			{
+				const int ix = std::min(std::max((int)((x-rmin[0])/dx[0]), 0), ng-1);
+				const int iy = std::min(std::max((int)((y-rmin[1])/dx[1]), 0), ng-1);
+				startelem = grd[iy*ng+ix] >= 0 ? grd[iy*ng+ix] : nel/2;
+			}
+
+			Walkdata dat = dg.find_containing_triangle_and_area_coords(x, y, startelem);
+			if(dat.elem < 0 || dat.elem >= nel)
+			{
+				prev = -1;
+				continue;
+			}
+			prev = dat.elem;
+
+			host[ipoin] = dat.elem;
+			for(int i = 0; i < 3; i++)
+				area[i][ipoin] = dat.areacoords[i];
+		}
+	}
+
+	bool ok = true;
+	for(int ipoin = 0; ipoin < np; ipoin++)
+		if(host[ipoin] < 0) {
+			std::cout << "dg_locate_points(): Error in locating point " << ipoin << "!!" << std::endl;
+			ok = false;
+		}
+	return ok;
+}
+
 /// Class to carry out mesh-movement using Delaunay graph mapping.
 class DGmove
 {
@@ -37,6 +166,27 @@ class DGmove
 	amat::Matrix<double>* bmotion;
 	amat::Matrix<int> bflag;
 
+	/// Finds the DG element containing each interior point, and the area coordinates of the point in that element
+	/** See [dg_locate_points](@ref dg_locate_points). Points that could not be located get -1 as their element.
+	 * \return false if some point could not be located
+	 */
+	bool locate_points()
+	{
+		std::vector<int> host;
+		std::vector<double> area[3];
+		bool ok = dg_locate_points(dg, dgpoints, points, host, area);
+
+		// store DG element and area coords in points
+		for(int ipoin = 0; ipoin < ninpoin; ipoin++)
+		{
+			points(ipoin,2) = host[ipoin];
+			if(host[ipoin] >= 0)
+				for(int i = 0; i < ndim+1; i++)
+					points(ipoin,i+3) = area[i][ipoin];
+		}
+		return ok;
+	}
+
 public:
 	Delaunay2D dg;
 	amat::Matrix<double> newcoords;
@@ -64,7 +214,7 @@ public:
 			for(int j = 0; j < incoords->cols(); j++)
 				points(i,j) = incoords->get(i,j);
 
-		dg.setup(&dgpoints, ndgpoin);
+		dg.setup(&dgpoints);
 	}
 
 	/** boundary_motion has as many rows as bouncoords and contains x and y displacement values for each boun point
@@ -90,7 +240,7 @@ public:
 			for(int j = 0; j < incoords->cols(); j++)
 				points(i,j) = incoords->get(i,j);
 
-		dg.setup(&dgpoints, ndgpoin);
+		dg.setup(&dgpoints);
 	}
 
 	void generateDG()
@@ -129,33 +279,20 @@ public:
 		}*/
 	}
 
-	void movemesh()
+	/// Moves the DG points by the boundary motion, and the interior points with the DG
+	/** Interior points that could not be located in the DG are reported, and left where they are; the others are moved.
+	 * \return false if some interior point could not be located
+	 */
+	bool movemesh()
 	{
-		// cycle over interior points
-		Walkdata dat;
+		// find containing DG element and area coordinates of each interior point by "walking-through" the DG
 		std::cout << "DGmove: movemesh(): Calculating containing elements and area coordinates for each interior point\n";
-		for(int ipoin = 0; ipoin < ninpoin; ipoin++)
-		{
-			//std::cout << ipoin << std::endl;
-			// first find containing DG element by "walking-through" the DG
-			//std::cout << "DGmove: movemesh(): Point " << ipoin << std::endl;
-			dat = dg.find_containing_triangle_and_area_coords(points(ipoin,0), points(ipoin,1), dg.elems.size()/2);
-			
-			if(dat.elem < 0 || dat.elem >= dg.elems.size())
-			{
-				std::cout << "DGmove: movemesh(): Error in locating point " << ipoin << "!!" << std::endl;
-				return;
-			}
-
-			// store DG element and area coords in points
-			points(ipoin,2) = dat.elem;
-			for(int i = 0; i < ndim+1; i++)
-				points(ipoin,i+3) = dat.areacoords[i];
-		}
+		const bool located = locate_points();
+		if(!located)
+			std::cout << "! DGmove: movemesh(): Some interior points could not be located in the DG; they will not be moved!\n";
 
 		// update coordinates in dgpoints using bmotion
 		std::cout << "DGmove: movemesh(): Moving the Delaunay graph\n";
-		int  k = 0;
 		for(int i = 0; i < bmotion->rows(); i++)
 		{
 			for(int j = 0; j < ndim; j++)
@@ -168,6 +305,7 @@ public:
 		for(int ipoin = 0; ipoin < ninpoin; ipoin++)
 		{
 			elem = points(ipoin,2);
+			if(elem < 0) continue;			// the point could not be located, so it is not moved
 			for(int dim = 0; dim < ndim; dim++)
 			{
 				points(ipoin,dim) = 0.0;
@@ -175,6 +313,7 @@ public:
 					points(ipoin,dim) += points(ipoin,i+3)*dgpoints(dginpoel(elem,i),dim);
 			}
 		}
+		return located;
 	}
 
 	void movedg()
@@ -191,11 +330,14 @@ public:
 	}
 
 	/// Combining the 3 steps of movement - generate DG, move mesh and move DG into 1 function.
-	void move()
+	/** \return false if some interior point could not be located, and so was not moved
+	 */
+	bool move()
 	{
 		generateDG();
-		movemesh();
+		const bool located = movemesh();
 		movedg();
+		return located;
 	}
 
 	amat::Matrix<double> getInteriorPoints()
@@ -238,4 +380,224 @@ public:
 	}
 };
 
+/// Cached Delaunay graph mapping, for moving a mesh repeatedly with different boundary displacements
+/** Holds the DG connectivity and, for each interior point, its host DG element and area coordinates, as flat arrays.
+ * Once [built](@ref build), each new boundary configuration only needs the O(N) evaluation in [map](@ref map);
+ * no triangulation or point location is repeated. The mapping can be [written](@ref write) to disk and [read](@ref read) back.
+ *
+ * [update](@ref update) additionally checks that no DG element becomes inverted in the new configuration.
+ * If some do, the DG is re-generated in the last configuration that was valid (with the interior points at their mapped positions there),
+ * so that the expensive steps are repeated only when the motion requires it.
+ */
+class DGMapping
+{
+	int nbpoin;							///< Number of DG (boundary) points
+	int ninpoin;						///< Number of interior points
+	int nelem;							///< Number of DG elements
+	std::vector<int> inpoel;			///< DG connectivity, nelem x 3 row-major
+	std::vector<int> host;				///< Host DG element of each interior point
+	std::vector<double> area[3];		///< Area coordinates of each interior point w.r.t. each vertex of its host element
+	amat::Matrix<double> refbcoords;	///< DG point coordinates in which the DG was generated
+	amat::Matrix<double> validbcoords;	///< DG point coordinates of the last configuration in which the DG was valid
+
+	/// Signed area (times 2) of DG element iel with point coordinates b
+	double jacobian(const amat::Matrix<double>& b, const int iel) const
+	{
+		const int* p = &inpoel[3*iel];
+		return (b.get(p[1],0)-b.get(p[0],0))*(b.get(p[2],1)-b.get(p[0],1)) - (b.get(p[2],0)-b.get(p[0],0))*(b.get(p[1],1)-b.get(p[0],1));
+	}
+
+public:
+	DGMapping() : nbpoin(0), ninpoin(0), nelem(0) {}
+
+	int gnbpoin() const { return nbpoin; }
+	int gninpoin() const { return ninpoin; }
+	int gnelem() const { return nelem; }
+	int ginpoel(const int iel, const int i) const { return inpoel[3*iel+i]; }
+	int ghost(const int ipoin) const { return host[ipoin]; }
+	double garea(const int ipoin, const int i) const { return area[i][ipoin]; }
+
+	/// Generates the DG of the boundary points and locates the interior points in it
+	/** \param[in] bouncoords contains the coordinates of the DG points
+	 * \param[in] incoords contains the coordinates of the interior points
+	 * \return false if some interior point could not be located
+	 */
+	bool build(const amat::Matrix<double>& bouncoords, const amat::Matrix<double>& incoords)
+	{
+		nbpoin = bouncoords.rows();
+		ninpoin = incoords.rows();
+		refbcoords = bouncoords;
+		validbcoords = bouncoords;
+
+		Delaunay2D dg;
+		dg.setup(&refbcoords);
+		dg.bowyer_watson();
+
+		nelem = dg.elems.size();
+		inpoel.resize(3*nelem);
+		for(int iel = 0; iel < nelem; iel++)
+			for(int i = 0; i < 3; i++)
+				inpoel[3*iel+i] = dg.elems[iel].p[i];
+
+		return dg_locate_points(dg, refbcoords, incoords, host, area);
+	}
+
+	/// Computes positions of interior points for the DG points' coordinates bouncoords
+	/** Interior points that could not be located when the DG was [built](@ref build) have no host element;
+	 * their rows of incoords are left unchanged.
+	 * \param[out] incoords must have ninpoin rows and at least 2 columns.
+	 */
+	void map(const amat::Matrix<double>& bouncoords, amat::Matrix<double>& incoords) const
+	{
+		const int np = ninpoin;
+		const int* const inp = inpoel.data();
+		const int* const hst = host.data();
+		const double* const a0 = area[0].data();
+		const double* const a1 = area[1].data();
+		const double* const a2 = area[2].data();
+
+		#pragma omp parallel for default(none) shared(bouncoords, incoords, inp, hst, a0, a1, a2, np)
+		for(int ipoin = 0; ipoin < np; ipoin++)
+		{
+			if(hst[ipoin] < 0) continue;
+			const int* p = &inp[3*hst[ipoin]];
+			for(int dim = 0; dim < 2; dim++)
+				incoords(ipoin,dim) = a0[ipoin]*bouncoords.get(p[0],dim) + a1[ipoin]*bouncoords.get(p[1],dim) + a2[ipoin]*bouncoords.get(p[2],dim);
+		}
+	}
+
+	/// Counts DG elements that are inverted or degenerate when the DG points have coordinates bouncoords
+	/** An element is counted if the sign of its Jacobian differs from that in the configuration in which the DG was generated.
+	 * \param[out] inverted, if not null, receives the indices of such elements
+	 */
+	int check(const amat::Matrix<double>& bouncoords, std::vector<int>* const inverted = nullptr) const
+	{
+		int nbad = 0;
+		if(inverted) inverted->clear();
+		for(int iel = 0; iel < nelem; iel++)
+			if(jacobian(bouncoords, iel)*jacobian(refbcoords, iel) <= 0)
+			{
+				nbad++;
+				if(inverted) inverted->push_back(iel);
+			}
+		return nbad;
+	}
+
+	/// Maps the interior points to a new DG configuration, re-generating the DG first only if it would become invalid
+	/** \return the number of DG elements that are still inverted in the new configuration; 0 if the mapping is valid
+	 */
+	int update(const amat::Matrix<double>& bouncoords, amat::Matrix<double>& incoords)
+	{
+		int nbad = check(bouncoords);
+		if(nbad > 0)
+		{
+			std::cout << "DGMapping: update(): " << nbad << " DG elements would be inverted; re-generating the DG in the last valid configuration.\n";
+			// points without a host element keep their current positions
+			amat::Matrix<double> inc(ninpoin, 2);
+			for(int ipoin = 0; ipoin < ninpoin; ipoin++)
+				for(int dim = 0; dim < 2; dim++)
+					inc(ipoin,dim) = incoords.get(ipoin,dim);
+			map(validbcoords, inc);
+			const amat::Matrix<double> vb = validbcoords;
+			if(!build(vb, inc))
+				return nelem;
+			nbad = check(bouncoords);
+			if(nbad > 0)
+				std::cout << "! DGMapping: update(): " << nbad << " DG elements are inverted in the new configuration!\n";
+		}
+
+		map(bouncoords, incoords);
+		if(nbad == 0)
+			validbcoords = bouncoords;
+		return nbad;
+	}
+
+	/// Writes the mapping to a binary file
+	bool write(const std::string fname) const
+	{
+		std::ofstream fout(fname, std::ios::binary);
+		if(!fout) {
+			std::cout << "! DGMapping: write(): Could not open file " << fname << "!\n";
+			return false;
+		}
+		const int header[4] = {DGM_MAPPING_FILE_VERSION, nbpoin, ninpoin, nelem};
+		fout.write(DGM_MAPPING_FILE_MAGIC, 8);
+		fout.write((const char*)header, sizeof(header));
+		for(int i = 0; i < nbpoin; i++)
+			for(int j = 0; j < 2; j++)
+			{
+				fout.write((const char*)&refbcoords(i,j), sizeof(double));
+				fout.write((const char*)&validbcoords(i,j), sizeof(double));
+			}
+		fout.write((const char*)inpoel.data(), 3*nelem*sizeof(int));
+		fout.write((const char*)host.data(), ninpoin*sizeof(int));
+		for(int i = 0; i < 3; i++)
+			fout.write((const char*)area[i].data(), ninpoin*sizeof(double));
+		return fout.good();
+	}
+
+	/// Reads a mapping written by [write](@ref write)
+	bool read(const std::string fname)
+	{
+		std::ifstream fin(fname, std::ios::binary);
+		if(!fin) {
+			std::cout << "! DGMapping: read(): Could not open file " << fname << "!\n";
+			return false;
+		}
+		char magic[8];
+		int header[4];
+		fin.read(magic, 8);
+		fin.read((char*)header, sizeof(header));
+		if(!fin || std::string(magic, 8) != std::string(DGM_MAPPING_FILE_MAGIC, 8) || header[0] != DGM_MAPPING_FILE_VERSION) {
+			std::cout << "! DGMapping: read(): " << fname << " is not a DG mapping file of version " << DGM_MAPPING_FILE_VERSION << "!\n";
+			return false;
+		}
+
+		// the sizes in the header must agree with the size of the file before anything is allocated
+		const long long nb = header[1], ni = header[2], ne = header[3];
+		const std::streamoff datastart = fin.tellg();
+		fin.seekg(0, std::ios::end);
+		const long long datasize = fin.tellg() - datastart;
+		fin.seekg(datastart);
+		if(nb < 0 || ni < 0 || ne < 0 || nb*4*sizeof(double) + ne*3*sizeof(int) + ni*(sizeof(int)+3*sizeof(double)) != (unsigned long long)datasize) {
+			std::cout << "! DGMapping: read(): The sizes in the header of " << fname << " (" << nb << " DG points, " << ni << " interior points, "
+				<< ne << " elements) do not match the size of the file!\n";
+			return false;
+		}
+		nbpoin = header[1]; ninpoin = header[2]; nelem = header[3];
+
+		refbcoords.setup(nbpoin, 2);
+		validbcoords.setup(nbpoin, 2);
+		for(int i = 0; i < nbpoin; i++)
+			for(int j = 0; j < 2; j++)
+			{
+				fin.read((char*)&refbcoords(i,j), sizeof(double));
+				fin.read((char*)&validbcoords(i,j), sizeof(double));
+			}
+		inpoel.resize(3*nelem);
+		host.resize(ninpoin);
+		fin.read((char*)inpoel.data(), 3*nelem*sizeof(int));
+		fin.read((char*)host.data(), ninpoin*sizeof(int));
+		for(int i = 0; i < 3; i++)
+		{
+			area[i].resize(ninpoin);
+			fin.read((char*)area[i].data(), ninpoin*sizeof(double));
+		}
+		bool valid = (bool)fin;
+		for(int i = 0; i < 3*nelem && valid; i++)
+			valid = inpoel[i] >= 0 && inpoel[i] < nbpoin;
+		for(int i = 0; i < ninpoin && valid; i++)
+			valid = host[i] >= -1 && host[i] < nelem;
+		if(!valid) {
+			std::cout << "! DGMapping: read(): " << fname << " is truncated or contains invalid indices!\n";
+			nbpoin = ninpoin = nelem = 0;
+			inpoel.clear(); host.clear();
+			for(int i = 0; i < 3; i++)
+				area[i].clear();
+			return false;
+		}
+		return true;
+	}
+};
+
 } // end namespace amc
@@ -13,6 +13,10 @@ Oct 7, 2015: Added a similar class, DGRBFrotate, for rotation interpolation.
 #include <abowyerwatson.hpp>
 #endif
 
+#ifndef __ARBFKERNELS_H
+#include <arbfkernels.hpp>
+#endif
+
 using namespace std;
 using namespace amat;
 
@@ -40,7 +44,8 @@ class DGRBFmove
 	Matrix<double>* s;
 	bool isallocMtt;
 	bool isallocalpha;
-	double (DGRBFmove::*rbf)(double);
+	RBFKernelType rbftype;					///< The RBF to use
+	double rbfscale;						///< Factor by which distances are multiplied before evaluating the RBF
 	double srad;			// support radius for RBFs
 
 public:
@@ -86,21 +91,20 @@ public:
 
 		bflag = bflags;
 		newcoords.setup(bflags.rows(),ndim);
-		dg.setup(&dgpoints, ndgpoin);
+		dg.setup(&dgpoints);
 
 		isallocMtt = false;
 		isallocalpha = false;
 		switch(rbf_type)
 		{
-			case(0): rbf = &DGRBFmove::rbf_c0;
-			break;
-			case(2): rbf = &DGRBFmove::rbf_c2_compact;
+			case(0): rbftype = RBF_C0;
 			break;
-			case(4): rbf = &DGRBFmove::rbf_c4;
-			default: rbf = &DGRBFmove::rbf_c2_compact;
+			default: rbftype = RBF_C2;
 		}
 
 		srad = support_radius;
+		// only the C2 function is scaled by the support radius
+		rbfscale = (rbftype == RBF_C2) ? 1.0/srad : 1.0;
 
 		//cout << "Test: " << rbf(0)<< ' ' << sqrt(0.0) << endl;
 	}
@@ -233,7 +237,7 @@ public:
 					for(int idim = 0; idim < ndim; idim++)
 					 	msum += (dgpoints(ipoin,idim)-dgpoints(jpoin,idim))*(dgpoints(ipoin,idim)-dgpoints(jpoin,idim));
 					if(msum < 0) { cout << "! DGRBFmove: calcMtt(): msum is " << msum << endl; msum = 0;}
-					Mtt[iel](i,j) = (this->*rbf)(sqrt(msum));
+					Mtt[iel](i,j) = rbf_eval(rbftype, rbfscale*sqrt(msum));
 				}
 			}
 		}
@@ -287,13 +291,13 @@ public:
 		cout << "DGmove: movemesh():  Moving the interior points\n";
 		int elem; double* rr = new double[ndim];
 		double sum = 0;
+		// distances of each interior point from the nodes of its containing DG element, so that the RBFs can be evaluated in one batch
+		const int nnode = ndim+1;
+		vector<double> rdist(ninpoin*nnode), phi(ninpoin*nnode);
 		for(int ipoin = 0; ipoin < ninpoin; ipoin++)
 		{
 			elem = points(ipoin,2);
-			//cout << "* " << elem << endl;
-
-			// calculate RBFs of point ipoin and store in A
-			for(int inode = 0; inode < ndim+1; inode++)
+			for(int inode = 0; inode < nnode; inode++)
 			{
 				sum = 0;
 				for(int idim = 0; idim < ndim; idim++)
@@ -301,9 +305,19 @@ public:
 					rr[idim] = dgpoints.get(dginpoel(elem,inode),idim);
 					sum += (rr[idim] - points(ipoin,idim)) * (rr[idim] - points(ipoin,idim));
 				}
-
-				A(inode) = (this->*rbf)( sqrt(sum) );
+				rdist[ipoin*nnode+inode] = sqrt(sum);
 			}
+		}
+		rbf_batch(rbftype, ninpoin*nnode, rdist.data(), rbfscale, phi.data());
+
+		for(int ipoin = 0; ipoin < ninpoin; ipoin++)
+		{
+			elem = points(ipoin,2);
+			//cout << "* " << elem << endl;
+
+			// get RBFs of point ipoin and store in A
+			for(int inode = 0; inode < nnode; inode++)
+				A(inode) = phi[ipoin*nnode+inode];
 
 			// Calculate displacement of ipoin using A and alpha, and update coordinates of point
 			for(int idim = 0; idim < ndim; idim++)
@@ -388,7 +402,8 @@ class DGRBFrotate
 	Matrix<double>* s;						///< Prescribed motion of nodes of each DG element.
 	bool isallocMtt;
 	bool isallocalpha;
-	double (DGRBFrotate::*rbf)(double);		///< Pointer to the specific RBF function to be used
+	RBFKernelType rbftype;					///< The RBF to use
+	double rbfscale;						///< Factor by which distances are multiplied before evaluating the RBF
 	double srad;							///< support radius for RBFs
 
 	vector<double> rc;						///< coordinates of centre of rotation
@@ -454,21 +469,20 @@ public:
 
 		bflag = bflags;
 		newcoords.setup(bflags.rows(),ndim);
-		dg.setup(&dgpoints, ndgpoin);
+		dg.setup(&dgpoints);
 
 		isallocMtt = false;
 		isallocalpha = false;
 		switch(rbf_type)
 		{
-			case(0): rbf = &DGRBFrotate::rbf_c0;
-			break;
-			case(2): rbf = &DGRBFrotate::rbf_c2_compact;
+			case(0): rbftype = RBF_C0;
 			break;
-			case(4): rbf = &DGRBFrotate::rbf_c4;
-			default: rbf = &DGRBFrotate::rbf_c2_compact;
+			default: rbftype = RBF_C2;
 		}
 
 		srad = support_radius;
+		// only the C2 function is scaled by the support radius
+		rbfscale = (rbftype == RBF_C2) ? 1.0/srad : 1.0;
 
 	}
 
@@ -603,7 +617,7 @@ public:
 					for(int idim = 0; idim < ndim; idim++)
 					 	msum += (dgpoints(ipoin,idim)-dgpoints(jpoin,idim))*(dgpoints(ipoin,idim)-dgpoints(jpoin,idim));
 					if(msum < 0) { cout << "! DGRBFmove: calcMtt(): msum is " << msum << endl; msum = 0;}
-					Mtt[iel](i,j) = (this->*rbf)(sqrt(msum));
+					Mtt[iel](i,j) = rbf_eval(rbftype, rbfscale*sqrt(msum));
 				}
 			}
 		}
@@ -658,14 +672,13 @@ public:
 		double* rr = new double[ndim];
 		double sum = 0;
 		vector<double> rp(ndim);
-		// This loop can be parallelized
+		// distances of each interior point from the nodes of its containing DG element, so that the RBFs can be evaluated in one batch
+		const int nnode = ndim+1;
+		vector<double> rdist(ninpoin*nnode), phi(ninpoin*nnode);
 		for(int ipoin = 0; ipoin < ninpoin; ipoin++)
 		{
-			// get the containing element
 			elem = points(ipoin,2);
-
-			// calculate RBFs of point ipoin and store in A
-			for(int inode = 0; inode < ndim+1; inode++)
+			for(int inode = 0; inode < nnode; inode++)
 			{
 				sum = 0;
 				for(int idim = 0; idim < ndim; idim++)
@@ -673,9 +686,20 @@ public:
 					rr[idim] = dgpoints.get(dginpoel(elem,inode),idim);
 					sum += (rr[idim] - points(ipoin,idim)) * (rr[idim] - points(ipoin,idim));
 				}
-
-				A(inode) = (this->*rbf)( sqrt(sum) );
+				rdist[ipoin*nnode+inode] = sqrt(sum);
 			}
+		}
+		rbf_batch(rbftype, ninpoin*nnode, rdist.data(), rbfscale, phi.data());
+
+		// This loop can be parallelized
+		for(int ipoin = 0; ipoin < ninpoin; ipoin++)
+		{
+			// get the containing element
+			elem = points(ipoin,2);
+
+			// get RBFs of point ipoin and store in A
+			for(int inode = 0; inode < nnode; inode++)
+				A(inode) = phi[ipoin*nnode+inode];
 
 			// Calculate displacement of ipoin using A and alpha, and update coordinates of point
 			for(int idim = 0; idim < rdim; idim++)
@@ -788,7 +812,8 @@ class DGRBF2
 	Matrix<double>* sd;						///< Prescribed displacements of nodes for each DG element
 	bool isallocMtt;
 	bool isallocalpha;
-	double (DGRBF2::*rbf)(double);		///< Pointer to the specific RBF function to be used
+	RBFKernelType rbftype;					///< The RBF to use
+	double rbfscale;						///< Factor by which distances are multiplied before evaluating the RBF
 	double srad;							///< support radius for RBFs
 
 	vector<double> rc;						///< coordinates of centre of rotation
@@ -859,21 +884,20 @@ public:
 
 		bflag = bflags;
 		newcoords.setup(bflags.rows(),ndim);
-		dg.setup(&dgpoints, ndgpoin);
+		dg.setup(&dgpoints);
 
 		isallocMtt = false;
 		isallocalpha = false;
 		switch(rbf_type)
 		{
-			case(0): rbf = &DGRBF2::rbf_c0;
-			break;
-			case(2): rbf = &DGRBF2::rbf_c2_compact;
+			case(0): rbftype = RBF_C0;
 			break;
-			case(4): rbf = &DGRBF2::rbf_c4;
-			default: rbf = &DGRBF2::rbf_c2_compact;
+			default: rbftype = RBF_C2;
 		}
 
 		srad = support_radius;
+		// only the C2 function is scaled by the support radius
+		rbfscale = (rbftype == RBF_C2) ? 1.0/srad : 1.0;
 		tol = 1e-15;
 
 		//cout << "Test: " << rbf(0)<< ' ' << sqrt(0.0) << endl;
@@ -1009,7 +1033,7 @@ public:
 					for(int idim = 0; idim < ndim; idim++)
 					 	msum += (dgpoints(ipoin,idim)-dgpoints(jpoin,idim))*(dgpoints(ipoin,idim)-dgpoints(jpoin,idim));
 					if(msum < 0) { cout << "! DGRBFmove: calcMtt(): msum is " << msum << endl; msum = 0;}
-					Mtt[iel](i,j) = (this->*rbf)(sqrt(msum));
+					Mtt[iel](i,j) = rbf_eval(rbftype, rbfscale*sqrt(msum));
 				}
 			}
 		}
@@ -1077,12 +1101,13 @@ public:
 		double* rra = new double[ndim];
 		double* rrd = new double[ndim];
 		double sum = 0;
+		// distances of each interior point from the nodes of its containing DG element, so that the RBFs can be evaluated in one batch
+		const int nnode = ndim+1;
+		vector<double> rdist(ninpoin*nnode), phi(ninpoin*nnode);
 		for(int ipoin = 0; ipoin < ninpoin; ipoin++)
 		{
 			elem = points(ipoin,2);
-
-			// calculate RBFs of point ipoin and store in A
-			for(int inode = 0; inode < ndim+1; inode++)
+			for(int inode = 0; inode < nnode; inode++)
 			{
 				sum = 0;
 				for(int idim = 0; idim < ndim; idim++)
@@ -1090,9 +1115,18 @@ public:
 					rrd[idim] = dgpoints.get(dginpoel(elem,inode),idim);
 					sum += (rrd[idim] - points(ipoin,idim)) * (rrd[idim] - points(ipoin,idim));
 				}
-
-				A(inode) = (this->*rbf)( sqrt(sum) );
+				rdist[ipoin*nnode+inode] = sqrt(sum);
 			}
+		}
+		rbf_batch(rbftype, ninpoin*nnode, rdist.data(), rbfscale, phi.data());
+
+		for(int ipoin = 0; ipoin < ninpoin; ipoin++)
+		{
+			elem = points(ipoin,2);
+
+			// get RBFs of point ipoin and store in A
+			for(int inode = 0; inode < nnode; inode++)
+				A(inode) = phi[ipoin*nnode+inode];
 
 			// Calculate displacement of ipoin using A and alpha, and update coordinates of point
 			for(int idim = 0; idim < rdim; idim++)
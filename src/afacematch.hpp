@@ -0,0 +1,105 @@
+/** \file afacematch.hpp
+ * \brief Matching of mesh faces that have the same vertices, by sorting canonical face keys.
+ * \author Aditya Kashi
+ *
+ * Each face is represented by its vertex numbers sorted in ascending order.
+ * Faces are first bucketed by their smallest vertex with a counting sort (one radix pass whose radix is the number of points),
+ * and the few faces in each bucket are then sorted by their remaining vertices; faces with identical keys become adjacent.
+ * The cost is linear in the number of faces, and the key computation and the per-bucket sorts run in parallel with OpenMP.
+ */
+
+#ifndef __AFACEMATCH_H
+
+#ifndef __ACONSTANTS_H
+#include <aconstants.h>
+#endif
+
+#ifndef _GLIBCXX_VECTOR
+#include <vector>
+#endif
+
+#ifndef _GLIBCXX_ALGORITHM
+#include <algorithm>
+#endif
+
+#ifdef _OPENMP
+#ifndef OMP_H
+#include <omp.h>
+#endif
+#endif
+
+#define __AFACEMATCH_H 1
+
+/// Maximum number of vertices of a face that can be matched
+#define FACEMATCH_MAX_NVFA 4
+
+namespace amc {
+
+/// Finds, for each face, the other face with the same set of vertices
+/** \param[in] npoin is the number of points; vertex numbers must be in [0,npoin)
+ * \param[in] nfac is the number of faces
+ * \param[in] nvfa is the number of vertices of each face, at most FACEMATCH_MAX_NVFA
+ * \param[in] facepo contains the nvfa vertex numbers of each face, row-major; a face whose first vertex is -1 is ignored
+ * \param[out] match is resized to nfac; match[i] is the index of the face with the same vertices as face i, or -1 if there is none.
+ *   If more than two faces have the same vertices, the first two (by index) are matched to each other and the rest get -1.
+ * \return the number of faces that share their vertices with more than one other face (0 for a valid conforming mesh)
+ */
+inline amc_int match_faces(const amc_int npoin, const amc_int nfac, const int nvfa, const std::vector<amc_int>& facepo, std::vector<amc_int>& match)
+{
+	// canonical keys: vertices of each face in ascending order
+	std::vector<amc_int> keys(facepo.begin(), facepo.begin() + (size_t)nfac*nvfa);
+	#pragma omp parallel for default(none) shared(keys, nfac, nvfa)
+	for(amc_int ifac = 0; ifac < nfac; ifac++)
+		std::sort(keys.begin() + (size_t)ifac*nvfa, keys.begin() + (size_t)(ifac+1)*nvfa);
+
+	// bucket faces by their smallest vertex
+	std::vector<amc_int> bucket_p(npoin+1, 0);
+	for(amc_int ifac = 0; ifac < nfac; ifac++)
+		if(facepo[(size_t)ifac*nvfa] >= 0)
+			bucket_p[keys[(size_t)ifac*nvfa]+1]++;
+	for(amc_int i = 0; i < npoin; i++)
+		bucket_p[i+1] += bucket_p[i];
+	std::vector<amc_int> bucket(bucket_p[npoin]);
+	std::vector<amc_int> pos(bucket_p.begin(), bucket_p.end()-1);
+	for(amc_int ifac = 0; ifac < nfac; ifac++)
+		if(facepo[(size_t)ifac*nvfa] >= 0)
+			bucket[pos[keys[(size_t)ifac*nvfa]]++] = ifac;
+
+	match.assign(nfac, -1);
+	amc_int nmulti = 0;
+
+	#pragma omp parallel for default(none) shared(keys, bucket_p, bucket, match, npoin, nvfa) schedule(dynamic,256) reduction(+:nmulti)
+	for(amc_int ipoin = 0; ipoin < npoin; ipoin++)
+	{
+		const amc_int start = bucket_p[ipoin], end = bucket_p[ipoin+1];
+		const amc_int* const k = keys.data();
+
+		// sort by the remaining vertices; ties are broken by face index so that the result is deterministic
+		std::sort(bucket.begin()+start, bucket.begin()+end, [k,nvfa](const amc_int a, const amc_int b) {
+				for(int i = 1; i < nvfa; i++)
+					if(k[(size_t)a*nvfa+i] != k[(size_t)b*nvfa+i])
+						return k[(size_t)a*nvfa+i] < k[(size_t)b*nvfa+i];
+				return a < b;
+			});
+
+		for(amc_int i = start; i < end; )
+		{
+			amc_int j = i+1;
+			while(j < end && std::equal(k + (size_t)bucket[i]*nvfa + 1, k + (size_t)(bucket[i]+1)*nvfa, k + (size_t)bucket[j]*nvfa + 1))
+				j++;
+			if(j-i >= 2)
+			{
+				match[bucket[i]] = bucket[i+1];
+				match[bucket[i+1]] = bucket[i];
+			}
+			if(j-i > 2)
+				nmulti += j-i;
+			i = j;
+		}
+	}
+
+	return nmulti;
+}
+
+}
+#endif
@@ -0,0 +1,316 @@
+#include "agmshreader.hpp"
+
+#ifndef _GLIBCXX_CSTRING
+#include <cstring>
+#endif
+
+#ifndef _GLIBCXX_CSTDLIB
+#include <cstdlib>
+#endif
+
+#ifndef _GLIBCXX_ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef _GLIBCXX_CSTDINT
+#include <cstdint>
+#endif
+
+namespace amc {
+
+int gmsh_element_nnodes(const int elmtype)
+{
+	// number of nodes of Gmsh element types 1 to 31
+	static const int nnodes[] = {0, 2,3,4,4,8,6,5,3,6,9, 10,27,18,14,1,8,20,15,13,9, 10,12,15,15,21,4,5,6,20,35, 56};
+	if(elmtype < 1 || elmtype > 31)
+		return 0;
+	return nnodes[elmtype];
+}
+
+static inline bool is_blank(const char c)
+{
+	return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+
+bool parse_int(const char*& p, const char* const end, int& val)
+{
+	while(p < end && is_blank(*p))
+		p++;
+	bool neg = false;
+	if(p < end && (*p == '-' || *p == '+')) {
+		neg = (*p == '-');
+		p++;
+	}
+	if(p == end || *p < '0' || *p > '9')
+		return false;
+
+	long long v = 0;
+	while(p < end && *p >= '0' && *p <= '9')
+	{
+		v = 10*v + (*p - '0');
+		if(v > 2147483647LL + neg)
+			return false;
+		p++;
+	}
+	val = (int)(neg ? -v : v);
+	return true;
+}
+
+bool parse_double(const char*& p, const char* const end, double& val)
+{
+	// powers of ten that are exactly representable in double precision
+	static const double exact_pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+	while(p < end && is_blank(*p))
+		p++;
+	const char* const start = p;
+
+	bool neg = false;
+	if(p < end && (*p == '-' || *p == '+')) {
+		neg = (*p == '-');
+		p++;
+	}
+
+	// read the significant digits into an integer mantissa, and keep track of the decimal exponent
+	uint64_t mant = 0;
+	int ndigits = 0, exp10 = 0;
+	bool anydigit = false, fast = true;
+	for( ; p < end && *p >= '0' && *p <= '9'; p++)
+	{
+		anydigit = true;
+		if(mant == 0 && *p == '0') continue;
+		if(ndigits < 19) {
+			mant = 10*mant + (*p - '0');
+			ndigits++;
+		}
+		else fast = false;
+	}
+	if(p < end && *p == '.')
+	{
+		p++;
+		for( ; p < end && *p >= '0' && *p <= '9'; p++)
+		{
+			anydigit = true;
+			exp10--;
+			if(mant == 0 && *p == '0') continue;
+			if(ndigits < 19) {
+				mant = 10*mant + (*p - '0');
+				ndigits++;
+			}
+			else fast = false;
+		}
+	}
+	if(anydigit && p < end && (*p == 'e' || *p == 'E'))
+	{
+		const char* q = p+1;
+		bool eneg = false;
+		if(q < end && (*q == '-' || *q == '+')) {
+			eneg = (*q == '-');
+			q++;
+		}
+		if(q < end && *q >= '0' && *q <= '9')
+		{
+			int e = 0;
+			for( ; q < end && *q >= '0' && *q <= '9'; q++)
+				if(e < 100000) e = 10*e + (*q - '0');
+			exp10 += eneg ? -e : e;
+			p = q;
+		}
+	}
+
+	if(anydigit && (p == end || is_blank(*p)))
+	{
+		if(mant == 0) {
+			val = neg ? -0.0 : 0.0;
+			return true;
+		}
+		// Clinger's fast path: both the mantissa and the power of ten are exact, so one rounding gives the correctly rounded result
+		if(fast && mant <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+			double v = (double)mant;
+			v = exp10 < 0 ? v / exact_pow10[-exp10] : v * exact_pow10[exp10];
+			val = neg ? -v : v;
+			return true;
+		}
+	}
+
+	// everything else (long mantissas, large exponents, inf, nan, hexadecimal..) is left to the C library
+	char tok[128];
+	int len = 0;
+	for(const char* q = start; q < end && !is_blank(*q) && len < 127; q++)
+		tok[len++] = *q;
+	tok[len] = '\0';
+	char* tokend;
+	val = std::strtod(tok, &tokend);
+	if(tokend == tok) {
+		p = start;
+		return false;
+	}
+	p = start + (tokend - tok);
+	return true;
+}
+
+GmshReader::GmshReader() : beg(nullptr), end(nullptr), binary(false), swap(false),
+	npoin(0), nelm(0), nodestart(nullptr), elmstart(nullptr)
+{ }
+
+const char* GmshReader::findSection(const char* p, const char* const header) const
+{
+	const size_t len = strlen(header);
+	while(p < end)
+	{
+		// section headers are the only lines that begin with '$'
+		const char* const q = (const char*)memchr(p, '$', end-p);
+		if(!q)
+			return nullptr;
+		p = q+1;
+		if((q == beg || q[-1] == '\n') && (size_t)(end-q) >= len && strncmp(q, header, len) == 0
+			&& (q+len == end || is_blank(q[len])))
+		{
+			const char* const nl = (const char*)memchr(q, '\n', end-q);
+			return nl ? nl+1 : end;
+		}
+	}
+	return nullptr;
+}
+
+bool GmshReader::readBinaryInts(const char*& p, const int n, int* const v) const
+{
+	if((size_t)(end-p) < (size_t)n*4) {
+		std::cout << "! GmshReader: Unexpected end of file " << fname << std::endl;
+		return false;
+	}
+	memcpy(v, p, (size_t)n*4);
+	p += (size_t)n*4;
+	if(swap)
+		for(int i = 0; i < n; i++) {
+			const uint32_t u = (uint32_t)v[i];
+			v[i] = (int)((u >> 24) | ((u >> 8) & 0xff00u) | ((u << 8) & 0xff0000u) | (u << 24));
+		}
+	return true;
+}
+
+bool GmshReader::open(const std::string& filename)
+{
+	fname = filename;
+	binary = swap = false;
+	npoin = nelm = 0;
+
+	if(!file.open(filename)) {
+		std::cout << "! GmshReader: open(): Could not read file " << filename << std::endl;
+		beg = end = nullptr;
+		return false;
+	}
+	beg = file.data();
+	end = file.end();
+
+	// $MeshFormat: version, file type (0 for ASCII, 1 for binary) and size of floating-point numbers
+	const char* p = findSection(beg, "$MeshFormat");
+	double version; int filetype, datasize;
+	if(!p || !parse_double(p,end,version) || !parse_int(p,end,filetype) || !parse_int(p,end,datasize)) {
+		std::cout << "! GmshReader: open(): " << filename << " does not have a valid MeshFormat section!" << std::endl;
+		return false;
+	}
+	if(version < 2.0 || version >= 3.0) {
+		std::cout << "! GmshReader: open(): Gmsh format version " << version << " of " << filename << " is not supported; only version 2 is." << std::endl;
+		return false;
+	}
+	binary = (filetype == 1);
+	if(binary)
+	{
+		if(datasize != (int)sizeof(double)) {
+			std::cout << "! GmshReader: open(): Binary files with floating-point data of size " << datasize << " are not supported." << std::endl;
+			return false;
+		}
+		// the integer 1, written in binary, follows on the next line; it tells us the endianness of the file
+		const char* q = (const char*)memchr(p, '\n', end-p);
+		int one;
+		if(!q || !readBinaryInts(++q, 1, &one)) {
+			std::cout << "! GmshReader: open(): " << filename << " does not have a valid MeshFormat section!" << std::endl;
+			return false;
+		}
+		swap = false;
+		if(one != 1) {
+			swap = true;
+			const uint32_t u = (uint32_t)one;
+			if(((u >> 24) | ((u >> 8) & 0xff00u) | ((u << 8) & 0xff0000u) | (u << 24)) != 1u) {
+				std::cout << "! GmshReader: open(): Could not determine the endianness of " << filename << std::endl;
+				return false;
+			}
+		}
+		p = q;
+	}
+
+	// $Nodes
+	p = findSection(p, "$Nodes");
+	if(!p || !parse_int(p,end,npoin) || npoin < 0) {
+		std::cout << "! GmshReader: open(): " << filename << " does not have a valid Nodes section!" << std::endl;
+		return false;
+	}
+	p = (const char*)memchr(p, '\n', end-p);
+	nodestart = p ? p+1 : end;
+
+	// $Elements; in a binary file, the node data has to be skipped explicitly as it may contain any bytes
+	if(binary) {
+		const size_t nodebytes = (size_t)npoin*(4+3*sizeof(double));
+		if((size_t)(end-nodestart) < nodebytes) {
+			std::cout << "! GmshReader: open(): Unexpected end of file " << filename << std::endl;
+			return false;
+		}
+		p = findSection(nodestart + nodebytes, "$EndNodes");
+		if(p) p = findSection(p, "$Elements");
+	}
+	else
+		p = findSection(nodestart, "$Elements");
+	if(!p || !parse_int(p,end,nelm) || nelm < 0) {
+		std::cout << "! GmshReader: open(): " << filename << " does not have a valid Elements section!" << std::endl;
+		return false;
+	}
+	p = (const char*)memchr(p, '\n', end-p);
+	elmstart = p ? p+1 : end;
+
+	return true;
+}
+
+bool GmshReader::readNodes(amat::Matrix<amc_real>& coords, const int ndim) const
+{
+	if(ndim < 1 || ndim > 3) {
+		std::cout << "! GmshReader: readNodes(): Invalid number of dimensions " << ndim << std::endl;
+		return false;
+	}
+	coords.setup(npoin, ndim);
+	const char* p = nodestart;
+
+	for(amc_int i = 0; i < npoin; i++)
+	{
+		int id;
+		double x[3];
+		if(binary)
+		{
+			if(!readBinaryInts(p, 1, &id))
+				return false;
+			memcpy(x, p, 3*sizeof(double));
+			p += 3*sizeof(double);
+			if(swap)
+				for(int j = 0; j < 3; j++) {
+					unsigned char* const b = (unsigned char*)&x[j];
+					for(int k = 0; k < 4; k++)
+						std::swap(b[k], b[7-k]);
+				}
+		}
+		else if(!parse_int(p,end,id) || !parse_double(p,end,x[0]) || !parse_double(p,end,x[1]) || !parse_double(p,end,x[2])) {
+			std::cout << "! GmshReader: readNodes(): Could not read node " << i+1 << " in " << fname << std::endl;
+			return false;
+		}
+
+		if(id < 1 || id > npoin) {
+			std::cout << "! GmshReader: readNodes(): Node number " << id << " is out of range; nodes must be numbered from 1 to " << npoin << std::endl;
+			return false;
+		}
+		for(int j = 0; j < ndim; j++)
+			coords(id-1,j) = x[j];
+	}
+	return true;
+}
+
+}
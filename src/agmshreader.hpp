@@ -0,0 +1,180 @@
+/** \file agmshreader.hpp
+ * \brief Fast reader for mesh files in the Gmsh 2 format, both ASCII and binary.
+ * \author Aditya Kashi
+ *
+ * The whole file is memory-mapped (or, where that is not available, read into memory with one block read),
+ * and numbers are parsed directly from the buffer by hand-written integer and floating-point parsers instead of through iostreams.
+ * Elements are not stored by the reader; instead, [forEachElement](@ref GmshReader::forEachElement) calls a function for each element.
+ * Mesh classes call it twice - once to count faces, elements and tags, and again to fill arrays allocated to exactly the right size.
+ */
+
+#ifndef __AGMSHREADER_H
+
+#ifndef __ACONSTANTS_H
+#include <aconstants.h>
+#endif
+
+#ifndef __AMATRIX_H
+#include <amatrix.hpp>
+#endif
+
+#ifndef __AMAPPEDFILE_H
+#include <amappedfile.hpp>
+#endif
+
+#ifndef _GLIBCXX_IOSTREAM
+#include <iostream>
+#endif
+
+#ifndef _GLIBCXX_STRING
+#include <string>
+#endif
+
+#ifndef _GLIBCXX_VECTOR
+#include <vector>
+#endif
+
+#define __AGMSHREADER_H 1
+
+namespace amc {
+
+/// Number of nodes of a Gmsh element type, or 0 if the type is unknown
+int gmsh_element_nnodes(const int elmtype);
+
+/// Parses a (decimal) integer starting at p, after skipping blanks and line breaks
+/** \param[in,out] p is advanced to just after the integer
+ * \param[in] end is one past the last character of the buffer
+ * \param[out] val is the integer read
+ * \return false if no integer could be read
+ */
+bool parse_int(const char*& p, const char* const end, int& val);
+
+/// Parses a floating-point number starting at p, after skipping blanks and line breaks
+/** Numbers with at most 19 significant digits and a decimal exponent small enough that the result is computed exactly
+ * (Clinger's fast path) are converted directly; others are handed to strtod. Either way the result is correctly rounded,
+ * so it is identical to what the standard library would read.
+ * \param[in,out] p is advanced to just after the number
+ * \param[in] end is one past the last character of the buffer
+ * \param[out] val is the number read
+ * \return false if no number could be read
+ */
+bool parse_double(const char*& p, const char* const end, double& val);
+
+/// Reads a Gmsh 2 mesh file (format version 2.x, ASCII or binary)
+/** Usage: [open](@ref open) the file, read the points with [readNodes](@ref readNodes),
+ * then call [forEachElement](@ref forEachElement) as many times as needed.
+ */
+class GmshReader
+{
+	std::string fname;
+	MappedFile file;				///< The contents of the mesh file
+	const char* beg;				///< Start of the file contents
+	const char* end;				///< One past the end of the file contents
+
+	bool binary;					///< Whether the file is in the binary Gmsh format
+	bool swap;						///< Whether binary data needs to be byte-swapped (the file was written on a machine of different endianness)
+	amc_int npoin;					///< Number of nodes in the file
+	amc_int nelm;					///< Number of entries in the Elements section
+	const char* nodestart;			///< Start of the node data
+	const char* elmstart;			///< Start of the element data
+
+	/// Finds the line that begins with a given section header, starting the search at p
+	/** \return a pointer to the start of the line following the header, or nullptr if the section was not found
+	 */
+	const char* findSection(const char* p, const char* const header) const;
+
+	/// Reads n 4-byte integers from the buffer into v
+	bool readBinaryInts(const char*& p, const int n, int* const v) const;
+
+public:
+	GmshReader();
+
+	/// Maps the file and parses its header; returns false (after printing a message) if the file could not be read or is not a Gmsh 2 mesh
+	bool open(const std::string& filename);
+
+	bool isBinary() const { return binary; }
+	amc_int gnpoin() const { return npoin; }
+	amc_int gnelm() const { return nelm; }
+
+	/// Reads the coordinates of all nodes into coords, which is re-allocated as npoin x ndim
+	/** Any coordinates beyond ndim are discarded. Nodes are stored by their Gmsh number (less 1),
+	 * so the file must number its nodes from 1 to npoin.
+	 */
+	bool readNodes(amat::Matrix<amc_real>& coords, const int ndim) const;
+
+	/// Calls f(elmtype, ntags, tags, nnodes, nodes) for each entry of the Elements section, in the order of the file
+	/** tags and nodes are pointers to int arrays that are valid only during the call; node numbers are as in the file (starting from 1).
+	 * \return false if the Elements section is malformed
+	 */
+	template <typename Func>
+	bool forEachElement(Func f) const;
+};
+
+template <typename Func>
+bool GmshReader::forEachElement(Func f) const
+{
+	const char* p = elmstart;
+	std::vector<int> data(64);
+
+	if(binary)
+	{
+		amc_int iel = 0;
+		while(iel < nelm)
+		{
+			// each block of elements of one type is preceded by the type, the number of elements in the block and the number of tags
+			int header[3];
+			if(!readBinaryInts(p, 3, header))
+				return false;
+			const int elmtype = header[0], nblk = header[1], ntags = header[2];
+			const int nnodes = gmsh_element_nnodes(elmtype);
+			if(nnodes == 0 || nblk < 0 || ntags < 0 || nblk > nelm-iel) {
+				std::cout << "! GmshReader: forEachElement(): Invalid element block of type " << elmtype << " in " << fname << std::endl;
+				return false;
+			}
+			const int nval = 1+ntags+nnodes;
+			if((int)data.size() < nval) data.resize(nval);
+
+			for(int i = 0; i < nblk; i++)
+			{
+				if(!readBinaryInts(p, nval, &data[0]))
+					return false;
+				f(elmtype, ntags, &data[1], nnodes, &data[1+ntags]);
+			}
+			iel += nblk;
+		}
+	}
+	else
+	{
+		for(amc_int iel = 0; iel < nelm; iel++)
+		{
+			// an entry is: number, type, number of tags, the tags, and the node numbers up to the end of the line
+			int num, elmtype, ntags, nval = 0;
+			if(!parse_int(p,end,num) || !parse_int(p,end,elmtype) || !parse_int(p,end,ntags) || ntags < 0) {
+				std::cout << "! GmshReader: forEachElement(): Could not read element " << iel+1 << " in " << fname << std::endl;
+				return false;
+			}
+			while(true)
+			{
+				while(p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+					p++;
+				if(p == end || *p == '\n')
+					break;
+				if(nval == (int)data.size()) data.resize(2*nval);
+				if(!parse_int(p,end,data[nval])) {
+					std::cout << "! GmshReader: forEachElement(): Could not read element " << iel+1 << " in " << fname << std::endl;
+					return false;
+				}
+				nval++;
+			}
+			if(nval < ntags) {
+				std::cout << "! GmshReader: forEachElement(): Element " << iel+1 << " has fewer numbers than tags in " << fname << std::endl;
+				return false;
+			}
+			f(elmtype, ntags, &data[0], nval-ntags, &data[ntags]);
+		}
+	}
+	return true;
+}
+
+}
+#endif
@@ -0,0 +1,125 @@
+#include "akdtree.hpp"
+
+#ifndef _GLIBCXX_ALGORITHM
+#include <algorithm>
+#endif
+
+namespace amc {
+
+KDTree::KDTree() : pts(nullptr), ndim(0), npoin(0), leafsize(16)
+{ }
+
+KDTree::KDTree(const amat::Matrix<amc_real>* const points, const int leaf_size)
+{
+	setup(points, leaf_size);
+}
+
+void KDTree::setup(const amat::Matrix<amc_real>* const points, const int leaf_size)
+{
+	pts = points;
+	npoin = points->rows();
+	ndim = points->cols();
+	leafsize = leaf_size > 0 ? leaf_size : 1;
+	nodes.clear();
+	if(ndim > KDTREE_MAX_DIM || ndim < 1) {
+		std::cout << "KDTree: setup(): ! Cannot handle points of dimension " << ndim << "!" << std::endl;
+		npoin = 0;
+		return;
+	}
+
+	perm.resize(npoin);
+	for(amc_int i = 0; i < npoin; i++)
+		perm[i] = i;
+
+	if(npoin == 0) return;
+	nodes.reserve(2*(npoin/leafsize+1));
+	build(0, npoin);
+}
+
+int KDTree::build(const amc_int start, const amc_int end)
+{
+	int inode = nodes.size();
+	nodes.push_back(Node());
+	Node nd;
+	nd.start = start; nd.end = end;
+	nd.left = nd.right = -1;
+
+	// bounding box of the points in this node
+	for(int idim = 0; idim < ndim; idim++)
+		nd.bmin[idim] = nd.bmax[idim] = pts->get(perm[start],idim);
+	for(amc_int i = start+1; i < end; i++)
+		for(int idim = 0; idim < ndim; idim++)
+		{
+			amc_real c = pts->get(perm[i],idim);
+			if(c < nd.bmin[idim]) nd.bmin[idim] = c;
+			if(c > nd.bmax[idim]) nd.bmax[idim] = c;
+		}
+
+	if(end-start > leafsize)
+	{
+		// split at the median along the direction of largest extent
+		int sdim = 0;
+		for(int idim = 1; idim < ndim; idim++)
+			if(nd.bmax[idim]-nd.bmin[idim] > nd.bmax[sdim]-nd.bmin[sdim]) sdim = idim;
+
+		amc_int mid = (start+end)/2;
+		const amat::Matrix<amc_real>* p = pts;
+		std::nth_element(perm.begin()+start, perm.begin()+mid, perm.begin()+end,
+				[p,sdim](const amc_int a, const amc_int b) { return p->get(a,sdim) < p->get(b,sdim); });
+
+		nd.left = build(start, mid);
+		nd.right = build(mid, end);
+	}
+
+	nodes[inode] = nd;
+	return inode;
+}
+
+amc_int KDTree::radiusSearch(const amc_real* const x, const amc_real radius, std::vector<amc_int>& indices, std::vector<amc_real>& dists) const
+{
+	if(nodes.empty()) return 0;
+
+	amc_int nfound = 0;
+	const amc_real r2 = radius*radius;
+	int stk[128];			// stack of nodes to visit; the tree is balanced, so its depth is about log2(npoin/leafsize)
+	int top = 0;
+	stk[top++] = 0;
+
+	while(top > 0)
+	{
+		const Node& nd = nodes[stk[--top]];
+
+		// squared distance from x to the bounding box of the node
+		amc_real bd = 0;
+		for(int idim = 0; idim < ndim; idim++)
+		{
+			if(x[idim] < nd.bmin[idim]) bd += (nd.bmin[idim]-x[idim])*(nd.bmin[idim]-x[idim]);
+			else if(x[idim] > nd.bmax[idim]) bd += (x[idim]-nd.bmax[idim])*(x[idim]-nd.bmax[idim]);
+		}
+		if(bd >= r2) continue;
+
+		if(nd.left < 0)
+		{
+			for(amc_int i = nd.start; i < nd.end; i++)
+			{
+				amc_real d = 0;
+				for(int idim = 0; idim < ndim; idim++)
+					d += (x[idim]-pts->get(perm[i],idim))*(x[idim]-pts->get(perm[i],idim));
+				if(d < r2)
+				{
+					indices.push_back(perm[i]);
+					dists.push_back(sqrt(d));
+					nfound++;
+				}
+			}
+		}
+		else
+		{
+			stk[top++] = nd.right;
+			stk[top++] = nd.left;
+		}
+	}
+	return nfound;
+}
+
+}
@@ -0,0 +1,82 @@
+/** \file akdtree.hpp
+ * \brief A k-d tree for fixed-radius neighbour searches in point clouds.
+ * \author Aditya Kashi
+ */
+
+#ifndef __AKDTREE_H
+
+#ifndef __AMATRIX_H
+#include <amatrix.hpp>
+#endif
+
+#ifndef _GLIBCXX_VECTOR
+#include <vector>
+#endif
+
+#define __AKDTREE_H 1
+
+#define KDTREE_MAX_DIM 3
+
+namespace amc {
+
+/// Balanced k-d tree over a set of points in 1, 2 or 3 dimensions, used for finding all points within some radius of a query point
+/** The tree stores a pointer to the list of points, not a copy; so the points must not be modified or de-allocated while the tree is in use.
+ * If the points move, the tree must be re-built by calling [setup](@ref setup) again.
+ * Each node owns a contiguous range of [perm](@ref perm), and stores the bounding box of the points in that range.
+ */
+class KDTree
+{
+public:
+	/// A node of the k-d tree
+	struct Node
+	{
+		amc_int start;					///< index into perm of the first point of this node
+		amc_int end;					///< one past the index into perm of the last point of this node
+		int left;						///< index of left child in nodes; -1 if this is a leaf
+		int right;						///< index of right child in nodes; -1 if this is a leaf
+		amc_real bmin[KDTREE_MAX_DIM];	///< lower corner of bounding box
+		amc_real bmax[KDTREE_MAX_DIM];	///< upper corner of bounding box
+	};
+
+private:
+	const amat::Matrix<amc_real>* pts;	///< list of points, npoin x ndim
+	int ndim;
+	amc_int npoin;
+	int leafsize;						///< maximum number of points in a leaf
+	std::vector<amc_int> perm;			///< indices of points, permuted such that each node has a contiguous range
+	std::vector<Node> nodes;			///< nodes of the tree; the root is nodes[0]
+
+	/// Recursively builds the sub-tree containing points perm[start] to perm[end-1], and returns the index of its root node
+	int build(const amc_int start, const amc_int end);
+
+public:
+	KDTree();
+
+	/// Builds the tree
+	/** \param[in] points is the npoin x ndim list of points
+	 * \param[in] leaf_size is the maximum number of points to hold in a leaf node
+	 */
+	KDTree(const amat::Matrix<amc_real>* const points, const int leaf_size = 16);
+
+	/// Builds (or re-builds) the tree
+	void setup(const amat::Matrix<amc_real>* const points, const int leaf_size = 16);
+
+	/// Finds all points whose distance from x is strictly less than radius
+	/** The indices of the points found and their distances from x are appended to indices and dists respectively.
+	 * \return the number of points found
+	 */
+	amc_int radiusSearch(const amc_real* const x, const amc_real radius, std::vector<amc_int>& indices, std::vector<amc_real>& dists) const;
+
+	amc_int gnpoin() const { return npoin; }
+	int gndim() const { return ndim; }
+
+	/// Number of nodes in the tree; children always have larger indices than their parent
+	int gnnodes() const { return nodes.size(); }
+	const Node& gnode(const int inode) const { return nodes[inode]; }
+
+	/// Returns the index of the point at position i in the tree's ordering of points
+	amc_int gperm(const amc_int i) const { return perm[i]; }
+};
+
+}
+#endif
@@ -272,6 +272,132 @@ void gausselim(Matrix<double>& A, Matrix<double>& b, Matrix<double>& x)
 	}
 }
 
+bool LUfactor(Matrix<amc_real>& A, Matrix<int>& p)
+{
+	int N = A.rows(), i, j, k;
+	if(A.cols() != N) { std::cout << "LUfactor: ! Matrix is not square!" << std::endl; return false; }
+	p.setup(N,1);
+	for(i = 0; i < N; i++)
+		p(i) = i;
+
+	for(k = 0; k < N; k++)
+	{
+		// find pivot
+		amc_real max = dabs(A(k,k));
+		int maxr = k;
+		for(i = k+1; i < N; i++)
+			if(dabs(A(i,k)) > max)
+			{
+				max = dabs(A(i,k));
+				maxr = i;
+			}
+		if(max <= ZERO_TOL) { std::cout << "LUfactor: ! Pivot not found at row " << k << "!" << std::endl; return false; }
+
+		if(maxr != k)
+		{
+			for(j = 0; j < N; j++)
+			{
+				amc_real temp = A(k,j);
+				A(k,j) = A(maxr,j);
+				A(maxr,j) = temp;
+			}
+			int tp = p(k); p(k) = p(maxr); p(maxr) = tp;
+		}
+
+		const amc_real piv = A(k,k);
+		#pragma omp parallel for default(none) private(i,j) shared(A,N,k,piv)
+		for(i = k+1; i < N; i++)
+		{
+			amc_real ff = A(i,k)/piv;
+			A(i,k) = ff;
+			for(j = k+1; j < N; j++)
+				A(i,j) -= ff*A(k,j);
+		}
+	}
+	return true;
+}
+
+void LUsolve(const Matrix<amc_real>& LU, const Matrix<int>& p, const Matrix<amc_real>& b, Matrix<amc_real>& x)
+{
+	int N = LU.rows(), nrhs = b.cols(), i, k, l;
+	if(b.rows() != N) { std::cout << "LUsolve: ! Invalid dimensions of LU and b!" << std::endl; return; }
+	x.setup(N,nrhs);
+
+	// forward substitution with unit lower triangle, on the permuted RHS
+	for(i = 0; i < N; i++)
+	{
+		for(l = 0; l < nrhs; l++)
+			x(i,l) = b.get(p.get(i),l);
+		for(k = 0; k < i; k++)
+			for(l = 0; l < nrhs; l++)
+				x(i,l) -= LU.get(i,k)*x(k,l);
+	}
+	// back substitution
+	for(i = N-1; i >= 0; i--)
+	{
+		for(k = i+1; k < N; k++)
+			for(l = 0; l < nrhs; l++)
+				x(i,l) -= LU.get(i,k)*x(k,l);
+		for(l = 0; l < nrhs; l++)
+			x(i,l) /= LU.get(i,i);
+	}
+}
+
+bool cholfactor(Matrix<amc_real>& A)
+{
+	int N = A.rows(), i, j, k;
+	if(A.cols() != N) { std::cout << "cholfactor: ! Matrix is not square!" << std::endl; return false; }
+
+	for(j = 0; j < N; j++)
+	{
+		amc_real sum = A(j,j);
+		for(k = 0; k < j; k++)
+			sum -= A(j,k)*A(j,k);
+		if(sum <= 0) { std::cout << "cholfactor: ! Matrix is not positive definite; failed at row " << j << "!" << std::endl; return false; }
+		const amc_real ljj = sqrt(sum);
+		A(j,j) = ljj;
+
+		// rows of L are contiguous in memory, so the inner products below are unit-stride
+		#pragma omp parallel for default(none) private(i,k) shared(A,N,j,ljj)
+		for(i = j+1; i < N; i++)
+		{
+			amc_real s = A(i,j);
+			for(k = 0; k < j; k++)
+				s -= A(i,k)*A(j,k);
+			A(i,j) = s/ljj;
+		}
+	}
+	return true;
+}
+
+void cholsolve(const Matrix<amc_real>& L, const Matrix<amc_real>& b, Matrix<amc_real>& x)
+{
+	int N = L.rows(), nrhs = b.cols(), i, k, l;
+	if(b.rows() != N) { std::cout << "cholsolve: ! Invalid dimensions of L and b!" << std::endl; return; }
+	x.setup(N,nrhs);
+
+	// solve L y = b
+	for(i = 0; i < N; i++)
+	{
+		for(l = 0; l < nrhs; l++)
+			x(i,l) = b.get(i,l);
+		for(k = 0; k < i; k++)
+			for(l = 0; l < nrhs; l++)
+				x(i,l) -= L.get(i,k)*x(k,l);
+		for(l = 0; l < nrhs; l++)
+			x(i,l) /= L.get(i,i);
+	}
+	// solve L^T x = y
+	for(i = N-1; i >= 0; i--)
+	{
+		for(l = 0; l < nrhs; l++)
+			x(i,l) /= L.get(i,i);
+		for(k = 0; k < i; k++)
+			for(l = 0; l < nrhs; l++)
+				x(k,l) -= L.get(i,k)*x(i,l);
+	}
+}
+
 #ifdef EIGEN_LIBRARY
 Matrix<double> gausselim(const SpMatrix& A, const Matrix<amc_real>& b)
 {
@@ -744,35 +870,34 @@ Matrix<double> sparseSOR(SpMatrix* A, Matrix<double> b, Matrix<double> xold, dou
  * No preconditioning is used.
  * NOTE: The parallel version is actually slower, due to some reason.
  */
-Matrix<double> sparseCG(const SpMatrix* A, Matrix<double> b, Matrix<double> xold, double tol, int maxiter)
+Matrix<double> sparseCG(const SparseMatrix<amc_real>* A, const Matrix<double>& b, const Matrix<double>& xold, double tol, int maxiter)
 {
 	std::cout << "sparseCG(): Solving " << A->rows() << "x" << A->cols() << " system by conjugate gradient method with no preconditioner\n";
 	if(A->rows() != b.rows() || A->rows() != xold.rows()) std::cout << "sparseCG(): ! Mismatch in number of rows!!" << std::endl;
 
-	Matrix<double> x(A->rows(),1);		// solution vector
-	Matrix<double> rold(A->rows(),1);		// initial residual = b - A*xold
+	// all work vectors are allocated here; the iterations update them in place
+	Matrix<double> x(xold);					// solution vector
 	Matrix<double> r(A->rows(),1);			// residual = b - A*x
 	Matrix<double> p(A->rows(),1);
-	Matrix<double> pold(A->rows(),1);
 	Matrix<double> temp(A->rows(),1);
-	Matrix<double> diff(A->rows(),1);
-	double temp1, temp2;
+	double rr, rrnew, pap;
 	double theta;
 	double beta;
 	double error = 1.0;
-	double initres;
 	double normalizer = b.l2norm();
 
-	A->multiply(xold, &temp);		// temp := A*xold
-	rold = b - temp;
-	error  = rold.l2norm();		// initial residue
+	A->multiply(x, &temp);		// temp := A*xold
+	r = b;
+	r -= temp;
+	error  = r.l2norm();		// initial residue
 	if(error < tol)
 	{
 		std::cout << "sparseCG(): Initial residual is very small. Nothing to do." << std::endl;
-		return xold;
+		return x;
 	}
 
-	pold = rold;
+	p = r;
+	rr = r.dot_product(r);
 
 	int steps = 0;
 
@@ -781,38 +906,29 @@ Matrix<double> sparseCG(const SpMatrix* A, Matrix<double> b, Matrix<double> xold
 	{
 		if(steps % 10 == 0 || steps == 1)
 			std::cout << "sparseCG(): Iteration " << steps << ", relative residual = " << error/normalizer << std::endl;
-		int i;
-
-		temp1 = rold.dot_product(rold);
 
-		A->multiply(pold, &temp);
+		A->multiply(p, &temp);
 
 		// p^T A p
-		temp2 = pold.dot_product(temp);
+		pap = p.dot_product(temp);
 		
-		if(temp2 <= ZERO_TOL) { 
-			std::cout << "sparseCG: Matrix A may not be positive-definite!! temp2 is " << temp2 << "\n";
-			std::cout << "sparseCG: Magnitude of pold in this iteration is " << pold.l2norm() << std::endl;
+		if(pap <= ZERO_TOL) { 
+			std::cout << "sparseCG: Matrix A may not be positive-definite!! p^T A p is " << pap << "\n";
+			std::cout << "sparseCG: Magnitude of p in this iteration is " << p.l2norm() << std::endl;
 		}
-		theta = temp1/temp2;
+		theta = rr/pap;
 
-		//#pragma omp parallel for default(none) private(i) shared(x,r,xold,rold,pold,temp,theta)
-		for(i = 0; i < x.rows(); i++)
-		{
-			x(i) = xold.get(i) + pold.get(i)*theta;
-			rold(i) = rold.get(i) - temp.get(i)*theta;
-		}
+		x.axpy(theta, p);
+		r.axpy(-theta, temp);
 
-		beta = rold.dot_product(rold) / temp1;
-		
-		for(i = 0; i < x.rows(); i++)
-			pold(i) = rold.get(i) + pold.get(i)*beta;
+		rrnew = r.dot_product(r);
+		beta = rrnew / rr;
+		rr = rrnew;
 
-		//calculate ||b - A*x||. 'error' is a misnomer - it's the residual norm.
-		error = rold.l2norm();
+		p.aypx(beta, r);
 
-		// set old variables
-		xold = x;
+		//calculate ||b - A*x||. 'error' is a misnomer - it's the residual norm.
+		error = sqrt(rr);
 
 		if(steps > maxiter)
 		{
@@ -826,53 +942,117 @@ Matrix<double> sparseCG(const SpMatrix* A, Matrix<double> b, Matrix<double> xold
 	return x;
 }
 
+Matrix<amc_real> matfreeCG(const LinearOperator* A, const Matrix<amc_real>& b, const Matrix<amc_real>& xold, double tol, int maxiter)
+{
+	const amc_int n = A->rows();
+	std::cout << "matfreeCG(): Solving " << n << "x" << n << " matrix-free system by conjugate gradient method with no preconditioner\n";
+	if(n != b.rows() || n != xold.rows()) std::cout << "matfreeCG(): ! Mismatch in number of rows!!" << std::endl;
+
+	Matrix<amc_real> x(xold);
+	Matrix<amc_real> r(n,1);			// residual = b - A*x
+	Matrix<amc_real> p(n,1);
+	Matrix<amc_real> temp(n,1);
+	amc_real rr, pap, theta, beta;
+	amc_real normalizer = b.l2norm();
+	if(normalizer < ZERO_TOL) normalizer = 1.0;
+
+	A->apply(x, temp);
+	r = b;
+	r -= temp;
+	amc_real error = r.l2norm();
+	if(error < tol)
+	{
+		std::cout << "matfreeCG(): Initial residual is very small. Nothing to do." << std::endl;
+		return x;
+	}
+
+	p = r;
+	rr = r.dot_product(r);
+	int steps = 0;
+
+	do
+	{
+		if(steps % 10 == 0 || steps == 1)
+			std::cout << "matfreeCG(): Iteration " << steps << ", relative residual = " << error/normalizer << std::endl;
+
+		A->apply(p, temp);
+		pap = p.dot_product(temp);
+		if(pap <= 0)
+			std::cout << "matfreeCG: Operator A may not be positive-definite!! p^T A p is " << pap << std::endl;
+		theta = rr/pap;
+
+		x.axpy(theta, p);
+		r.axpy(-theta, temp);
+
+		beta = 1.0/rr;
+		rr = r.dot_product(r);
+		beta *= rr;
+
+		p.aypx(beta, r);
+
+		error = sqrt(rr);
+
+		if(steps > maxiter)
+		{
+			std::cout << "! matfreeCG(): Max iterations reached!\n";
+			break;
+		}
+		steps++;
+	} while(error/normalizer > tol);
+
+	std::cout << "matfreeCG(): Done. Number of iterations: " << steps << "; final residual " << error/normalizer << ".\n";
+	return x;
+}
+
 /* Calculates solution of Ax=b where A is a SPD matrix in sparse format.
  * The preconditioner is a diagonal matrix.
  * NOTE: The parallel version is actually slower, due to some reason.
  */
-Matrix<double> sparseCG_d(const SpMatrix* A, Matrix<double> b, Matrix<double> xold, double tol, int maxiter)
+Matrix<double> sparseCG_d(const SparseMatrix<amc_real>* A, const Matrix<double>& b, const Matrix<double>& xold, double tol, int maxiter,
+		const Preconditioner* precon)
 {
-	std::cout << "sparseCG_d(): Solving " << A->rows() << "x" << A->cols() << " system by conjugate gradient method with diagonal preconditioner\n";
+	std::cout << "sparseCG_d(): Solving " << A->rows() << "x" << A->cols() << " system by conjugate gradient method with "
+		<< (precon ? "the given" : "diagonal") << " preconditioner\n";
 	if(A->rows() != b.rows() || A->rows() != xold.rows()) std::cout << "sparseCG_d(): ! Mismatch in number of rows!!" << std::endl;
 
-	Matrix<double> x(A->rows(),1);		// solution vector
+	// all work vectors are allocated here; the iterations update them in place
+	Matrix<double> x(xold);					// solution vector
 	Matrix<double> M(A->rows(), 1);		// diagonal preconditioner, or soon, inverse of preconditioner
-	Matrix<double> rold(A->rows(),1);		// initial residual = b - A*xold
 	Matrix<double> r(A->rows(),1);			// residual = b - A*x
-	Matrix<double> z(A->rows(),1);
-	Matrix<double> zold(A->rows(),1);
+	Matrix<double> z(A->rows(),1);			// preconditioned residual
 	Matrix<double> p(A->rows(),1);
-	Matrix<double> pold(A->rows(),1);
 	Matrix<double> temp(A->rows(),1);
-	Matrix<double> diff(A->rows(),1);
-	double temp1, temp2;
+	double rz, pap;
 	double theta;
 	double beta;
 	double error = 1.0;
-	double initres;
 	double normalizer = b.l2norm();
 
-	M.zeros();
-	A->get_diagonal(&M);
-	for(int i = 0; i < A->rows(); i++)
+	if(!precon)
 	{
-		M(i) = 1.0/M(i);
+		M.zeros();
+		A->get_diagonal(&M);
+		for(int i = 0; i < A->rows(); i++)
+		{
+			M(i) = 1.0/M(i);
+		}
 	}
 
-	A->multiply(xold, &temp);		// temp := A*xold
-	rold = b - temp;
-	error  = rold.l2norm();		// initial residue
+	A->multiply(x, &temp);		// temp := A*xold
+	r = b;
+	r -= temp;
+	error  = r.l2norm();		// initial residue
 	if(error < tol)
 	{
 		std::cout << "sparseCG_d(): Initial residual is very small. Nothing to do." << std::endl;
-		return xold;
+		return x;
 	}
 
-	for(int i = 0; i < A->rows(); i++)
-		//zold(i) = M(i)*rold(i);				// zold = M*rold
-		zold(i) = rold(i);
-
-	pold = zold;
+	if(precon)
+		precon->apply(r, z);
+	else
+		z = r;
+	p = z;
 
 	int steps = 0;
 
@@ -883,52 +1063,37 @@ Matrix<double> sparseCG_d(const SpMatrix* A, Matrix<double> b, Matrix<double> xo
 			std::cout << "sparseCG_d(): Iteration " << steps << ", relative residual = " << error/normalizer << std::endl;
 		int i;
 
-		temp1 = rold.dot_product(zold);
+		rz = r.dot_product(z);
 
-		A->multiply(pold, &temp);
-		//temp.mprint();
+		A->multiply(p, &temp);
 
-		temp2 = pold.dot_product(temp);
-		if(temp2 <= ZERO_TOL) { 
-			std::cout << "sparseCG_d: Matrix A may not be positive-definite!! temp2 is " << temp2 << "\n";
-			std::cout << "sparseCG_D: Magnitude of pold in this iteration is " << pold.l2norm() << std::endl;
+		pap = p.dot_product(temp);
+		if(pap <= ZERO_TOL) { 
+			std::cout << "sparseCG_d: Matrix A may not be positive-definite!! p^T A p is " << pap << "\n";
+			std::cout << "sparseCG_D: Magnitude of p in this iteration is " << p.l2norm() << std::endl;
 		}
-		theta = temp1/temp2;
+		theta = rz/pap;
 
-		//#pragma omp parallel for default(none) private(i) shared(x,r,xold,rold,pold,temp,theta)
-		for(i = 0; i < x.rows(); i++)
-		{
-			x(i) = xold.get(i) + pold.get(i)*theta;
-			rold(i) = rold.get(i) - temp.get(i)*theta;
-		}
+		x.axpy(theta, p);
+		r.axpy(-theta, temp);
 
-		if(steps > 2)
+		// the diagonal preconditioner is only applied after the first few iterations
+		if(precon)
+			precon->apply(r, z);
+		else if(steps > 2)
 		{
-			//#pragma omp parallel for default(none) private(i) shared(zold,M,rold,A)
 			for(i = 0; i < A->rows(); i++)
-				zold(i) = M(i)*rold(i);
+				z(i) = M(i)*r(i);
 		}
 		else
-		{
-			//#pragma omp parallel for default(none) private(i) shared(zold,M,rold,A)
-			for(i = 0; i < A->rows(); i++)
-				zold(i) = rold(i);
-		}
+			z = r;
 
-		beta = rold.dot_product(zold) / temp1;
+		beta = r.dot_product(z) / rz;
 
-		//#pragma omp parallel for default(none) private(i) shared(zold,x,p,pold,beta)
-		for(i = 0; i < x.rows(); i++)
-			pold(i) = zold.get(i) + pold.get(i)*beta;
+		p.aypx(beta, z);
 
 		//calculate ||b - A*x||. 'error' is a misnomer - it's the residual norm.
-		error = rold.l2norm();
-
-		// set old variables
-		xold = x;
-		/*rold = r;
-		zold = z;
-		pold = p;*/
+		error = r.l2norm();
 
 		if(steps > maxiter)
 		{
@@ -942,6 +1107,77 @@ Matrix<double> sparseCG_d(const SpMatrix* A, Matrix<double> b, Matrix<double> xo
 	return x;
 }
 
+/* Calculates solution of Ax=b where A is a SPD matrix stored as its upper triangle.
+ * The preconditioner is one SSOR sweep starting from zero.
+ */
+Matrix<double> sparseCG_ssor(const MatrixSymCSR<amc_real>* A, const Matrix<double>& b, const Matrix<double>& xold, double tol, int maxiter, double omega)
+{
+	std::cout << "sparseCG_ssor(): Solving " << A->rows() << "x" << A->cols() << " system by conjugate gradient method with SSOR preconditioner\n";
+	if(A->rows() != b.rows() || A->rows() != xold.rows()) std::cout << "sparseCG_ssor(): ! Mismatch in number of rows!!" << std::endl;
+
+	// all work vectors are allocated here; the iterations update them in place
+	Matrix<double> x(xold);					// solution vector
+	Matrix<double> r(A->rows(),1);			// residual = b - A*x
+	Matrix<double> z(A->rows(),1);			// preconditioned residual
+	Matrix<double> p(A->rows(),1);
+	Matrix<double> temp(A->rows(),1);
+	double rz, rznew, pap;
+	double theta;
+	double error = 1.0;
+	double normalizer = b.l2norm();
+
+	A->multiply(x, &temp);		// temp := A*xold
+	r = b;
+	r -= temp;
+	error  = r.l2norm();		// initial residue
+	if(error < tol)
+	{
+		std::cout << "sparseCG_ssor(): Initial residual is very small. Nothing to do." << std::endl;
+		return x;
+	}
+
+	z.zeros();
+	A->ssor(r, z, omega);
+	p = z;
+	rz = r.dot_product(z);
+
+	int steps = 0;
+	do
+	{
+		if(steps % 10 == 0 || steps == 1)
+			std::cout << "sparseCG_ssor(): Iteration " << steps << ", relative residual = " << error/normalizer << std::endl;
+
+		A->multiply(p, &temp);
+
+		pap = p.dot_product(temp);
+		if(pap <= ZERO_TOL)
+			std::cout << "sparseCG_ssor: Matrix A may not be positive-definite!! p^T A p is " << pap << "\n";
+		theta = rz/pap;
+
+		x.axpy(theta, p);
+		r.axpy(-theta, temp);
+
+		z.zeros();
+		A->ssor(r, z, omega);
+		rznew = r.dot_product(z);
+
+		p.aypx(rznew/rz, z);
+		rz = rznew;
+
+		error = r.l2norm();
+
+		if(steps > maxiter)
+		{
+			std::cout << "! sparseCG_ssor(): Max iterations reached!\n";
+			break;
+		}
+		steps++;
+	} while(error/normalizer > tol);
+
+	std::cout << "sparseCG_ssor(): Done. Number of iterations: " << steps << "; final residual " << error/normalizer << ".\n";
+	return x;
+}
+
 // Does not currently have a prototype in the header file
 void precon_jacobi(SpMatrix* A, const Matrix<double>& r, Matrix<double>& z)
 // Multiplies r by the Jacobi preconditioner matrix of A, and stores the result in z
@@ -1106,7 +1342,8 @@ Matrix<double> sparsePCG(SpMatrix* A, Matrix<double> b, Matrix<double> xold, std
 /** Jacobi preconditioning is used.
  * NOTE: The initial guess vector xold is modified by this function.
  */
-Matrix<double> sparse_bicgstab(const SpMatrix* A, const Matrix<double>& b, Matrix<double>& xold, double tol, int maxiter)
+Matrix<double> sparse_bicgstab(const SparseMatrix<amc_real>* A, const Matrix<double>& b, Matrix<double>& xold, double tol, int maxiter,
+		const Preconditioner* precon)
 {
 	Matrix<double> x(b.rows(), 1);
 	// checks
@@ -1131,19 +1368,24 @@ Matrix<double> sparse_bicgstab(const SpMatrix* A, const Matrix<double>& b, Matri
 	double rhoold, rho, wold, w, alpha, beta;
 	double resnormrel, resnorm, normalizer;
 
-	M.zeros();
-	A->get_diagonal(&M);
-	for(int i = 0; i < A->rows(); i++)
+	if(!precon)
 	{
-		M(i) = 1.0/M(i);
+		M.zeros();
+		A->get_diagonal(&M);
+		for(int i = 0; i < A->rows(); i++)
+		{
+			M(i) = 1.0/M(i);
+		}
 	}
-	// M now contains K^(-1), where K is the preconditioning matrix
+	// M now contains K^(-1), where K is the preconditioning matrix, unless precon is given
 	A->multiply(xold, &t);		// t = A*xold, initially (t is only a temp variable here)
-	rold = b - t;
+	rold = b;
+	rold -= t;
 	resnorm = rold.l2norm();
 	
 	if(resnorm < A_SMALL_NUMBER) {
 		std::cout << "sparse_bicgstab(): Initial residual is very small. Exiting." << std::endl;
+		x = xold;
 		return x;
 	}
 
@@ -1171,26 +1413,33 @@ Matrix<double> sparse_bicgstab(const SpMatrix* A, const Matrix<double>& b, Matri
 		beta = rho*alpha/(rhoold*wold);
 
 		for(i = 0; i < b.rows(); i++)
-		{
 			p(i) = rold.get(i) + beta * (pold.get(i) - wold*vold.get(i));
-			y(i) = M.get(i)*p.get(i);
-		}
+		if(precon)
+			precon->apply(p, y);
+		else
+			for(i = 0; i < b.rows(); i++)
+				y(i) = M.get(i)*p.get(i);
 		
 		A->multiply(y, &v);			// v = A*y
 		alpha = rho / rhat.dot_product(v);
 
 		for(i = 0; i < b.rows(); i++)
-		{
 			s(i) = rold.get(i) - alpha*v.get(i);
-			z(i) = M.get(i)*s.get(i);
-		}
+		if(precon)
+			precon->apply(s, z);
+		else
+			for(i = 0; i < b.rows(); i++)
+				z(i) = M.get(i)*s.get(i);
 
 		A->multiply(z, &t);			// t = A*K^-1*s
 
 		//--------------- modification begins here (this is for purely left-preconditioning)
 
-		for(i = 0; i < b.rows(); i++)
-			u(i) = M.get(i)*t.get(i);		// u = K^(-1)*A*K^(-1)*s = K^(-1)*t
+		if(precon)
+			precon->apply(t, u);
+		else
+			for(i = 0; i < b.rows(); i++)
+				u(i) = M.get(i)*t.get(i);		// u = K^(-1)*A*K^(-1)*s = K^(-1)*t
 
 		//w = t.dot_product(s)/t.dot_product(t);
 		w = u.dot_product(z) / u.dot_product(u);
@@ -31,6 +31,33 @@
 namespace amat
 {
 
+/// Abstract square linear operator, for iterative solvers that only need products of a matrix with vectors
+/** This lets a solver work on a matrix that is never formed explicitly, such as one applied by a hierarchical (tree-code) summation.
+ */
+class LinearOperator
+{
+public:
+	virtual ~LinearOperator() { }
+
+	/// Number of rows (and columns) of the operator
+	virtual amc_int rows() const = 0;
+
+	/// Computes y := A x, where x and y are vectors (or several vectors side by side) with [rows](@ref rows) rows
+	virtual void apply(const Matrix<amc_real>& x, Matrix<amc_real>& y) const = 0;
+};
+
+/// Abstract preconditioner for the Krylov solvers
+/** It applies the inverse of some approximation M of the system matrix to a vector.
+ */
+class Preconditioner
+{
+public:
+	virtual ~Preconditioner() { }
+
+	/// Computes z := M^(-1) r for column vectors r and z
+	virtual void apply(const Matrix<amc_real>& r, Matrix<amc_real>& z) const = 0;
+};
+
 /// Computes solution of Ax = b by Gaussian elimination. Reasonably well-tested. ("DLU")
 /** A is mxm, b is mxk where k is the number of systems to be solved with the same LHS.
 */
@@ -58,6 +85,29 @@ Matrix<double> cholesky(Matrix<double> A, Matrix<double> b);
  */
 void chol(Matrix<amc_real>& A, Matrix<amc_real>& b);
 
+/// Computes the LU factorization of a dense square matrix with partial pivoting, in place ("DLU")
+/** On output, the strict lower triangle of A contains L (whose diagonal is all ones) and the upper triangle contains U.
+ * \param[out] p is an N x 1 list that stores, for each row of the factored matrix, the row of the original matrix it came from.
+ * \return false if a zero pivot is encountered
+ */
+bool LUfactor(Matrix<amc_real>& A, Matrix<int>& p);
+
+/// Solves Ax = b given the LU factorization of A computed by [LUfactor](@ref LUfactor)
+/** b can have any number of columns; all of them are solved for in the same sweep through the factors.
+ */
+void LUsolve(const Matrix<amc_real>& LU, const Matrix<int>& p, const Matrix<amc_real>& b, Matrix<amc_real>& x);
+
+/// Computes the Cholesky factor L of a dense SPD matrix, in place ("DCHOL")
+/** On output, the lower triangle of A contains L such that A = L L^T. The strict upper triangle is not referenced.
+ * \return false if the matrix is found to not be positive definite
+ */
+bool cholfactor(Matrix<amc_real>& A);
+
+/// Solves Ax = b given the Cholesky factor of A computed by [cholfactor](@ref cholfactor)
+/** b can have any number of columns.
+ */
+void cholsolve(const Matrix<amc_real>& L, const Matrix<amc_real>& b, Matrix<amc_real>& x);
+
 
 /// Solves Ax = b for dense A by point-Jacobi iterations
 /** \param check should be set to 'y' for testing diagonal dominance before solving.
@@ -76,19 +126,31 @@ Matrix<double> sparsegaussseidel(SpMatrix* A, Matrix<double> b, Matrix<double> x
 Matrix<double> sparseSOR(SpMatrix* A, Matrix<double> b, Matrix<double> xold, double tol, int maxiter, double w=1.25, char check='n');
 
 /// Solves the linear system Ax=b by unpreconditioned CG ("CG")
-Matrix<amc_real> sparseCG(const SpMatrix* A, Matrix<double> b, Matrix<double> xold, double tol, int maxiter);
+Matrix<amc_real> sparseCG(const SparseMatrix<amc_real>* A, const Matrix<double>& b, const Matrix<double>& xold, double tol, int maxiter);
+
+/// Solves Ax=b by unpreconditioned CG, where A is an SPD matrix available only through its action on vectors ("TREECG" for RBF mesh movement)
+Matrix<amc_real> matfreeCG(const LinearOperator* A, const Matrix<amc_real>& b, const Matrix<amc_real>& xold, double tol, int maxiter);
 
 /// Calculates solution of Ax=b where A is a SPD matrix in sparse format. This function is well-tested. ("PCG")
-/** The preconditioner is a diagonal matrix.
+/** The default preconditioner is a diagonal matrix, applied from the fourth iteration on.
+ * If a (symmetric) preconditioner precon is given, it is used instead, from the first iteration ("PCG-IC0").
  * NOTE: The parallel version is actually slower, due to some reason.
  */
-Matrix<double> sparseCG_d(const SpMatrix* A, Matrix<double> b, Matrix<double> xold, double tol, int maxiter);
+Matrix<double> sparseCG_d(const SparseMatrix<amc_real>* A, const Matrix<double>& b, const Matrix<double>& xold, double tol, int maxiter,
+		const Preconditioner* precon = nullptr);
+
+/// Solves Ax=b for a SPD matrix A stored as its upper triangle, by CG preconditioned with one SSOR sweep ("SSORCG")
+/** \param omega is the relaxation factor, which must be in (0,2); omega = 1 gives the symmetric Gauss-Seidel preconditioner.
+ */
+Matrix<double> sparseCG_ssor(const MatrixSymCSR<amc_real>* A, const Matrix<double>& b, const Matrix<double>& xold, double tol, int maxiter, double omega=1.0);
 
 /**	Solves general linear system Ax=b using stabilized biconjugate gradient method of van der Vorst. ("BICGSTAB")
  * 
+ * The default preconditioner is Jacobi; if precon is given, it is used instead ("BICGSTAB-ILU0", "BICGSTAB-ILUT").
  * NOTE: The initial guess vector xold is modified by this function.
  */
-Matrix<double> sparse_bicgstab(const SpMatrix* A, const Matrix<double>& b, Matrix<double>& xold, double tol, int maxiter);
+Matrix<double> sparse_bicgstab(const SparseMatrix<amc_real>* A, const Matrix<double>& b, Matrix<double>& xold, double tol, int maxiter,
+		const Preconditioner* precon = nullptr);
 
 
 /// solves the least squares problem (finds the minimum point x) \f$ \min(||Ax - b||_2) \f$ by solving the normal equations
@@ -33,6 +33,9 @@
 #ifndef __AMESH2DGENERAL_H
 #include <amesh2d.hpp>
 #endif
+#ifndef __ASPARSEMATRIX_H
+#include <asparsematrix.hpp>
+#endif
 
 #define __ALINELAST_P2_STIFFENED_H 1
 
@@ -51,6 +54,8 @@ class LinElastP2
 	amat::Matrix<double> geoel;		///< holds 2*area of element, and derivatives of barycentric coordinate functions lambdas
 	amat::Matrix<double> geofa;		///< holds normals to and length of boundary faces
 	amat::SpMatrix K;					///< global stiffness matrix
+	amat::CRSAssembler<double> Kasm;	///< assembles the global stiffness matrix; its pattern is computed once per mesh
+	const UMesh2d* patternmesh;			///< the mesh for which the pattern of Kasm was computed
 	amat::Matrix<double> f;			///< global load vector
 	amat::Matrix<double>* stiff;		///< stiffening factor for each element
 
@@ -61,6 +66,7 @@ class LinElastP2
 	double cbig;				///< for Dirichlet BCs
 
 public:
+	LinElastP2() : m(nullptr), patternmesh(nullptr) { }
 
 	/// Sets inputs and computes derivatives of basis functions and face-normals
 	/** \note The computations are only for straight-sided P2 elements!
@@ -245,43 +251,42 @@ public:
 		return K12;
 	}
 
+	/// Assembles the stiffness matrix
+	/** The sparsity pattern is computed only the first time this is called for a mesh; after that,
+	 * the element stiffness matrices are just added into place, in parallel over elements of the same colour.
+	 */
 	void assembleStiffnessMatrix()
 	{
-		amat::SpMatrix K11, K22, K12;
-		K11.setup(m->gnpoin(),m->gnpoin()); K22.setup(m->gnpoin(), m->gnpoin()); K12.setup(m->gnpoin(), m->gnpoin());
-		//K11.zeros(); K22.zeros(); K12.zeros();
-		std::vector<int> ip(m->gnnode());
-		for(int iel = 0; iel < m->gnelem(); iel++)
-		{
-			// get element stiffness matrices
-			amat::Matrix<double> K11e = elementstiffnessK11(iel);
-			amat::Matrix<double> K22e = elementstiffnessK22(iel);
-			amat::Matrix<double> K12e = elementstiffnessK12(iel);
-
-			for(int i = 0; i < m->gnnode(); i++)
-				ip[i] = m->ginpoel(iel,i);
-
-			double temp;
-			for(int i = 0; i < m->gnnode(); i++)
-				for(int j = 0; j < m->gnnode(); j++)
-				{
-					temp = K11.get(ip[i],ip[j]);
-					K11.set(ip[i],ip[j], temp+K11e(i,j));
-					temp = K22.get(ip[i],ip[j]);
-					K22.set(ip[i],ip[j], temp+K22e(i,j));
-					temp = K12.get(ip[i],ip[j]);
-					K12.set(ip[i],ip[j], temp+K12e(i,j));
-				}
+		if(patternmesh != m || Kasm.gnrows() != m->gndim()*m->gnpoin()) {
+			Kasm.symbolic(*m, m->gndim());
+			patternmesh = m;
 		}
-		std::cout << "LinElastP2: assembleStiffnessamat::Matrix(): Assembling final 2N by 2N matrix\n";
-		/*K11.trim();
-		K12.trim();
-		K22.trim();*/
+		Kasm.zeros();
 
-		amat::SpMatrix K21(m->gnpoin(), m->gnpoin());
-		K21 = K12.transpose();
+		for(int icolour = 0; icolour < Kasm.gncolours(); icolour++)
+		{
+			const int start = Kasm.gcolourstart(icolour), end = Kasm.gcolourstart(icolour+1);
+			#pragma omp parallel for default(shared)
+			for(int k = start; k < end; k++)
+			{
+				const int iel = Kasm.gcolourelem(k);
+
+				// get element stiffness matrices
+				amat::Matrix<double> K11e = elementstiffnessK11(iel);
+				amat::Matrix<double> K22e = elementstiffnessK22(iel);
+				amat::Matrix<double> K12e = elementstiffnessK12(iel);
+
+				// the x-displacements are numbered before the y-displacements, and K21 is the transpose of K12
+				Kasm.add_element_block(iel, 0, 0, K11e);
+				Kasm.add_element_block(iel, 0, 1, K12e);
+				Kasm.add_element_block(iel, 1, 0, K12e, true);
+				Kasm.add_element_block(iel, 1, 1, K22e);
+			}
+		}
+		std::cout << "LinElastP2: assembleStiffnessMatrix(): Assembled " << Kasm.gnrows() << " by " << Kasm.gnrows() << " matrix with "
+			<< Kasm.gnnz() << " non-zeros\n";
 
-		K.combine_sparse_matrices(K11,K12,K21,K22);
+		Kasm.get_matrix(K);
 	}
 
 	void assembleLoadVector()
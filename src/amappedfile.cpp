@@ -0,0 +1,77 @@
+#include "amappedfile.hpp"
+
+#ifndef _GLIBCXX_FSTREAM
+#include <fstream>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define AMAPPEDFILE_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace amc {
+
+MappedFile::MappedFile() : mapped(nullptr), mapsize(0), beg(nullptr), fin(nullptr)
+{ }
+
+MappedFile::~MappedFile()
+{
+	release();
+}
+
+void MappedFile::release()
+{
+#ifdef AMAPPEDFILE_MMAP
+	if(mapped)
+		munmap(mapped, mapsize);
+#endif
+	mapped = nullptr;
+	mapsize = 0;
+	std::vector<char>().swap(buffer);
+	beg = fin = nullptr;
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+	release();
+
+#ifdef AMAPPEDFILE_MMAP
+	const int fd = ::open(filename.c_str(), O_RDONLY);
+	if(fd < 0)
+		return false;
+	struct stat st;
+	if(fstat(fd, &st) == 0 && st.st_size > 0) {
+		void* const m = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(m != MAP_FAILED) {
+			mapped = (char*)m;
+			mapsize = (size_t)st.st_size;
+			madvise(m, mapsize, MADV_SEQUENTIAL);
+			beg = mapped;
+			fin = mapped + mapsize;
+		}
+	}
+	close(fd);
+	if(beg)
+		return true;
+#endif
+
+	// could not map the file; read all of it at once instead
+	std::ifstream infile(filename, std::ios::binary | std::ios::ate);
+	if(!infile)
+		return false;
+	const std::streamsize size = infile.tellg();
+	infile.seekg(0);
+	buffer.resize(size > 0 ? (size_t)size : 1);
+	if(size > 0 && !infile.read(&buffer[0], size)) {
+		std::vector<char>().swap(buffer);
+		return false;
+	}
+	beg = buffer.data();
+	fin = beg + (size > 0 ? (size_t)size : 0);
+	return true;
+}
+
+}
@@ -0,0 +1,52 @@
+/** \file amappedfile.hpp
+ * \brief Read-only access to the whole contents of a file as one contiguous buffer.
+ * \author Aditya Kashi
+ */
+
+#ifndef __AMAPPEDFILE_H
+
+#ifndef _GLIBCXX_STRING
+#include <string>
+#endif
+
+#ifndef _GLIBCXX_VECTOR
+#include <vector>
+#endif
+
+#define __AMAPPEDFILE_H 1
+
+namespace amc {
+
+/// A file mapped into memory for reading
+/** On POSIX systems the file is memory-mapped, so that only the pages actually touched are read from disk;
+ * elsewhere, or if mapping fails, the whole file is read into a buffer with one block read.
+ */
+class MappedFile
+{
+	char* mapped;					///< The memory-mapped file, if it could be mapped
+	size_t mapsize;					///< Size of the mapped region
+	std::vector<char> buffer;		///< Contents of the file, if it could not be mapped
+	const char* beg;				///< Start of the file contents
+	const char* fin;				///< One past the end of the file contents
+
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	/// Maps the file; returns false if it could not be opened or read
+	bool open(const std::string& filename);
+
+	/// Unmaps the file, invalidating any pointers into it
+	void release();
+
+	bool isOpen() const { return beg != nullptr; }
+	const char* data() const { return beg; }
+	const char* end() const { return fin; }
+	size_t size() const { return fin-beg; }
+};
+
+}
+#endif
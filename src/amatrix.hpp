@@ -101,6 +101,7 @@ public:
 	Matrix()
 	{
 		nrows = 0; ncols = 0; size = 0;
+		elems = nullptr;
 		isalloc = false;
 	}
 
@@ -136,6 +137,14 @@ public:
 		}
 	}
 
+	/// Move constructor: takes over the storage of other, which is left empty
+	Matrix(Matrix<T>&& other) : nrows(other.nrows), ncols(other.ncols), size(other.size), elems(other.elems), isalloc(other.isalloc)
+	{
+		other.nrows = other.ncols = other.size = 0;
+		other.elems = nullptr;
+		other.isalloc = false;
+	}
+
 	~Matrix()
 	{
 		if(isalloc == true)	
@@ -143,18 +152,20 @@ public:
 		isalloc = false;
 	}
 
+	/// Copy assignment; the existing storage is re-used if it has the right size, so that no allocation takes place
 	Matrix<T>& operator=(const Matrix<T>& rhs)
 	{
-#ifdef DEBUG
 		if(this==&rhs) return *this;		// check for self-assignment
-#endif
+		if(isalloc == false || size != rhs.nrows*rhs.ncols)
+		{
+			if(isalloc == true)
+				delete [] elems;
+			elems = new T[rhs.nrows*rhs.ncols];
+			isalloc = true;
+		}
 		nrows = rhs.nrows;
 		ncols = rhs.ncols;
 		size = nrows*ncols;
-		if(isalloc == true)
-			delete [] elems;
-		elems = new T[nrows*ncols];
-		isalloc = true;
 		for(amc_int i = 0; i < nrows*ncols; i++)
 		{
 			elems[i] = rhs.elems[i];
@@ -162,6 +173,20 @@ public:
 		return *this;
 	}
 
+	/// Move assignment: takes over the storage of rhs, which is left empty
+	Matrix<T>& operator=(Matrix<T>&& rhs)
+	{
+		if(this==&rhs) return *this;
+		if(isalloc == true)
+			delete [] elems;
+		nrows = rhs.nrows; ncols = rhs.ncols; size = rhs.size;
+		elems = rhs.elems; isalloc = rhs.isalloc;
+		rhs.nrows = rhs.ncols = rhs.size = 0;
+		rhs.elems = nullptr;
+		rhs.isalloc = false;
+		return *this;
+	}
+
 	/// Separate setup function in case no-arg constructor has to be used
 	void setup(amc_int nr, amc_int nc)
 	{
@@ -474,7 +499,7 @@ public:
 	}
 
 	/// Multiply a matrix by a scalar. Note: only expressions of type A*3 work, not 3*A
-	Matrix<T> operator*(T num)
+	Matrix<T> operator*(T num) const
 	{
 		Matrix<T> A(nrows,ncols);
 		amc_int i;
@@ -484,8 +509,10 @@ public:
 		return A;
 	}
 
-	/**	The matrix addition and subtraction operators are inefficient! Do not use in long loops. */
-	Matrix<T> operator+(Matrix<T> B) const
+	/**	The matrix addition and subtraction operators allocate a new matrix for the result. In long loops,
+	 * use the compound assignment operators or [axpy](@ref axpy) instead, which work in place.
+	 */
+	Matrix<T> operator+(const Matrix<T>& B) const
 	{
 #ifdef DEBUG
 		if(nrows != B.rows() || ncols != B.cols())
@@ -503,7 +530,7 @@ public:
 		return C;
 	}
 
-	Matrix<T> operator-(Matrix<T> B) const
+	Matrix<T> operator-(const Matrix<T>& B) const
 	{
 #ifdef DEBUG
 		if(nrows != B.rows() || ncols != B.cols())
@@ -520,7 +547,7 @@ public:
 		return C;
 	}
 
-	Matrix<T> operator*(Matrix<T> B)
+	Matrix<T> operator*(const Matrix<T>& B) const
 	{
 		Matrix<amc_real> C(nrows, B.cols());
 		C.zeros();
@@ -540,8 +567,70 @@ public:
 		return C;
 	}
 
+	/// Adds B to this matrix in place
+	Matrix<T>& operator+=(const Matrix<T>& B)
+	{
+#ifdef DEBUG
+		if(nrows != B.rows() || ncols != B.cols()) {
+			std::cout << "! Matrix: Addition cannot be performed due to incompatible sizes\n";
+			return *this;
+		}
+#endif
+		for(amc_int i = 0; i < size; i++)
+			elems[i] += B.elems[i];
+		return *this;
+	}
+
+	/// Subtracts B from this matrix in place
+	Matrix<T>& operator-=(const Matrix<T>& B)
+	{
+#ifdef DEBUG
+		if(nrows != B.rows() || ncols != B.cols()) {
+			std::cout << "! Matrix: Subtraction cannot be performed due to incompatible sizes\n";
+			return *this;
+		}
+#endif
+		for(amc_int i = 0; i < size; i++)
+			elems[i] -= B.elems[i];
+		return *this;
+	}
+
+	/// Multiplies this matrix by a scalar in place
+	Matrix<T>& operator*=(const T num)
+	{
+		scal(num);
+		return *this;
+	}
+
+	/// Scales this matrix by a, in place
+	void scal(const T a)
+	{
+		for(amc_int i = 0; i < size; i++)
+			elems[i] *= a;
+	}
+
+	/// Computes this := this + a*X, in place. X must have the same size as this matrix.
+	void axpy(const T a, const Matrix<T>& X)
+	{
+#ifdef DEBUG
+		if(nrows != X.rows() || ncols != X.cols()) { std::cout << "! Matrix: axpy(): Incompatible sizes!\n"; return; }
+#endif
+		for(amc_int i = 0; i < size; i++)
+			elems[i] += X.elems[i]*a;
+	}
+
+	/// Computes this := X + a*this, in place; this is how search directions are updated in Krylov solvers
+	void aypx(const T a, const Matrix<T>& X)
+	{
+#ifdef DEBUG
+		if(nrows != X.rows() || ncols != X.cols()) { std::cout << "! Matrix: aypx(): Incompatible sizes!\n"; return; }
+#endif
+		for(amc_int i = 0; i < size; i++)
+			elems[i] = X.elems[i] + elems[i]*a;
+	}
+
 	/// Returns sum of products of respective elements of flattened arrays containing matrix elements of this and A
-	T dot_product(const Matrix<T>& A)
+	T dot_product(const Matrix<T>& A) const
 	{
 		T* elemsA = A.elems;
 		#ifdef _OPENMP
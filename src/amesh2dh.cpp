@@ -40,6 +40,7 @@ UMesh2dh::UMesh2dh(const UMesh2dh& other)
 	bfacebp = other.bfacebp;
 	bifmap = other.bifmap;
 	ifbmap = other.ifbmap;
+	bfaceHostCell = other.bfaceHostCell;
 	isBoundaryMaps = other.isBoundaryMaps;
 	//gallfa = other.gallfa;
 	alloc_jacobians = other.alloc_jacobians;
@@ -78,6 +79,7 @@ UMesh2dh& UMesh2dh::operator=(const UMesh2dh& other)
 	bfacebp = other.bfacebp;
 	bifmap = other.bifmap;
 	ifbmap = other.ifbmap;
+	bfaceHostCell = other.bfaceHostCell;
 	isBoundaryMaps = other.isBoundaryMaps;
 	//gallfa = other.gallfa;
 	alloc_jacobians = other.alloc_jacobians;
@@ -239,194 +241,113 @@ void UMesh2dh::readDomn(std::string mfile)
 void UMesh2dh::readGmsh2(std::string mfile, int dimensions)
 {
 	std::cout << "UMesh2d: readGmsh2(): Reading mesh file...\n";
-	int dum; double dummy; std::string dums; char ch;
 	ndim = dimensions;
 
-	std::ifstream infile(mfile);
-	for(int i = 0; i < 4; i++)		//skip 4 lines
-		do
-			ch = infile.get();
-		while(ch != '\n');
+	GmshReader reader;
+	if(!reader.open(mfile)) {
+		std::cout << "! UMesh2d: readGmsh2(): Could not read mesh file " << mfile << std::endl;
+		return;
+	}
 
-	infile >> npoin;
+	npoin = reader.gnpoin();
 	std::cout << "UMesh2d: readGmsh2(): No. of points = " << npoin << std::endl;
-	coords.setup(npoin,ndim);
-
-	// read coords of points
-	for(int i = 0; i < npoin; i++)
-	{
-		infile >> dum;
-		for(int j = 0; j < ndim; j++)
-			infile >> coords(i,j);
-		if(ndim < 3) infile >> dummy;
-	}
-	infile >> dums;		// get 'endnodes'
-	infile >> dums;		// get 'elements'
+	if(!reader.readNodes(coords, ndim))
+		return;
 
-	int width_elms = 25;
-	int nelm, elmtype, nbtags, ntags;
-	/// elmtype is the standard element type in the Gmsh 2 mesh format - of either faces or elements
+	/// elmtype is the standard element type in the Gmsh 2 mesh format - of either faces or elements.
+	/// elmtype is different for all faces and for all elements. However, meshes in which high-order and linear elements are both present are not supported.
+	// The first pass counts faces and elements and finds the number of tags and the maximum number of nodes and faces of an element.
+	int nskipped = 0;
 	ndtag = 0; nbtag = 0;
-	infile >> nelm;
-	amat::Matrix<int > elms(nelm,width_elms);
 	nface = 0; nelem = 0;
-	std::vector<int> nnodes(nelm,0);
-	std::vector<int> nfaels(nelm,0);
-	//std::cout << "UMesh2d: readGmsh2(): Total number of elms is " << nelm << std::endl;
+	maxnnode = 0; maxnfael = 0;
+
+	// number of nodes and faces of the element types in 2D, or 0 for boundary faces and unrecognized types
+	auto elemnnode = [](const int elmtype) {
+		switch(elmtype) {
+			case(2): return 3;		// linear triangles
+			case(3): return 4;		// linear quads
+			case(9): return 6;		// quadratic triangles
+			case(16): return 8;		// quadratic quad (8 nodes)
+			case(10): return 9;		// quadratic quad (9 nodes)
+			default: return 0;
+		}
+	};
+	auto elemnfael = [](const int elmtype) {
+		return (elmtype == 2 || elmtype == 9) ? 3 : 4;
+	};
 
-	for(int i = 0; i < nelm; i++)
+	bool readok = reader.forEachElement([&](const int elmtype, const int ntags, const int* const, const int nnodes, const int* const)
 	{
-		infile >> dum;
-		infile >> elmtype;
-		/// elmtype is different for all faces and for all elements. However, meshes in which high-order and linear elements are both present are not supported.
-		switch(elmtype)
+		if(nnodes != gmsh_element_nnodes(elmtype)) {
+			nskipped++;
+			return;
+		}
+		if(elmtype == 1 || elmtype == 8)
 		{
-			case(1): // linear edge
-				nnofa = 2;
-				infile >> nbtags;
-				if(nbtags > nbtag) nbtag = nbtags;
-				for(int j = 0; j < nbtags; j++)
-					infile >> elms(i,j+nnofa);		// get tags
-				for(int j = 0; j < nnofa; j++)
-					infile >> elms(i,j);			// get node numbers
-				nface++;
-				break;
-			case(8): // quadratic edge
-				nnofa = 3;
-				infile >> nbtags;
-				if(nbtags > nbtag) nbtag = nbtags;
-				for(int j = 0; j < nbtags; j++)
-					infile >> elms(i,j+nnofa);		// get tags
-				for(int j = 0; j < nnofa; j++)
-					infile >> elms(i,j);			// get node numbers
-				nface++;
-				break;
-			case(2): // linear triangles
-				nnodes[i] = 3;
-				nfaels[i] = 3;
-				nnofa = 2;
-				infile >> ntags;
-				if(ntags > ndtag) ndtag = ntags;
-				for(int j = 0; j < ntags; j++)
-					infile >> elms(i,j+nnodes[i]);		// get tags
-				for(int j = 0; j < nnodes[i]; j++)
-					infile >> elms(i,j);			// get node numbers
-				nelem++;
-				break;
-			case(3):	// linear quads
-				nnodes[i] = 4;
-				nfaels[i] = 4;
-				nnofa = 2;
-				infile >> ntags;
-				if(ntags > ndtag) ndtag = ntags;
-				for(int j = 0; j < ntags; j++)
-					infile >> elms(i,j+nnodes[i]);		// get tags
-				for(int j = 0; j < nnodes[i]; j++)
-					infile >> elms(i,j);			// get node numbers
-				nelem++;
-				break;
-			case(9):	// quadratic triangles
-				nnodes[i] = 6;
-				nfaels[i] = 3;
-				nnofa = 3;
-				infile >> ntags;
-				if(ntags > ndtag) ndtag = ntags;
-				for(int j = 0; j < ntags; j++)
-					infile >> elms(i,j+nnodes[i]);		// get tags
-				for(int j = 0; j < nnodes[i]; j++)
-					infile >> elms(i,j);			// get node numbers
-				nelem++;
-				break;
-			case(16):	// quadratic quad (8 nodes)
-				nnodes[i] = 8;
-				nfaels[i] = 4;
-				nnofa = 3;
-				infile >> ntags;
-				if(ntags > ndtag) ndtag = ntags;
-				for(int j = 0; j < ntags; j++)
-					infile >> elms(i,j+nnodes[i]);		// get tags
-				for(int j = 0; j < nnodes[i]; j++)
-					infile >> elms(i,j);			// get node numbers
-				nelem++;
-				break;
-			case(10):	// quadratic quad (9 nodes)
-				nnodes[i] = 9;
-				nfaels[i] = 4;
-				nnofa = 3;
-				infile >> ntags;
-				if(ntags > ndtag) ndtag = ntags;
-				for(int j = 0; j < ntags; j++)
-					infile >> elms(i,j+nnodes[i]);		// get tags
-				for(int j = 0; j < nnodes[i]; j++)
-					infile >> elms(i,j);			// get node numbers
-				nelem++;
-				break;
-			default:
-				std::cout << "! UMesh2d: readGmsh2(): Element type not recognized. Setting as linear triangle." << std::endl;
-				nnodes[i] = 3;
-				nfaels[i] = 3;
-				nnofa = 2;
-				infile >> ntags;
-				if(ntags > ndtag) ndtag = ntags;
-				for(int j = 0; j < ntags; j++)
-					infile >> elms(i,j+nnodes[i]);		// get tags
-				for(int j = 0; j < nnodes[i]; j++)
-					infile >> elms(i,j);			// get node numbers
-				nelem++;
+			// linear or quadratic edge
+			nnofa = nnodes;
+			if(ntags > nbtag) nbtag = ntags;
+			nface++;
 		}
-	}
-	/*std::cout << "UMesh2d: readGmsh2(): Done reading elms" << std::endl;
-	for(int i = 0; i < nelm; i++)
-		std::cout << nnodes[i] << " " << nfaels[i] << std::endl;*/
-
-	nnode.reserve(nelem);
-	nfael.reserve(nelem);
+		else if(elemnnode(elmtype) > 0)
+		{
+			nnofa = elemnnode(elmtype) > 4 ? 3 : 2;
+			if(nnodes > maxnnode) maxnnode = nnodes;
+			if(elemnfael(elmtype) > maxnfael) maxnfael = elemnfael(elmtype);
+			if(ntags > ndtag) ndtag = ntags;
+			nelem++;
+		}
+		else
+			nskipped++;
+	});
 
-	// calculate max nnode and nfael
-	maxnnode = nnodes[nface]; maxnfael = nfaels[nface];
-	for(int i = 0; i < nelm; i++)
-	{
-		if(nnodes[i] > maxnnode)
-			maxnnode = nnodes[i];
-		if(nfaels[i] > maxnfael)
-			maxnfael = nfaels[i];
-	}
+	if(!readok)
+		return;
+	if(nskipped > 0)
+		std::cout << "! UMesh2d: readGmsh2(): Skipped " << nskipped << " elms of types that are not recognized." << std::endl;
 
-	if(nface > 0)
+	if(nface > 0) {
 		bface.setup(nface, nnofa+nbtag);
+		bface.zeros();
+	}
 	else std::cout << "UMesh2d: readGmsh2(): NOTE: There is no boundary data!" << std::endl;
 
 	inpoel.setup(nelem, maxnnode);
+	inpoel.zeros();
 	vol_regions.setup(nelem, ndtag);
+	vol_regions.zeros();
+	nnode.resize(nelem);
+	nfael.resize(nelem);
 
 	std::cout << "UMesh2dh: readGmsh2(): Done. No. of points: " << npoin << ", number of elements: " << nelem << ", number of boundary faces " << nface << ",\n max number of nodes per element: " << maxnnode << ", number of nodes per face: " << nnofa << ", max number of faces per element: " << maxnfael << std::endl;
 
-	// write into inpoel and bface
-	// the first nface rows to be read are boundary faces
-	for(int i = 0; i < nface; i++)
+	// second pass: write into inpoel and bface
+	int iface = 0, ielem = 0;
+	reader.forEachElement([&](const int elmtype, const int ntags, const int* const tags, const int nnodes, const int* const nodes)
 	{
-		for(int j = 0; j < nnofa; j++)
-			bface(i,j) = elms(i,j)-1;			// -1 to correct for the fact that our numbering starts from zero
-		for(int j = nnofa; j < nnofa+nbtag; j++)
-			bface(i,j) = elms(i,j);
-	}
-	for(int i = 0; i < nelem; i++)
-	{
-		for(int j = 0; j < nnodes[i+nface]; j++)
-			inpoel(i,j) = elms(i+nface,j)-1;
-		for(int j = 0; j < ndtag; j++)
-			vol_regions(i,j) = elms(i+nface,j+nnodes[i+nface]);
-		nnode.push_back(nnodes[i+nface]);
-		nfael.push_back(nfaels[i+nface]);
-	}
-	infile.close();
+		if(nnodes != gmsh_element_nnodes(elmtype))
+			return;
+		if(elmtype == 1 || elmtype == 8)
+		{
+			for(int j = 0; j < nnodes && j < nnofa; j++)
+				bface(iface,j) = nodes[j]-1;			// -1 to correct for the fact that our numbering starts from zero
+			for(int j = 0; j < ntags; j++)
+				bface(iface,nnofa+j) = tags[j];
+			iface++;
+		}
+		else if(elemnnode(elmtype) > 0)
+		{
+			for(int j = 0; j < nnodes; j++)
+				inpoel(ielem,j) = nodes[j]-1;
+			for(int j = 0; j < ntags; j++)
+				vol_regions(ielem,j) = tags[j];
+			nnode[ielem] = nnodes;
+			nfael[ielem] = elemnfael(elmtype);
+			ielem++;
+		}
+	});
 
-	/*for(int i = 0; i < nelem; i++) 
-	{	
-		if (nnode == 3) nmtens[i] = 1;
-		else if(nnode == 4) nmtens[i] = 4;
-	}*/
-	
 	// set flag_bpoin
 	flag_bpoin.setup(npoin,1);
 	flag_bpoin.zeros();
@@ -589,6 +510,77 @@ void UMesh2dh::writeGmsh2(std::string mfile)
 	outf.close();
 }
 
+void UMesh2dh::writeSnapshot(std::string mfile) const
+{
+	SnapshotWriter w(SNAPSHOT_UMESH2DH);
+	w.addScalar("npoin", npoin); w.addScalar("nelem", nelem); w.addScalar("nface", nface); w.addScalar("ndim", ndim);
+	w.addScalar("maxnnode", maxnnode); w.addScalar("maxnfael", maxnfael); w.addScalar("nnofa", nnofa); w.addScalar("naface", naface);
+	w.addScalar("nbface", nbface); w.addScalar("nbpoin", nbpoin); w.addScalar("nbtag", nbtag); w.addScalar("ndtag", ndtag);
+	w.addScalar("isBoundaryMaps", isBoundaryMaps);
+
+	w.addArray("nnode", nnode);
+	w.addArray("nfael", nfael);
+	w.addArray("coords", coords);
+	w.addArray("inpoel", inpoel);
+	w.addArray("bface", bface);
+	w.addArray("vol_regions", vol_regions);
+	w.addArray("flag_bpoin", flag_bpoin);
+
+	// derived connectivity, whatever of it has been computed
+	w.addArray("esup_p", esup_p); w.addArray("esup", esup);
+	w.addArray("psup_p", psup_p); w.addArray("psup", psup);
+	w.addArray("esuel", esuel);
+	w.addArray("intfac", intfac);
+	w.addArray("intfacbtags", intfacbtags);
+	w.addArray("bpoints", bpoints);
+	w.addArray("bpointsb", bpointsb);
+	w.addArray("bfacebp", bfacebp);
+	w.addArray("bifmap", bifmap); w.addArray("ifbmap", ifbmap);
+	w.addArray("bfaceHostCell", bfaceHostCell);
+
+	if(w.write(mfile))
+		std::cout << "UMesh2dh: writeSnapshot(): Wrote " << mfile << std::endl;
+}
+
+bool UMesh2dh::readSnapshot(std::string mfile)
+{
+	SnapshotReader r;
+	if(!r.open(mfile))
+		return false;
+	if(r.gkind() != SNAPSHOT_UMESH2DH) {
+		std::cout << "! UMesh2dh: readSnapshot(): " << mfile << " does not contain a 2D hybrid mesh!" << std::endl;
+		return false;
+	}
+
+	r.getScalar("npoin", npoin); r.getScalar("nelem", nelem); r.getScalar("nface", nface); r.getScalar("ndim", ndim);
+	r.getScalar("maxnnode", maxnnode); r.getScalar("maxnfael", maxnfael); r.getScalar("nnofa", nnofa); r.getScalar("naface", naface);
+	r.getScalar("nbface", nbface); r.getScalar("nbpoin", nbpoin); r.getScalar("nbtag", nbtag); r.getScalar("ndtag", ndtag);
+	r.getScalar("isBoundaryMaps", isBoundaryMaps);
+
+	if(!r.getArray("coords", coords) || !r.getArray("inpoel", inpoel) || !r.getArray("nnode", nnode) || !r.getArray("nfael", nfael)) {
+		std::cout << "! UMesh2dh: readSnapshot(): " << mfile << " does not contain the points and elements of the mesh!" << std::endl;
+		return false;
+	}
+	r.getArray("bface", bface);
+	r.getArray("vol_regions", vol_regions);
+	r.getArray("flag_bpoin", flag_bpoin);
+
+	r.getArray("esup_p", esup_p); r.getArray("esup", esup);
+	r.getArray("psup_p", psup_p); r.getArray("psup", psup);
+	r.getArray("esuel", esuel);
+	r.getArray("intfac", intfac);
+	r.getArray("intfacbtags", intfacbtags);
+	r.getArray("bpoints", bpoints);
+	r.getArray("bpointsb", bpointsb);
+	r.getArray("bfacebp", bfacebp);
+	r.getArray("bifmap", bifmap); r.getArray("ifbmap", ifbmap);
+	r.getArray("bfaceHostCell", bfaceHostCell);
+
+	std::cout << "UMesh2dh: readSnapshot(): Done. No. of points: " << npoin << ", number of elements: " << nelem << ", number of boundary faces " << nface
+		<< (intfac.rows() > 0 ? ", with connectivity data." : ".") << std::endl;
+	return true;
+}
+
 /** \brief Computes area of linear triangular elements. So it can't be used for hybrid meshes.
  * 
  * \todo TODO: Generalize so that it works for quadrilateral meshes also
@@ -628,6 +620,40 @@ void UMesh2dh::detect_negative_jacobians(std::ofstream& out)
 	if(flagj == true) std::cout << "UMesh2d: detect_negative_jacobians(): There exist " << nneg << " element(s) with negative jacobian!!\n";
 }
 
+void UMesh2dh::compute_elementsSurroundingElements()
+{
+	// list the faces of all elements, face ifael of element ielem being face ielem*maxnfael+ifael, followed by the boundary faces
+	const int nelfac = nelem*maxnfael;
+	std::vector<amc_int> facepo((nelfac+nface)*nnofa, -1);
+	for(int ielem = 0; ielem < nelem; ielem++)
+		for(int ifael = 0; ifael < nfael[ielem]; ifael++)
+			for(int i = 0; i < nnofa; i++)
+				facepo[(ielem*maxnfael+ifael)*nnofa+i] = inpoel(ielem, (ifael+i) % nnode[ielem]);
+	for(int iface = 0; iface < nface; iface++)
+		for(int i = 0; i < nnofa; i++)
+			facepo[(nelfac+iface)*nnofa+i] = bface(iface,i);
+
+	std::vector<amc_int> match;
+	if(match_faces(npoin, nelfac+nface, nnofa, facepo, match) > 0)
+		std::cout << "! UMesh2dh: compute_elementsSurroundingElements(): Some faces are shared by more than two elements!" << std::endl;
+
+	esuel.setup(nelem, maxnfael);
+	for(int ielem = 0; ielem < nelem; ielem++)
+		for(int ifael = 0; ifael < maxnfael; ifael++)
+		{
+			const int jfac = match[ielem*maxnfael+ifael];
+			esuel(ielem,ifael) = (jfac >= 0 && jfac < nelfac) ? jfac/maxnfael : -1;
+		}
+
+	bfaceHostCell.setup(nface > 0 ? nface : 1, 2);
+	for(int iface = 0; iface < nface; iface++)
+	{
+		const int jfac = match[nelfac+iface];
+		bfaceHostCell(iface,0) = (jfac >= 0 && jfac < nelfac) ? jfac/maxnfael : -1;
+		bfaceHostCell(iface,1) = (jfac >= 0 && jfac < nelfac) ? jfac%maxnfael : -1;
+	}
+}
+
 /// \todo: TODO: There is an issue with psup for some boundary nodes belonging to elements of different types. Correct this.
 void UMesh2dh::compute_topological()
 {
@@ -771,70 +797,7 @@ void UMesh2dh::compute_topological()
 	/// 3. Elements surrounding elements
 	std::cout << "UMesh2dh: compute_topological(): Elements surrounding elements...\n";
 
-	//amat::Matrix<int> lpoin(npoin,1);
-	esuel.setup(nelem, maxnfael);
-	for(int ii = 0; ii < nelem; ii++)
-		for(int jj = 0; jj < maxnfael; jj++)
-			esuel(ii,jj) = -1;
-	//lpofa.mprint();
-	amat::Matrix<int > lhelp(nnofa,1);
-	lhelp.zeros();
-	lpoin.zeros();
-
-	for(int ielem = 0; ielem < nelem; ielem++)
-	{
-		// first get lpofa for this element
-		amat::Matrix<int > lpofai(nfael[ielem], nnofa);	// lpofa(i,j) holds local node number of jth node of ith face (j in [0:nnofa], i in [0:nfael])
-		amat::Matrix<int > lpofaj;							// to be initialized for each jelem
-		for(int i = 0; i < nfael[ielem]; i++)
-		{
-			for(int j = 0; j < nnofa; j++)
-			{
-				lpofai(i,j) = (i+j) % nnode[ielem];		// fine as long as operands of % are not negative
-			}
-		}
-
-		for(int ifael = 0; ifael < nfael[ielem]; ifael++)
-		{
-			for(int i = 0; i < nnofa; i++)
-			{
-				lhelp(i,0) = inpoel(ielem, lpofai(ifael,i));	// lhelp stores global node nos. of current face of current element
-				lpoin(lhelp(i,0)) = 1;
-			}
-			int ipoin = lhelp(0);
-			for(int istor = esup_p(ipoin); istor < esup_p(ipoin+1); istor++)
-			{
-				int jelem = esup(istor);
-
-				if(jelem != ielem)
-				{
-					// setup lpofa for jelem
-					lpofaj.setup(nfael[jelem],nnofa);
-					for(int i = 0; i < nfael[jelem]; i++)
-						for(int j = 0; j < nnofa; j++)
-							lpofaj(i,j) = (i+j)%nnode[jelem];
-
-					for(int jfael = 0; jfael < nfael[jelem]; jfael++)
-					{
-						//Assume that no. of nodes in face ifael is same as that in face jfael
-						int icoun = 0;
-						for(int jnofa = 0; jnofa < nnofa; jnofa++)
-						{
-							int jpoin = inpoel(jelem, lpofaj(jfael,jnofa));
-							if(lpoin(jpoin)==1) icoun++;
-						}
-						if(icoun == nnofa)		// nnofa is 2
-						{
-							esuel(ielem,ifael) = jelem;
-							esuel(jelem,jfael) = ielem;
-						}
-					}
-				}
-			}
-			for(int i = 0; i < nnofa; i++)
-				lpoin(lhelp(i)) = 0;
-		}
-	}
+	compute_elementsSurroundingElements();
 
 	/** Computes, for each face, the elements on either side, the starting node and the ending node of the face. This is stored in intfac. Also computes unit normals to, and lengths of, each face as well as boundary flags of boundary faces, in gallfa.
 	The orientation of the face is such that the element with smaller index is always to the left of the face, while the element with greater index is always to the right of the face.
@@ -993,6 +956,27 @@ void UMesh2dh::compute_boundary_maps()
 	bifmap.setup(nbface,1);
 	ifbmap.setup(nbface,1);
 
+	// if the host cells of bfaces are known, the intfac face of each bface is given by esuel
+	if(bfaceHostCell.rows() == nface && nface == nbface)
+	{
+		bool found = true;
+		for(int ibface = 0; ibface < nface; ibface++)
+		{
+			const int ielem = bfaceHostCell(ibface,0), ifael = bfaceHostCell(ibface,1);
+			const int inface = ielem >= 0 ? esuel(ielem,ifael)-nelem : -1;
+			if(inface < 0 || inface >= nbface) {
+				found = false;
+				break;
+			}
+			bifmap(inface) = ibface;
+			ifbmap(ibface) = inface;
+		}
+		if(found) {
+			isBoundaryMaps = true;
+			return;
+		}
+	}
+
 	std::vector<int> fpo(nnofa);
 
 	for(int ibface = 0; ibface < nface; ibface++)
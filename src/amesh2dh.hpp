@@ -39,6 +39,18 @@
 
 #include <aconstants.h>
 
+#ifndef __AFACEMATCH_H
+#include <afacematch.hpp>
+#endif
+
+#ifndef __AGMSHREADER_H
+#include <agmshreader.hpp>
+#endif
+
+#ifndef __ASNAPSHOT_H
+#include <asnapshot.hpp>
+#endif
+
 #define __AMESH2DHYBRID_H
 
 namespace amc {
@@ -103,6 +115,7 @@ private:
 	amat::Matrix<int > bifmap;				///< relates boundary faces in intfac with bface, ie, bifmap(intfac no.) = bface no.
 	amat::Matrix<int > ifbmap;				///< relates boundary faces in bface with intfac, ie, ifbmap(bface no.) = intfac no.
 	bool isBoundaryMaps;			///< Specifies whether bface-intfac maps have been created
+	amat::Matrix<int > bfaceHostCell;		///< Host element of each bface, and the local face number of the bface in that element
 
 	bool alloc_jacobians;			///< Flag indicating whether space has been allocated for jacobians
 	amat::Matrix<double > jacobians;		///< Contains jacobians of each (linear) element
@@ -205,6 +218,14 @@ public:
 	void printmeshstats();
 	void writeGmsh2(std::string mfile);
 
+	/// Writes the mesh to a binary [snapshot](@ref asnapshot.hpp) file, along with whatever connectivity data has been computed
+	void writeSnapshot(std::string mfile) const;
+
+	/// Reads a mesh, and any connectivity data stored with it, from a snapshot file written by [writeSnapshot](@ref writeSnapshot)
+	/** Connectivity arrays absent from the file are emptied. Returns false if the file could not be read.
+	 */
+	bool readSnapshot(std::string mfile);
+
 	void compute_jacobians();
 	void detect_negative_jacobians(std::ofstream& out);
 	
@@ -220,6 +241,12 @@ public:
 	 */
 	void compute_topological();
 
+	/// Computes elements surrounding elements (esuel) and the host element of each bface (bfaceHostCell)
+	/** Faces are matched by sorting their node numbers (see match_faces()), so this takes linear time and does not need esup.
+	 * Entries of esuel for faces on the boundary are -1.
+	 */
+	void compute_elementsSurroundingElements();
+
 	/// Iterates over bfaces and finds the corresponding intfac face for each bface
 	/** Stores this data in the boundary label maps [ifbmap](@ref ifbmap) and [bifmap](@ref bifmap).
 	 */
@@ -9,7 +9,7 @@
 namespace amc {
 
 /** No-arg constructor. */
-UMesh::UMesh() {alloc_jacobians = false; psup = nullptr; elsed = nullptr;}
+UMesh::UMesh() {alloc_jacobians = false;}
 
 UMesh::UMesh(const UMesh& other)
 {
@@ -36,21 +36,14 @@ UMesh::UMesh(const UMesh& other)
 	vol_regions = other.vol_regions;
 	esup = other.esup;
 	esup_p = other.esup_p;
-	if(other.psup != nullptr)
-	{
-		psup = new std::vector<int>[npoin];
-		for(int i = 0; i < npoin; i++)
-			psup[i] = other.psup[i];
-	}
-	if(other.elsed != nullptr)
-	{
-		elsed = new std::vector<int>[nedge];
-		for(int i = 0; i < nedge; i++)
-			elsed[i] = other.elsed[i];
-	}
+	psup_p = other.psup_p;
+	psup = other.psup;
+	edsup_p = other.edsup_p;
+	edsup = other.edsup;
+	elsed_p = other.elsed_p;
+	elsed = other.elsed;
 	esuel = other.esuel;
 	edgepo = other.edgepo;
-	elsed = other.elsed;
 	intfac = other.intfac;
 	alloc_jacobians = other.alloc_jacobians;
 	jacobians = other.jacobians;
@@ -58,223 +51,136 @@ UMesh::UMesh(const UMesh& other)
 
 UMesh::~UMesh()
 {
-	if(psup != nullptr)
-		delete [] psup;
-	if(edsup != nullptr)
-		delete [] edsup;
-	if(elsed != nullptr)
-		delete [] elsed;
 }
 
 // Reads mesh from Gmsh 2 format file. For quadratic meshes, mapping has to be applied for node-ordering.
 void UMesh::readGmsh2(std::string mfile, int dimensions)
 {
 	std::cout << "UMesh3d: readGmsh2(): Reading mesh file...\n";
-	int dum; double dummy; std::string dums; char ch;
 	ndim = dimensions;
 
-	std::ifstream infile(mfile);
-	for(int i = 0; i < 4; i++)		//skip 4 lines
-		do
-			ch = infile.get();
-		while(ch != '\n');
+	GmshReader reader;
+	if(!reader.open(mfile)) {
+		std::cout << "! UMesh3d: readGmsh2(): Could not read mesh file " << mfile << std::endl;
+		return;
+	}
 
-	infile >> npoin;
+	npoin = reader.gnpoin();
 	std::cout << "UMesh3d: readGmsh2(): No. of points = " << npoin << std::endl;
-	coords.setup(npoin,ndim);
+	if(!reader.readNodes(coords, ndim))
+		return;
 
-	// read coords of points
-	for(int i = 0; i < npoin; i++)
-	{
-		infile >> dum;
-		for(int j = 0; j < ndim; j++)
-			infile >> coords(i,j);
-		if(ndim < 3) infile >> dummy;
-	}
-	infile >> dums;
-	infile >> dums;
-	//std::cout << "UMesh3d: readGmsh2(): coords read." << std::endl;
+	std::cout << "UMesh3d: readGmsh2(): Total number of elms is " << reader.gnelm() << std::endl;
 
-	int elmtype, nbtags, ntags, nskipped= 0;
-	amc_int nelm, i;
+	// First pass: count boundary faces and elements, and find their types and the number of tags.
+	// The assumption here is that elm-type is same for all boundary faces and same for all elements.
+	int facetype = 0, elemtype = 0;
+	amc_int nskipped = 0;
+	bool consistent = true;
 	ndtag = 0; nbtag = 0;
-	infile >> nelm;
-	amat::Matrix<amc_int> elms(nelm,40);
 	nface = 0; nelem = 0;
-	std::cout << "UMesh3d: readGmsh2(): Total number of elms is " << nelm << std::endl;
-	amat::Matrix<amc_int> temper(27,1);		// to temporarily store nodes in Gmsh order
 
-	for(i = 0; i < nelm; i++)
+	bool readok = reader.forEachElement([&](const int elmtype, const int ntags, const int* const, const int nnodes, const int* const)
 	{
-		infile >> dum;
-		infile >> elmtype;
-		// assumption here is that elm-type is same for all edges, same for all boundary faces and same for all elements
+		if(nnodes != gmsh_element_nnodes(elmtype)) {
+			nskipped++;
+			return;
+		}
 		switch(elmtype)
 		{
 			case(2): // linear triangle face
-				nnofa = 3;
-				nnoded = 2;
-				nedfa = 3;
-				infile >> nbtags;
-				if(nbtags > nbtag) nbtag = nbtags;
-				for(int j = 0; j < nbtags; j++)
-					infile >> elms(i,j+nnofa);		// get tags
-				for(int j = 0; j < nnofa; j++)
-					infile >> elms(i,j);			// get node numbers
-				nface++;
+				nnofa = 3; nnoded = 2; nedfa = 3;
 				break;
 			case(3): // linear quad (4-node) face
-				nnofa = 4;
-				nnoded = 2;
-				nedfa = 4;
-				infile >> nbtags;
-				if(nbtags > nbtag) nbtag = nbtags;
-				for(int j = 0; j < nbtags; j++)
-					infile >> elms(i,j+nnofa);		// get tags
-				for(int j = 0; j < nnofa; j++)
-					infile >> elms(i,j);			// get node numbers
-				nface++;
+				nnofa = 4; nnoded = 2; nedfa = 4;
 				break;
 			case(9): // quadratic triangle face
-				nnofa = 6;
-				nnoded = 3;
-				nedfa = 3;
-				infile >> nbtags;
-				if(nbtags > nbtag) nbtag = nbtags;
-				for(int j = 0; j < nbtags; j++)
-					infile >> elms(i,j+nnofa);		// get tags
-				for(int j = 0; j < nnofa; j++)
-					infile >> elms(i,j);			// get node numbers
-				nface++;
+				nnofa = 6; nnoded = 3; nedfa = 3;
 				break;
 			case(10): // quadratic quad (9-node) face
-				nnofa = 9;
-				nnoded = 3;
-				nedfa = 4;
-				infile >> nbtags;
-				if(nbtags > nbtag) nbtag = nbtags;
-				for(int j = 0; j < nbtags; j++)
-					infile >> elms(i,j+nnofa);		// get tags
-				for(int j = 0; j < nnofa; j++)
-					infile >> elms(i,j);			// get node numbers
-				nface++;
+				nnofa = 9; nnoded = 3; nedfa = 4;
 				break;
 			case(4): // linear tet
-				nnode = 4;
-				nfael = 4;
-				nnofa = 3;
-				nnoded = 2;
-				nedel = 6;
-				infile >> ntags;
-				if(ntags > ndtag) ndtag = ntags;
-				for(int j = 0; j < ntags; j++)
-					infile >> elms(i,j+nnode);		// get tags
-				for(int j = 0; j < nnode; j++)
-					infile >> elms(i,j);			// get node numbers
-				nelem++;
+				nnode = 4; nfael = 4; nnofa = 3; nnoded = 2; nedel = 6;
 				break;
-			case(5):	// linear hex
-				nnode = 8;
-				nfael = 6;
-				nnofa = 4;
-				nnoded = 2;
-				nedel = 12;
-				infile >> ntags;
-				if(ntags > ndtag) ndtag = ntags;
-				for(int j = 0; j < ntags; j++)
-					infile >> elms(i,j+nnode);		// get tags
-				for(int j = 0; j < nnode; j++)
-					infile >> elms(i,j);			// get node numbers
-				nelem++;
+			case(5): // linear hex
+				nnode = 8; nfael = 6; nnofa = 4; nnoded = 2; nedel = 12;
 				break;
-			case(11):	// quadratic tet
-				nnode = 10;
-				nfael = 4;
-				nnofa = 6;
-				nnoded = 3;
-				nedel = 6;
-				infile >> ntags;
-				if(ntags > ndtag) ndtag = ntags;
-				for(int j = 0; j < ntags; j++)
-					infile >> elms(i,j+nnode);		// get tags
-				for(int j = 0; j < nnode; j++)
-					infile >> elms(i,j);			// get node numbers
-				nelem++;
+			case(11): // quadratic tet
+				nnode = 10; nfael = 4; nnofa = 6; nnoded = 3; nedel = 6;
 				break;
-			case(12):	// quadratic hex (27 nodes)
-				nnode = 27;
-				nfael = 6;
-				nnofa = 9;
-				nnoded = 3;
-				nedel = 12;
-				infile >> ntags;
-				if(ntags > ndtag) ndtag = ntags;
-				for(int j = 0; j < ntags; j++)
-					infile >> elms(i,j+nnode);		// get tags
-				for(int j = 0; j < nnode; j++)
-					infile >> temper(j);			// get node numbers
-				
-				for(int j = 0; j <= 8; j++)		// first 8 nodes are same
-					elms(i,j) = temper(j);
-				
-				// add mapping from gmsh format to RDGFlo format
-				elms(i,9) = temper(11);
-				elms(i,10) = temper(13);
-				elms(i,11) = temper(9);
-				elms(i,12) = temper(10);
-				elms(i,13) = temper(12);
-				elms(i,14) = temper(14);
-				elms(i,15) = temper(15);
-				elms(i,16) = temper(16);
-				elms(i,17) = temper(18);
-				elms(i,18) = temper(19);
-				elms(i,19) = temper(17);
-				elms(i,20) = temper(20);
-				elms(i,21) = temper(21);
-				elms(i,22) = temper(23);
-				elms(i,23) = temper(24);
-				elms(i,24) = temper(22);
-				elms(i,25) = temper(25);
-				elms(i,26) = temper(26);
-				
-				nelem++;
+			case(12): // quadratic hex (27 nodes)
+				nnode = 27; nfael = 6; nnofa = 9; nnoded = 3; nedel = 12;
 				break;
-				
 			default:
-				std::cout << "! UMesh3d: readGmsh2(): Element type not recognized. Skipping." << std::endl;
-				do
-					ch = infile.get();
-				while(ch != '\n');
 				nskipped++;
-				break;
+				return;
+		}
+		if(elmtype == 2 || elmtype == 3 || elmtype == 9 || elmtype == 10)
+		{
+			if(facetype != 0 && facetype != elmtype) consistent = false;
+			facetype = elmtype;
+			if(ntags > nbtag) nbtag = ntags;
+			nface++;
 		}
+		else
+		{
+			if(elemtype != 0 && elemtype != elmtype) consistent = false;
+			elemtype = elmtype;
+			if(ntags > ndtag) ndtag = ntags;
+			nelem++;
+		}
+	});
+
+	if(!readok)
+		return;
+	if(!consistent) {
+		std::cout << "! UMesh3d: readGmsh2(): Meshes with more than one type of element or of boundary face are not supported!" << std::endl;
+		return;
 	}
-	//std::cout << "UMesh3d: readGmsh2(): Done reading elms" << std::endl;
+	if(nskipped > 0)
+		std::cout << "! UMesh3d: readGmsh2(): Skipped " << nskipped << " elms of types that are not recognized." << std::endl;
 
-	if(nface > 0)
+	if(nface > 0) {
 		bface.setup(nface, nnofa+nbtag);
+		bface.zeros();
+	}
 	else std::cout << "UMesh3d: readGmsh2(): NOTE: There is no data to populate bface!" << std::endl;
 
 	inpoel.setup(nelem, nnode);
 	vol_regions.setup(nelem, ndtag);
+	vol_regions.zeros();
 
-	// write into inpoel and bface
-	// the first nface rows to be read are boundary faces
-	for(i = 0; i < nface; i++)
-	{
-		for(int j = 0; j < nnofa; j++)
-			bface(i,j) = elms(i+nskipped,j)-1;			// -1 to correct for the fact that our numbering starts from zero
-		for(int j = nnofa; j < nnofa+nbtag; j++)
-			bface(i,j) = elms(i+nskipped,j);
-	}
-	for(i = 0; i < nelem; i++)
+	// order in which the nodes of a 27-node hex appear in Gmsh, for each node in RDGFlo ordering
+	const int gmshtordgflo_hex27[27] = {0,1,2,3,4,5,6,7,8, 11,13,9,10,12,14,15,16,18,19,17,20,21,23,24,22,25,26};
+
+	// Second pass: write into inpoel and bface
+	amc_int iface = 0, ielem = 0;
+	reader.forEachElement([&](const int elmtype, const int ntags, const int* const tags, const int nnodes, const int* const nodes)
 	{
-		for(int j = 0; j < nnode; j++)
-			inpoel(i,j) = elms(i+nface+nskipped,j)-1;
-		for(int j = 0; j < ndtag; j++)
-			vol_regions(i,j) = elms(i+nface+nskipped,j+nnode);
-	}
-	infile.close();
+		if(nnodes != gmsh_element_nnodes(elmtype))
+			return;
+		if(elmtype == facetype)
+		{
+			for(int j = 0; j < nnofa; j++)
+				bface(iface,j) = nodes[j]-1;			// -1 to correct for the fact that our numbering starts from zero
+			for(int j = 0; j < ntags; j++)
+				bface(iface,nnofa+j) = tags[j];
+			iface++;
+		}
+		else if(elmtype == elemtype)
+		{
+			if(elmtype == 12)
+				for(int j = 0; j < nnode; j++)
+					inpoel(ielem,j) = nodes[gmshtordgflo_hex27[j]]-1;
+			else
+				for(int j = 0; j < nnode; j++)
+					inpoel(ielem,j) = nodes[j]-1;
+			for(int j = 0; j < ntags; j++)
+				vol_regions(ielem,j) = tags[j];
+			ielem++;
+		}
+	});
 
 	std::cout << "UMesh3d: readGmsh2(): Setting flag_bpoin..." << std::endl;
 
@@ -353,9 +259,6 @@ void UMesh::readDomn(std::string mfile)
 	esup_p.setup(npoin+1,1);
 	esup_p.zeros();
 
-	amat::Matrix<amc_int> lpoin(npoin,1);
-	lpoin.zeros();
-	
 	for(int i = 0; i < nelem; i++)
 	{
 		for(int j = 0; j < nnode; j++)
@@ -390,74 +293,8 @@ void UMesh::readDomn(std::string mfile)
 	
 	//  Elements surrounding elements
 	std::cout << "UMesh3d: readDomn(): Elements surrounding elements...\n";
-
-	esuel.setup(nelem, nfael);
-	for(int ii = 0; ii < nelem; ii++)
-		for(int jj = 0; jj < nfael; jj++)
-			esuel(ii,jj) = -1;
-
-	lpofa.setup(nfael, nnofa);	// lpofa(i,j) holds local node number of jth node of ith face (j in [0:nnofa], i in [0:nfael])
-
-	if(nnode == 4)								// if tet
-		for(int i = 0; i < nfael; i++)
-		{
-			for(int j = 0; j < nnofa; j++)
-			{
-				//lpofa(i,j) = perm(0,nnode-1,i,j);
-				lpofa(i,j) = (i+j)%nnode;
-			}
-		}
-
-	if(nnode == 8)								// if hex
-	{
-		lpofa(0,0) = 0; lpofa(0,1) = 3; lpofa(0,2) = 2; lpofa(0,3) = 1;
-		lpofa(1,0) = 0; lpofa(1,1) = 1; lpofa(1,2) = 5; lpofa(1,3) = 4;
-		lpofa(2,0) = 0; lpofa(2,1) = 4; lpofa(2,2) = 7; lpofa(2,3) = 3;
-		lpofa(3,0) = 1; lpofa(3,1) = 2; lpofa(3,2) = 6; lpofa(3,3) = 5;
-		lpofa(4,0) = 2; lpofa(4,1) = 3; lpofa(4,2) = 7; lpofa(4,3) = 6;
-		lpofa(5,0) = 4; lpofa(5,1) = 5; lpofa(5,2) = 6; lpofa(5,3) = 7;
-	}
-
-	amat::Matrix<int> lhelp(nnofa,1);
-	lhelp.zeros();
-	lpoin.zeros();
-
-	for(int ielem = 0; ielem < nelem; ielem++)
-	{
-		for(int ifael = 0; ifael < nfael; ifael++)
-		{
-			for(int i = 0; i < nnofa; i++)
-			{
-				lhelp(i) = inpoel(ielem, lpofa(ifael,i));		// lhelp stores global node nos. of current face of current element
-				lpoin(lhelp(i)) = 1;
-			}
-			int ipoin = lhelp(0);								// ipoin is the global node number of first point of this face
-			for(int istor = esup_p(ipoin); istor < esup_p(ipoin+1); istor++)
-			{
-				int jelem = esup(istor);
-				if(jelem != ielem)
-				{
-					for(int jfael = 0; jfael < nfael; jfael++)
-					{
-						//Assume that no. of nodes in face ifael is same as that in face jfael
-						int icoun = 0;
-						for(int jnofa = 0; jnofa < nnofa; jnofa++)
-						{
-							int jpoin = inpoel(jelem, lpofa(jfael,jnofa));
-							if(lpoin(jpoin)==1) icoun++;
-						}
-						if(icoun == nnofa)		// if all nnofa points of face ifael are found in face jfael, they both are the same face
-						{
-							esuel(ielem,ifael) = jelem;
-							esuel(jelem,jfael) = ielem;
-						}
-					}
-				}
-			}
-			for(int i = 0; i < nnofa; i++)
-				lpoin(lhelp(i)) = 0;
-		}
-	}
+	nface = 0;		// boundary faces are not known yet; they are computed below
+	compute_elementsSurroundingElements();
 
 	/** Computes, for each face, the elements on either side, the starting node and the ending node of the face. This is stored in intfac.
 	 * The orientation of the face is such that the face points towards the element with larger index.
@@ -548,7 +385,7 @@ void UMesh::readDomn(std::string mfile)
 		}
 	}
 
-	flag_bpoin.setup(nbface,1);
+	flag_bpoin.setup(npoin,1);
 	flag_bpoin.zeros();
 
 	// compute bface and set flag_bpoin using intfac
@@ -695,66 +532,56 @@ void UMesh::findLocalFaceLocalPointConnectivityLinearElements(amat::Matrix<int>&
 void UMesh::findBfaceHostCell()
 {
 	bfaceHostCell.setup(nface,1);
-	amc_int iface, ielem;
-	int inofa, inode, ifael, ncoun, i;
 
 	amat::Matrix<int> lpofal;
 	if(nnode == 8 || nnode == 27)
 		lpofal.setup(nfael,4);
 	else if(nnode == 4 || nnode == 10)
 		lpofal.setup(nfael,3);
+	else {
+		std::cout << "! UMesh: findBfaceHostCell(): Element type not supported!" << std::endl;
+		return;
+	}
 	findLocalFaceLocalPointConnectivityLinearElements(lpofal);
+	const int nvfa = lpofal.cols();			// number of vertices of a face
 
-	for(iface = 0; iface < nface; iface++)
+	// only elements surrounding the first node of a bface need to be checked
+	if(esup_p.rows() != npoin+1)
+		compute_elementsSurroundingPoints();
+
+	amc_int nnotfound = 0;
+	#pragma omp parallel for default(none) shared(lpofal, nvfa) reduction(+:nnotfound)
+	for(amc_int iface = 0; iface < nface; iface++)
 	{
-		//std::cout << " " << iface << std::flush;
-		bool set = false;
-		for(ielem = 0; ielem < nelem; ielem++)
+		bfaceHostCell(iface) = -1;
+		const amc_int ipoin = bface.get(iface,0);
+		for(amc_int isup = esup_p.get(ipoin); isup < esup_p.get(ipoin+1) && bfaceHostCell.get(iface) < 0; isup++)
 		{
-			for(ifael = 0; ifael < nfael; ifael++)
-			{
-				ncoun = 0;
-				// now for each bface node, check if it matches any node of this fael of this element
-				for(inofa = 0; inofa < nnofa; inofa++)
-				{
-					if(nnode == 8 || nnode == 27)
-						for(i = 0; i < 4; i++)
+			const amc_int ielem = esup.get(isup);
+			for(int ifael = 0; ifael < nfael; ifael++)
+			{
+				int ncoun = 0;
+				// now for each bface node, check if it matches any vertex of this fael of this element
+				for(int inofa = 0; inofa < nnofa; inofa++)
+					for(int i = 0; i < nvfa; i++)
+						if(bface.get(iface,inofa) == inpoel.get(ielem, lpofal.get(ifael,i)) )
 						{
-							if(bface.get(iface,inofa) == inpoel.get(ielem, lpofal.get(ifael,i)) )
-							{
-								ncoun++;
-								break;
-							}
+							ncoun++;
+							break;
 						}
-					else if(nnode == 4 || nnode == 10)
-						for(i = 0; i < 3; i++)
-						{
-							if(bface.get(iface,inofa) == inpoel.get(ielem, lpofal.get(ifael,i)) )
-							{
-								ncoun++;
-								break;
-							}
-						}
-				}
-				if((nnode == 8 || nnode == 27) && ncoun == 4)
-				{
-					bfaceHostCell(iface) = ielem;
-					set = true;
-					break;
-				}
-				if((nnode == 4 || nnode == 10) && ncoun == 3)
+				if(ncoun == nvfa)
 				{
 					bfaceHostCell(iface) = ielem;
-					set = true;
 					break;
 				}
 			}
-
-			// if element has been found for this face, break from ielem loop
-			if(set) break;
 		}
+		if(bfaceHostCell.get(iface) < 0)
+			nnotfound++;
 	}
-	//std::cout << std::endl;
+
+	if(nnotfound > 0)
+		std::cout << "! UMesh: findBfaceHostCell(): Could not find host cells of " << nnotfound << " boundary faces!" << std::endl;
 }
 
 /* Writes mesh to Gmsh2 file format. */
@@ -896,6 +723,88 @@ void UMesh::writeDomn(std::string mfile, std::vector<int> farfieldnumber, std::v
 	fout.close();
 }
 
+void UMesh::writeSnapshot(std::string mfile) const
+{
+	SnapshotWriter w(SNAPSHOT_UMESH3D);
+	w.addScalar("npoin", npoin); w.addScalar("nelem", nelem); w.addScalar("nface", nface); w.addScalar("nedge", nedge);
+	w.addScalar("ndim", ndim); w.addScalar("nnode", nnode); w.addScalar("nfael", nfael); w.addScalar("nedel", nedel);
+	w.addScalar("nnofa", nnofa); w.addScalar("nedfa", nedfa); w.addScalar("nnoded", nnoded); w.addScalar("naface", naface);
+	w.addScalar("nbface", nbface); w.addScalar("nbedge", nbedge); w.addScalar("nbtag", nbtag); w.addScalar("ndtag", ndtag);
+	w.addScalar("nbpoin", nbpoin);
+
+	w.addArray("coords", coords);
+	w.addArray("inpoel", inpoel);
+	w.addArray("bface", bface);
+	w.addArray("flag_bpoin", flag_bpoin);
+	w.addArray("vol_regions", vol_regions);
+
+	// derived connectivity, whatever of it has been computed
+	w.addArray("lpofa", lpofa);
+	w.addArray("esup", esup); w.addArray("esup_p", esup_p);
+	w.addArray("psup", psup); w.addArray("psup_p", psup_p);
+	w.addArray("esuel", esuel);
+	w.addArray("edgepo", edgepo);
+	w.addArray("edsup", edsup); w.addArray("edsup_p", edsup_p);
+	w.addArray("elsed", elsed); w.addArray("elsed_p", elsed_p);
+	w.addArray("intfac", intfac);
+	w.addArray("bpoints", bpoints); w.addArray("bpointsinv", bpointsinv);
+	w.addArray("bfacebp", bfacebp);
+	w.addArray("bfsubp", bfsubp); w.addArray("bfsubp_p", bfsubp_p);
+	w.addArray("bfsubf", bfsubf);
+	w.addArray("bpsubp", bpsubp); w.addArray("bpsubp_p", bpsubp_p);
+	w.addArray("intbedge", intbedge);
+	w.addArray("bfaceHostCell", bfaceHostCell);
+
+	if(w.write(mfile))
+		std::cout << "UMesh3d: writeSnapshot(): Wrote " << mfile << std::endl;
+}
+
+bool UMesh::readSnapshot(std::string mfile)
+{
+	SnapshotReader r;
+	if(!r.open(mfile))
+		return false;
+	if(r.gkind() != SNAPSHOT_UMESH3D) {
+		std::cout << "! UMesh3d: readSnapshot(): " << mfile << " does not contain a 3D mesh!" << std::endl;
+		return false;
+	}
+
+	r.getScalar("npoin", npoin); r.getScalar("nelem", nelem); r.getScalar("nface", nface); r.getScalar("nedge", nedge);
+	r.getScalar("ndim", ndim); r.getScalar("nnode", nnode); r.getScalar("nfael", nfael); r.getScalar("nedel", nedel);
+	r.getScalar("nnofa", nnofa); r.getScalar("nedfa", nedfa); r.getScalar("nnoded", nnoded); r.getScalar("naface", naface);
+	r.getScalar("nbface", nbface); r.getScalar("nbedge", nbedge); r.getScalar("nbtag", nbtag); r.getScalar("ndtag", ndtag);
+	r.getScalar("nbpoin", nbpoin);
+
+	if(!r.getArray("coords", coords) || !r.getArray("inpoel", inpoel)) {
+		std::cout << "! UMesh3d: readSnapshot(): " << mfile << " does not contain the points and elements of the mesh!" << std::endl;
+		return false;
+	}
+	r.getArray("bface", bface);
+	r.getArray("flag_bpoin", flag_bpoin);
+	r.getArray("vol_regions", vol_regions);
+
+	r.getArray("lpofa", lpofa);
+	r.getArray("esup", esup); r.getArray("esup_p", esup_p);
+	r.getArray("psup", psup); r.getArray("psup_p", psup_p);
+	r.getArray("esuel", esuel);
+	r.getArray("edgepo", edgepo);
+	r.getArray("edsup", edsup); r.getArray("edsup_p", edsup_p);
+	r.getArray("elsed", elsed); r.getArray("elsed_p", elsed_p);
+	r.getArray("intfac", intfac);
+	r.getArray("bpoints", bpoints); r.getArray("bpointsinv", bpointsinv);
+	r.getArray("bfacebp", bfacebp);
+	r.getArray("bfsubp", bfsubp); r.getArray("bfsubp_p", bfsubp_p);
+	r.getArray("bfsubf", bfsubf);
+	r.getArray("bpsubp", bpsubp); r.getArray("bpsubp_p", bpsubp_p);
+	r.getArray("intbedge", intbedge);
+	r.getArray("bfaceHostCell", bfaceHostCell);
+
+	alloc_jacobians = false;
+	std::cout << "UMesh3d: readSnapshot(): Done. No. of points: " << npoin << ", number of elements: " << nelem << ", number of boundary faces " << nface
+		<< (intfac.rows() > 0 ? ", with connectivity data." : ".") << std::endl;
+	return true;
+}
+
 /// Computes jacobians for linear elements
 /** Currently only for tetrahedra
  */
@@ -950,12 +859,8 @@ void UMesh::compute_jacobians()
  * 
  * \note NOTE: Currently only works for linear mesh - and psup works only for tetrahedral or hexahedral linear mesh
  */
-void UMesh::compute_topological()
+void UMesh::compute_elementsSurroundingPoints()
 {
-	std::cout << "UMesh: compute_topological(): Calculating and storing topological information..." << std::endl;
-	amc_int ied, i, iel, jel;
-	
-	//1. Elements surrounding points
 	esup_p.setup(npoin+1,1);
 	esup_p.zeros();
 	
@@ -988,101 +893,152 @@ void UMesh::compute_topological()
 	for(int i = npoin; i >= 1; i--)
 		esup_p(i,0) = esup_p(i-1,0);
 	esup_p(0,0) = 0;
+}
 
-	// Elements surrounding points is now done.
+void UMesh::compute_elementsSurroundingElements()
+{
+	lpofa.setup(nfael, nnofa);	// lpofa(i,j) holds local node number of jth node of ith face (j in [0:nnofa], i in [0:nfael])
 
-	//2. Points surrounding points - works only for tets and hexes!!
-	std::cout << "UMesh2d: compute_topological(): Points surrounding points\n";
-	if(psup != nullptr)
-		delete [] psup;
-	psup = new std::vector<int>[npoin];
-	edsup = new std::vector<int>[npoin];		// also allocate edges surrounding point
-	for(int i = 0; i < npoin; i++)
+	if(nnode == 4)								// if tet
+		for(int i = 0; i < nfael; i++)
+		{
+			for(int j = 0; j < nnofa; j++)
+			{
+				//lpofa(i,j) = perm(0,nnode-1,i,j);
+				lpofa(i,j) = (i+j)%nnode;
+			}
+		}
+
+	if(nnode == 8)								// if hex
 	{
-		psup[i].reserve(10);
-		edsup[i].reserve(10);
+		lpofa(0,0) = 0; lpofa(0,1) = 3; lpofa(0,2) = 2; lpofa(0,3) = 1;
+		lpofa(1,0) = 0; lpofa(1,1) = 1; lpofa(1,2) = 5; lpofa(1,3) = 4;
+		lpofa(2,0) = 0; lpofa(2,1) = 4; lpofa(2,2) = 7; lpofa(2,3) = 3;
+		lpofa(3,0) = 1; lpofa(3,1) = 2; lpofa(3,2) = 6; lpofa(3,3) = 5;
+		lpofa(4,0) = 2; lpofa(4,1) = 3; lpofa(4,2) = 7; lpofa(4,3) = 6;
+		lpofa(5,0) = 4; lpofa(5,1) = 5; lpofa(5,2) = 6; lpofa(5,3) = 7;
 	}
 
-	amat::Matrix<int> lpoin(npoin,1);  // The ith member indicates the global point number of which the ith point is a surrounding point
+	// list the faces of all elements, face ifael of element ielem being face ielem*nfael+ifael, followed by the boundary faces
+	const amc_int nelfac = nelem*nfael;
+	std::vector<amc_int> facepo((size_t)(nelfac+nface)*nnofa);
+	for(amc_int ielem = 0; ielem < nelem; ielem++)
+		for(int ifael = 0; ifael < nfael; ifael++)
+			for(int i = 0; i < nnofa; i++)
+				facepo[(size_t)(ielem*nfael+ifael)*nnofa+i] = inpoel.get(ielem, lpofa.get(ifael,i));
+	for(amc_int iface = 0; iface < nface; iface++)
+		for(int i = 0; i < nnofa; i++)
+			facepo[(size_t)(nelfac+iface)*nnofa+i] = bface.get(iface,i);
 
-	for(int i = 0; i < npoin; i++)
-		lpoin(i,0) = -1;	// initialize this std::vector to -1
+	std::vector<amc_int> match;
+	if(match_faces(npoin, nelfac+nface, nnofa, facepo, match) > 0)
+		std::cout << "! UMesh: compute_elementsSurroundingElements(): Some faces are shared by more than two elements!" << std::endl;
 
-	for(int ip = 0; ip < npoin; ip++)
-	{
-		lpoin(ip) = ip;
-		// iterate over elements surrounding point
-		for(int i = esup_p(ip); i < esup_p(ip+1); i++)
+	esuel.setup(nelem, nfael);
+	for(amc_int ielem = 0; ielem < nelem; ielem++)
+		for(int ifael = 0; ifael < nfael; ifael++)
 		{
-			int ielem = esup(i);
-			int inode;
+			const amc_int jfac = match[ielem*nfael+ifael];
+			esuel(ielem,ifael) = (jfac >= 0 && jfac < nelfac) ? jfac/nfael : -1;
+		}
 
-			// find local node number of ip in ielem -- needed for anything except tetrahedral mesh
-			for(int jnode = 0; jnode < nnode; jnode++)
-				if(inpoel(ielem,jnode) == ip) inode = jnode;
+	bfaceHostCell.setup(nface > 0 ? nface : 1, 1);
+	for(amc_int iface = 0; iface < nface; iface++)
+	{
+		const amc_int jfac = match[nelfac+iface];
+		bfaceHostCell(iface) = (jfac >= 0 && jfac < nelfac) ? jfac/nfael : -1;
+	}
+}
 
-			std::vector<bool> nbd(nnode);		// contains true if that local node number is connected to inode
-			for(int j = 0; j < nnode; j++)
-				nbd[j] = false;
+void UMesh::compute_topological()
+{
+	std::cout << "UMesh: compute_topological(): Calculating and storing topological information..." << std::endl;
+	amc_int ied, i, iel, jel;
+	
+	//1. Elements surrounding points
+	compute_elementsSurroundingPoints();
 
-			if(nnode == 4)					// for a tet, all local nodes are connected to any given node
-			{
-				for(int inb = 0; inb < nbd.size(); inb++)
-					nbd[inb] = true;
-			}
-			if(nnode == 8)					// for a hex, hard-code based on local point numbering
-			{
-				if(inode==0) { nbd[1] = true; nbd[3] = true; nbd[4] = true; }
-				else if(inode==1) { nbd[0] = true; nbd[2] = true; nbd[5] = true; }
-				else if(inode==2) { nbd[1] = nbd[3] = nbd[6] = true; }
-				else if(inode==3) { nbd[2] = nbd[0] = nbd[7] = true; }
-				else if(inode==4) { nbd[0] = nbd[5] = nbd[7] = true; }
-				else if(inode==5) { nbd[1] = nbd[4] = nbd[6] = true; }
-				else if(inode==6) { nbd[2] = nbd[5] = nbd[7] = true; }
-				else if(inode==7) { nbd[3] = nbd[6] = nbd[4] = true; }
-				else std::cout << "! UMesh3d: compute_topological(): Error in psup!" << std::endl;
-			}
+	//2. Points surrounding points - works only for tets and hexes!!
+	std::cout << "UMesh2d: compute_topological(): Points surrounding points\n";
+	std::vector<amc_int> lpoin(npoin);		// lpoin[j] is the point of which j was last found to be a surrounding point
+	std::vector<bool> nbd(nnode);			// contains true if that local node number is connected to inode
+	psup_p.assign(npoin+1, 0);
 
-			for(int jnode = 0; jnode < nnode; jnode++)
+	// first pass: count surrounding points; second pass: store them
+	for(int ipass = 0; ipass < 2; ipass++)
+	{
+		if(ipass == 1)
+		{
+			for(int i = 0; i < npoin; i++)
+				psup_p[i+1] += psup_p[i];
+			psup.resize(psup_p[npoin]);
+		}
+		for(int i = 0; i < npoin; i++)
+			lpoin[i] = -1;
+
+		for(int ip = 0; ip < npoin; ip++)
+		{
+			lpoin[ip] = ip;
+			amc_int istor = psup_p[ip];
+			// iterate over elements surrounding point
+			for(int i = esup_p(ip); i < esup_p(ip+1); i++)
 			{
-				int jpoin = inpoel(ielem, jnode);
-				if(lpoin(jpoin) != ip && nbd[jnode] == true)
+				int ielem = esup(i);
+				int inode;
+
+				// find local node number of ip in ielem -- needed for anything except tetrahedral mesh
+				for(int jnode = 0; jnode < nnode; jnode++)
+					if(inpoel(ielem,jnode) == ip) inode = jnode;
+
+				for(int j = 0; j < nnode; j++)
+					nbd[j] = false;
+
+				if(nnode == 4)					// for a tet, all local nodes are connected to any given node
+				{
+					for(int inb = 0; inb < nnode; inb++)
+						nbd[inb] = true;
+				}
+				if(nnode == 8)					// for a hex, hard-code based on local point numbering
 				{
-					psup[ip].push_back(jpoin);
-					lpoin(jpoin) = ip;
+					if(inode==0) { nbd[1] = true; nbd[3] = true; nbd[4] = true; }
+					else if(inode==1) { nbd[0] = true; nbd[2] = true; nbd[5] = true; }
+					else if(inode==2) { nbd[1] = nbd[3] = nbd[6] = true; }
+					else if(inode==3) { nbd[2] = nbd[0] = nbd[7] = true; }
+					else if(inode==4) { nbd[0] = nbd[5] = nbd[7] = true; }
+					else if(inode==5) { nbd[1] = nbd[4] = nbd[6] = true; }
+					else if(inode==6) { nbd[2] = nbd[5] = nbd[7] = true; }
+					else if(inode==7) { nbd[3] = nbd[6] = nbd[4] = true; }
+					else std::cout << "! UMesh3d: compute_topological(): Error in psup!" << std::endl;
+				}
+
+				for(int jnode = 0; jnode < nnode; jnode++)
+				{
+					int jpoin = inpoel(ielem, jnode);
+					if(lpoin[jpoin] != ip && nbd[jnode] == true)
+					{
+						if(ipass == 0)
+							psup_p[ip+1]++;
+						else
+							psup[istor++] = jpoin;
+						lpoin[jpoin] = ip;
+					}
 				}
 			}
 		}
-		for(int i = 0; i < npoin; i++)
-			lpoin(i,0) = -1;
 	}
 	//Points surrounding points is done.
 
-	// 3. calculate number of edges using psup
+	// 3. calculate number of edges using psup; each edge is found from its endpoint with the smaller index
 	std::cout << "UMesh: compute_topological(): calculate number of edges using psup" << std::endl;
 	nedge = 0; nbedge = 0;
-	lpoin.zeros();
 
 	for(int ipoin = 0; ipoin < npoin; ipoin++)
-	{
-		lpoin(ipoin) = 1;
-		for(int jp = 0; jp < psup[ipoin].size(); jp++)
-		{
-			int jpoin = psup[ipoin].at(jp);
-
-			if(lpoin(jpoin) != 1)
+		for(const amc_int jpoin : gpsuprange(ipoin))
+			if(jpoin > ipoin)
 				nedge++;
-		}
-	}
-
-	for(int i = 0; i < npoin; i++)
-		lpoin(i) = 0;
 
 	std::cout << "UMesh3d: compute_topological(): Number of edges = " << nedge << std::endl;
 
-	elsed = new std::vector<int>[nedge];
-	for(int i = 0; i < nedge; i++)
-		elsed[i].reserve(8);
 	edgepo.setup(nedge, nnoded);
 
 	// 4. get edgepo and edsup
@@ -1090,143 +1046,92 @@ void UMesh::compute_topological()
 
 	// first, boundary edges
 	nbedge = 0;
-
 	for(int ipoin = 0; ipoin < npoin; ipoin++)
-	{
-		lpoin(ipoin) = 1;
-		for(int jp = 0; jp < psup[ipoin].size(); jp++)
-		{
-			int jpoin = psup[ipoin][jp];
-			if(lpoin.get(jpoin) != 1 && flag_bpoin.get(ipoin)==1 && flag_bpoin.get(jpoin)==1)
+		for(const amc_int jpoin : gpsuprange(ipoin))
+			if(jpoin > ipoin && flag_bpoin.get(ipoin)==1 && flag_bpoin.get(jpoin)==1)
 			{
 				edgepo(nbedge,0) = ipoin;
 				edgepo(nbedge,1) = jpoin;
-				edsup[ipoin].push_back(nbedge);
-				edsup[ipoin].push_back(nbedge);
 				nbedge++;
 			}
-		}
-	}
 
 	std::cout << "UMesh3d: compute_topological(): Number of boundary edges = " << nbedge << std::endl;
-	for(int i = 0; i < npoin; i++)
-		lpoin(i) = 0;
 
-	//std::cout << "UMesh3d: compute_topological(): Calculating edgepo - interior" << std::endl;
 	nedge = nbedge;
 	for(int ipoin = 0; ipoin < npoin; ipoin++)
-	{
-		lpoin(ipoin) = 1;
-		for(int jp = 0; jp < psup[ipoin].size(); jp++)
-		{
-			int jpoin = psup[ipoin].at(jp);
-			if(lpoin(jpoin) != 1 && !(flag_bpoin.get(ipoin)==1 && flag_bpoin.get(jpoin)==1) )
+		for(const amc_int jpoin : gpsuprange(ipoin))
+			if(jpoin > ipoin && !(flag_bpoin.get(ipoin)==1 && flag_bpoin.get(jpoin)==1) )
 			{
 				edgepo(nedge,0) = ipoin;
 				edgepo(nedge,1) = jpoin;
-				edsup[ipoin].push_back(nedge);
-				edsup[ipoin].push_back(nedge);
 				nedge++;
 			}
-		}
-	}
+
+	// edges surrounding points, in increasing order of edge index
+	edsup_p.assign(npoin+1, 0);
+	for(ied = 0; ied < nedge; ied++)
+		for(i = 0; i < nnoded; i++)
+			edsup_p[edgepo(ied,i)+1]++;
+	for(i = 0; i < npoin; i++)
+		edsup_p[i+1] += edsup_p[i];
+	edsup.resize(edsup_p[npoin]);
+	for(i = 0; i < npoin; i++)
+		lpoin[i] = edsup_p[i];
+	for(ied = 0; ied < nedge; ied++)
+		for(i = 0; i < nnoded; i++)
+			edsup[lpoin[edgepo(ied,i)]++] = ied;
 
 	// 5. Get elsed (elements surrounding each edge) using esup
 	std::cout << "UMesh3d: compute_topological(): Calculating elsed" << std::endl;
 	amat::Matrix<int> lelem(nelem,1);
+	lelem.zeros();
 	amc_int* ip = new amc_int[nnoded];
+	elsed_p.assign(nedge+1, 0);
 
-	for( ied = 0; ied < nedge; ied++)
+	// first pass: count elements surrounding each edge; second pass: store them
+	for(int ipass = 0; ipass < 2; ipass++)
 	{
-		for( i = 0; i < nnoded; i++)
-			ip[i] = edgepo(ied,i);
-
-		lelem.zeros();
-		for( iel = esup_p(ip[0]); iel < esup_p(ip[0]+1); iel++)
+		if(ipass == 1)
 		{
-			lelem(esup(iel)) = 1;
+			for( ied = 0; ied < nedge; ied++)
+				elsed_p[ied+1] += elsed_p[ied];
+			elsed.resize(elsed_p[nedge]);
 		}
 
-		for( jel = esup_p(ip[1]+1)-1; jel >= esup_p(ip[1]); jel--)
+		for( ied = 0; ied < nedge; ied++)
 		{
-			if(lelem(esup(jel)) == 1)
-				elsed[ied].push_back(esup(jel));
-		}
-	}
-
-	delete [] ip;
-
-	// 6. Elements surrounding elements
-	std::cout << "UMesh3d: compute_topological(): Elements surrounding elements...\n";
-
-	esuel.setup(nelem, nfael);
-	for(int ii = 0; ii < nelem; ii++)
-		for(int jj = 0; jj < nfael; jj++)
-			esuel(ii,jj) = -1;
+			for( i = 0; i < nnoded; i++)
+				ip[i] = edgepo(ied,i);
 
-	lpofa.setup(nfael, nnofa);	// lpofa(i,j) holds local node number of jth node of ith face (j in [0:nnofa], i in [0:nfael])
-
-	if(nnode == 4)								// if tet
-		for(int i = 0; i < nfael; i++)
-		{
-			for(int j = 0; j < nnofa; j++)
+			for( iel = esup_p(ip[0]); iel < esup_p(ip[0]+1); iel++)
 			{
-				//lpofa(i,j) = perm(0,nnode-1,i,j);
-				lpofa(i,j) = (i+j)%nnode;
+				lelem(esup(iel)) = 1;
 			}
-		}
-
-	if(nnode == 8)								// if hex
-	{
-		lpofa(0,0) = 0; lpofa(0,1) = 3; lpofa(0,2) = 2; lpofa(0,3) = 1;
-		lpofa(1,0) = 0; lpofa(1,1) = 1; lpofa(1,2) = 5; lpofa(1,3) = 4;
-		lpofa(2,0) = 0; lpofa(2,1) = 4; lpofa(2,2) = 7; lpofa(2,3) = 3;
-		lpofa(3,0) = 1; lpofa(3,1) = 2; lpofa(3,2) = 6; lpofa(3,3) = 5;
-		lpofa(4,0) = 2; lpofa(4,1) = 3; lpofa(4,2) = 7; lpofa(4,3) = 6;
-		lpofa(5,0) = 4; lpofa(5,1) = 5; lpofa(5,2) = 6; lpofa(5,3) = 7;
-	}
 
-	amat::Matrix<int> lhelp(nnofa,1);
-	lhelp.zeros();
-	lpoin.zeros();
-
-	for(int ielem = 0; ielem < nelem; ielem++)
-	{
-		for(int ifael = 0; ifael < nfael; ifael++)
-		{
-			for(int i = 0; i < nnofa; i++)
-			{
-				lhelp(i) = inpoel(ielem, lpofa(ifael,i));		// lhelp stores global node nos. of current face of current element
-				lpoin(lhelp(i)) = 1;
-			}
-			int ipoin = lhelp(0);								// ipoin is the global node number of first point of this face
-			for(int istor = esup_p(ipoin); istor < esup_p(ipoin+1); istor++)
+			amc_int istor = elsed_p[ied];
+			for( jel = esup_p(ip[1]+1)-1; jel >= esup_p(ip[1]); jel--)
 			{
-				int jelem = esup(istor);
-				if(jelem != ielem)
+				if(lelem(esup(jel)) == 1)
 				{
-					for(int jfael = 0; jfael < nfael; jfael++)
-					{
-						//Assume that no. of nodes in face ifael is same as that in face jfael
-						int icoun = 0;
-						for(int jnofa = 0; jnofa < nnofa; jnofa++)
-						{
-							int jpoin = inpoel(jelem, lpofa(jfael,jnofa));
-							if(lpoin(jpoin)==1) icoun++;
-						}
-						if(icoun == nnofa)		// if all nnofa points of face ifael are found in face jfael, they both are the same face
-						{
-							esuel(ielem,ifael) = jelem;
-							esuel(jelem,jfael) = ielem;
-						}
-					}
+					if(ipass == 0)
+						elsed_p[ied+1]++;
+					else
+						elsed[istor++] = esup(jel);
 				}
 			}
-			for(int i = 0; i < nnofa; i++)
-				lpoin(lhelp(i)) = 0;
+
+			// reset only the marked elements, so that this is not quadratic in the number of elements
+			for( iel = esup_p(ip[0]); iel < esup_p(ip[0]+1); iel++)
+				lelem(esup(iel)) = 0;
 		}
 	}
 
+	delete [] ip;
+
+	// 6. Elements surrounding elements
+	std::cout << "UMesh3d: compute_topological(): Elements surrounding elements...\n";
+	compute_elementsSurroundingElements();
+
 	/** Computes, for each face, the elements on either side, the starting node and the ending node of the face. This is stored in intfac.
 	The orientation of the face is such that the face points towards the element with larger index.
 	NOTE: After the following portion, esuel holds (nelem + face no.) for each ghost cell, instead of -1 as before.*/
@@ -1708,7 +1613,7 @@ UMesh UMesh::convertLinearToQuadratic()
 	q.edgepo.setup(q.nedge,q.nnoded);
 	q.flag_bpoin.setup(q.npoin,1);
 
-	int ipoin, inode, idim, i, j, inofa, jnofa, ifnode, elem, ielem, iface, ibface;
+	int ipoin, inode, idim, i, j, inofa, jnofa, ifnode, elem, iface, ibface;
 	
 	// copy nodes, elements and bfaces
 
@@ -2115,9 +2020,8 @@ UMesh UMesh::convertLinearToQuadratic()
 
 			// add to elements surrounding edge
 			//std::cout << "add to elements surr edge" << std::endl;
-			for(ielem = 0; ielem < elsed[ied].size(); ielem++)
+			for(const amc_int elem : gelsedrange(ied))
 			{
-				elem = elsed[ied].at(ielem);
 
 				if((edgepo.get(ied,0)==inpoel(elem,0)&&edgepo.get(ied,1)==inpoel(elem,1)) || (edgepo.get(ied,1)==inpoel(elem,0)&&edgepo.get(ied,0)==inpoel(elem,1)))
 					q.inpoel(elem,8) = cono;
@@ -2201,9 +2105,8 @@ UMesh UMesh::convertLinearToQuadratic()
 				q.coords(cono, idim) = centre[idim];
 
 			// add to elements surrounding edge
-			for(ielem = 0; ielem < elsed[ied].size(); ielem++)
+			for(const amc_int elem : gelsedrange(ied))
 			{
-				elem = elsed[ied].at(ielem);
 
 				if((edgepo(ied,0)==inpoel(elem,0)&&edgepo(ied,1)==inpoel(elem,1)) || (edgepo(ied,1)==inpoel(elem,0)&&edgepo(ied,0)==inpoel(elem,1)))
 					q.inpoel(elem,8) = cono;
@@ -2258,9 +2161,8 @@ UMesh UMesh::convertLinearToQuadratic()
 			q.coords(cono, idim) = centre[idim];
 
 		// add to elements surrounding edge NOTE: ordering of nodes is taken from Gmsh docs
-		for(int ielem = 0; ielem < elsed[ied].size(); ielem++)
+		for(const amc_int elem : gelsedrange(ied))
 		{
-			int elem = elsed[ied][ielem];
 
 			if((edgepo(ied,0)==inpoel(elem,0)&&edgepo(ied,1)==inpoel(elem,1)) || (edgepo(ied,1)==inpoel(elem,0)&&edgepo(ied,0)==inpoel(elem,1)))
 				q.inpoel(elem,4) = cono;
@@ -2328,9 +2230,8 @@ UMesh UMesh::convertLinearToQuadratic()
 			q.coords(cono, idim) = centre[idim];
 
 		// add to elements surrounding edge NOTE: ordering of nodes is taken from Gmsh docs
-		for(int ielem = 0; ielem < elsed[ied].size(); ielem++)
+		for(const amc_int elem : gelsedrange(ied))
 		{
-			int elem = elsed[ied].at(ielem);
 
 			if((edgepo(ied,0)==inpoel(elem,0)&&edgepo(ied,1)==inpoel(elem,1)) || (edgepo(ied,1)==inpoel(elem,0)&&edgepo(ied,0)==inpoel(elem,1)))
 				q.inpoel(elem,4) = cono;
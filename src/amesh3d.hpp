@@ -33,6 +33,18 @@
 #include "adatastructures.hpp"
 #endif
 
+#ifndef __AFACEMATCH_H
+#include "afacematch.hpp"
+#endif
+
+#ifndef __AGMSHREADER_H
+#include "agmshreader.hpp"
+#endif
+
+#ifndef __ASNAPSHOT_H
+#include "asnapshot.hpp"
+#endif
+
 #define __AMESH3D_H
 
 /**
@@ -77,11 +89,14 @@ private:
 	amat::Matrix<amc_real> lpofa;		///< for each face of an element, it contains local node numbers of the nodes forming that face. Assumed to be same for all elements.
 	amat::Matrix<amc_int> esup;			///< elements surrounding points
 	amat::Matrix<int> esup_p;			///< array containing index of esup where elements surrounding a certain point start
-	std::vector<int>* psup;				///< points surrounding points
+	std::vector<amc_int> psup;			///< points surrounding points
+	std::vector<amc_int> psup_p;		///< index of psup where points surrounding a certain point start
 	amat::Matrix<amc_int> esuel;		///< elements surrounding elements
 	amat::Matrix<amc_int> edgepo;		///< edge data structure. Stores the indices of the points making up the edge.
-	std::vector<amc_int>* edsup;		///< edges surrounding point
-	std::vector<int>* elsed;			///< elements surrounding edge; note that ordering of edges is same as in [edgepo](@ref edgepo)
+	std::vector<amc_int> edsup;			///< edges surrounding point
+	std::vector<amc_int> edsup_p;		///< index of edsup where edges surrounding a certain point start
+	std::vector<amc_int> elsed;			///< elements surrounding edge; note that ordering of edges is same as in [edgepo](@ref edgepo)
+	std::vector<amc_int> elsed_p;		///< index of elsed where elements surrounding a certain edge start
 	amat::Matrix<amc_int> intfac;		///< face data strcture
 	
 	amat::Matrix<amc_int> bpoints;		///< an ordering of the boundary points, containing corresponding node numbers in coords
@@ -96,7 +111,7 @@ private:
 										  Contains, for each b-edge, the two bfaces forming it and the nodes that it consists of.
 											NOTE: The edge may not always point from smaller index cell to larger index cell! 
 											The edge direction may not be consistent. */
-	amat::Matrix<amc_int> bfaceHostCell;		///< Stores the host element number for each bface, computed (inefficiently) by findBfaceHostCell()
+	amat::Matrix<amc_int> bfaceHostCell;		///< Stores the host element number for each bface, computed by findBfaceHostCell()
 
 public:
 
@@ -147,13 +162,20 @@ public:
 	int glpofa(amc_int iface, int ifnode) const { return lpofa.get(iface, ifnode); }
 	amc_int gesup(amc_int i) const { return esup.get(i); }
 	amc_int gesup_p(amc_int i) const { return esup_p.get(i); }
-	amc_int gpsup(amc_int i, int j) const { return psup[i].at(j); }		// get jth surrounding point of ith node
-	amc_int gpsupsize(amc_int i) const { return psup[i].size(); }
+	amc_int gpsup(amc_int i, int j) const { return psup[psup_p[i]+j]; }		// get jth surrounding point of ith node
+	amc_int gpsupsize(amc_int i) const { return psup_p[i+1]-psup_p[i]; }
 	amc_int gedgepo(amc_int iedge, int ipoin) const { return edgepo.get(iedge,ipoin); }
-	amc_int gedsup(amc_int ipoin, int j) const { return edsup[ipoin][j]; }
-	amc_int gedsupsize(amc_int ipoin) const { return edsup[ipoin].size(); }
-	amc_int gelsed(amc_int iedge, int ielem) const { return elsed[iedge].at(ielem); }
-	amc_int gelsedsize(amc_int iedge) const { return elsed[iedge].size(); }
+	amc_int gedsup(amc_int ipoin, int j) const { return edsup[edsup_p[ipoin]+j]; }
+	amc_int gedsupsize(amc_int ipoin) const { return edsup_p[ipoin+1]-edsup_p[ipoin]; }
+	amc_int gelsed(amc_int iedge, int ielem) const { return elsed[elsed_p[iedge]+ielem]; }
+	amc_int gelsedsize(amc_int iedge) const { return elsed_p[iedge+1]-elsed_p[iedge]; }
+
+	/// Points surrounding point ipoin, for use in range-based for loops
+	ArrayRange<amc_int> gpsuprange(amc_int ipoin) const { return ArrayRange<amc_int>(psup.data()+psup_p[ipoin], psup.data()+psup_p[ipoin+1]); }
+	/// Edges surrounding point ipoin, for use in range-based for loops
+	ArrayRange<amc_int> gedsuprange(amc_int ipoin) const { return ArrayRange<amc_int>(edsup.data()+edsup_p[ipoin], edsup.data()+edsup_p[ipoin+1]); }
+	/// Elements surrounding edge iedge, for use in range-based for loops
+	ArrayRange<amc_int> gelsedrange(amc_int iedge) const { return ArrayRange<amc_int>(elsed.data()+elsed_p[iedge], elsed.data()+elsed_p[iedge+1]); }
 	amc_int gesuel(amc_int ielem, int jnode) const { return esuel.get(ielem, jnode); }
 	amc_int gintfac(amc_int face, int i) const { return intfac.get(face,i); }
 	amc_int gbfsubp_p(amc_int i) const { return bfsubp_p.get(i); }
@@ -212,6 +234,10 @@ public:
 	void findLocalFaceLocalPointConnectivityLinearElements(amat::Matrix<int>& lpofal);
 	
 	/// Finds the host element for each boundary face and stores in bfaceHostCell
+	/** Only the elements surrounding the first node of each face are searched, so this needs esup;
+	 * esup is computed if it is not available, but the rest of compute_topological() is not needed.
+	 * Faces for which no host element is found get -1.
+	 */
 	void findBfaceHostCell();
 
 	/// Writes mesh to Gmsh2 file format
@@ -244,12 +270,33 @@ public:
 	 * 		end do
 	 */
 	void writeDomn(std::string mfile, std::vector<int> farfieldnumber, std::vector<int> symmetrynumber, std::vector<int> wallnumber);
+
+	/// Writes the mesh to a binary [snapshot](@ref asnapshot.hpp) file, along with whatever connectivity data has been computed
+	/** Reading the snapshot with [readSnapshot](@ref readSnapshot) restores the mesh without having to call compute_topological()
+	 * or compute_boundary_topological() again, if they were called before writing it.
+	 */
+	void writeSnapshot(std::string mfile) const;
+
+	/// Reads a mesh, and any connectivity data stored with it, from a snapshot file written by [writeSnapshot](@ref writeSnapshot)
+	/** Connectivity arrays absent from the file are emptied. Returns false if the file could not be read.
+	 */
+	bool readSnapshot(std::string mfile);
 	
 	/// Computes jacobians for linear elements
 	/** Currently only for tetrahedra
 	 */
 	void compute_jacobians();
 
+	/// Computes elements surrounding points (esup and esup_p)
+	void compute_elementsSurroundingPoints();
+
+	/// Computes elements surrounding elements (esuel) and the host element of each boundary face (bfaceHostCell)
+	/** Faces are matched by sorting their vertex numbers (see match_faces()), so this takes linear time and does not need esup.
+	 * Entries of esuel for faces on the boundary are -1. Also sets up [lpofa](@ref lpofa).
+	 * \note Only for linear tetrahedral and hexahedral meshes.
+	 */
+	void compute_elementsSurroundingElements();
+
 	/** \brief Computes various connectivity data structures for the mesh.
 	 *
 	 * These include
@@ -1,234 +1,553 @@
-/** @file aoutput.cpp
- * @brief Implementation of subroutines to write mesh data to various kinds of output formats
- */
-
-#include <aoutput.hpp>
-
-/** Writes multiple scalar data sets and one vector data set, all cell-centered data, to a file in VTU format.
- * If either x or y is a 0x0 matrix, it is ignored.
- * \param fname is the output vtu file name
- */
-void writeScalarsVectorToVtu_CellData(std::string fname, const amc::UMesh2d& m, const amat::Matrix<double>& x, std::string scaname[], const amat::Matrix<double>& y, std::string vecname)
-{
-	int elemcode = 5;
-	if(m.gnnode() == 4)
-		elemcode = 9;
-	else if(m.gnnode() == 6)
-		elemcode = 22;
-	else if(m.gnnode() == 8)
-		elemcode = 23;
-	else if(m.gnnode() == 9)
-		elemcode = 28;
-	
-	std::cout << "aoutput: Writing vtu output...\n";
-	std::ofstream out(fname);
-
-	int nscalars = x.cols();
-
-	out << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
-	out << "<UnstructuredGrid>\n";
-	out << "\t<Piece NumberOfPoints=\"" << m.gnpoin() << "\" NumberOfCells=\"" << m.gnelem() << "\">\n";
-
-	//out << "\t\t<CellData Scalars=\""<<scaname[0]<< "\" Vectors=\"" << vecname << "\">\n";
-	
-	if(x.msize()>0 || y.msize()>0) {
-		out << "\t\t<CellData ";
-		if(x.msize() > 0)
-			out << "Scalars=\"" << scaname[0] << "\" ";
-		if(y.msize() > 0)
-			out << "Vectors=\"" << vecname << "\"";
-		out << ">\n";
-	}
-	
-	//enter cell scalar data if available
-	if(x.msize() > 0) {
-		//cout << "aoutput: Writing scalars..\n";
-		for(int in = 0; in < nscalars; in++)
-		{
-			out << "\t\t\t<DataArray type=\"Float64\" Name=\"" << scaname[in] << "\" Format=\"ascii\">\n";
-			for(int i = 0; i < m.gnelem(); i++)
-				out << "\t\t\t\t" << x.get(i,in) << '\n';
-			out << "\t\t\t</DataArray>\n";
-		}
-		//cout << "aoutput: Scalars written.\n";
-	}
-
-	//enter vector cell data if available
-	if(y.msize() > 0) {
-		out << "\t\t\t<DataArray type=\"Float64\" Name=\"" << vecname << "\" NumberOfComponents=\"3\" Format=\"ascii\">\n";
-		for(int i = 0; i < m.gnelem(); i++)
-		{
-			out << "\t\t\t\t";
-			for(int idim = 0; idim < y.cols(); idim++)
-				out << y.get(i,idim) << " ";
-			if(y.cols() == 2)
-				out << "0.0 ";
-			out << '\n';
-		}
-		out << "\t\t\t</DataArray>\n";
-	}
-	if(x.msize() > 0 || y.msize() > 0)
-		out << "\t\t</CellData>\n";
-
-	//enter points
-	out << "\t\t<Points>\n";
-	out << "\t\t<DataArray type=\"Float64\" NumberOfComponents=\"3\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnpoin(); i++)
-	{
-		out << "\t\t\t";
-		for(int idim = 0; idim < m.gndim(); idim++)
-			out << m.gcoords(i,idim) << " ";
-		if(m.gndim() == 2)
-			out << "0.0 ";
-		out << '\n';
-	}
-	out << "\t\t</DataArray>\n";
-	out << "\t\t</Points>\n";
-
-	//enter cells
-	out << "\t\t<Cells>\n";
-	out << "\t\t\t<DataArray type=\"UInt32\" Name=\"connectivity\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnelem(); i++) {
-		out << "\t\t\t\t"; 
-		for(int inode = 0; inode < m.gnnode(); inode++)	
-			out << m.ginpoel(i,inode) << " ";
-		out << '\n';
-	}
-	out << "\t\t\t</DataArray>\n";
-	out << "\t\t\t<DataArray type=\"UInt32\" Name=\"offsets\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnelem(); i++)
-		out << "\t\t\t\t" << m.gnnode()*(i+1) << '\n';
-	out << "\t\t\t</DataArray>\n";
-	out << "\t\t\t<DataArray type=\"Int32\" Name=\"types\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnelem(); i++)
-		out << "\t\t\t\t" << elemcode << '\n';
-	out << "\t\t\t</DataArray>\n";
-	out << "\t\t</Cells>\n";
-
-	//finish upper
-	out << "\t</Piece>\n";
-	out << "</UnstructuredGrid>\n";
-	out << "</VTKFile>";
-	out.close();
-	std::cout << "Vtu file written.\n";
-}
-
-
-/// Writes a quadratic mesh in VTU format.
-/** VTK does not have a 9-node quadrilateral, so we ignore the cell-centered note for output.
- */
-void writeQuadraticMeshToVtu(std::string fname, amc::UMesh2d& m)
-{
-	int elemcode = 5;
-	if(m.gnnode() == 4)
-		elemcode = 9;
-	else if(m.gnnode() == 6)
-		elemcode = 22;
-	else if(m.gnnode() == 8)
-		elemcode = 23;
-	else if(m.gnnode() == 9)
-		elemcode = 23;
-
-	std::cout << "Writing vtu output...\n";
-	std::ofstream out(fname);
-
-	out << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
-	out << "<UnstructuredGrid>\n";
-	out << "\t<Piece NumberOfPoints=\"" << m.gnpoin() << "\" NumberOfCells=\"" << m.gnelem() << "\">\n";
-
-	//enter points
-	out << "\t\t<Points>\n";
-	out << "\t\t<DataArray type=\"Float64\" NumberOfComponents=\"3\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnpoin(); i++)
-		out << "\t\t\t" << m.gcoords(i,0) << " " << m.gcoords(i,1) << " " << 0.0 << '\n';
-	out << "\t\t</DataArray>\n";
-	out << "\t\t</Points>\n";
-
-	//enter cells
-	out << "\t\t<Cells>\n";
-	out << "\t\t\t<DataArray type=\"UInt32\" Name=\"connectivity\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnelem(); i++)
-	{
-		out << "\t\t\t\t";
-		for(int j = 0; j < m.gnnode(); j++)
-			out << m.ginpoel(i,j) << " ";
-		out << '\n';
-	}
-	out << "\t\t\t</DataArray>\n";
-	out << "\t\t\t<DataArray type=\"UInt32\" Name=\"offsets\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnelem(); i++)
-		out << "\t\t\t\t" << m.gnnode()*(i+1) << '\n';
-	out << "\t\t\t</DataArray>\n";
-	out << "\t\t\t<DataArray type=\"Int32\" Name=\"types\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnelem(); i++)
-		out << "\t\t\t\t" << elemcode << '\n';
-	out << "\t\t\t</DataArray>\n";
-	out << "\t\t</Cells>\n";
-
-	//finish upper
-	out << "\t</Piece>\n";
-	out << "</UnstructuredGrid>\n";
-	out << "</VTKFile>";
-	out.close();
-	std::cout << "Vtu file written.\n";
-}
-
-/// Writes a hybrid mesh in VTU format.
-/** VTK does not have a 9-node quadrilateral, so we ignore the cell-centered note for output.
- */
-void writeMeshToVtu(std::string fname, amc::UMesh2dh& m)
-{
-	std::cout << "Writing vtu output...\n";
-	std::ofstream out(fname);
-
-	out << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
-	out << "<UnstructuredGrid>\n";
-	out << "\t<Piece NumberOfPoints=\"" << m.gnpoin() << "\" NumberOfCells=\"" << m.gnelem() << "\">\n";
-
-	//enter points
-	out << "\t\t<Points>\n";
-	out << "\t\t<DataArray type=\"Float64\" NumberOfComponents=\"3\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnpoin(); i++)
-		out << "\t\t\t" << m.gcoords(i,0) << " " << m.gcoords(i,1) << " " << 0.0 << '\n';
-	out << "\t\t</DataArray>\n";
-	out << "\t\t</Points>\n";
-
-	//enter cells
-	out << "\t\t<Cells>\n";
-	out << "\t\t\t<DataArray type=\"UInt32\" Name=\"connectivity\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnelem(); i++)
-	{
-		out << "\t\t\t\t";
-		for(int j = 0; j < m.gnnode(i); j++)
-			out << m.ginpoel(i,j) << " ";
-		out << '\n';
-	}
-	out << "\t\t\t</DataArray>\n";
-	out << "\t\t\t<DataArray type=\"UInt32\" Name=\"offsets\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnelem(); i++)
-		out << "\t\t\t\t" << m.gnnode(i)*(i+1) << '\n';
-	out << "\t\t\t</DataArray>\n";
-	out << "\t\t\t<DataArray type=\"Int32\" Name=\"types\" Format=\"ascii\">\n";
-	for(int i = 0; i < m.gnelem(); i++)
-	{
-		int elemcode = 5;
-		if(m.gnnode(i) == 4)
-			elemcode = 9;
-		else if(m.gnnode(i) == 6)
-			elemcode = 22;
-		else if(m.gnnode(i) == 8)
-			elemcode = 23;
-		else if(m.gnnode(i) == 9)
-			elemcode = 23;
-			out << "\t\t\t\t" << elemcode << '\n';
-	}
-	out << "\t\t\t</DataArray>\n";
-	out << "\t\t</Cells>\n";
-
-	//finish upper
-	out << "\t</Piece>\n";
-	out << "</UnstructuredGrid>\n";
-	out << "</VTKFile>";
-	out.close();
-	std::cout << "Vtu file written.\n";
-}
+/** @file aoutput.cpp
+ * @brief Implementation of subroutines to write mesh data to various kinds of output formats
+ */
+
+#include <aoutput.hpp>
+
+#ifndef _GLIBCXX_VECTOR
+#include <vector>
+#endif
+
+#ifndef _GLIBCXX_CSTDINT
+#include <cstdint>
+#endif
+
+#ifndef _GLIBCXX_CSTRING
+#include <cstring>
+#endif
+
+#ifdef ZLIB_LIBRARY
+#include <zlib.h>
+#endif
+
+/// Size of the blocks in which data is compressed; this is what VTK itself uses
+#define VTU_COMPRESSION_BLOCK_SIZE 32768
+
+/// VTK type names of the types that are written out
+template <typename T> struct vtk_type_name;
+template <> struct vtk_type_name<double> { static const char* get() { return "Float64"; } };
+template <> struct vtk_type_name<int> { static const char* get() { return "Int32"; } };
+template <> struct vtk_type_name<uint8_t> { static const char* get() { return "UInt8"; } };
+
+/// Encodes n bytes in base64 and appends the result to out
+static void base64_encode(const unsigned char* const data, const size_t n, std::string& out)
+{
+	static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	const size_t start = out.size();
+	const long ngroups = (long)(n/3);
+	out.resize(start + 4*((n+2)/3));
+	char* const o = &out[start];
+
+	// groups of 3 bytes become 4 characters
+	#pragma omp parallel for default(none) shared(table, data, ngroups, o) schedule(static) if(ngroups > 100000)
+	for(long i = 0; i < ngroups; i++)
+	{
+		const uint32_t v = (uint32_t)data[3*i] << 16 | (uint32_t)data[3*i+1] << 8 | (uint32_t)data[3*i+2];
+		o[4*i] = table[v >> 18];
+		o[4*i+1] = table[(v >> 12) & 63];
+		o[4*i+2] = table[(v >> 6) & 63];
+		o[4*i+3] = table[v & 63];
+	}
+
+	// the last 1 or 2 bytes are padded
+	const size_t rem = n - 3*ngroups;
+	if(rem > 0)
+	{
+		const uint32_t v = (uint32_t)data[3*ngroups] << 16 | (rem == 2 ? (uint32_t)data[3*ngroups+1] << 8 : 0);
+		char* const q = o + 4*ngroups;
+		q[0] = table[v >> 18];
+		q[1] = table[(v >> 12) & 63];
+		q[2] = rem == 2 ? table[(v >> 6) & 63] : '=';
+		q[3] = '=';
+	}
+}
+
+/// Writes the pieces of a VTU file that do not depend on what mesh is being written
+/** Data arrays are written in the chosen encoding. In the binary encodings, each array is preceded by a header of UInt64 values:
+ * its size in bytes if uncompressed; otherwise the number of blocks, the size of a block, the size of the last block if it is partial,
+ * and the compressed size of each block, followed by the zlib-compressed blocks. In the appended encoding,
+ * the DataArray element just gives the offset of the array within the AppendedData section written at the end.
+ */
+class VtuWriter
+{
+	std::ofstream& out;
+	const VtuFormat format;
+	bool compress;
+	std::string appended;			///< Contents of the AppendedData section
+
+	/// Returns the header and the (possibly compressed) data of an array in the binary encodings
+	void encode(const unsigned char* const data, const size_t nbytes, std::vector<uint64_t>& header, std::vector<unsigned char>& body) const
+	{
+#ifdef ZLIB_LIBRARY
+		if(compress)
+		{
+			const long nblocks = (long)((nbytes + VTU_COMPRESSION_BLOCK_SIZE-1) / VTU_COMPRESSION_BLOCK_SIZE);
+			std::vector<std::vector<unsigned char>> blocks(nblocks);
+
+			#pragma omp parallel for default(none) shared(blocks, data, nbytes, nblocks) schedule(dynamic,16)
+			for(long ib = 0; ib < nblocks; ib++)
+			{
+				const size_t start = (size_t)ib*VTU_COMPRESSION_BLOCK_SIZE;
+				const size_t len = std::min((size_t)VTU_COMPRESSION_BLOCK_SIZE, nbytes-start);
+				uLongf clen = compressBound(len);
+				blocks[ib].resize(clen);
+				compress2(blocks[ib].data(), &clen, data+start, len, Z_BEST_SPEED);
+				blocks[ib].resize(clen);
+			}
+
+			header.assign(3+nblocks, 0);
+			header[0] = nblocks;
+			header[1] = VTU_COMPRESSION_BLOCK_SIZE;
+			header[2] = nbytes % VTU_COMPRESSION_BLOCK_SIZE;
+			body.clear();
+			for(long ib = 0; ib < nblocks; ib++) {
+				header[3+ib] = blocks[ib].size();
+				body.insert(body.end(), blocks[ib].begin(), blocks[ib].end());
+			}
+			return;
+		}
+#endif
+		header.assign(1, nbytes);
+		body.assign(data, data+nbytes);
+	}
+
+public:
+	VtuWriter(std::ofstream& outstream, const VtuFormat fmt, const bool compression)
+		: out(outstream), format(fmt), compress(compression && fmt != VTU_ASCII)
+	{
+#ifndef ZLIB_LIBRARY
+		if(compress)
+			std::cout << "! aoutput: Not built with zlib; writing uncompressed output.\n";
+		compress = false;
+#endif
+	}
+
+	/// Writes the VTKFile, UnstructuredGrid and Piece start tags
+	void begin(const amc::amc_int npoin, const amc::amc_int nelem)
+	{
+		if(format == VTU_ASCII)
+			out << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+		else {
+			out << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\"";
+			if(compress)
+				out << " compressor=\"vtkZLibDataCompressor\"";
+			out << ">\n";
+		}
+		out << "<UnstructuredGrid>\n";
+		out << "\t<Piece NumberOfPoints=\"" << npoin << "\" NumberOfCells=\"" << nelem << "\">\n";
+	}
+
+	/// Writes a DataArray element; data contains n tuples of ncomp values each
+	template <typename T>
+	void dataArray(const std::string& indent, const std::string& name, const int ncomp, const std::vector<T>& data)
+	{
+		out << indent << "<DataArray type=\"" << vtk_type_name<T>::get() << "\"";
+		if(name != "")
+			out << " Name=\"" << name << "\"";
+		if(ncomp > 1)
+			out << " NumberOfComponents=\"" << ncomp << "\"";
+
+		if(format == VTU_ASCII)
+		{
+			out << " format=\"ascii\">\n";
+			const size_t n = data.size()/ncomp;
+			for(size_t i = 0; i < n; i++)
+			{
+				out << indent << "\t";
+				for(int j = 0; j < ncomp; j++)
+					out << +data[i*ncomp+j] << " ";		// unary + so that bytes are written as numbers
+				out << '\n';
+			}
+			out << indent << "</DataArray>\n";
+			return;
+		}
+
+		std::vector<uint64_t> header;
+		std::vector<unsigned char> body;
+		encode((const unsigned char*)data.data(), data.size()*sizeof(T), header, body);
+
+		if(format == VTU_BINARY)
+		{
+			// the header and the data are encoded separately, which is what VTK expects
+			std::string enc;
+			base64_encode((const unsigned char*)header.data(), header.size()*sizeof(uint64_t), enc);
+			base64_encode(body.data(), body.size(), enc);
+			out << " format=\"binary\">\n" << indent << "\t" << enc << '\n' << indent << "</DataArray>\n";
+		}
+		else
+		{
+			out << " format=\"appended\" offset=\"" << appended.size() << "\"/>\n";
+			appended.append((const char*)header.data(), header.size()*sizeof(uint64_t));
+			appended.append((const char*)body.data(), body.size());
+		}
+	}
+
+	/// Writes the Points and Cells elements
+	/** \param points contains 3 coordinates of each point
+	 * \param conn contains the node numbers of all cells one after the other
+	 * \param offsets contains, for each cell, the position in conn just after its last node
+	 * \param types contains the VTK cell type of each cell
+	 */
+	void pointsAndCells(const std::vector<double>& points, const std::vector<int>& conn, const std::vector<int>& offsets, const std::vector<uint8_t>& types)
+	{
+		out << "\t\t<Points>\n";
+		dataArray("\t\t", "", 3, points);
+		out << "\t\t</Points>\n";
+		out << "\t\t<Cells>\n";
+		dataArray("\t\t\t", "connectivity", 1, conn);
+		dataArray("\t\t\t", "offsets", 1, offsets);
+		dataArray("\t\t\t", "types", 1, types);
+		out << "\t\t</Cells>\n";
+	}
+
+	/// Closes the Piece, UnstructuredGrid and VTKFile elements, writing any appended data before the last
+	void end()
+	{
+		out << "\t</Piece>\n";
+		out << "</UnstructuredGrid>\n";
+		if(format == VTU_APPENDED) {
+			out << "<AppendedData encoding=\"raw\">\n_";
+			out.write(appended.data(), appended.size());
+			out << "\n</AppendedData>\n";
+		}
+		out << "</VTKFile>";
+	}
+};
+
+/// Copies point coordinates into a list of 3 coordinates per point
+template <class Mesh>
+static void vtu_points(const Mesh& m, std::vector<double>& points)
+{
+	const amc::amc_int npoin = m.gnpoin();
+	const int ndim = m.gndim();
+	points.assign(3*(size_t)npoin, 0.0);
+	for(amc::amc_int i = 0; i < npoin; i++)
+		for(int idim = 0; idim < ndim && idim < 3; idim++)
+			points[3*i+idim] = m.gcoords(i,idim);
+}
+
+/** Writes multiple scalar data sets and one vector data set, all cell-centered data, to a file in VTU format.
+ * If either x or y is a 0x0 matrix, it is ignored.
+ * \param fname is the output vtu file name
+ */
+void writeScalarsVectorToVtu_CellData(std::string fname, const amc::UMesh2d& m, const amat::Matrix<double>& x, std::string scaname[], const amat::Matrix<double>& y, std::string vecname,
+		const VtuFormat format, const bool compress)
+{
+	int elemcode = 5;
+	if(m.gnnode() == 4)
+		elemcode = 9;
+	else if(m.gnnode() == 6)
+		elemcode = 22;
+	else if(m.gnnode() == 8)
+		elemcode = 23;
+	else if(m.gnnode() == 9)
+		elemcode = 28;
+	
+	std::cout << "aoutput: Writing vtu output...\n";
+	std::ofstream out(fname, std::ios::binary);
+	VtuWriter w(out, format, compress);
+
+	int nscalars = x.cols();
+	w.begin(m.gnpoin(), m.gnelem());
+
+	if(x.msize()>0 || y.msize()>0) {
+		out << "\t\t<CellData ";
+		if(x.msize() > 0)
+			out << "Scalars=\"" << scaname[0] << "\" ";
+		if(y.msize() > 0)
+			out << "Vectors=\"" << vecname << "\"";
+		out << ">\n";
+	}
+	
+	//enter cell scalar data if available
+	if(x.msize() > 0) {
+		std::vector<double> vals(m.gnelem());
+		for(int in = 0; in < nscalars; in++)
+		{
+			for(int i = 0; i < m.gnelem(); i++)
+				vals[i] = x.get(i,in);
+			w.dataArray("\t\t\t", scaname[in], 1, vals);
+		}
+	}
+
+	//enter vector cell data if available
+	if(y.msize() > 0) {
+		std::vector<double> vals(3*(size_t)m.gnelem(), 0.0);
+		for(int i = 0; i < m.gnelem(); i++)
+			for(int idim = 0; idim < y.cols() && idim < 3; idim++)
+				vals[3*i+idim] = y.get(i,idim);
+		w.dataArray("\t\t\t", vecname, 3, vals);
+	}
+	if(x.msize() > 0 || y.msize() > 0)
+		out << "\t\t</CellData>\n";
+
+	std::vector<double> points;
+	vtu_points(m, points);
+
+	const int nnode = m.gnnode();
+	std::vector<int> conn((size_t)m.gnelem()*nnode), offsets(m.gnelem());
+	for(int i = 0; i < m.gnelem(); i++) {
+		for(int inode = 0; inode < nnode; inode++)
+			conn[(size_t)i*nnode+inode] = m.ginpoel(i,inode);
+		offsets[i] = nnode*(i+1);
+	}
+	std::vector<uint8_t> types(m.gnelem(), elemcode);
+
+	w.pointsAndCells(points, conn, offsets, types);
+	w.end();
+	out.close();
+	std::cout << "Vtu file written.\n";
+}
+
+
+/// Writes a quadratic mesh in VTU format.
+/** VTK does not have a 9-node quadrilateral, so we ignore the cell-centered note for output.
+ */
+void writeQuadraticMeshToVtu(std::string fname, amc::UMesh2d& m, const VtuFormat format, const bool compress)
+{
+	int elemcode = 5;
+	if(m.gnnode() == 4)
+		elemcode = 9;
+	else if(m.gnnode() == 6)
+		elemcode = 22;
+	else if(m.gnnode() == 8)
+		elemcode = 23;
+	else if(m.gnnode() == 9)
+		elemcode = 23;
+
+	std::cout << "Writing vtu output...\n";
+	std::ofstream out(fname, std::ios::binary);
+	VtuWriter w(out, format, compress);
+	w.begin(m.gnpoin(), m.gnelem());
+
+	std::vector<double> points;
+	vtu_points(m, points);
+
+	const int nnode = m.gnnode();
+	std::vector<int> conn((size_t)m.gnelem()*nnode), offsets(m.gnelem());
+	for(int i = 0; i < m.gnelem(); i++) {
+		for(int j = 0; j < nnode; j++)
+			conn[(size_t)i*nnode+j] = m.ginpoel(i,j);
+		offsets[i] = nnode*(i+1);
+	}
+	std::vector<uint8_t> types(m.gnelem(), elemcode);
+
+	w.pointsAndCells(points, conn, offsets, types);
+	w.end();
+	out.close();
+	std::cout << "Vtu file written.\n";
+}
+
+/// Lists the cells of a hybrid mesh in VTU form
+/** \param conn gets the node numbers of all cells one after the other
+ * \param offsets gets, for each cell, the position in conn just after its last node
+ * \param types gets the VTK cell type of each cell
+ */
+static bool vtu_cells(const amc::UMesh2dh& m, std::vector<int>& conn, std::vector<int>& offsets, std::vector<uint8_t>& types)
+{
+	conn.clear();
+	offsets.resize(m.gnelem());
+	types.resize(m.gnelem());
+	for(int i = 0; i < m.gnelem(); i++)
+	{
+		for(int j = 0; j < m.gnnode(i); j++)
+			conn.push_back(m.ginpoel(i,j));
+		offsets[i] = conn.size();
+
+		int elemcode = 5;
+		if(m.gnnode(i) == 4)
+			elemcode = 9;
+		else if(m.gnnode(i) == 6)
+			elemcode = 22;
+		else if(m.gnnode(i) == 8)
+			elemcode = 23;
+		else if(m.gnnode(i) == 9)
+			elemcode = 23;
+		types[i] = elemcode;
+	}
+	return true;
+}
+
+/// Lists the cells of a 3D mesh in VTU form; returns false if the type of element cannot be written
+static bool vtu_cells(const amc::UMesh& m, std::vector<int>& conn, std::vector<int>& offsets, std::vector<uint8_t>& types)
+{
+	// VTK cell type and number of nodes written for each of our element types
+	int elemcode, nnode = m.gnnode();
+	if(m.gnnode() == 4)
+		elemcode = 10;
+	else if(m.gnnode() == 10)
+		elemcode = 24;
+	else if(m.gnnode() == 8)
+		elemcode = 12;
+	else if(m.gnnode() == 27) {
+		elemcode = 12;
+		nnode = 8;
+	}
+	else {
+		std::cout << "! aoutput: Elements with " << m.gnnode() << " nodes are not supported!" << std::endl;
+		return false;
+	}
+
+	// our 10-node tetrahedra have Gmsh's node ordering, in which the last two nodes are swapped relative to VTK's
+	int vtkorder[10] = {0,1,2,3,4,5,6,7,8,9};
+	if(m.gnnode() == 10) {
+		vtkorder[8] = 9;
+		vtkorder[9] = 8;
+	}
+
+	const amc::amc_int nelem = m.gnelem();
+	conn.resize((size_t)nelem*nnode);
+	offsets.resize(nelem);
+	#pragma omp parallel for default(none) shared(m, conn, offsets, vtkorder, nnode, nelem)
+	for(amc::amc_int i = 0; i < nelem; i++) {
+		for(int j = 0; j < nnode; j++)
+			conn[(size_t)i*nnode+j] = m.ginpoel(i, nnode == 10 ? vtkorder[j] : j);
+		offsets[i] = nnode*(i+1);
+	}
+	types.assign(nelem, elemcode);
+	return true;
+}
+
+/// Writes a mesh, whose cells have been listed by vtu_cells, to a VTU file
+template <class Mesh>
+static void vtu_write_mesh(const std::string& fname, const Mesh& m, const std::vector<int>& conn, const std::vector<int>& offsets,
+		const std::vector<uint8_t>& types, const VtuFormat format, const bool compress)
+{
+	std::ofstream out(fname, std::ios::binary);
+	VtuWriter w(out, format, compress);
+	w.begin(m.gnpoin(), m.gnelem());
+
+	std::vector<double> points;
+	vtu_points(m, points);
+
+	w.pointsAndCells(points, conn, offsets, types);
+	w.end();
+	out.close();
+}
+
+/// Writes the cells numbered from start to end-1 of a mesh, and only the points they use, to a VTU file
+/** The points are re-numbered in the order in which the cells reference them.
+ * \param localno is scratch space of size npoin, which must contain -1 everywhere; it is left that way on return.
+ */
+template <class Mesh>
+static void vtu_write_piece(const std::string& fname, const Mesh& m, const std::vector<int>& conn, const std::vector<int>& offsets,
+		const std::vector<uint8_t>& types, const amc::amc_int start, const amc::amc_int end, std::vector<int>& localno,
+		const VtuFormat format, const bool compress)
+{
+	const int cstart = start > 0 ? offsets[start-1] : 0;
+	const int cend = end > 0 ? offsets[end-1] : 0;
+
+	std::vector<int> pconn(cend-cstart), poffsets(end-start), globalno;
+	for(int k = cstart; k < cend; k++)
+	{
+		const int ip = conn[k];
+		if(localno[ip] < 0) {
+			localno[ip] = globalno.size();
+			globalno.push_back(ip);
+		}
+		pconn[k-cstart] = localno[ip];
+	}
+	for(amc::amc_int i = start; i < end; i++)
+		poffsets[i-start] = offsets[i]-cstart;
+	std::vector<uint8_t> ptypes(types.begin()+start, types.begin()+end);
+
+	const int ndim = m.gndim();
+	std::vector<double> points(3*globalno.size(), 0.0);
+	for(size_t i = 0; i < globalno.size(); i++)
+	{
+		for(int idim = 0; idim < ndim && idim < 3; idim++)
+			points[3*i+idim] = m.gcoords(globalno[i],idim);
+		localno[globalno[i]] = -1;
+	}
+
+	std::ofstream out(fname, std::ios::binary);
+	VtuWriter w(out, format, compress);
+	w.begin(globalno.size(), end-start);
+	w.pointsAndCells(points, pconn, poffsets, ptypes);
+	w.end();
+	out.close();
+}
+
+/// Splits a mesh into npieces contiguous ranges of elements, writes each to a VTU file in parallel, and writes the PVTU file
+template <class Mesh>
+static void vtu_write_pieces(const std::string& fname, const Mesh& m, int npieces, const VtuFormat format, const bool compress)
+{
+	std::vector<int> conn, offsets;
+	std::vector<uint8_t> types;
+	if(!vtu_cells(m, conn, offsets, types))
+		return;
+
+	const amc::amc_int nelem = m.gnelem();
+	if(npieces > nelem)
+		npieces = nelem;
+	if(npieces < 1)
+		npieces = 1;
+
+	// the pieces are named after the PVTU file, and referred to in it relative to its directory
+	std::string base = fname;
+	if(base.size() > 5 && base.compare(base.size()-5, 5, ".pvtu") == 0)
+		base.erase(base.size()-5);
+	const size_t slash = base.rfind('/');
+	const std::string relbase = slash == std::string::npos ? base : base.substr(slash+1);
+
+	std::cout << "Writing pvtu output in " << npieces << " pieces...\n";
+
+	#pragma omp parallel default(none) shared(m, conn, offsets, types, npieces, nelem, base, format, compress)
+	{
+		std::vector<int> localno(m.gnpoin(), -1);
+		#pragma omp for schedule(dynamic,1)
+		for(int ip = 0; ip < npieces; ip++)
+		{
+			const amc::amc_int start = (amc::amc_int)((long long)nelem*ip/npieces);
+			const amc::amc_int end = (amc::amc_int)((long long)nelem*(ip+1)/npieces);
+			vtu_write_piece(base + "_" + std::to_string(ip) + ".vtu", m, conn, offsets, types, start, end, localno, format, compress);
+		}
+	}
+
+	std::ofstream out(fname);
+	out << "<VTKFile type=\"PUnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">\n";
+	out << "<PUnstructuredGrid GhostLevel=\"0\">\n";
+	out << "\t<PPoints>\n";
+	out << "\t\t<PDataArray type=\"Float64\" NumberOfComponents=\"3\"/>\n";
+	out << "\t</PPoints>\n";
+	for(int ip = 0; ip < npieces; ip++)
+		out << "\t<Piece Source=\"" << relbase << "_" << ip << ".vtu\"/>\n";
+	out << "</PUnstructuredGrid>\n";
+	out << "</VTKFile>";
+	out.close();
+	std::cout << "Pvtu file written.\n";
+}
+
+/// Writes a hybrid mesh in VTU format.
+/** VTK does not have a 9-node quadrilateral, so we ignore the cell-centered note for output.
+ */
+void writeMeshToVtu(std::string fname, amc::UMesh2dh& m, const VtuFormat format, const bool compress)
+{
+	std::cout << "Writing vtu output...\n";
+	std::vector<int> conn, offsets;
+	std::vector<uint8_t> types;
+	vtu_cells(m, conn, offsets, types);
+	vtu_write_mesh(fname, m, conn, offsets, types, format, compress);
+	std::cout << "Vtu file written.\n";
+}
+
+void writeMeshToVtu(std::string fname, const amc::UMesh& m, const VtuFormat format, const bool compress)
+{
+	std::vector<int> conn, offsets;
+	std::vector<uint8_t> types;
+	if(!vtu_cells(m, conn, offsets, types))
+		return;
+	std::cout << "Writing vtu output...\n";
+	vtu_write_mesh(fname, m, conn, offsets, types, format, compress);
+	std::cout << "Vtu file written.\n";
+}
+
+void writeMeshToPvtu(std::string fname, const amc::UMesh2dh& m, const int npieces, const VtuFormat format, const bool compress)
+{
+	vtu_write_pieces(fname, m, npieces, format, compress);
+}
+
+void writeMeshToPvtu(std::string fname, const amc::UMesh& m, const int npieces, const VtuFormat format, const bool compress)
+{
+	vtu_write_pieces(fname, m, npieces, format, compress);
+}
@@ -1,46 +1,78 @@
-/** @file aoutput.hpp
- * @brief A collection of subroutines to write mesh data to various kinds of output formats
- */
-
-#ifndef __AOUTPUT_H
-
-#ifndef __AMATRIX_H
-#include <amatrix.hpp>
-#endif
-
-#ifndef __AMESH2DGENERAL_H
-#include <amesh2d.hpp>
-#endif
-
-#ifndef __AMESH2DHYBRID_H
-#include <amesh2dh.hpp>
-#endif
-
-#ifndef _GLIBCXX_FSTREAM
-#include <fstream>
-#endif
-
-#ifndef _GLIBCXX_STRING
-#include <string>
-#endif
-
-#define __AOUTPUT_H 1
-
-/** Writes multiple scalar data sets and one vector data set, all cell-centered data, to a file in VTU format.
- * If either x or y is a 0x0 matrix, it is ignored.
- * \param fname is the output vtu file name
- */
-void writeScalarsVectorToVtu_CellData(std::string fname, const amc::UMesh2d& m, const amat::Matrix<double>& x, std::string scaname[], const amat::Matrix<double>& y, std::string vecname);
-
-/// Writes a hybrid mesh in VTU format.
-/** VTK does not have a 9-node quadrilateral, so we ignore the cell-centered note for output.
- */
-void writeMeshToVtu(std::string fname, amc::UMesh2dh& m);
-
-/// Writes a quadratic mesh in VTU format.
-/** VTK does not have a 9-node quadrilateral, so we ignore the cell-centered note for output.
- */
-void writeQuadraticMeshToVtu(std::string fname, amc::UMesh2d& m);
-
-
-#endif
+/** @file aoutput.hpp
+ * @brief A collection of subroutines to write mesh data to various kinds of output formats
+ */
+
+#ifndef __AOUTPUT_H
+
+#ifndef __AMATRIX_H
+#include <amatrix.hpp>
+#endif
+
+#ifndef __AMESH2DGENERAL_H
+#include <amesh2d.hpp>
+#endif
+
+#ifndef __AMESH2DHYBRID_H
+#include <amesh2dh.hpp>
+#endif
+
+#ifndef __AMESH3D_H
+#include <amesh3d.hpp>
+#endif
+
+#ifndef _GLIBCXX_FSTREAM
+#include <fstream>
+#endif
+
+#ifndef _GLIBCXX_STRING
+#include <string>
+#endif
+
+#define __AOUTPUT_H 1
+
+/// Encodings of the data arrays in VTU files
+/** All of them can be read by ParaView. Compression (with zlib) applies only to the binary encodings,
+ * and is available only if the code is built with ZLIB_LIBRARY defined; otherwise, output is written uncompressed.
+ */
+enum VtuFormat {
+	VTU_ASCII,		///< Human-readable text
+	VTU_BINARY,		///< Base64-encoded binary data within each DataArray element
+	VTU_APPENDED	///< Raw binary data in an AppendedData section at the end of the file; the smallest and fastest to read and write
+};
+
+/** Writes multiple scalar data sets and one vector data set, all cell-centered data, to a file in VTU format.
+ * If either x or y is a 0x0 matrix, it is ignored.
+ * \param fname is the output vtu file name
+ */
+void writeScalarsVectorToVtu_CellData(std::string fname, const amc::UMesh2d& m, const amat::Matrix<double>& x, std::string scaname[], const amat::Matrix<double>& y, std::string vecname,
+		const VtuFormat format = VTU_ASCII, const bool compress = false);
+
+/// Writes a hybrid mesh in VTU format.
+/** VTK does not have a 9-node quadrilateral, so we ignore the cell-centered note for output.
+ */
+void writeMeshToVtu(std::string fname, amc::UMesh2dh& m, const VtuFormat format = VTU_ASCII, const bool compress = false);
+
+/// Writes a 3D mesh in VTU format.
+/** Linear and quadratic tetrahedra and linear hexahedra are written as such.
+ * VTK's 27-node hexahedron has a different node ordering from ours, so only the vertices of 27-node hexahedra are written.
+ */
+void writeMeshToVtu(std::string fname, const amc::UMesh& m, const VtuFormat format = VTU_ASCII, const bool compress = false);
+
+/// Writes a hybrid mesh as a parallel VTU data set, consisting of a PVTU file and npieces VTU files.
+/** The elements are split into npieces contiguous ranges, each of which is written, along with the points it uses, to its own VTU file.
+ * The pieces are written concurrently, one per OpenMP thread. If fname is, say, out.pvtu, the pieces are out_0.vtu, out_1.vtu etc.
+ */
+void writeMeshToPvtu(std::string fname, const amc::UMesh2dh& m, const int npieces, const VtuFormat format = VTU_APPENDED, const bool compress = false);
+
+/// Writes a 3D mesh as a parallel VTU data set, consisting of a PVTU file and npieces VTU files.
+/** See the 2D version for details. Elements are written as by [writeMeshToVtu](@ref writeMeshToVtu).
+ */
+void writeMeshToPvtu(std::string fname, const amc::UMesh& m, const int npieces, const VtuFormat format = VTU_APPENDED, const bool compress = false);
+
+/// Writes a quadratic mesh in VTU format.
+/** VTK does not have a 9-node quadrilateral, so we ignore the cell-centered note for output.
+ */
+void writeQuadraticMeshToVtu(std::string fname, amc::UMesh2d& m, const VtuFormat format = VTU_ASCII, const bool compress = false);
+
+
+#endif
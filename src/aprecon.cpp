@@ -0,0 +1,407 @@
+#include "aprecon.hpp"
+
+#ifndef _GLIBCXX_ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef _GLIBCXX_QUEUE
+#include <queue>
+#endif
+
+#ifndef _GLIBCXX_FUNCTIONAL
+#include <functional>
+#endif
+
+namespace amat {
+
+SparseTriangularFactor::SparseTriangularFactor() : lower(true), n(0), parallel(false)
+{
+	row_ptr.assign(1,0);
+	level_ptr.assign(1,0);
+}
+
+void SparseTriangularFactor::setup(const bool is_lower, const amc_int nrows, std::vector<amc_int>& rowptr, std::vector<amc_int>& colind,
+		std::vector<amc_real>& vals, std::vector<amc_real>& inverse_diag)
+{
+	lower = is_lower;
+	n = nrows;
+	row_ptr.swap(rowptr); col_ind.swap(colind); val.swap(vals); invdiag.swap(inverse_diag);
+	rowptr.clear(); colind.clear(); vals.clear(); inverse_diag.clear();
+	compute_levels();
+}
+
+void SparseTriangularFactor::compute_levels()
+{
+	// the level of a row is one more than the highest level of the rows it depends on
+	std::vector<amc_int> lev(n,0);
+	amc_int nlev = 0;
+	for(amc_int ii = 0; ii < n; ii++)
+	{
+		const amc_int i = lower ? ii : n-1-ii;
+		amc_int l = 0;
+		for(amc_int k = row_ptr[i]; k < row_ptr[i+1]; k++)
+			l = std::max(l, lev[col_ind[k]]+1);
+		lev[i] = l;
+		nlev = std::max(nlev, l+1);
+	}
+
+	level_ptr.assign(nlev+1, 0);
+	for(amc_int i = 0; i < n; i++)
+		level_ptr[lev[i]+1]++;
+	for(amc_int l = 0; l < nlev; l++)
+		level_ptr[l+1] += level_ptr[l];
+	level_rows.resize(n);
+	std::vector<amc_int> next(level_ptr.begin(), level_ptr.end()-1);
+	for(amc_int i = 0; i < n; i++)
+		level_rows[next[lev[i]]++] = i;
+
+	// with few rows per level, synchronizing the threads after each level costs more than it saves
+	parallel = n >= SPARSE_PARALLEL_MIN_ROWS && n >= (amc_int)TRISOLVE_PARALLEL_MIN_LEVEL_SIZE*nlev;
+}
+
+void SparseTriangularFactor::solve(amc_real* const x) const
+{
+	const amc_int* const rp = row_ptr.data(); const amc_int* const ci = col_ind.data();
+	const amc_real* const v = val.data(); const amc_real* const id = invdiag.data();
+
+	if(!parallel)
+	{
+		for(amc_int ii = 0; ii < n; ii++)
+		{
+			const amc_int i = lower ? ii : n-1-ii;
+			amc_real sum = x[i];
+			for(amc_int k = rp[i]; k < rp[i+1]; k++)
+				sum -= v[k]*x[ci[k]];
+			x[i] = sum*id[i];
+		}
+		return;
+	}
+
+	const amc_int nlev = gnlevels();
+	const amc_int* const lp = level_ptr.data(); const amc_int* const lr = level_rows.data();
+	#pragma omp parallel default(none) shared(nlev, lp, lr, rp, ci, v, id, x)
+	for(amc_int l = 0; l < nlev; l++)
+	{
+		#pragma omp for schedule(static)
+		for(amc_int kr = lp[l]; kr < lp[l+1]; kr++)
+		{
+			const amc_int i = lr[kr];
+			amc_real sum = x[i];
+			for(amc_int k = rp[i]; k < rp[i+1]; k++)
+				sum -= v[k]*x[ci[k]];
+			x[i] = sum*id[i];
+		}
+	}
+}
+
+/// Returns an estimate of the condition number of the product of the factors L and U of A
+/** This is the estimate of Chow and Saad: the largest entry of (LU)^(-1) e, where e is a vector of ones, times the largest absolute row sum of A.
+ * It is a lower bound for the condition number of LU (with LU replaced by A in the first norm); a huge or non-finite value means
+ * that the factors are unstable, and useless as a preconditioner, even though no zero pivot was encountered.
+ */
+static amc_real condition_estimate(const MatrixCSR<amc_real>& A, const SparseTriangularFactor& L, const SparseTriangularFactor& U)
+{
+	const amc_int n = A.rows();
+	const int* const rp = A.growptr(); const amc_real* const v = A.gval();
+	std::vector<amc_real> z(n,1.0);
+	L.solve(z.data());
+	U.solve(z.data());
+	amc_real zmax = 0, amax = 0;
+	for(amc_int i = 0; i < n; i++)
+	{
+		if(!std::isfinite(z[i]))
+			return std::fabs(z[i]);
+		zmax = std::max(zmax, std::fabs(z[i]));
+		amc_real rowsum = 0;
+		for(int k = rp[i]; k < rp[i+1]; k++)
+			rowsum += std::fabs(v[k]);
+		amax = std::max(amax, rowsum);
+	}
+	return zmax*amax;
+}
+
+bool ILU0::setup(const MatrixCSR<amc_real>& A)
+{
+	const amc_int n = A.rows();
+	const int* const rp = A.growptr(); const int* const ci = A.gcolind();
+	std::vector<amc_real> lu(A.gval(), A.gval()+rp[n]);
+	std::vector<amc_int> diag(n);
+	std::vector<amc_int> iw(n,-1);
+
+	for(amc_int i = 0; i < n; i++)
+	{
+		const int* const pos = std::lower_bound(ci+rp[i], ci+rp[i+1], i);
+		if(pos == ci+rp[i+1] || *pos != i) {
+			std::cout << "! ILU0: setup(): Row " << i << " has no diagonal entry!" << std::endl;
+			return false;
+		}
+		diag[i] = pos-ci;
+	}
+
+	// IKJ variant of Gaussian elimination, restricted to the non-zero pattern of A
+	for(amc_int i = 0; i < n; i++)
+	{
+		for(amc_int k = rp[i]; k < rp[i+1]; k++)
+			iw[ci[k]] = k;
+
+		for(amc_int k = rp[i]; k < diag[i]; k++)
+		{
+			const amc_int j = ci[k];
+			lu[k] /= lu[diag[j]];
+			for(amc_int kk = diag[j]+1; kk < rp[j+1]; kk++)
+				if(iw[ci[kk]] >= 0)
+					lu[iw[ci[kk]]] -= lu[k]*lu[kk];
+		}
+
+		for(amc_int k = rp[i]; k < rp[i+1]; k++)
+			iw[ci[k]] = -1;
+
+		if(lu[diag[i]] == 0) {
+			std::cout << "! ILU0: setup(): Zero pivot in row " << i << "!" << std::endl;
+			return false;
+		}
+	}
+
+	// split into the factors
+	std::vector<amc_int> lptr(n+1), lcol, uptr(n+1), ucol;
+	std::vector<amc_real> lval, uval, linv(n,1.0), uinv(n);
+	lptr[0] = uptr[0] = 0;
+	for(amc_int i = 0; i < n; i++)
+	{
+		for(amc_int k = rp[i]; k < diag[i]; k++) {
+			lcol.push_back(ci[k]);
+			lval.push_back(lu[k]);
+		}
+		for(amc_int k = diag[i]+1; k < rp[i+1]; k++) {
+			ucol.push_back(ci[k]);
+			uval.push_back(lu[k]);
+		}
+		lptr[i+1] = lcol.size();
+		uptr[i+1] = ucol.size();
+		uinv[i] = 1.0/lu[diag[i]];
+	}
+
+	L.setup(true, n, lptr, lcol, lval, linv);
+	U.setup(false, n, uptr, ucol, uval, uinv);
+	std::cout << "ILU0: setup(): Number of levels in L and U: " << L.gnlevels() << ", " << U.gnlevels() << std::endl;
+
+	const amc_real cond = condition_estimate(A, L, U);
+	if(!(cond <= ILU_MAX_CONDEST)) {
+		std::cout << "! ILU0: setup(): The factors are unstable; condition estimate " << cond << "!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void ILU0::apply(const Matrix<amc_real>& r, Matrix<amc_real>& z) const
+{
+	z = r;
+	L.solve(&z(0,0));
+	U.solve(&z(0,0));
+}
+
+bool ILUT::setup(const MatrixCSR<amc_real>& A, const amc_real tau, const int p)
+{
+	const amc_int n = A.rows();
+	const int* const rp = A.growptr(); const int* const ci = A.gcolind(); const amc_real* const v = A.gval();
+
+	std::vector<amc_int> lptr(n+1), lcol, uptr(n+1), ucol;
+	std::vector<amc_real> lval, uval, linv(n,1.0), uinv(n);
+	lptr[0] = uptr[0] = 0;
+
+	std::vector<amc_real> w(n,0.0);					// the current row
+	std::vector<char> inrow(n,0);					// whether a column is in the non-zero pattern of the current row
+	std::vector<amc_int> touched, lkeep, upper;
+	std::priority_queue<amc_int, std::vector<amc_int>, std::greater<amc_int>> lower;		// lower columns still to be eliminated
+
+	for(amc_int i = 0; i < n; i++)
+	{
+		amc_real norm = 0;
+		for(amc_int k = rp[i]; k < rp[i+1]; k++)
+			norm += v[k]*v[k];
+		norm = sqrt(norm);
+		if(norm == 0) {
+			std::cout << "! ILUT: setup(): Row " << i << " is zero!" << std::endl;
+			return false;
+		}
+		const amc_real droptol = tau*norm;
+
+		touched.clear(); lkeep.clear(); upper.clear();
+		inrow[i] = 1; touched.push_back(i);
+		for(amc_int k = rp[i]; k < rp[i+1]; k++)
+		{
+			const amc_int j = ci[k];
+			w[j] = v[k];
+			if(j == i) continue;
+			inrow[j] = 1; touched.push_back(j);
+			if(j < i) lower.push(j);
+			else upper.push_back(j);
+		}
+
+		// eliminate the lower entries in increasing order of column; this can create fill-in on either side
+		while(!lower.empty())
+		{
+			const amc_int k = lower.top();
+			lower.pop();
+			const amc_real wk = w[k]*uinv[k];
+			if(std::fabs(wk) < droptol) {
+				w[k] = 0;
+				continue;
+			}
+			w[k] = wk;
+			lkeep.push_back(k);
+			for(amc_int kk = uptr[k]; kk < uptr[k+1]; kk++)
+			{
+				const amc_int j = ucol[kk];
+				if(!inrow[j]) {
+					inrow[j] = 1; touched.push_back(j);
+					w[j] = 0;
+					if(j < i) lower.push(j);
+					else upper.push_back(j);
+				}
+				w[j] -= wk*uval[kk];
+			}
+		}
+
+		// keep the p largest entries of each part
+		if((int)lkeep.size() > p) {
+			std::nth_element(lkeep.begin(), lkeep.begin()+p, lkeep.end(), [&w](const amc_int a, const amc_int b) { return std::fabs(w[a]) > std::fabs(w[b]); });
+			lkeep.resize(p);
+		}
+		for(size_t k = 0; k < lkeep.size(); k++) {
+			lcol.push_back(lkeep[k]);
+			lval.push_back(w[lkeep[k]]);
+		}
+		lptr[i+1] = lcol.size();
+
+		upper.erase(std::remove_if(upper.begin(), upper.end(), [&w,droptol](const amc_int j) { return std::fabs(w[j]) < droptol; }), upper.end());
+		if((int)upper.size() > p) {
+			std::nth_element(upper.begin(), upper.begin()+p, upper.end(), [&w](const amc_int a, const amc_int b) { return std::fabs(w[a]) > std::fabs(w[b]); });
+			upper.resize(p);
+		}
+		for(size_t k = 0; k < upper.size(); k++) {
+			ucol.push_back(upper[k]);
+			uval.push_back(w[upper[k]]);
+		}
+		uptr[i+1] = ucol.size();
+
+		// a zero pivot is replaced by a small multiple of the norm of the row
+		const amc_real d = w[i] != 0 ? w[i] : (tau > 0 ? tau : 1e-4)*norm;
+		uinv[i] = 1.0/d;
+
+		for(size_t k = 0; k < touched.size(); k++) {
+			w[touched[k]] = 0;
+			inrow[touched[k]] = 0;
+		}
+	}
+
+	const amc_int nnzl = lcol.size(), nnzu = ucol.size();
+	L.setup(true, n, lptr, lcol, lval, linv);
+	U.setup(false, n, uptr, ucol, uval, uinv);
+	std::cout << "ILUT: setup(): Non-zeros in L and U: " << nnzl << ", " << nnzu+n << "; number of levels: " << L.gnlevels() << ", " << U.gnlevels() << std::endl;
+
+	const amc_real cond = condition_estimate(A, L, U);
+	if(!(cond <= ILU_MAX_CONDEST)) {
+		std::cout << "! ILUT: setup(): The factors are unstable; condition estimate " << cond << "!" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+void ILUT::apply(const Matrix<amc_real>& r, Matrix<amc_real>& z) const
+{
+	z = r;
+	L.solve(&z(0,0));
+	U.solve(&z(0,0));
+}
+
+bool IC0::setup(const MatrixSymCSR<amc_real>& A)
+{
+	const amc_int n = A.rows();
+	const int* const rp = A.growptr(); const int* const ci = A.gcolind(); const amc_real* const v = A.gval();
+	std::vector<amc_real> u;
+	std::vector<amc_int> pos(n,-1);
+
+	// the first entry of each row is the diagonal
+	amc_real alpha = 0;
+	bool ok = false;
+	for(int attempt = 0; attempt < 30 && !ok; attempt++)
+	{
+		u.assign(v, v+rp[n]);
+		for(amc_int i = 0; i < n; i++)
+			u[rp[i]] *= 1.0+alpha;
+
+		ok = true;
+		for(amc_int i = 0; i < n && ok; i++)
+		{
+			if(u[rp[i]] <= 0) {
+				ok = false;
+				break;
+			}
+			const amc_real d = sqrt(u[rp[i]]);
+			u[rp[i]] = d;
+			for(amc_int k = rp[i]+1; k < rp[i+1]; k++)
+				u[k] /= d;
+
+			// update the rows below by the outer product of row i with itself, restricted to the pattern
+			for(amc_int k1 = rp[i]+1; k1 < rp[i+1]; k1++)
+			{
+				const amc_int j = ci[k1];
+				for(amc_int kk = rp[j]; kk < rp[j+1]; kk++)
+					pos[ci[kk]] = kk;
+				for(amc_int k2 = k1; k2 < rp[i+1]; k2++)
+					if(pos[ci[k2]] >= 0)
+						u[pos[ci[k2]]] -= u[k1]*u[k2];
+				for(amc_int kk = rp[j]; kk < rp[j+1]; kk++)
+					pos[ci[kk]] = -1;
+			}
+		}
+
+		if(!ok) {
+			alpha = alpha == 0 ? 1e-3 : 2*alpha;
+			std::cout << "IC0: setup(): Non-positive pivot; re-starting with diagonal shift " << alpha << std::endl;
+		}
+	}
+	if(!ok) {
+		std::cout << "! IC0: setup(): Could not compute the incomplete Cholesky factorization!" << std::endl;
+		return false;
+	}
+
+	// U is the strict upper part, and its transpose is formed for the forward solve
+	std::vector<amc_int> uptr(n+1), ucol(rp[n]-n), tptr(n+1,0), tcol(rp[n]-n);
+	std::vector<amc_real> uval(rp[n]-n), uinv(n), tval(rp[n]-n);
+	uptr[0] = 0;
+	for(amc_int i = 0; i < n; i++)
+	{
+		uinv[i] = 1.0/u[rp[i]];
+		uptr[i+1] = rp[i+1]-(i+1);
+		for(amc_int k = rp[i]+1; k < rp[i+1]; k++) {
+			ucol[k-(i+1)] = ci[k];
+			uval[k-(i+1)] = u[k];
+			tptr[ci[k]+1]++;
+		}
+	}
+	for(amc_int i = 0; i < n; i++)
+		tptr[i+1] += tptr[i];
+	std::vector<amc_int> next(tptr.begin(), tptr.end()-1);
+	for(amc_int i = 0; i < n; i++)
+		for(amc_int k = uptr[i]; k < uptr[i+1]; k++) {
+			tcol[next[ucol[k]]] = i;
+			tval[next[ucol[k]]++] = uval[k];
+		}
+	std::vector<amc_real> tinv(uinv);
+
+	Ut.setup(true, n, tptr, tcol, tval, tinv);
+	U.setup(false, n, uptr, ucol, uval, uinv);
+	std::cout << "IC0: setup(): Number of levels: " << U.gnlevels() << std::endl;
+	return true;
+}
+
+void IC0::apply(const Matrix<amc_real>& r, Matrix<amc_real>& z) const
+{
+	z = r;
+	Ut.solve(&z(0,0));
+	U.solve(&z(0,0));
+}
+
+}
@@ -0,0 +1,118 @@
+/** \file aprecon.hpp
+ * \brief Incomplete factorization preconditioners for the Krylov solvers in alinalg.hpp.
+ * \author Aditya Kashi
+ *
+ * The factors are stored in compressed row storage. Triangular solves with them use level scheduling:
+ * the rows are grouped into levels such that each row depends only on rows in earlier levels, so the rows of a level
+ * can be solved in parallel.
+ */
+
+#ifndef __APRECON_H
+
+#ifndef __ALINALG_H
+#include <alinalg.hpp>
+#endif
+
+#ifndef _GLIBCXX_VECTOR
+#include <vector>
+#endif
+
+#define __APRECON_H 1
+
+/// Triangular solves are only done in parallel if the levels have at least this many rows on average
+#define TRISOLVE_PARALLEL_MIN_LEVEL_SIZE 64
+
+/// Incomplete LU factors are rejected as unstable if the estimate of the condition number of their product is larger than this
+#define ILU_MAX_CONDEST 1e12
+
+namespace amat {
+
+/// A sparse lower or upper triangular matrix in compressed row storage, for triangular solves
+/** The diagonal is stored separately (as its inverse) from the strictly lower or upper part.
+ */
+class SparseTriangularFactor
+{
+	bool lower;									///< True for a lower triangular matrix, false for an upper triangular one
+	amc_int n;									///< Number of rows
+	std::vector<amc_int> row_ptr;				///< Index into col_ind and val where each row begins
+	std::vector<amc_int> col_ind;				///< Column indices of the off-diagonal entries
+	std::vector<amc_real> val;					///< Off-diagonal entries
+	std::vector<amc_real> invdiag;				///< Inverse of the diagonal entries
+	std::vector<amc_int> level_ptr;				///< Index into level_rows where each level begins
+	std::vector<amc_int> level_rows;			///< Rows sorted by level
+	bool parallel;								///< Whether solves are done level by level in parallel
+
+	/// Groups the rows into levels
+	void compute_levels();
+
+public:
+	SparseTriangularFactor();
+
+	/// Sets up the factor from its off-diagonal entries in compressed row storage and the inverse of its diagonal
+	/** The arrays are swapped into the object, so they are empty on return.
+	 */
+	void setup(const bool is_lower, const amc_int nrows, std::vector<amc_int>& rowptr, std::vector<amc_int>& colind,
+			std::vector<amc_real>& vals, std::vector<amc_real>& inverse_diag);
+
+	amc_int gnlevels() const { return (amc_int)level_ptr.size()-1; }
+	amc_int gnnz() const { return row_ptr[n]; }
+
+	/// Overwrites x with T^(-1) x, where T is this triangular matrix
+	void solve(amc_real* const x) const;
+};
+
+/// Incomplete LU factorization with no fill-in, for general sparse matrices ("BICGSTAB-ILU0")
+/** The factors L (with unit diagonal) and U have the non-zero pattern of the lower and upper triangles of A.
+ * A must have all its diagonal entries in its non-zero pattern.
+ */
+class ILU0 : public Preconditioner
+{
+	SparseTriangularFactor L;
+	SparseTriangularFactor U;
+
+public:
+	/// Computes the factorization; returns false if A has a missing or zero diagonal entry, a zero pivot is encountered,
+	/// or the factors are unstable (see ILU_MAX_CONDEST)
+	bool setup(const MatrixCSR<amc_real>& A);
+
+	void apply(const Matrix<amc_real>& r, Matrix<amc_real>& z) const;
+};
+
+/// Incomplete LU factorization with threshold dropping ("BICGSTAB-ILUT")
+/** This is Saad's ILUT(tau,p): in the factorization of each row, entries smaller than tau times the 2-norm of the row of A are dropped,
+ * and then only the p largest entries in the L part and the p largest in the U part (besides the diagonal) are kept.
+ */
+class ILUT : public Preconditioner
+{
+	SparseTriangularFactor L;
+	SparseTriangularFactor U;
+
+public:
+	/// Computes the factorization; returns false if a zero row is encountered, or the factors are unstable (see ILU_MAX_CONDEST)
+	/** \param tau is the relative drop tolerance
+	 * \param p is the maximum number of off-diagonal entries kept in each row of each factor
+	 */
+	bool setup(const MatrixCSR<amc_real>& A, const amc_real tau = 1e-4, const int p = 20);
+
+	void apply(const Matrix<amc_real>& r, Matrix<amc_real>& z) const;
+};
+
+/// Incomplete Cholesky factorization with no fill-in, for symmetric positive definite matrices ("PCG-IC0")
+/** Computes an upper triangular U with the non-zero pattern of the upper triangle of A, such that A is approximately U^T U.
+ * IC(0) can break down (encounter a non-positive pivot) even for SPD matrices; if that happens, the factorization is re-started
+ * for A + alpha*diag(A), with increasing values of the shift alpha.
+ */
+class IC0 : public Preconditioner
+{
+	SparseTriangularFactor Ut;				///< The transpose of U
+	SparseTriangularFactor U;
+
+public:
+	/// Computes the factorization; returns false if no shift that avoids breakdown was found
+	bool setup(const MatrixSymCSR<amc_real>& A);
+
+	void apply(const Matrix<amc_real>& r, Matrix<amc_real>& z) const;
+};
+
+}
+#endif
@@ -0,0 +1,323 @@
+#include "apredicates.hpp"
+
+#ifndef _GLIBCXX_CMATH
+#include <cmath>
+#endif
+
+#ifndef _GLIBCXX_ALGORITHM
+#include <algorithm>
+#endif
+
+namespace amc {
+
+namespace {
+
+/// Half of the machine epsilon for double precision, \f$ 2^{-53} \f$
+const amc_real epsilon = 1.1102230246251565e-16;
+/// \f$ 2^{27}+1 \f$, used to split a double into two halves of 26 bits each
+const amc_real splitter = 134217729.0;
+
+/// Error bounds for the floating-point evaluation of the predicates; see Shewchuk's paper
+const amc_real o3derrboundA = (7.0 + 56.0*epsilon)*epsilon;
+const amc_real isperrboundA = (16.0 + 224.0*epsilon)*epsilon;
+
+inline void fast_two_sum(const amc_real a, const amc_real b, amc_real& x, amc_real& y)
+{
+	x = a + b;
+	const amc_real bvirt = x - a;
+	y = b - bvirt;
+}
+
+inline void two_sum(const amc_real a, const amc_real b, amc_real& x, amc_real& y)
+{
+	x = a + b;
+	const amc_real bvirt = x - a;
+	const amc_real avirt = x - bvirt;
+	const amc_real bround = b - bvirt;
+	const amc_real around = a - avirt;
+	y = around + bround;
+}
+
+inline void two_diff(const amc_real a, const amc_real b, amc_real& x, amc_real& y)
+{
+	x = a - b;
+	const amc_real bvirt = a - x;
+	const amc_real avirt = x + bvirt;
+	const amc_real bround = bvirt - b;
+	const amc_real around = a - avirt;
+	y = around + bround;
+}
+
+inline void split(const amc_real a, amc_real& ahi, amc_real& alo)
+{
+	const amc_real c = splitter*a;
+	const amc_real abig = c - a;
+	ahi = c - abig;
+	alo = a - ahi;
+}
+
+inline void two_product(const amc_real a, const amc_real b, amc_real& x, amc_real& y)
+{
+	x = a*b;
+	amc_real ahi, alo, bhi, blo;
+	split(a, ahi, alo);
+	split(b, bhi, blo);
+	const amc_real err1 = x - ahi*bhi;
+	const amc_real err2 = err1 - alo*bhi;
+	const amc_real err3 = err2 - ahi*blo;
+	y = alo*blo - err3;
+}
+
+/// Sum of two expansions (Shewchuk's FAST-EXPANSION-SUM with zero elimination)
+/** An expansion is a sum of non-overlapping doubles, stored in an array in increasing order of magnitude.
+ * Expansions returned by this function and [scale](@ref scale) have zero components eliminated, but have at least one component.
+ * \param[out] h must have room for elen+flen components
+ * \return the number of components of h
+ */
+int sum(const int elen, const amc_real* const e, const int flen, const amc_real* const f, amc_real* const h)
+{
+	amc_real enow = e[0], fnow = f[0], Q, hh;
+	int ie = 0, jf = 0, nh = 0;
+	if((fnow > enow) == (fnow > -enow)) {
+		Q = enow;
+		enow = ++ie < elen ? e[ie] : 0;
+	}
+	else {
+		Q = fnow;
+		fnow = ++jf < flen ? f[jf] : 0;
+	}
+	if(ie < elen && jf < flen)
+	{
+		if((fnow > enow) == (fnow > -enow)) {
+			fast_two_sum(enow, Q, Q, hh);
+			enow = ++ie < elen ? e[ie] : 0;
+		}
+		else {
+			fast_two_sum(fnow, Q, Q, hh);
+			fnow = ++jf < flen ? f[jf] : 0;
+		}
+		if(hh != 0.0) h[nh++] = hh;
+		while(ie < elen && jf < flen)
+		{
+			if((fnow > enow) == (fnow > -enow)) {
+				two_sum(Q, enow, Q, hh);
+				enow = ++ie < elen ? e[ie] : 0;
+			}
+			else {
+				two_sum(Q, fnow, Q, hh);
+				fnow = ++jf < flen ? f[jf] : 0;
+			}
+			if(hh != 0.0) h[nh++] = hh;
+		}
+	}
+	for( ; ie < elen; ie++)
+	{
+		two_sum(Q, e[ie], Q, hh);
+		if(hh != 0.0) h[nh++] = hh;
+	}
+	for( ; jf < flen; jf++)
+	{
+		two_sum(Q, f[jf], Q, hh);
+		if(hh != 0.0) h[nh++] = hh;
+	}
+	if(Q != 0.0 || nh == 0) h[nh++] = Q;
+	return nh;
+}
+
+/// Product of an expansion and a double (Shewchuk's SCALE-EXPANSION with zero elimination)
+/** \param[out] h must have room for 2*elen components
+ * \return the number of components of h
+ */
+int scale(const int elen, const amc_real* const e, const amc_real b, amc_real* const h)
+{
+	amc_real Q, hh, product1, product0, s;
+	int nh = 0;
+	two_product(e[0], b, Q, hh);
+	if(hh != 0.0) h[nh++] = hh;
+	for(int i = 1; i < elen; i++)
+	{
+		two_product(e[i], b, product1, product0);
+		two_sum(Q, product0, s, hh);
+		if(hh != 0.0) h[nh++] = hh;
+		fast_two_sum(product1, s, Q, hh);
+		if(hh != 0.0) h[nh++] = hh;
+	}
+	if(Q != 0.0 || nh == 0) h[nh++] = Q;
+	return nh;
+}
+
+/// Exact 2x2 determinants \f$ x_i y_j - x_j y_i \f$ of all pairs i < j of up to 5 points, with at most 4 components each
+struct XYMinors
+{
+	amc_real m[5][5][4];
+	int len[5][5];
+
+	XYMinors(const amc_real* const* const p, const int n)
+	{
+		for(int i = 0; i < n; i++)
+			for(int j = i+1; j < n; j++)
+			{
+				amc_real a[2], b[2];
+				two_product(p[i][0], p[j][1], a[1], a[0]);
+				two_product(-p[j][0], p[i][1], b[1], b[0]);
+				len[i][j] = sum(2, a, 2, b, m[i][j]);
+			}
+	}
+};
+
+/// Exact determinant of the 3x3 matrix with rows (x, y, 1) of points u < v < w; at most 12 components
+int det3(const XYMinors& mn, const int u, const int v, const int w, amc_real* const h)
+{
+	amc_real t[8], neg[4];
+	const int tlen = sum(mn.len[u][v], mn.m[u][v], mn.len[v][w], mn.m[v][w], t);
+	for(int i = 0; i < mn.len[u][w]; i++)
+		neg[i] = -mn.m[u][w][i];
+	return sum(tlen, t, mn.len[u][w], neg, h);
+}
+
+/// Exact determinant of the 4x4 matrix with rows (x, y, z, 1) of points r[0] < r[1] < r[2] < r[3], expanded along the z column;
+/// at most 96 components
+int det4(const amc_real* const* const p, const XYMinors& mn, const int r[4], amc_real* const h)
+{
+	amc_real d3[12], t[24], acc[2][72];
+	int len = 0, cur = 0;
+	for(int k = 0; k < 4; k++)
+	{
+		int o[3], no = 0;
+		for(int j = 0; j < 4; j++)
+			if(j != k) o[no++] = r[j];
+		const int d3len = det3(mn, o[0], o[1], o[2], d3);
+		const int tlen = scale(d3len, d3, k%2 == 0 ? p[r[k]][2] : -p[r[k]][2], t);
+		if(k == 0) {
+			std::copy(t, t+tlen, acc[0]);
+			len = tlen;
+		}
+		else if(k < 3) {
+			len = sum(len, acc[cur], tlen, t, acc[1-cur]);
+			cur = 1-cur;
+		}
+		else
+			len = sum(len, acc[cur], tlen, t, h);
+	}
+	return len;
+}
+
+amc_real orient3d_exact(const amc_real* const pa, const amc_real* const pb, const amc_real* const pc, const amc_real* const pd)
+{
+	// the determinant of the differences from pd equals that of the 4x4 matrix with rows (x, y, z, 1)
+	const amc_real* const p[4] = {pa, pb, pc, pd};
+	const XYMinors mn(p, 4);
+	const int r[4] = {0, 1, 2, 3};
+	amc_real det[96];
+	const int len = det4(p, mn, r, det);
+	return det[len-1];
+}
+
+amc_real insphere_exact(const amc_real* const pa, const amc_real* const pb, const amc_real* const pc, const amc_real* const pd, const amc_real* const pe)
+{
+	// the determinant of the lifted differences from pe equals that of the 5x5 matrix with rows (x, y, z, x^2+y^2+z^2, 1),
+	// which is expanded along the lifted column; each term is at most 1152 components long, so the sum has at most 5760
+	const amc_real* const p[5] = {pa, pb, pc, pd, pe};
+	const XYMinors mn(p, 5);
+	amc_real d4[96], t192[192], tx[384], t384[384], txy[768], term[1152], acc[2][5760];
+	int len = 0, cur = 0;
+	for(int i = 0; i < 5; i++)
+	{
+		int r[4], nr = 0;
+		for(int j = 0; j < 5; j++)
+			if(j != i) r[nr++] = j;
+		const int d4len = det4(p, mn, r, d4);
+
+		// (-1)^(i+3) (x^2 + y^2 + z^2) times the minor
+		const amc_real sign = i%2 == 0 ? -1.0 : 1.0;
+		int len192 = scale(d4len, d4, sign*p[i][0], t192);
+		const int txlen = scale(len192, t192, p[i][0], tx);
+		len192 = scale(d4len, d4, sign*p[i][1], t192);
+		int len384 = scale(len192, t192, p[i][1], t384);
+		const int txylen = sum(txlen, tx, len384, t384, txy);
+		len192 = scale(d4len, d4, sign*p[i][2], t192);
+		len384 = scale(len192, t192, p[i][2], t384);
+		const int termlen = sum(txylen, txy, len384, t384, term);
+
+		if(i == 0) {
+			std::copy(term, term+termlen, acc[0]);
+			len = termlen;
+		}
+		else {
+			len = sum(len, acc[cur], termlen, term, acc[1-cur]);
+			cur = 1-cur;
+		}
+	}
+	return acc[cur][len-1];
+}
+}
+
+amc_real orient3d(const amc_real* const pa, const amc_real* const pb, const amc_real* const pc, const amc_real* const pd)
+{
+	const amc_real adx = pa[0] - pd[0], bdx = pb[0] - pd[0], cdx = pc[0] - pd[0];
+	const amc_real ady = pa[1] - pd[1], bdy = pb[1] - pd[1], cdy = pc[1] - pd[1];
+	const amc_real adz = pa[2] - pd[2], bdz = pb[2] - pd[2], cdz = pc[2] - pd[2];
+
+	const amc_real bdxcdy = bdx*cdy, cdxbdy = cdx*bdy;
+	const amc_real cdxady = cdx*ady, adxcdy = adx*cdy;
+	const amc_real adxbdy = adx*bdy, bdxady = bdx*ady;
+
+	const amc_real det = adz*(bdxcdy - cdxbdy) + bdz*(cdxady - adxcdy) + cdz*(adxbdy - bdxady);
+
+	const amc_real permanent = (fabs(bdxcdy) + fabs(cdxbdy))*fabs(adz) + (fabs(cdxady) + fabs(adxcdy))*fabs(bdz)
+		+ (fabs(adxbdy) + fabs(bdxady))*fabs(cdz);
+	const amc_real errbound = o3derrboundA*permanent;
+	if(det > errbound || -det > errbound)
+		return det;
+
+	return orient3d_exact(pa, pb, pc, pd);
+}
+
+amc_real insphere(const amc_real* const pa, const amc_real* const pb, const amc_real* const pc, const amc_real* const pd, const amc_real* const pe)
+{
+	const amc_real aex = pa[0] - pe[0], bex = pb[0] - pe[0], cex = pc[0] - pe[0], dex = pd[0] - pe[0];
+	const amc_real aey = pa[1] - pe[1], bey = pb[1] - pe[1], cey = pc[1] - pe[1], dey = pd[1] - pe[1];
+	const amc_real aez = pa[2] - pe[2], bez = pb[2] - pe[2], cez = pc[2] - pe[2], dez = pd[2] - pe[2];
+
+	const amc_real aexbey = aex*bey, bexaey = bex*aey;
+	const amc_real bexcey = bex*cey, cexbey = cex*bey;
+	const amc_real cexdey = cex*dey, dexcey = dex*cey;
+	const amc_real dexaey = dex*aey, aexdey = aex*dey;
+	const amc_real aexcey = aex*cey, cexaey = cex*aey;
+	const amc_real bexdey = bex*dey, dexbey = dex*bey;
+
+	const amc_real ab = aexbey - bexaey, bc = bexcey - cexbey, cd = cexdey - dexcey;
+	const amc_real da = dexaey - aexdey, ac = aexcey - cexaey, bd = bexdey - dexbey;
+
+	const amc_real abc = aez*bc - bez*ac + cez*ab;
+	const amc_real bcd = bez*cd - cez*bd + dez*bc;
+	const amc_real cda = cez*da + dez*ac + aez*cd;
+	const amc_real dab = dez*ab + aez*bd + bez*da;
+
+	const amc_real alift = aex*aex + aey*aey + aez*aez;
+	const amc_real blift = bex*bex + bey*bey + bez*bez;
+	const amc_real clift = cex*cex + cey*cey + cez*cez;
+	const amc_real dlift = dex*dex + dey*dey + dez*dez;
+
+	const amc_real det = (dlift*abc - clift*dab) + (blift*cda - alift*bcd);
+
+	const amc_real aezplus = fabs(aez), bezplus = fabs(bez), cezplus = fabs(cez), dezplus = fabs(dez);
+	const amc_real aexbeyplus = fabs(aexbey), bexaeyplus = fabs(bexaey);
+	const amc_real bexceyplus = fabs(bexcey), cexbeyplus = fabs(cexbey);
+	const amc_real cexdeyplus = fabs(cexdey), dexceyplus = fabs(dexcey);
+	const amc_real dexaeyplus = fabs(dexaey), aexdeyplus = fabs(aexdey);
+	const amc_real aexceyplus = fabs(aexcey), cexaeyplus = fabs(cexaey);
+	const amc_real bexdeyplus = fabs(bexdey), dexbeyplus = fabs(dexbey);
+
+	const amc_real permanent = ((cexdeyplus + dexceyplus)*bezplus + (dexbeyplus + bexdeyplus)*cezplus + (bexceyplus + cexbeyplus)*dezplus)*alift
+		+ ((dexaeyplus + aexdeyplus)*cezplus + (aexceyplus + cexaeyplus)*dezplus + (cexdeyplus + dexceyplus)*aezplus)*blift
+		+ ((aexbeyplus + bexaeyplus)*dezplus + (bexdeyplus + dexbeyplus)*aezplus + (dexaeyplus + aexdeyplus)*bezplus)*clift
+		+ ((bexceyplus + cexbeyplus)*aezplus + (cexaeyplus + aexceyplus)*bezplus + (aexbeyplus + bexaeyplus)*cezplus)*dlift;
+	const amc_real errbound = isperrboundA*permanent;
+	if(det > errbound || -det > errbound)
+		return det;
+
+	return insphere_exact(pa, pb, pc, pd, pe);
+}
+
+}
@@ -0,0 +1,40 @@
+/** \file apredicates.hpp
+ * \brief Robust geometric predicates (orientation and in-sphere tests) for 3D points.
+ * \author Aditya Kashi
+ *
+ * These follow J.R. Shewchuk, "Adaptive precision floating-point arithmetic and fast robust geometric predicates",
+ * Discrete & Computational Geometry 18 (1997). Each predicate is first evaluated in ordinary floating-point arithmetic;
+ * if the magnitude of the result is larger than a bound on its round-off error, its sign is correct and it is returned.
+ * Otherwise, the determinant is re-computed exactly using floating-point expansions, which is much slower but rarely needed.
+ *
+ * \note The exact arithmetic requires that the compiler does not contract multiplications and additions into fused multiply-adds,
+ * so apredicates.cpp is compiled with -ffp-contract=off. It also requires IEEE double precision without extended precision (eg. SSE2 on x86).
+ */
+
+#ifndef __APREDICATES_H
+
+#ifndef __ACONSTANTS_H
+#include <aconstants.h>
+#endif
+
+#define __APREDICATES_H 1
+
+namespace amc {
+
+/// Orientation of point pd with respect to the plane through pa, pb and pc
+/** \return a positive value if pd lies below the plane, when pa, pb and pc appear in counterclockwise order seen from above the plane;
+ * a negative value if pd lies above the plane; zero if the four points are coplanar.
+ * The result approximates six times the signed volume of the tetrahedron, and its sign is always correct.
+ * Note that this is the negative of the Jacobian \f$ (b-a) \cdot ((c-a)\times(d-a)) \f$ of tetrahedron abcd.
+ */
+amc_real orient3d(const amc_real* const pa, const amc_real* const pb, const amc_real* const pc, const amc_real* const pd);
+
+/// Position of point pe relative to the sphere through pa, pb, pc and pd
+/** The points pa, pb, pc and pd must be ordered such that [orient3d](@ref orient3d) of them is positive.
+ * \return a positive value if pe lies inside the sphere, a negative value if it lies outside, and zero if the five points are co-spherical.
+ * The sign of the result is always correct.
+ */
+amc_real insphere(const amc_real* const pa, const amc_real* const pb, const amc_real* const pc, const amc_real* const pd, const amc_real* const pe);
+
+}
+#endif
@@ -12,10 +12,10 @@
 
 namespace amc {
 	
-RBFmove::RBFmove() {isalloc = false; }
+RBFmove::RBFmove() {isalloc = false; compact = true; frozen = false; greedytol = 0; }
 
 RBFmove::RBFmove(amat::Matrix<double>* int_points, amat::Matrix<double>* boun_points, amat::Matrix<double>* boundary_motion, const int rbf_ch, const double support_radius, 
-		const int num_steps, const double tolerance, const int iter, const std::string linear_solver)
+		const int num_steps, const double tolerance, const int iter, const std::string linear_solver, const bool frozen_centres, const double greedy_tolerance)
 // boundary_motion is nbpoin-by-ndim array - containing displacements corresponding to boundary points.
 {
 	std::cout << "RBFmove: Storing inputs" << std::endl;
@@ -34,13 +34,15 @@ RBFmove::RBFmove(amat::Matrix<double>* int_points, amat::Matrix<double>* boun_po
 
 	switch(rbf_ch)
 	{
-		case(0): rbf = &RBFmove::rbf_c0;
+		case(0): rbftype = RBF_C0;
 		break;
-		case(2): rbf = &RBFmove::rbf_c2_compact;
+		case(2): rbftype = RBF_C2;
 		break;
-		case(4): rbf = &RBFmove::rbf_c4;
-		default: rbf = &RBFmove::rbf_c2_compact;
+		case(4): rbftype = RBF_C4;
+		break;
+		default: rbftype = RBF_C2;
 	}
+	compact = true;
 
 	b = new amat::Matrix<double>[ndim];		// RHS std::vectors of linear system for each coordinate direction
 	coeffs = new amat::Matrix<double>[ndim];
@@ -61,15 +63,23 @@ RBFmove::RBFmove(amat::Matrix<double>* int_points, amat::Matrix<double>* boun_po
 	tol = tolerance;
 	maxiter = iter;
 	srad = support_radius;
+	rbfscale = compact ? 1.0/srad : 1.0;
 	lsolver = linear_solver;
+	frozen = frozen_centres;
+	greedytol = greedy_tolerance;
+	nallbpoin = nbpoin;
 	
 	std::cout << "RBFmove: RBF to use: " << rbf_ch << std::endl;
 	std::cout << "RBFmove: Support radius = " << srad << std::endl;
 	std::cout << "RBFmove: Number of steps = " << nsteps << std::endl;
+	if(frozen)
+		std::cout << "RBFmove: RBF centres are frozen at their initial positions" << std::endl;
+	if(greedytol > 0)
+		std::cout << "RBFmove: RBF centres will be selected greedily with tolerance " << greedytol << std::endl;
 }
 
 void RBFmove::setup(amat::Matrix<double>* int_points, amat::Matrix<double>* boun_points, amat::Matrix<double>* boundary_motion, const int rbf_ch, const double support_radius, 
-		const int num_steps, const double tolerance, const int iter, const std::string linear_solver)
+		const int num_steps, const double tolerance, const int iter, const std::string linear_solver, const bool frozen_centres, const double greedy_tolerance)
 // boundary_motion is nbpoin-by-ndim array - containing displacements corresponding to boundary points.
 {
 	std::cout << "RBFmove: Storing inputs" << std::endl;
@@ -88,14 +98,16 @@ void RBFmove::setup(amat::Matrix<double>* int_points, amat::Matrix<double>* boun
 
 	switch(rbf_ch)
 	{
-		case(0): rbf = &RBFmove::rbf_c0;
+		case(0): rbftype = RBF_C0;
 		break;
-		case(2): rbf = &RBFmove::rbf_c2_compact;
+		case(2): rbftype = RBF_C2;
 				 std::cout << "RBFmove: setup(): Selected C2 function as RBF" << std::endl;
 		break;
-		case(4): rbf = &RBFmove::rbf_c4;
-		default: rbf = &RBFmove::gaussian;
+		case(4): rbftype = RBF_C4;
+		break;
+		default: rbftype = RBF_GAUSSIAN;
 	}
+	compact = (rbftype != RBF_GAUSSIAN);
 
 	b = new amat::Matrix<double>[ndim];		// RHS std::vectors of linear system for each coordinate direction
 	coeffs = new amat::Matrix<double>[ndim];
@@ -117,11 +129,19 @@ void RBFmove::setup(amat::Matrix<double>* int_points, amat::Matrix<double>* boun
 	tol = tolerance;
 	maxiter = iter;
 	srad = support_radius;
+	rbfscale = compact ? 1.0/srad : 1.0;
 	lsolver = linear_solver;
+	frozen = frozen_centres;
+	greedytol = greedy_tolerance;
+	nallbpoin = nbpoin;
 	
 	std::cout << "RBFmove: RBF to use: " << rbf_ch << std::endl;
 	std::cout << "RBFmove: Support radius = " << srad << std::endl;
 	std::cout << "RBFmove: Number of steps = " << nsteps << std::endl;
+	if(frozen)
+		std::cout << "RBFmove: RBF centres are frozen at their initial positions" << std::endl;
+	if(greedytol > 0)
+		std::cout << "RBFmove: RBF centres will be selected greedily with tolerance " << greedytol << std::endl;
 }
 
 RBFmove::~RBFmove()
@@ -136,74 +156,157 @@ RBFmove::~RBFmove()
 // Wendland's C2 function
 double RBFmove::rbf_c2_compact(double xi)
 {
-	if(xi < srad)
-	{
-		double q = xi/srad;
-		return (1.0-q)*(1.0-q)*(1.0-q)*(1.0-q)*(4.0*q+1.0);
-	}
-	else return 0.0;
+	return WendlandC2::eval(xi/srad);
 }
 
 double RBFmove::rbf_c0(double xi)
 {
-	if(xi < srad)
-		return (1-xi/srad)*(1-xi/srad);
-	else
-		return 0;
+	return WendlandC0::eval(xi/srad);
 }
 
 double RBFmove::rbf_c4(double xi)
 {
-	if(xi < srad)
-		return pow(1-xi/srad,6)*(35*xi*xi/(srad*srad) + 18*xi/srad + 3);
-	else
-		return 0;
+	return WendlandC4::eval(xi/srad);
 }
 
 double RBFmove::gaussian(double xi)
 {
-	return exp(-xi*xi);
+	return GaussianRBF::eval(xi);
 }
 
-/** Note that an element is only inserted into the sparse LHS matrix if its magnitude is more than tol * tol
+bool RBFmove::upper_only() const
+{
+	return lsolver == "CG" || lsolver == "PCG" || lsolver == "SSORCG" || lsolver == "PCG-IC0";
+}
+
+/** Note that an element is only inserted into the sparse LHS matrix if its magnitude is more than tol * tol.
+ * For compact RBFs, the non-zero pattern of each row is obtained by a radius search in [btree](@ref btree),
+ * so the cost of assembly is proportional to the number of non-zeros rather than nbpoin^2.
+ * Blocks of rows are computed independently, in parallel, and then copied into the flat arrays.
  */
-void RBFmove::assembleLHS()
+void RBFmove::assemble_rows(const bool upper, std::vector<int>& rowptr, std::vector<int>& colind, std::vector<amc_real>& vals)
 {
-	std::cout << "RBFmove:  assembleLHS(): assembling LHS matrix" << std::endl;
-	int i, j;
-	double dist;
-	double temp;
+	const int blocksize = 256;
+	const int nblocks = (nbpoin + blocksize-1)/blocksize;
+	int ib;
 
-	amat::SpMatrix* A = &(RBFmove::A);
 	amat::Matrix<double>* bpoints = &(RBFmove::bpoints);
-	double (RBFmove::*rbfunc)(double) = rbf;
+	const RBFKernelType rbftype = RBFmove::rbftype;
+	const amc_real rbfscale = RBFmove::rbfscale;
 	int nbpoin = RBFmove::nbpoin;
 	int ndim = RBFmove::ndim;
+	bool compact = RBFmove::compact;
+	amc_real sr = RBFmove::srad;
+	amc_real mintol = tol*tol;
 
-	// set the top nbpoin-by-nbpoin elements of A, ie, M_bb
-	
-	//#pragma omp parallel for default(none) private(i,j,dist,temp) shared(A,bpoints,rbfunc,nbpoin,ndim)
-	for(i = 0; i < nbpoin; i++)
-	{
-		A->set(i,i, (this->*rbfunc)(0.0));			// set diagonal element in row i
-		//A->set(i,i, 1.0);			// set diagonal element in row i
+	// the tree is also used by move_step() to evaluate the RBF at interior points
+	if(compact)
+		btree.setup(bpoints);
+	const KDTree* tree = &btree;
+
+	std::vector<std::vector<int>> bcols(nblocks);		// column indices of the rows of each block
+	std::vector<std::vector<amc_real>> bvals(nblocks);	// and their values
+	rowptr.assign(nbpoin+1, 0);
+	int* const rowlen = rowptr.data()+1;
 
-		for(j = i+1; j < nbpoin; j++)		// traverse lower triangular matrix
+	#pragma omp parallel default(none) private(ib) shared(bpoints,rbftype,rbfscale,nbpoin,ndim,compact,sr,mintol,tree,bcols,bvals,upper,rowlen,nblocks,blocksize)
+	{
+		std::vector<amc_int> nbrs;			// candidate columns of the current row
+		std::vector<amc_real> dists;		// distances of the corresponding boundary points from boundary point i
+		std::vector<amc_real> phi;			// RBF values at those distances
+		std::vector<amc_int> ord;			// ordering of candidates by column index
+		amc_real x[KDTREE_MAX_DIM];
+
+		#pragma omp for schedule(dynamic)
+		for(ib = 0; ib < nblocks; ib++)
 		{
-			dist = 0;
-			for(int id = 0; id < ndim; id++)
-				dist += (bpoints->get(i,id) - bpoints->get(j,id))*(bpoints->get(i,id) - bpoints->get(j,id));
-			dist = sqrt(dist);
-			temp = (this->*rbfunc)(dist);
-			//std::cout << temp << " ";
-			if(fabs(temp) > tol*tol)
+			const int iend = std::min((ib+1)*blocksize, nbpoin);
+			for(int i = ib*blocksize; i < iend; i++)
 			{
-				A->set(i,j, temp);
-				A->set(j,i, temp);
+				nbrs.clear(); dists.clear();
+				if(compact)
+				{
+					for(int id = 0; id < ndim; id++)
+						x[id] = bpoints->get(i,id);
+					tree->radiusSearch(x, sr, nbrs, dists);
+				}
+				else
+				{
+					for(amc_int j = upper ? i : 0; j < nbpoin; j++)
+					{
+						double dist = 0;
+						for(int id = 0; id < ndim; id++)
+							dist += (bpoints->get(i,id) - bpoints->get(j,id))*(bpoints->get(i,id) - bpoints->get(j,id));
+						nbrs.push_back(j);
+						dists.push_back(sqrt(dist));
+					}
+				}
+
+				phi.resize(dists.size());
+				rbf_batch(rbftype, dists.size(), dists.data(), rbfscale, phi.data());
+
+				ord.resize(nbrs.size());
+				for(size_t k = 0; k < nbrs.size(); k++)
+					ord[k] = k;
+				std::sort(ord.begin(), ord.end(), [&nbrs](const amc_int a, const amc_int b) { return nbrs[a] < nbrs[b]; });
+
+				// the diagonal is always kept, so in the upper triangle it is the first entry of the row
+				const size_t start = bcols[ib].size();
+				for(size_t k = 0; k < ord.size(); k++)
+				{
+					const amc_int j = nbrs[ord[k]];
+					if(upper && j < i) continue;
+					double temp = phi[ord[k]];
+					if(fabs(temp) > mintol || j == i)
+					{
+						bcols[ib].push_back(j);
+						bvals[ib].push_back(temp);
+					}
+				}
+				rowlen[i] = bcols[ib].size()-start;
 			}
 		}
 	}
 
+	for(int i = 0; i < nbpoin; i++)
+		rowptr[i+1] += rowptr[i];
+	colind.resize(rowptr[nbpoin]);
+	vals.resize(rowptr[nbpoin]);
+	for(ib = 0; ib < nblocks; ib++)
+	{
+		std::copy(bcols[ib].begin(), bcols[ib].end(), colind.begin()+rowptr[ib*blocksize]);
+		std::copy(bvals[ib].begin(), bvals[ib].end(), vals.begin()+rowptr[ib*blocksize]);
+		std::vector<int>().swap(bcols[ib]);
+		std::vector<amc_real>().swap(bvals[ib]);
+	}
+}
+
+void RBFmove::assembleLHS()
+{
+	std::cout << "RBFmove:  assembleLHS(): assembling LHS matrix" << std::endl;
+	std::vector<int> rowptr, colind;
+	std::vector<amc_real> vals;
+	const bool upper = upper_only();
+	assemble_rows(upper, rowptr, colind, vals);
+
+	if(upper) {
+		As.assign_upper(nbpoin, rowptr, colind, vals);
+		return;
+	}
+	if(lsolver == "BICGSTAB" || lsolver == "BICGSTAB-ILU0" || lsolver == "BICGSTAB-ILUT") {
+		Af.take(nbpoin, nbpoin, rowptr, colind, vals);
+		if(!Af.build_sell())
+			std::cout << "RBFmove:  assembleLHS(): Rows vary too much in length for SELL-C-sigma; using CSR" << std::endl;
+		return;
+	}
+
+	amat::SpMatrix* A = &(RBFmove::A);
+	int i;
+	#pragma omp parallel for default(none) private(i) shared(A,rowptr,colind,vals)
+	for(i = 0; i < nbpoin; i++)
+		A->setrow(i, rowptr[i+1]-rowptr[i], &colind[rowptr[i]], &vals[rowptr[i]]);
+	A->update_nnz();
+
 	/*std::cout << "RBFmove:  assembleLHS(): assembling P_b" << std::endl;
 	// set P_b and P_b transpose
 	for(i = 0; i < nbpoin; i++)
@@ -222,30 +325,241 @@ void RBFmove::assembleLHS()
 	fout.close();*/
 }
 
-void RBFmove::move_step()
+void RBFmove::select_centres()
 {
-	// solve for RBF coefficients
-	std::cout << "RBFmove:  move_step(): Solving linear system" << std::endl;
+	std::cout << "RBFmove: select_centres(): Selecting RBF centres from " << nbpoin << " boundary points" << std::endl;
+	auto tstart = std::chrono::steady_clock::now();
+
+	const int N = nbpoin;
+	int i, idim;
+
+	// the full interpolation matrix gives the RBF values between boundary points; only needed for compact RBFs
+	std::vector<int> frowptr, fcolind;
+	std::vector<amc_real> fval;
+	if(compact)
+		assemble_rows(false, frowptr, fcolind, fval);
+
+	std::vector<int> cpos(N,-1);			// position of each boundary point in the list of centres, or -1
+	std::vector<amc_real> Lp;				// Cholesky factor of the centre matrix, packed by rows
+	std::vector<amc_real> row;				// new row of the Cholesky factor
+	std::vector<amc_real> y, c;				// intermediate and final coefficients, ncentres x ndim
+	amat::Matrix<amc_real> interp(N,ndim);	// current interpolated displacement at all boundary points
+	std::vector<amc_real> err(N);
+	centres.clear();
+
+	// maximum boundary displacement, which also gives the first centre
+	amc_real bmax = 0; int inew = 0;
+	for(i = 0; i < N; i++)
+	{
+		amc_real mag = 0;
+		for(idim = 0; idim < ndim; idim++)
+			mag += b[idim].get(i)*b[idim].get(i);
+		if(mag > bmax) { bmax = mag; inew = i; }
+	}
+	bmax = sqrt(bmax);
+	const amc_real errtol = greedytol*bmax;
+	amc_real maxerr = bmax;
+
+	while(maxerr > errtol && (int)centres.size() < N)
+	{
+		const int k = centres.size();
+
+		// RBF values between the new centre and existing centres
+		row.assign(k+1, 0.0);
+		if(compact)
+		{
+			for(int jj = frowptr[inew]; jj < frowptr[inew+1]; jj++)
+				if(cpos[fcolind[jj]] >= 0)
+					row[cpos[fcolind[jj]]] = fval[jj];
+		}
+		else
+			for(int j = 0; j < k; j++)
+			{
+				amc_real dist = 0;
+				for(idim = 0; idim < ndim; idim++)
+					dist += (bpoints.get(inew,idim)-bpoints.get(centres[j],idim))*(bpoints.get(inew,idim)-bpoints.get(centres[j],idim));
+				row[j] = rbf_eval(rbftype, rbfscale*sqrt(dist));
+			}
+		row[k] = rbf_eval(rbftype, 0.0);
+
+		// update the Cholesky factor: solve L l = a, then the new diagonal is sqrt(phi(0) - l.l)
+		amc_real diag = row[k];
+		for(int j = 0; j < k; j++)
+		{
+			const amc_real* Lj = &Lp[(size_t)j*(j+1)/2];
+			amc_real sum = row[j];
+			for(int l = 0; l < j; l++)
+				sum -= Lj[l]*row[l];
+			row[j] = sum/Lj[j];
+			diag -= row[j]*row[j];
+		}
+		if(diag <= A_SMALL_NUMBER*row[k]) {
+			std::cout << "RBFmove: select_centres(): ! Centre matrix is numerically singular; stopping with " << k << " centres." << std::endl;
+			break;
+		}
+		row[k] = sqrt(diag);
+		Lp.insert(Lp.end(), row.begin(), row.end());
+		centres.push_back(inew);
+		cpos[inew] = k;
+
+		// solve for the coefficients with the new factor
+		y.resize((k+1)*ndim); c.resize((k+1)*ndim);
+		for(int j = 0; j <= k; j++)
+		{
+			const amc_real* Lj = &Lp[(size_t)j*(j+1)/2];
+			for(idim = 0; idim < ndim; idim++)
+			{
+				amc_real sum = b[idim].get(centres[j]);
+				for(int l = 0; l < j; l++)
+					sum -= Lj[l]*y[l*ndim+idim];
+				y[j*ndim+idim] = sum/Lj[j];
+			}
+		}
+		for(int j = k; j >= 0; j--)
+		{
+			const amc_real* Lj = &Lp[(size_t)j*(j+1)/2];
+			for(idim = 0; idim < ndim; idim++)
+				c[j*ndim+idim] = y[j*ndim+idim]/Lj[j];
+			for(int l = 0; l < j; l++)
+				for(idim = 0; idim < ndim; idim++)
+					y[l*ndim+idim] -= Lj[l]*c[j*ndim+idim];
+		}
+
+		// evaluate the interpolant and its error at all boundary points
+		#pragma omp parallel for default(none) private(i,idim) shared(frowptr,fcolind,fval,cpos,c,interp,err,k,N)
+		for(i = 0; i < N; i++)
+		{
+			for(idim = 0; idim < ndim; idim++)
+				interp(i,idim) = 0;
+			if(compact)
+			{
+				for(int jj = frowptr[i]; jj < frowptr[i+1]; jj++)
+					if(cpos[fcolind[jj]] >= 0)
+						for(idim = 0; idim < ndim; idim++)
+							interp(i,idim) += c[cpos[fcolind[jj]]*ndim+idim]*fval[jj];
+			}
+			else
+				for(int j = 0; j <= k; j++)
+				{
+					amc_real dist = 0;
+					for(idim = 0; idim < ndim; idim++)
+						dist += (bpoints.get(i,idim)-bpoints.get(centres[j],idim))*(bpoints.get(i,idim)-bpoints.get(centres[j],idim));
+					amc_real phi = rbf_eval(rbftype, rbfscale*sqrt(dist));
+					for(idim = 0; idim < ndim; idim++)
+						interp(i,idim) += c[j*ndim+idim]*phi;
+				}
+
+			amc_real e = 0;
+			for(idim = 0; idim < ndim; idim++)
+				e += (b[idim].get(i)-interp.get(i,idim))*(b[idim].get(i)-interp.get(i,idim));
+			err[i] = sqrt(e);
+		}
+
+		maxerr = 0;
+		for(i = 0; i < N; i++)
+			if(cpos[i] < 0 && err[i] > maxerr) { maxerr = err[i]; inew = i; }
+	}
+
+	const int nc = centres.size();
+	std::cout << "RBFmove: select_centres(): Selected " << nc << " centres out of " << N << " boundary points; max interpolation error " << maxerr
+		<< " (max displacement " << bmax << ")" << std::endl;
+
+	if(nc == N)
+	{
+		std::cout << "RBFmove: select_centres(): All boundary points are needed as centres." << std::endl;
+		centres.clear();
+		return;
+	}
+
+	// keep all boundary points separately, and reduce bpoints and the RHS to the centres
+	allbpoints = bpoints;
+	allb.setup(N,ndim);
+	for(i = 0; i < N; i++)
+		for(idim = 0; idim < ndim; idim++)
+			allb(i,idim) = b[idim].get(i);
+
+	bpoints.setup(nc,ndim);
+	for(int j = 0; j < nc; j++)
+		for(idim = 0; idim < ndim; idim++)
+			bpoints(j,idim) = allbpoints.get(centres[j],idim);
+	for(idim = 0; idim < ndim; idim++)
+	{
+		b[idim].setup(nc,1);
+		coeffs[idim].setup(nc,1);
+		for(int j = 0; j < nc; j++)
+			b[idim](j) = allb.get(centres[j],idim);
+	}
+	nbpoin = nc;
+	A.setup(nbpoin,nbpoin);
+
+	std::chrono::duration<double> tsel = std::chrono::steady_clock::now() - tstart;
+	std::cout << "RBFmove: select_centres(): Time taken for centre selection = " << tsel.count() << " s" << std::endl;
+}
+
+bool RBFmove::compute_coeffs()
+{
+	std::cout << "RBFmove:  compute_coeffs(): Solving linear system" << std::endl;
 	amat::Matrix<double> xold(nbpoin,1);
 	xold.zeros();
 	
-	if(lsolver == "CG")
-		for(int idim = 0; idim < ndim; idim++)
-		{
-			coeffs[idim] = sparseCG(&A, b[idim], xold, tol, maxiter);
-		}	
-	else if(lsolver == "PCG")
+	if(upper_only())
+	{
+		// the matrix is symmetric, so only its upper triangle was assembled, into As
+		amat::IC0 ic;
+		const amat::Preconditioner* precon = nullptr;
+		if(lsolver == "PCG-IC0") {
+			if(ic.setup(As))
+				precon = &ic;
+			else
+				std::cout << "! RBFmove: compute_coeffs(): Incomplete Cholesky factorization failed; using the diagonal preconditioner instead." << std::endl;
+		}
 		for(int idim = 0; idim < ndim; idim++)
 		{
-			coeffs[idim] = sparseCG_d(&A, b[idim], xold, tol, maxiter);
+			if(lsolver == "CG")
+				coeffs[idim] = sparseCG(&As, b[idim], xold, tol, maxiter);
+			else if(lsolver == "PCG" || lsolver == "PCG-IC0")
+				coeffs[idim] = sparseCG_d(&As, b[idim], xold, tol, maxiter, precon);
+			else
+				coeffs[idim] = sparseCG_ssor(&As, b[idim], xold, tol, maxiter);
+		}
+	}
+	else if(lsolver == "BICGSTAB" || lsolver == "BICGSTAB-ILU0" || lsolver == "BICGSTAB-ILUT")
+	{
+		// the matrix was assembled into Af, which BiCGSTAB and the incomplete factorizations need
+		amat::ILU0 ilu0;
+		amat::ILUT ilut;
+		const amat::Preconditioner* precon = nullptr;
+		// if the incomplete factorization fails, BiCGSTAB falls back to its default Jacobi preconditioner
+		if(lsolver == "BICGSTAB-ILU0") {
+			if(ilu0.setup(Af))
+				precon = &ilu0;
+			else
+				std::cout << "! RBFmove: compute_coeffs(): ILU0 factorization failed; using the Jacobi preconditioner instead." << std::endl;
+		}
+		else if(lsolver == "BICGSTAB-ILUT") {
+			if(ilut.setup(Af))
+				precon = &ilut;
+			else
+				std::cout << "! RBFmove: compute_coeffs(): ILUT factorization failed; using the Jacobi preconditioner instead." << std::endl;
 		}
+		for(int idim = 0; idim < ndim; idim++)
+			coeffs[idim] = sparse_bicgstab(&Af, b[idim], xold, tol, maxiter, precon);
+	}
 	else if(lsolver == "SOR")
 		for(int idim = 0; idim < ndim; idim++)
 			coeffs[idim] = sparseSOR(&A, b[idim], xold, tol, maxiter);
-	else if(lsolver == "BICGSTAB")
+	else if(lsolver == "TREECG")
+	{
+		// the interpolation matrix is never assembled; its products with vectors are computed by the tree-code.
+		// As in assembleLHS(), the Gaussian is not truncated at the support radius in the interpolation matrix.
+		// The products are only approximate and not exactly symmetric, so the opening angle is chosen for an error below tol.
+		const amc_real theta = RBFTreecode::opening_angle(tol);
+		std::cout << "RBFmove:  compute_coeffs(): Tree-code opening angle = " << theta << std::endl;
+		tcode.setup(&bpoints, rbftype, rbfscale, compact ? srad : std::numeric_limits<amc_real>::max(), theta);
 		for(int idim = 0; idim < ndim; idim++)
-			coeffs[idim] = sparse_bicgstab(&A, b[idim], xold, tol, maxiter);
-	else if(lsolver == "DLU")
+			coeffs[idim] = matfreeCG(&tcode, b[idim], xold, tol, maxiter);
+	}
+	else if(lsolver == "DLU" || lsolver == "DCHOL")
 	{
 		amat::Matrix<double> coeffsm(nbpoin,ndim);
 		amat::Matrix<double> rhs(nbpoin,ndim);
@@ -255,7 +569,24 @@ void RBFmove::move_step()
 			for(int j = 0; j < ndim; j++)
 				rhs(i,j) = b[j](i);
 		
-		gausselim(B, rhs, coeffsm);
+		// factor once, then back-substitute for all coordinate directions together
+		if(lsolver == "DLU")
+		{
+			amat::Matrix<int> piv;
+			if(!LUfactor(B, piv)) {
+				std::cout << "! RBFmove: compute_coeffs(): LU factorization of the RBF matrix failed!" << std::endl;
+				return false;
+			}
+			LUsolve(B, piv, rhs, coeffsm);
+		}
+		else
+		{
+			if(!cholfactor(B)) {
+				std::cout << "! RBFmove: compute_coeffs(): Cholesky factorization of the RBF matrix failed!" << std::endl;
+				return false;
+			}
+			cholsolve(B, rhs, coeffsm);
+		}
 		
 		for(int i = 0; i < nbpoin; i++)
 			for(int j = 0; j < ndim; j++)
@@ -300,76 +631,161 @@ void RBFmove::move_step()
 		//coeffs[idim] = sparsePCG(&A, b[idim], xold, "jacobi", tol, maxiter);
 		//coeffs[idim] = sparsegaussseidel(&A, b[idim], xold, tol, maxiter);
 		//coeffs[idim] = gausselim(B, b[idim]);
+	return true;
+}
 
-	std::cout << "RBFmove:  move_step(): Moving interior points" << std::endl;
+void RBFmove::move_interior()
+{
+	std::cout << "RBFmove:  move_interior(): Moving interior points" << std::endl;
 	// calculate new positions of interior points
 	int i;
-	amat::Matrix<double>* co = coeffs;			// first assign local pointers to class variables for OpenMP
-	amat::Matrix<double>* bp = &bpoints;
 	amat::Matrix<double>* ip = &inpoints;
-	double (RBFmove::*rbfunc)(double) = rbf;
+	const RBFKernelType rbftype = RBFmove::rbftype;
+	const amc_real rbfscale = RBFmove::rbfscale;
 	int nbpoin = RBFmove::nbpoin;
 	int ninpoin = RBFmove::ninpoin;
 	int ndim = RBFmove::ndim;
 	amc_real sr = RBFmove::srad;
 
-	#pragma omp parallel for default(none) private(i) shared(co, bp, ip, rbfunc, nbpoin, ninpoin, ndim)
-	for(i = 0; i < ninpoin; i++)
+	if(!compact || lsolver == "TREECG")
 	{
-		double* sum = new double[ndim];		// for storing sum of RBFs corresponding to an interior point
-		double* psum = new double[ndim];	// for storing value of linear polynomial corresponding to an interior point
-
-		int j;
-		for(j = 0; j < ndim; j++)
-		{
-			sum[j] = 0;
-			psum[j] = 1.0;
-		}
+		// hierarchical summation over the boundary points within the support radius; as in the solve, the Gaussian is not truncated.
+		// The opening angle matches the accuracy of iteratively computed coefficients. Coefficients from a direct solver are exact,
+		// so then no node is accepted for expansion and the tree-code reduces to direct summation.
+		const bool direct = lsolver == "DLU" || lsolver == "DCHOL" || lsolver == "EIGENLU" || lsolver == "PASTIXLDLT";
+		tcode.setup(&bpoints, rbftype, rbfscale, compact ? srad : std::numeric_limits<amc_real>::max(),
+				direct ? 0.0 : RBFTreecode::opening_angle(tol));
+
+		amat::Matrix<amc_real> cm(nbpoin,ndim), disp;
+		for(int j = 0; j < nbpoin; j++)
+			for(int idim = 0; idim < ndim; idim++)
+				cm(j,idim) = coeffs[idim].get(j);
+		tcode.evaluate(inpoints, cm, disp);
 
-		// get RBF part
-		for(j = 0; j < nbpoin; j++)
-		{
-			double dist = 0;
+		for(i = 0; i < ninpoin; i++)
 			for(int idim = 0; idim < ndim; idim++)
-				dist += (ip->get(i,idim)-bp->get(j,idim))*(ip->get(i,idim)-bp->get(j,idim));
-			dist = sqrt(dist);
+				inpoints(i,idim) += disp.get(i,idim);
+		return;
+	}
 
-			if(dist < srad)	
-				for(int idim = 0; idim < ndim; idim++)
-					sum[idim] += co[idim].get(j) * (this->*rbfunc)(dist);
-		}
+	// gather the coefficients of all directions for each boundary point contiguously
+	std::vector<amc_real> cm(nbpoin*ndim);
+	for(int j = 0; j < nbpoin; j++)
+		for(int idim = 0; idim < ndim; idim++)
+			cm[j*ndim+idim] = coeffs[idim].get(j);
+	const amc_real* co = cm.data();
 
-		//get polynomial part
-		/*for(int idim = 0; idim < ndim; idim++)
-			for(int jdim = 0; jdim < ndim; jdim++)
-				psum[idim] += co[idim].get(nbpoin+1+jdim) * ip->get(i, jdim);*/
+	// only the boundary points within the support radius of an interior point contribute to its motion
+	// btree was built over bpoints in assembleLHS()
+	const KDTree* tree = &btree;
 
-		for(int idim = 0; idim < ndim; idim++)
+	#pragma omp parallel default(none) private(i) shared(co, ip, rbftype, rbfscale, ninpoin, ndim, sr, tree)
+	{
+		std::vector<amc_int> nbrs;		// boundary points inside the support of the current interior point
+		std::vector<amc_real> dists;	// their distances from the interior point
+		std::vector<amc_real> phi;		// RBF values at those distances
+		nbrs.reserve(64); dists.reserve(64);
+		amc_real x[KDTREE_MAX_DIM];
+		amc_real sum[KDTREE_MAX_DIM];
+
+		#pragma omp for
+		for(i = 0; i < ninpoin; i++)
 		{
-			(*ip)(i,idim) += sum[idim];
+			int idim;
+			for(idim = 0; idim < ndim; idim++)
+			{
+				x[idim] = ip->get(i,idim);
+				sum[idim] = 0;
+			}
+
+			nbrs.clear(); dists.clear();
+			amc_int nn = tree->radiusSearch(x, sr, nbrs, dists);
+			phi.resize(nn);
+			rbf_batch(rbftype, nn, dists.data(), rbfscale, phi.data());
+
+			for(amc_int k = 0; k < nn; k++)
+				for(idim = 0; idim < ndim; idim++)
+					sum[idim] += co[nbrs[k]*ndim+idim] * phi[k];
+
+			for(idim = 0; idim < ndim; idim++)
+				(*ip)(i,idim) += sum[idim];
 		}
+	}
+}
+
+bool RBFmove::move_step()
+{
+	if(!compute_coeffs())
+		return false;
+	move_interior();
+	return true;
+}
 
-		delete [] sum;
-		delete [] psum;
+void RBFmove::move_boundary(const double factor)
+{
+	int i, j;
+	if(nallbpoin == nbpoin)
+	{
+		for(i = 0; i < nbpoin; i++)
+			for(j = 0; j < ndim; j++)
+				bpoints(i,j) += factor*b[j](i);
+		return;
 	}
+
+	// only a subset of boundary points are centres; move all of them, then update the centres
+	for(i = 0; i < nallbpoin; i++)
+		for(j = 0; j < ndim; j++)
+			allbpoints(i,j) += factor*allb.get(i,j);
+	for(i = 0; i < nbpoin; i++)
+		for(j = 0; j < ndim; j++)
+			bpoints(i,j) = allbpoints.get(centres[i],j);
 }
 
-void RBFmove::move()
+bool RBFmove::move()
 {
 	int istep;
 
+	if(greedytol > 0)
+		select_centres();
+
+	// wall-clock times for assembly, solution of the RBF systems and movement of the interior points, over all steps
+	std::chrono::duration<double> tasm(0), tsolve(0), tinterior(0);
 	for(istep = 0; istep < nsteps; istep++)
 	{
 		std::cout << "RBFmove: move(): Step " << istep << std::endl;
-		assembleLHS();
+		if(!frozen || istep == 0)
+		{
+			auto t0 = std::chrono::steady_clock::now();
+			if(lsolver != "TREECG")
+				assembleLHS();
+			auto t1 = std::chrono::steady_clock::now();
+			const bool solved = compute_coeffs();
+			tasm += t1-t0;
+			tsolve += std::chrono::steady_clock::now()-t1;
+			if(!solved) {
+				std::cout << "! RBFmove: move(): Could not solve for the RBF coefficients in step " << istep << "; stopping." << std::endl;
+				return false;
+			}
+		}
 
-		move_step();
+		auto t2 = std::chrono::steady_clock::now();
+		move_interior();
+		tinterior += std::chrono::steady_clock::now()-t2;
 
 		// move buondary points
-		for(int i = 0; i < nbpoin; i++)
-			for(int j = 0; j < ndim; j++)
-				bpoints(i,j) += b[j](i);
+		if(!frozen)
+			move_boundary(1.0);
 	}
+
+	// with frozen centres, the boundary points are moved only after all steps
+	if(frozen)
+		move_boundary(nsteps);
+
+	std::cout << "RBFmove: move(): Time taken for assembly = " << tasm.count() << " s, linear solves = " << tsolve.count()
+		<< " s, interior movement = " << tinterior.count() << " s" << std::endl;
+	if(nallbpoin != nbpoin)
+		std::cout << "RBFmove: move(): Used " << nbpoin << " of " << nallbpoin << " boundary points as centres" << std::endl;
+	return true;
 }
 
 amat::Matrix<double> RBFmove::getInteriorPoints()
@@ -379,6 +795,8 @@ amat::Matrix<double> RBFmove::getInteriorPoints()
 
 amat::Matrix<double> RBFmove::getBoundaryPoints()
 {
+	if(nallbpoin != nbpoin)
+		return allbpoints;
 	return bpoints;
 }
 
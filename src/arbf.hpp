@@ -19,10 +19,38 @@
 #include <string>
 #endif
 
+#ifndef _GLIBCXX_ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef _GLIBCXX_CHRONO
+#include <chrono>
+#endif
+
+#ifndef _GLIBCXX_NUMERIC_LIMITS
+#include <limits>
+#endif
+
 #ifndef __ALINALG_H
 #include <alinalg.hpp>
 #endif
 
+#ifndef __APRECON_H
+#include <aprecon.hpp>
+#endif
+
+#ifndef __AKDTREE_H
+#include <akdtree.hpp>
+#endif
+
+#ifndef __ARBFKERNELS_H
+#include <arbfkernels.hpp>
+#endif
+
+#ifndef __ARBFTREECODE_H
+#include <arbftreecode.hpp>
+#endif
+
 #define __ARBF_H 1
 
 namespace amc {
@@ -40,21 +68,57 @@ class RBFmove
 	int ninpoin;		///< number of interior points
 	int nbpoin;			///< number of boundary points
 	int ndim;
-	double (RBFmove::*rbf)(double);
+	RBFKernelType rbftype;	///< The RBF to use; see arbfkernels.hpp
 	double srad;
+	double rbfscale;		///< Factor by which distances are multiplied before evaluating the RBF - 1/[srad](@ref srad) for compact RBFs, 1 for the Gaussian
+	bool compact;		///< True if the RBF has compact support, in which case a spatial search is used to find boundary points within the support radius
+	KDTree btree;		///< k-d tree over [bpoints](@ref bpoints), re-built every step
+	RBFTreecode tcode;	///< Tree-code over [bpoints](@ref bpoints), used for global RBFs and by the "TREECG" solver
 
 	int nsteps;			///< Number of steps in which to carry out the movement. More steps lead to better results upto a certain number of steps.
 	double tol;
 	int maxiter;
 
 	amat::SpMatrix A;					///< LHS matrix; contains RBF values relative to pairs of boundary points, and coordinates of boundary points
+	amat::MatrixSymCSR<amc_real> As;	///< Upper triangle of the LHS matrix, which is all that is assembled for the CG solvers
+	amat::MatrixCSR<amc_real> Af;		///< LHS matrix in flat storage, as assembled for the BiCGSTAB solvers
 	amat::Matrix<double>* coeffs;		///< contains coefficients of RBFs and linear polynomial for each boundary point
 	amat::Matrix<double>* b;			///< rhs for each of the dimensions; contains displacements of boundary points
 	bool isalloc;				///< This flag is true if both [b](@ref b) and [coeffs](@ref coeffs) have been allocated
 	
-	/// string indicating the solver to use - options are 'CG', 'SOR', 'BICGSTAB' or 'LU' (defaults to LU)
+	/// string indicating the solver to use - options are 'CG', 'PCG', 'PCG-IC0', 'SSORCG', 'SOR', 'BICGSTAB', 'BICGSTAB-ILU0', 'BICGSTAB-ILUT', 'DLU', 'DCHOL' or 'TREECG'
+	/** 'TREECG' is matrix-free CG, with products of the interpolation matrix and vectors computed by the [tree-code](@ref RBFTreecode);
+	 * the matrix is never assembled. The tree-code's opening angle is chosen from the solver tolerance. It pays off only for
+	 * loose tolerances (about 1e-3 or larger); for tolerances below about 1e-4 it is essentially direct summation.
+	 */
 	std::string lsolver;
 
+	/// If true, the RBF centres are kept at the initial positions of the boundary points for all steps
+	/** The interpolation matrix and its right-hand sides are then the same for every step,
+	 * so the system is assembled and solved only once, in the first step.
+	 */
+	bool frozen;
+
+	/// Relative tolerance for greedy selection of RBF centres; if zero, all boundary points are used as centres
+	/** See [select_centres](@ref select_centres).
+	 */
+	double greedytol;
+	std::vector<amc_int> centres;		///< Indices (into the full list of boundary points) of the boundary points selected as RBF centres
+	int nallbpoin;						///< Total number of boundary points, including those not used as centres
+	amat::Matrix<double> allbpoints;	///< All boundary points, when only a subset of them are RBF centres
+	amat::Matrix<double> allb;			///< Displacement of all boundary points in each step, when only a subset of them are RBF centres
+
+	/// Adds factor times the per-step displacement to the boundary points
+	void move_boundary(const double factor);
+
+	/// True if the solver only needs the upper triangle of the LHS matrix, in [As](@ref As)
+	bool upper_only() const;
+
+	/// Computes the rows of the interpolation matrix in compressed row storage, with the column indices of each row sorted
+	/** \param upper if true, only the upper triangle is computed; each row then begins with its diagonal entry
+	 */
+	void assemble_rows(const bool upper, std::vector<int>& rowptr, std::vector<int>& colind, std::vector<amc_real>& vals);
+
 public:
 
 	/// No-arg constructor
@@ -67,10 +131,12 @@ public:
 	 * \param boundary_motion is nbpoin-by-ndim array - containing displacements corresponding to boundary points.
 	 * \param rbf_ch indicates the RBF to use - 0 : C0, 2 : C2, 4 : C4, default : Gaussian
 	 * \param num_steps is the number of steps in which to break up the movement to perform separately (sequentially)
-	 * \param linear_solver indicates the linear solver to use to solve the RBF equations - "DLU", "CG", "LU"
+	 * \param linear_solver indicates the linear solver to use to solve the RBF equations - "DLU", "DCHOL", "CG", "PCG", "PCG-IC0", "SSORCG", "SOR", "BICGSTAB", "BICGSTAB-ILU0", "BICGSTAB-ILUT", "TREECG"
+	 * \param frozen_centres if true, the RBF centres are not moved between steps (see [frozen](@ref frozen))
+	 * \param greedy_tolerance if positive, only a subset of boundary points are used as RBF centres (see [select_centres](@ref select_centres))
 	 */
 	RBFmove(amat::Matrix<double>* int_points, amat::Matrix<double>* boun_points, amat::Matrix<double>* boundary_motion, const int rbf_ch, const double support_radius, const int num_steps, 
-			const double tolerance, const int iter, const std::string linear_solver);
+			const double tolerance, const int iter, const std::string linear_solver, const bool frozen_centres = false, const double greedy_tolerance = 0.0);
 
 	/// Sets the data needed
 	/** Note that all parameters are deep-copied.
@@ -79,12 +145,14 @@ public:
 	 * \param boundary_motion is nbpoin-by-ndim array - containing displacements corresponding to boundary points.
 	 * \param rbf_ch indicates the RBF to use - 0 : C0, 2 : C2, 4 : C4, default : Gaussian
 	 * \param num_steps is the number of steps in which to break up the movement to perform separately (sequentially)
-	 * \param linear_solver indicates the linear solver to use to solve the RBF equations - "DLU", "CG", "LU"
+	 * \param linear_solver indicates the linear solver to use to solve the RBF equations - "DLU", "DCHOL", "CG", "PCG", "PCG-IC0", "SSORCG", "SOR", "BICGSTAB", "BICGSTAB-ILU0", "BICGSTAB-ILUT", "TREECG"
+	 * \param frozen_centres if true, the RBF centres are not moved between steps (see [frozen](@ref frozen))
+	 * \param greedy_tolerance if positive, only a subset of boundary points are used as RBF centres (see [select_centres](@ref select_centres))
 	 * 
 	 * \note The use of this function is deprecated; use the constructor instead.
 	 */
 	void setup(amat::Matrix<double>* int_points, amat::Matrix<double>* boun_points, amat::Matrix<double>* boundary_motion, const int rbf_ch, const double support_radius, const int num_steps, 
-			const double tolerance, const int iter, const std::string linear_solver);
+			const double tolerance, const int iter, const std::string linear_solver, const bool frozen_centres = false, const double greedy_tolerance = 0.0);
 
 	~RBFmove();
 
@@ -97,15 +165,46 @@ public:
 	double gaussian(double xi);
 
 	/// Assembles the LHS matrix.
+	/** For the CG solvers, only its upper triangle is assembled, into [As](@ref As). For the BiCGSTAB solvers, the matrix is assembled
+	 * into [Af](@ref Af), with a SELL-C-sigma copy if that is cheaper. Otherwise, the full matrix is assembled into [A](@ref A).
+	 */
 	void assembleLHS();
 
+	/// Greedily selects a subset of the boundary points to use as RBF centres, following Rendall and Allen (2009)
+	/** Starting with the boundary point having the largest displacement, the point at which the current interpolant
+	 * has the largest error is added to the set of centres, until the largest error at any boundary point is
+	 * less than [greedytol](@ref greedytol) times the largest boundary displacement.
+	 * The interpolation matrix for the centres is factored by a Cholesky factorization that is updated with each new centre,
+	 * so it must be positive definite (true for the Wendland functions and the Gaussian).
+	 * Thereafter, only the selected centres are used by [assembleLHS](@ref assembleLHS) and [move_interior](@ref move_interior),
+	 * while the other boundary points are moved by their own displacements.
+	 */
+	void select_centres();
+
+	/// Solves the RBF system for the coefficients of all coordinate directions.
+	/** The direct solvers ("DLU", "DCHOL") factor the matrix once and back-substitute for all ndim right-hand sides together.
+	 * If an incomplete factorization preconditioner cannot be computed, the iterative solver falls back to its default
+	 * diagonal (Jacobi) preconditioner, after printing a warning.
+	 * \return false if the matrix could not be factored by a direct solver, in which case the coefficients are not updated
+	 */
+	bool compute_coeffs();
+
+	/// Moves the interior points using the current RBF coefficients.
+	/** For compact RBFs, the boundary points within the support radius of each interior point are found from [btree](@ref btree).
+	 * For the Gaussian, or with the "TREECG" solver, the sums are evaluated by the [tree-code](@ref RBFTreecode).
+	 */
+	void move_interior();
+
 	/// Executes 1 step of the mesh movement.
-	void move_step();
+	/** \return false if the coefficients could not be computed; the points are then not moved
+	 */
+	bool move_step();
 
 	/// Uses [move_step](@ref move_step) to execute the total number of steps specified.
 	/** This function calls all other required functions, so it should be used directly after setup.
+	 * \return false if the RBF system of some step could not be solved; the movement stops at the beginning of that step
 	 */
-	void move();
+	bool move();
 
 	/// Returns new positions of interior points.
 	amat::Matrix<double> getInteriorPoints();
@@ -0,0 +1,187 @@
+/** \file arbfkernels.hpp
+ * \brief Radial basis functions, selected at compile time and evaluated in batches over arrays of distances.
+ * \author Aditya Kashi
+ *
+ * Each kernel is a struct with static inline functions eval(), deriv() and deriv2() of the scaled distance q;
+ * the derivatives are used by the tree-code in arbftreecode.hpp.
+ * The compact (Wendland) functions are written without branches, using \f$ (1-q)_+ = \frac12 (1-q + |1-q|) \f$,
+ * so that loops over arrays of distances can be vectorized by the compiler (eg. with AVX when built with -mavx).
+ * (GCC does not if-convert a comparison or fmax here without -ffast-math.)
+ */
+
+#ifndef __ARBFKERNELS_H
+
+#ifndef _GLIBCXX_CMATH
+#include <cmath>
+#endif
+
+#ifndef __ACONSTANTS_H
+#include <aconstants.h>
+#endif
+
+#define __ARBFKERNELS_H 1
+
+namespace amc {
+
+/// Identifies a radial basis function; the values of the compact functions are the RBF choices used in control files
+enum RBFKernelType { RBF_C0 = 0, RBF_C2 = 2, RBF_C4 = 4, RBF_GAUSSIAN = 10 };
+
+/// Positive part of x, without branches
+inline amc_real rbf_pospart(const amc_real x)
+{
+	return 0.5*(x + fabs(x));
+}
+
+/// Wendland's C0 function \f$ (1-q)_+^2 \f$
+struct WendlandC0
+{
+	static const bool compact = true;
+	static inline amc_real eval(const amc_real q)
+	{
+		const amc_real t = rbf_pospart(1.0-q);
+		return t*t;
+	}
+	/// Derivative with respect to q
+	static inline amc_real deriv(const amc_real q)
+	{
+		return -2.0*rbf_pospart(1.0-q);
+	}
+	/// Second derivative with respect to q
+	static inline amc_real deriv2(const amc_real q)
+	{
+		return q < 1.0 ? 2.0 : 0.0;
+	}
+};
+
+/// Wendland's C2 function \f$ (1-q)_+^4 (4q+1) \f$
+struct WendlandC2
+{
+	static const bool compact = true;
+	static inline amc_real eval(const amc_real q)
+	{
+		const amc_real t = rbf_pospart(1.0-q);
+		const amc_real t2 = t*t;
+		return t2*t2*(4.0*q+1.0);
+	}
+	static inline amc_real deriv(const amc_real q)
+	{
+		const amc_real t = rbf_pospart(1.0-q);
+		return -20.0*q*t*t*t;
+	}
+	static inline amc_real deriv2(const amc_real q)
+	{
+		const amc_real t = rbf_pospart(1.0-q);
+		return 20.0*t*t*(4.0*q-1.0);
+	}
+};
+
+/// Wendland's C4 function \f$ (1-q)_+^6 (35q^2+18q+3) \f$
+struct WendlandC4
+{
+	static const bool compact = true;
+	static inline amc_real eval(const amc_real q)
+	{
+		const amc_real t = rbf_pospart(1.0-q);
+		const amc_real t2 = t*t;
+		return t2*t2*t2*(35.0*q*q + 18.0*q + 3.0);
+	}
+	static inline amc_real deriv(const amc_real q)
+	{
+		const amc_real t = rbf_pospart(1.0-q);
+		const amc_real t2 = t*t;
+		return -56.0*q*t2*t2*t*(5.0*q+1.0);
+	}
+	static inline amc_real deriv2(const amc_real q)
+	{
+		const amc_real t = rbf_pospart(1.0-q);
+		const amc_real t2 = t*t;
+		return 56.0*t2*t2*(35.0*q*q - 4.0*q - 1.0);
+	}
+};
+
+/// Gaussian \f$ e^{-q^2} \f$
+struct GaussianRBF
+{
+	static const bool compact = false;
+	static inline amc_real eval(const amc_real q)
+	{
+		return exp(-q*q);
+	}
+	static inline amc_real deriv(const amc_real q)
+	{
+		return -2.0*q*exp(-q*q);
+	}
+	static inline amc_real deriv2(const amc_real q)
+	{
+		return (4.0*q*q-2.0)*exp(-q*q);
+	}
+};
+
+/// Evaluates the RBF Kernel at n distances r, each scaled by scale
+/** \param[in] r is the array of (unscaled) distances
+ * \param[in] scale is the factor by which to multiply distances before evaluating the RBF, usually the inverse of the support radius
+ * \param[out] phi is the array of RBF values, which must have space for n entries
+ */
+template <class Kernel>
+inline void rbf_batch(const int n, const amc_real* const __restrict__ r, const amc_real scale, amc_real* const __restrict__ phi)
+{
+	#pragma omp simd
+	for(int i = 0; i < n; i++)
+		phi[i] = Kernel::eval(scale*r[i]);
+}
+
+/// Evaluates the RBF of the given type at n distances r, each scaled by scale
+/** The type of the RBF is resolved once for the whole batch, rather than once per evaluation.
+ */
+inline void rbf_batch(const RBFKernelType type, const int n, const amc_real* const r, const amc_real scale, amc_real* const phi)
+{
+	switch(type)
+	{
+		case RBF_C0: rbf_batch<WendlandC0>(n, r, scale, phi);
+		break;
+		case RBF_C2: rbf_batch<WendlandC2>(n, r, scale, phi);
+		break;
+		case RBF_C4: rbf_batch<WendlandC4>(n, r, scale, phi);
+		break;
+		default: rbf_batch<GaussianRBF>(n, r, scale, phi);
+	}
+}
+
+/// Evaluates the RBF of the given type at a single scaled distance q
+inline amc_real rbf_eval(const RBFKernelType type, const amc_real q)
+{
+	switch(type)
+	{
+		case RBF_C0: return WendlandC0::eval(q);
+		case RBF_C2: return WendlandC2::eval(q);
+		case RBF_C4: return WendlandC4::eval(q);
+		default: return GaussianRBF::eval(q);
+	}
+}
+
+/// Evaluates the derivative of the RBF of the given type, with respect to the scaled distance q
+inline amc_real rbf_deriv(const RBFKernelType type, const amc_real q)
+{
+	switch(type)
+	{
+		case RBF_C0: return WendlandC0::deriv(q);
+		case RBF_C2: return WendlandC2::deriv(q);
+		case RBF_C4: return WendlandC4::deriv(q);
+		default: return GaussianRBF::deriv(q);
+	}
+}
+
+/// Evaluates the second derivative of the RBF of the given type, with respect to the scaled distance q
+inline amc_real rbf_deriv2(const RBFKernelType type, const amc_real q)
+{
+	switch(type)
+	{
+		case RBF_C0: return WendlandC0::deriv2(q);
+		case RBF_C2: return WendlandC2::deriv2(q);
+		case RBF_C4: return WendlandC4::deriv2(q);
+		default: return GaussianRBF::deriv2(q);
+	}
+}
+
+}
+#endif
@@ -0,0 +1,251 @@
+#include "arbftreecode.hpp"
+
+namespace amc {
+
+RBFTreecode::RBFTreecode() : src(nullptr), nsrc(0), ndim(0), rbftype(RBF_C2), scale(1.0), cutoff(1.0), theta(RBF_TREECODE_THETA), order(2), qcut(1.0), ncol(0)
+{ }
+
+void RBFTreecode::setup(const amat::Matrix<amc_real>* const sources, const RBFKernelType type, const amc_real dist_scale, const amc_real cutoff_dist,
+		const amc_real opening_angle, const int leaf_size, const int expansion_order)
+{
+	src = sources;
+	nsrc = sources->rows();
+	ndim = sources->cols();
+	rbftype = type;
+	scale = dist_scale;
+	theta = opening_angle;
+	order = expansion_order < 0 ? 0 : (expansion_order > 2 ? 2 : expansion_order);
+	cutoff = cutoff_dist;
+	if(rbftype != RBF_GAUSSIAN && cutoff > 1.0/scale)
+		cutoff = 1.0/scale;
+	qcut = sqrt(-log(RBF_TREECODE_GAUSSIAN_EPS));
+	ncol = 0;
+
+	tree.setup(sources, leaf_size);
+
+	// centre and radius of the bounding box of each node
+	const int nnodes = tree.gnnodes();
+	centre.resize(nnodes*ndim);
+	radius.resize(nnodes);
+	for(int inode = 0; inode < nnodes; inode++)
+	{
+		const KDTree::Node& nd = tree.gnode(inode);
+		amc_real r2 = 0;
+		for(int idim = 0; idim < ndim; idim++)
+		{
+			centre[inode*ndim+idim] = 0.5*(nd.bmin[idim]+nd.bmax[idim]);
+			r2 += 0.25*(nd.bmax[idim]-nd.bmin[idim])*(nd.bmax[idim]-nd.bmin[idim]);
+		}
+		radius[inode] = sqrt(r2);
+	}
+}
+
+amc_real RBFTreecode::opening_angle(const amc_real tol, const int expansion_order)
+{
+	const int p = expansion_order < 0 ? 0 : (expansion_order > 2 ? 2 : expansion_order);
+	const amc_real th = pow(0.5*tol/RBF_TREECODE_ERROR_CONSTANT, 1.0/(p+1));
+	return th < RBF_TREECODE_THETA ? th : RBF_TREECODE_THETA;
+}
+
+void RBFTreecode::upward(const amat::Matrix<amc_real>& charges) const
+{
+	const int nnodes = tree.gnnodes();
+	const int nd = ndim;
+	const int m = 1 + ndim + ndim*ndim;		// number of moments per column
+	ncol = charges.cols();
+	const int nc = ncol;
+	const int stride = nc*m;
+	moments.assign(nnodes*stride, 0.0);
+
+	const KDTree* tr = &tree;
+	const amat::Matrix<amc_real>* y = src;
+	const amc_real* cen = centre.data();
+	amc_real* mom = moments.data();
+	int inode;
+
+	// leaves, directly from the sources
+	#pragma omp parallel for default(none) private(inode) shared(tr, y, charges, cen, mom, nnodes, nd, m, nc, stride)
+	for(inode = 0; inode < nnodes; inode++)
+	{
+		const KDTree::Node& node = tr->gnode(inode);
+		if(node.left >= 0) continue;
+		amc_real del[KDTREE_MAX_DIM];
+		for(amc_int i = node.start; i < node.end; i++)
+		{
+			const amc_int ip = tr->gperm(i);
+			for(int idim = 0; idim < nd; idim++)
+				del[idim] = y->get(ip,idim) - cen[inode*nd+idim];
+			for(int k = 0; k < nc; k++)
+			{
+				const amc_real a = charges.get(ip,k);
+				amc_real* mk = mom + inode*stride + k*m;
+				mk[0] += a;
+				for(int idim = 0; idim < nd; idim++)
+				{
+					mk[1+idim] += a*del[idim];
+					for(int jdim = 0; jdim < nd; jdim++)
+						mk[1+nd+idim*nd+jdim] += a*del[idim]*del[jdim];
+				}
+			}
+		}
+	}
+
+	// interior nodes, by shifting the moments of the children; children always come after their parent
+	for(inode = nnodes-1; inode >= 0; inode--)
+	{
+		const KDTree::Node& node = tr->gnode(inode);
+		if(node.left < 0) continue;
+		const int child[2] = {node.left, node.right};
+		for(int ic = 0; ic < 2; ic++)
+		{
+			amc_real t[KDTREE_MAX_DIM];
+			for(int idim = 0; idim < nd; idim++)
+				t[idim] = cen[child[ic]*nd+idim] - cen[inode*nd+idim];
+			for(int k = 0; k < nc; k++)
+			{
+				const amc_real* mc = mom + child[ic]*stride + k*m;
+				amc_real* mk = mom + inode*stride + k*m;
+				mk[0] += mc[0];
+				for(int idim = 0; idim < nd; idim++)
+				{
+					mk[1+idim] += mc[1+idim] + mc[0]*t[idim];
+					for(int jdim = 0; jdim < nd; jdim++)
+						mk[1+nd+idim*nd+jdim] += mc[1+nd+idim*nd+jdim] + mc[1+idim]*t[jdim] + t[idim]*mc[1+jdim] + mc[0]*t[idim]*t[jdim];
+				}
+			}
+		}
+	}
+}
+
+void RBFTreecode::evaluate(const amat::Matrix<amc_real>& targets, const amat::Matrix<amc_real>& charges, amat::Matrix<amc_real>& result) const
+{
+	const amc_int ntarg = targets.rows();
+	result.setup(ntarg, charges.cols());
+	result.zeros();
+	if(nsrc == 0) return;
+	if(charges.rows() != nsrc) {
+		std::cout << "RBFTreecode: evaluate(): ! Number of charges does not match number of sources!" << std::endl;
+		return;
+	}
+
+	upward(charges);
+
+	const KDTree* tr = &tree;
+	const amat::Matrix<amc_real>* y = src;
+	const amc_real* cen = centre.data();
+	const amc_real* rad = radius.data();
+	const amc_real* mom = moments.data();
+	const int nd = ndim;
+	const int nc = ncol;
+	const int m = 1 + ndim + ndim*ndim;
+	const RBFKernelType type = rbftype;
+	const amc_real sc = scale, cut = cutoff, th = theta, qc = qcut;
+	const int p = order;
+	const bool compact = (rbftype != RBF_GAUSSIAN);
+	amc_int i;
+
+	#pragma omp parallel default(none) private(i) shared(targets, charges, result, tr, y, cen, rad, mom, nd, nc, m, type, sc, cut, th, qc, p, compact, ntarg)
+	{
+		std::vector<amc_real> dists, phi;
+		std::vector<amc_real> sum(nc);
+		int stk[128];
+		amc_real x[KDTREE_MAX_DIM], r[KDTREE_MAX_DIM];
+
+		#pragma omp for
+		for(i = 0; i < ntarg; i++)
+		{
+			int idim, jdim, k;
+			for(idim = 0; idim < nd; idim++)
+				x[idim] = targets.get(i,idim);
+			for(k = 0; k < nc; k++)
+				sum[k] = 0;
+
+			int top = 0;
+			stk[top++] = 0;
+			while(top > 0)
+			{
+				const int inode = stk[--top];
+				const KDTree::Node& node = tr->gnode(inode);
+
+				amc_real d = 0;
+				for(idim = 0; idim < nd; idim++)
+				{
+					r[idim] = x[idim] - cen[inode*nd+idim];
+					d += r[idim]*r[idim];
+				}
+				d = sqrt(d);
+				const amc_real rho = rad[inode];
+
+				// nodes with all sources outside the support
+				if(d-rho >= cut) continue;
+				if(!compact && sc*(d-rho) >= qc) continue;
+
+				if(rho < th*d && sc*rho < th && d+rho < cut)
+				{
+					// far field: Taylor expansion of order p about the centre of the node
+					const amc_real q = sc*d;
+					const amc_real g = rbf_eval(type, q);
+					const amc_real g1 = p > 0 ? sc*rbf_deriv(type, q) : 0;
+					const amc_real g2 = p > 1 ? sc*sc*rbf_deriv2(type, q) : 0;
+					for(idim = 0; idim < nd; idim++)
+						r[idim] /= d;
+
+					for(k = 0; k < nc; k++)
+					{
+						const amc_real* mk = mom + inode*nc*m + k*m;
+						sum[k] += g*mk[0];
+						if(p == 0) continue;
+						amc_real rm1 = 0, rm2r = 0, trm2 = 0;
+						for(idim = 0; idim < nd; idim++)
+						{
+							rm1 += r[idim]*mk[1+idim];
+							trm2 += mk[1+nd+idim*nd+idim];
+							for(jdim = 0; jdim < nd; jdim++)
+								rm2r += r[idim]*mk[1+nd+idim*nd+jdim]*r[jdim];
+						}
+						sum[k] -= g1*rm1;
+						if(p > 1)
+							sum[k] += 0.5*(g2*rm2r + g1/d*(trm2-rm2r));
+					}
+				}
+				else if(node.left < 0)
+				{
+					// near field: direct summation over the leaf
+					const int n = node.end - node.start;
+					dists.resize(n); phi.resize(n);
+					for(int j = 0; j < n; j++)
+					{
+						const amc_int jp = tr->gperm(node.start+j);
+						amc_real dd = 0;
+						for(idim = 0; idim < nd; idim++)
+							dd += (x[idim]-y->get(jp,idim))*(x[idim]-y->get(jp,idim));
+						dists[j] = sqrt(dd);
+					}
+					rbf_batch(type, n, dists.data(), sc, phi.data());
+					for(int j = 0; j < n; j++)
+						if(dists[j] < cut)
+						{
+							const amc_int jp = tr->gperm(node.start+j);
+							for(k = 0; k < nc; k++)
+								sum[k] += phi[j]*charges.get(jp,k);
+						}
+				}
+				else
+				{
+					stk[top++] = node.right;
+					stk[top++] = node.left;
+				}
+			}
+
+			for(k = 0; k < nc; k++)
+				result(i,k) = sum[k];
+		}
+	}
+}
+
+void RBFTreecode::apply(const amat::Matrix<amc_real>& x, amat::Matrix<amc_real>& y) const
+{
+	evaluate(*src, x, y);
+}
+
+}
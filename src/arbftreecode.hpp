@@ -0,0 +1,120 @@
+/** \file arbftreecode.hpp
+ * \brief Hierarchical (tree-code) summation of radial basis functions, for RBFs of global or large support.
+ * \author Aditya Kashi
+ *
+ * Computes sums \f$ s_k(x) = \sum_j \phi(\sigma |x - y_j|) a_{jk} \f$ over a large number of source points \f$ y_j \f$
+ * in O(log N) operations per target point x, instead of O(N).
+ * The sources are organized in a [k-d tree](@ref KDTree). For each node of the tree, the moments
+ * \f$ M_0 = \sum_j a_j \f$, \f$ M_1 = \sum_j a_j (y_j-c) \f$ and \f$ M_2 = \sum_j a_j (y_j-c)(y_j-c)^T \f$ about the centre c of its bounding box
+ * are computed in an upward pass. A node that is well-separated from the target point is then summed by a second-order Taylor expansion
+ * of the RBF about c, while nodes close to the target are opened, down to direct summation over the points in leaves.
+ * A node is well-separated if its radius \f$ \rho \f$ satisfies \f$ \rho < \theta d \f$ and \f$ \sigma\rho < \theta \f$, where d is the distance
+ * from the target to the centre, and if it lies entirely inside the support (or cutoff radius) of the RBF. Nodes entirely outside the support
+ * are skipped; for the Gaussian, so are nodes at which the RBF is smaller than [RBF_TREECODE_GAUSSIAN_EPS](@ref RBF_TREECODE_GAUSSIAN_EPS).
+ * The expansion can also be truncated at order 0 or 1.
+ *
+ * The error of a far-field term is of the order of \f$ \theta^{p+1} \f$ relative to the term, for an expansion of order p.
+ * For charges of mixed sign, as in the vectors of a Krylov solver, the relative error of the whole sum is larger because of cancellation:
+ * measured on boundary-like point sets, it is about \f$ 0.1\theta^3 \f$ for p = 2 (6e-3 at the default \f$ \theta = 0.5 \f$).
+ * The approximation is also not symmetric: \f$ u^T \tilde{A} v - v^T \tilde{A} u \f$ is a few times larger than the error.
+ * An iterative solver using the tree-code cannot reduce the residual much below these levels, so
+ * [opening_angle](@ref RBFTreecode::opening_angle) chooses \f$ \theta \f$ from the required tolerance.
+ * As \f$ \theta \f$ decreases, more nodes are opened; below about 0.02, the tree-code is essentially direct summation.
+ *
+ * Evaluating the sum at the sources themselves is the product of the RBF interpolation matrix with a vector,
+ * so the tree-code is also a matrix-free [linear operator](@ref amat::LinearOperator) for the iterative solvers.
+ */
+
+#ifndef __ARBFTREECODE_H
+
+#ifndef __ALINALG_H
+#include <alinalg.hpp>
+#endif
+
+#ifndef __AKDTREE_H
+#include <akdtree.hpp>
+#endif
+
+#ifndef __ARBFKERNELS_H
+#include <arbfkernels.hpp>
+#endif
+
+#define __ARBFTREECODE_H 1
+
+/// Default opening angle of the tree-code
+#define RBF_TREECODE_THETA 0.5
+
+/// Constant C in the estimate \f$ C\theta^{p+1} \f$ of the relative error (including asymmetry) of a product computed with expansions of order p
+#define RBF_TREECODE_ERROR_CONSTANT 0.5
+
+/// Value of the Gaussian below which contributions are neglected
+#define RBF_TREECODE_GAUSSIAN_EPS 1e-16
+
+namespace amc {
+
+/// Tree-code for sums of radial basis functions centred at a fixed set of source points
+/** The tree-code stores a pointer to the list of sources, not a copy; so the sources must not be modified or de-allocated while it is in use.
+ * If the sources move, [setup](@ref setup) must be called again.
+ */
+class RBFTreecode : public amat::LinearOperator
+{
+	const amat::Matrix<amc_real>* src;		///< source points (RBF centres), nsrc x ndim
+	amc_int nsrc;
+	int ndim;
+	KDTree tree;							///< k-d tree over the sources
+	RBFKernelType rbftype;
+	amc_real scale;							///< Factor by which distances are multiplied before evaluating the RBF
+	amc_real cutoff;						///< Distance beyond which the RBF is taken as zero
+	amc_real theta;							///< Opening angle
+	int order;								///< Order of the Taylor expansion of far-field nodes: 0, 1 or 2
+	amc_real qcut;							///< Scaled distance beyond which the Gaussian is neglected
+
+	std::vector<amc_real> centre;			///< Centre of each node, nnodes x ndim
+	std::vector<amc_real> radius;			///< Radius of each node about its centre
+
+	/// Number of columns of charges for which moments were last computed
+	mutable int ncol;
+	/// Moments of each node, nnodes x ncol x (1 + ndim + ndim*ndim): for each column, M0, then M1, then M2 by rows
+	mutable std::vector<amc_real> moments;
+
+	/// Computes the moments of all nodes for the given charges
+	void upward(const amat::Matrix<amc_real>& charges) const;
+
+public:
+	RBFTreecode();
+
+	/// Builds the tree over the sources
+	/** \param[in] sources is the list of RBF centres
+	 * \param[in] type is the RBF to use
+	 * \param[in] dist_scale is the factor by which distances are multiplied before evaluating the RBF, usually the inverse of the support radius
+	 * \param[in] cutoff_dist is the distance at and beyond which the RBF is taken to be zero;
+	 *   for compact RBFs, it is reduced to the support radius if larger
+	 * \param[in] opening_angle is the parameter \f$ \theta \f$ that controls the accuracy of the far-field approximation;
+	 *   if it is zero, no node is expanded and the sums are computed exactly
+	 * \param[in] leaf_size is the maximum number of sources in a leaf of the tree
+	 * \param[in] expansion_order is the order (0, 1 or 2) of the Taylor expansion used for far-field nodes
+	 */
+	void setup(const amat::Matrix<amc_real>* const sources, const RBFKernelType type, const amc_real dist_scale, const amc_real cutoff_dist,
+			const amc_real opening_angle = RBF_TREECODE_THETA, const int leaf_size = 32, const int expansion_order = 2);
+
+	/// Computes the sums of RBFs weighted by charges at each of a list of target points
+	/** \param[in] targets is the list of points at which to evaluate the sums, ntarg x ndim
+	 * \param[in] charges is the nsrc x k matrix of weights of the sources; each column gives a separate sum
+	 * \param[out] result is ntarg x k, and contains \f$ \sum_j \phi(\sigma |x_i - y_j|) a_{jk} \f$ in the (i,k) position
+	 */
+	void evaluate(const amat::Matrix<amc_real>& targets, const amat::Matrix<amc_real>& charges, amat::Matrix<amc_real>& result) const;
+
+	/// Returns the opening angle needed for the relative error of products with the interpolation matrix to be about tol/2
+	/** It is at most [RBF_TREECODE_THETA](@ref RBF_TREECODE_THETA). For tolerances below about 1e-4 with second-order expansions,
+	 * it is small enough that the tree-code costs about as much as direct summation.
+	 */
+	static amc_real opening_angle(const amc_real tol, const int expansion_order = 2);
+
+	amc_int rows() const { return nsrc; }
+
+	/// Applies the RBF interpolation matrix of the sources to x, approximately, by [evaluating](@ref evaluate) at the sources
+	void apply(const amat::Matrix<amc_real>& x, amat::Matrix<amc_real>& y) const;
+};
+
+}
+#endif
@@ -1,6 +1,6 @@
 
-#ifndef __AMATRIX2_H
-#include <amatrix2.hpp>
+#ifndef __AMATRIX_H
+#include <amatrix.hpp>
 #endif
 #ifndef __AMESH2DGENRERAL_H
 #include <amesh2d.hpp>
@@ -0,0 +1,160 @@
+/** \file asfcsort.hpp
+ * \brief Orderings of point sets along a Hilbert space-filling curve, for incremental algorithms such as Bowyer-Watson triangulation.
+ * \author Aditya Kashi
+ *
+ * Points that are consecutive in such an ordering are close to each other in space, so a walk-through point location
+ * started from the element created by the previous point is short.
+ * The Hilbert index computation is John Skilling's transpose algorithm ("Programming the Hilbert curve", AIP Conf. Proc. 707, 2004).
+ * BRIO (biased randomized insertion order) is from Amenta, Choi and Rote, "Incremental constructions con BRIO", SoCG 2003.
+ */
+
+#ifndef __ASFCSORT_H
+
+#ifndef __AMATRIX_H
+#include <amatrix.hpp>
+#endif
+
+#ifndef _GLIBCXX_VECTOR
+#include <vector>
+#endif
+
+#ifndef _GLIBCXX_ALGORITHM
+#include <algorithm>
+#endif
+
+#ifndef _GLIBCXX_RANDOM
+#include <random>
+#endif
+
+#ifndef _GLIBCXX_CSTDINT
+#include <cstdint>
+#endif
+
+#define __ASFCSORT_H 1
+
+/// Number of points below which a BRIO round is not split further
+#define BRIO_MIN_ROUND 64
+
+namespace amc {
+
+/// Orderings in which points can be inserted into a Delaunay triangulation
+enum PointOrdering { ORDER_NONE = 0, ORDER_HILBERT = 1, ORDER_BRIO = 2 };
+
+/// Computes the position along the Hilbert curve of a point with integer coordinates
+/** \param[in] x are the ndim coordinates, each in [0, 2^bits); modified by this function
+ * \param[in] bits is the number of bits per coordinate; ndim*bits must not exceed 64
+ */
+inline uint64_t hilbert_key(uint32_t* const x, const int ndim, const int bits)
+{
+	const uint32_t M = 1u << (bits-1);
+	uint32_t P, Q, t;
+	int i;
+
+	// inverse undo
+	for(Q = M; Q > 1; Q >>= 1)
+	{
+		P = Q-1;
+		for(i = 0; i < ndim; i++)
+			if(x[i] & Q)
+				x[0] ^= P;
+			else
+			{
+				t = (x[0]^x[i]) & P;
+				x[0] ^= t;
+				x[i] ^= t;
+			}
+	}
+
+	// Gray encode
+	for(i = 1; i < ndim; i++)
+		x[i] ^= x[i-1];
+	t = 0;
+	for(Q = M; Q > 1; Q >>= 1)
+		if(x[ndim-1] & Q) t ^= Q-1;
+	for(i = 0; i < ndim; i++)
+		x[i] ^= t;
+
+	// interleave the bits of the transposed index
+	uint64_t key = 0;
+	for(int b = bits-1; b >= 0; b--)
+		for(i = 0; i < ndim; i++)
+			key = (key << 1) | ((x[i] >> b) & 1u);
+	return key;
+}
+
+/// Sorts a subset of points along the Hilbert curve through the bounding box of all the points
+/** \param[in] points is the npoin x ndim list of points (ndim is 2 or 3)
+ * \param[in,out] order contains indices of points; its entries from start to end-1 are sorted
+ */
+inline void hilbert_sort(const amat::Matrix<amc_real>& points, std::vector<amc_int>& order, const amc_int start, const amc_int end)
+{
+	const int ndim = points.cols();
+	const int bits = 64/ndim < 31 ? 64/ndim : 31;
+	const amc_int npoin = points.rows();
+	if(npoin == 0 || end-start < 2) return;
+
+	amc_real rmin[3], rmax[3], scale[3];
+	for(int idim = 0; idim < ndim; idim++)
+		rmin[idim] = rmax[idim] = points.get(0,idim);
+	for(amc_int i = 1; i < npoin; i++)
+		for(int idim = 0; idim < ndim; idim++)
+		{
+			if(points.get(i,idim) < rmin[idim]) rmin[idim] = points.get(i,idim);
+			if(points.get(i,idim) > rmax[idim]) rmax[idim] = points.get(i,idim);
+		}
+	const amc_real ncells = (amc_real)((1u << bits) - 1);
+	for(int idim = 0; idim < ndim; idim++)
+		scale[idim] = rmax[idim] > rmin[idim] ? ncells/(rmax[idim]-rmin[idim]) : 0;
+
+	std::vector<std::pair<uint64_t,amc_int>> keys(end-start);
+	uint32_t x[3];
+	for(amc_int i = start; i < end; i++)
+	{
+		for(int idim = 0; idim < ndim; idim++)
+			x[idim] = (uint32_t)((points.get(order[i],idim)-rmin[idim])*scale[idim]);
+		keys[i-start].first = hilbert_key(x, ndim, bits);
+		keys[i-start].second = order[i];
+	}
+	std::sort(keys.begin(), keys.end());
+	for(amc_int i = start; i < end; i++)
+		order[i] = keys[i-start].second;
+}
+
+/// Computes an ordering of points for insertion into a triangulation
+/** \param[in] points is the npoin x ndim list of points (ndim is 2 or 3)
+ * \param[in] ordering is the kind of ordering;
+ *   for ORDER_HILBERT, points are sorted along the Hilbert curve;
+ *   for ORDER_BRIO, points are shuffled and divided into rounds, each about twice as large as the previous, and each round is sorted along the Hilbert curve.
+ * \param[out] order contains the indices of points in the order in which they should be inserted
+ * \param[in] seed is the seed for the random shuffle of BRIO
+ */
+inline void compute_insertion_order(const amat::Matrix<amc_real>& points, const PointOrdering ordering, std::vector<amc_int>& order, const unsigned seed = 1)
+{
+	const amc_int npoin = points.rows();
+	order.resize(npoin);
+	for(amc_int i = 0; i < npoin; i++)
+		order[i] = i;
+
+	if(ordering == ORDER_HILBERT)
+		hilbert_sort(points, order, 0, npoin);
+	else if(ordering == ORDER_BRIO)
+	{
+		std::mt19937 gen(seed);
+		std::shuffle(order.begin(), order.end(), gen);
+
+		// round boundaries, from the last round backwards
+		std::vector<amc_int> bounds(1, npoin);
+		amc_int m = npoin;
+		while(m > BRIO_MIN_ROUND)
+		{
+			m /= 2;
+			bounds.push_back(m);
+		}
+		bounds.push_back(0);
+		for(size_t i = bounds.size()-1; i > 0; i--)
+			hilbert_sort(points, order, bounds[i], bounds[i-1]);
+	}
+}
+
+}
+#endif
@@ -0,0 +1,179 @@
+#include "asnapshot.hpp"
+
+#ifndef _GLIBCXX_FSTREAM
+#include <fstream>
+#endif
+
+#ifndef _GLIBCXX_ALGORITHM
+#include <algorithm>
+#endif
+
+namespace amc {
+
+/// Size in bytes of the snapshot header
+static const size_t snapshot_header_size = 8 + 6*4;
+/// Size in bytes of one entry of the scalar table
+static const size_t snapshot_scalar_size = SNAPSHOT_NAME_LENGTH + 8;
+/// Size in bytes of one entry of the array table
+static const size_t snapshot_array_size = SNAPSHOT_NAME_LENGTH + 2*4 + 3*8;
+
+static const uint32_t snapshot_byte_order = 0x01020304;
+
+static inline size_t snapshot_align(const size_t off)
+{
+	return (off + SNAPSHOT_ALIGNMENT-1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+/// Copies a name into a zero-padded field of SNAPSHOT_NAME_LENGTH characters, truncating it if it is longer
+static inline void snapshot_name(char* const field, const std::string& name)
+{
+	memset(field, 0, SNAPSHOT_NAME_LENGTH);
+	memcpy(field, name.c_str(), std::min(name.size(), (size_t)SNAPSHOT_NAME_LENGTH));
+}
+
+void SnapshotWriter::addRaw(const std::string& name, const uint32_t type, const uint32_t elsize, const int64_t rows, const int64_t cols,
+		const void* const data)
+{
+	ArrayEntry a;
+	a.name = name; a.type = type; a.elsize = elsize; a.rows = rows; a.cols = cols; a.data = data;
+	arrays.push_back(a);
+}
+
+bool SnapshotWriter::write(const std::string& filename) const
+{
+	std::ofstream fout(filename, std::ios::binary);
+	if(!fout) {
+		std::cout << "! SnapshotWriter: write(): Could not open file " << filename << std::endl;
+		return false;
+	}
+
+	char magic[8] = {0};
+	strncpy(magic, SNAPSHOT_FILE_MAGIC, 8);
+	const uint32_t header[6] = {SNAPSHOT_FILE_VERSION, snapshot_byte_order, kind, (uint32_t)scalars.size(), (uint32_t)arrays.size(), 0};
+	fout.write(magic, 8);
+	fout.write((const char*)header, sizeof(header));
+
+	for(size_t i = 0; i < scalars.size(); i++)
+	{
+		char name[SNAPSHOT_NAME_LENGTH];
+		snapshot_name(name, scalars[i].first);
+		fout.write(name, SNAPSHOT_NAME_LENGTH);
+		fout.write((const char*)&scalars[i].second, 8);
+	}
+
+	// lay out the data after the tables
+	size_t offset = snapshot_header_size + scalars.size()*snapshot_scalar_size + arrays.size()*snapshot_array_size;
+	std::vector<uint64_t> offsets(arrays.size());
+	for(size_t i = 0; i < arrays.size(); i++)
+	{
+		offset = snapshot_align(offset);
+		offsets[i] = offset;
+		offset += (size_t)arrays[i].rows*arrays[i].cols*arrays[i].elsize;
+	}
+
+	for(size_t i = 0; i < arrays.size(); i++)
+	{
+		char name[SNAPSHOT_NAME_LENGTH];
+		snapshot_name(name, arrays[i].name);
+		fout.write(name, SNAPSHOT_NAME_LENGTH);
+		fout.write((const char*)&arrays[i].type, 4);
+		fout.write((const char*)&arrays[i].elsize, 4);
+		fout.write((const char*)&arrays[i].rows, 8);
+		fout.write((const char*)&arrays[i].cols, 8);
+		fout.write((const char*)&offsets[i], 8);
+	}
+
+	const char zeros[SNAPSHOT_ALIGNMENT] = {0};
+	size_t pos = snapshot_header_size + scalars.size()*snapshot_scalar_size + arrays.size()*snapshot_array_size;
+	for(size_t i = 0; i < arrays.size(); i++)
+	{
+		fout.write(zeros, offsets[i]-pos);
+		const size_t nbytes = (size_t)arrays[i].rows*arrays[i].cols*arrays[i].elsize;
+		fout.write((const char*)arrays[i].data, nbytes);
+		pos = offsets[i] + nbytes;
+	}
+
+	if(!fout) {
+		std::cout << "! SnapshotWriter: write(): Error writing file " << filename << std::endl;
+		return false;
+	}
+	return true;
+}
+
+SnapshotReader::SnapshotReader() : kind(0), nscalars(0), narrays(0), scalartable(nullptr), arraytable(nullptr)
+{ }
+
+bool SnapshotReader::open(const std::string& filename)
+{
+	fname = filename;
+	nscalars = narrays = 0;
+	if(!file.open(filename)) {
+		std::cout << "! SnapshotReader: open(): Could not read file " << filename << std::endl;
+		return false;
+	}
+
+	const char* const beg = file.data();
+	uint32_t header[6];
+	if(file.size() < snapshot_header_size || strncmp(beg, SNAPSHOT_FILE_MAGIC, 8) != 0) {
+		std::cout << "! SnapshotReader: open(): " << filename << " is not a mesh snapshot!" << std::endl;
+		return false;
+	}
+	memcpy(header, beg+8, sizeof(header));
+	if(header[1] != snapshot_byte_order) {
+		std::cout << "! SnapshotReader: open(): " << filename << " was written on a machine with a different byte order!" << std::endl;
+		return false;
+	}
+	if(header[0] != SNAPSHOT_FILE_VERSION) {
+		std::cout << "! SnapshotReader: open(): " << filename << " has version " << header[0] << " of the snapshot format; only version "
+			<< SNAPSHOT_FILE_VERSION << " is supported." << std::endl;
+		return false;
+	}
+	kind = header[2];
+
+	const size_t tablesize = snapshot_header_size + (size_t)header[3]*snapshot_scalar_size + (size_t)header[4]*snapshot_array_size;
+	if(file.size() < tablesize) {
+		std::cout << "! SnapshotReader: open(): " << filename << " is truncated!" << std::endl;
+		return false;
+	}
+	scalartable = beg + snapshot_header_size;
+	arraytable = scalartable + (size_t)header[3]*snapshot_scalar_size;
+	nscalars = header[3];
+	narrays = header[4];
+
+	// check that all arrays lie within the file
+	for(uint32_t i = 0; i < narrays; i++)
+	{
+		const char* const entry = arraytable + i*snapshot_array_size;
+		uint32_t elsize; int64_t rows, cols; uint64_t offset;
+		memcpy(&elsize, entry+SNAPSHOT_NAME_LENGTH+4, 4);
+		memcpy(&rows, entry+SNAPSHOT_NAME_LENGTH+8, 8);
+		memcpy(&cols, entry+SNAPSHOT_NAME_LENGTH+16, 8);
+		memcpy(&offset, entry+SNAPSHOT_NAME_LENGTH+24, 8);
+		if(rows < 0 || cols < 0 || offset > file.size() || (uint64_t)rows*cols*elsize > file.size()-offset) {
+			std::cout << "! SnapshotReader: open(): " << filename << " is truncated or corrupt!" << std::endl;
+			nscalars = narrays = 0;
+			return false;
+		}
+	}
+	return true;
+}
+
+const char* SnapshotReader::findArray(const std::string& name, uint32_t& type, uint32_t& elsize, int64_t& rows, int64_t& cols) const
+{
+	for(uint32_t i = 0; i < narrays; i++)
+	{
+		const char* const entry = arraytable + i*snapshot_array_size;
+		if(strncmp(entry, name.c_str(), SNAPSHOT_NAME_LENGTH) == 0) {
+			uint64_t offset;
+			memcpy(&type, entry+SNAPSHOT_NAME_LENGTH, 4);
+			memcpy(&elsize, entry+SNAPSHOT_NAME_LENGTH+4, 4);
+			memcpy(&rows, entry+SNAPSHOT_NAME_LENGTH+8, 8);
+			memcpy(&cols, entry+SNAPSHOT_NAME_LENGTH+16, 8);
+			memcpy(&offset, entry+SNAPSHOT_NAME_LENGTH+24, 8);
+			return file.data() + offset;
+		}
+	}
+	return nullptr;
+}
+
+}
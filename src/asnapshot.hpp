@@ -0,0 +1,195 @@
+/** \file asnapshot.hpp
+ * \brief Binary snapshot files holding a mesh and, optionally, its derived connectivity data as contiguous arrays.
+ * \author Aditya Kashi
+ *
+ * A snapshot is written in the native byte order and consists of
+ * - a header: the magic string SNAPSHOT_FILE_MAGIC (8 bytes), then 32-bit unsigned integers for the format version,
+ *   a byte-order marker (0x01020304), the kind of mesh (SNAPSHOT_UMESH3D or SNAPSHOT_UMESH2DH),
+ *   the number of scalars, the number of arrays and a padding word;
+ * - the scalars, each a 16-character name followed by a 64-bit integer value;
+ * - the array table, each entry being a 16-character name, 32-bit unsigned type code and element size,
+ *   and 64-bit numbers of rows and columns and offset of the array's data from the start of the file;
+ * - the data of each array, row-major, starting at an offset that is a multiple of SNAPSHOT_ALIGNMENT.
+ *
+ * Reading a snapshot memory-maps the file and copies each array into place, so it takes about as long as copying the data,
+ * which is much faster than parsing a text mesh file and re-computing the connectivity.
+ */
+
+#ifndef __ASNAPSHOT_H
+
+#ifndef __AMATRIX_H
+#include <amatrix.hpp>
+#endif
+
+#ifndef __AMAPPEDFILE_H
+#include <amappedfile.hpp>
+#endif
+
+#ifndef _GLIBCXX_STRING
+#include <string>
+#endif
+
+#ifndef _GLIBCXX_VECTOR
+#include <vector>
+#endif
+
+#ifndef _GLIBCXX_CSTDINT
+#include <cstdint>
+#endif
+
+#ifndef _GLIBCXX_CSTRING
+#include <cstring>
+#endif
+
+#define __ASNAPSHOT_H 1
+
+#define SNAPSHOT_FILE_MAGIC "AMCSNAP"
+#define SNAPSHOT_FILE_VERSION 1
+#define SNAPSHOT_ALIGNMENT 64
+#define SNAPSHOT_NAME_LENGTH 16
+
+/// Kinds of mesh that can be stored in a snapshot
+#define SNAPSHOT_UMESH2DH 2
+#define SNAPSHOT_UMESH3D 3
+
+namespace amc {
+
+/// Type codes of snapshot arrays
+enum SnapshotType {SNAPSHOT_INT = 1, SNAPSHOT_REAL = 2};
+
+template <typename T> struct snapshot_type;
+template <> struct snapshot_type<int> { static const uint32_t code = SNAPSHOT_INT; };
+template <> struct snapshot_type<double> { static const uint32_t code = SNAPSHOT_REAL; };
+
+/// Collects named scalars and arrays of a mesh, and writes them to a snapshot file
+/** The arrays are not copied; they must not be modified or de-allocated before [write](@ref write) is called.
+ * Empty arrays are not written.
+ */
+class SnapshotWriter
+{
+	struct ArrayEntry {
+		std::string name;
+		uint32_t type;
+		uint32_t elsize;
+		int64_t rows;
+		int64_t cols;
+		const void* data;
+	};
+
+	uint32_t kind;
+	std::vector<std::pair<std::string,int64_t>> scalars;
+	std::vector<ArrayEntry> arrays;
+
+	void addRaw(const std::string& name, const uint32_t type, const uint32_t elsize, const int64_t rows, const int64_t cols, const void* const data);
+
+public:
+	SnapshotWriter(const uint32_t mesh_kind) : kind(mesh_kind) { }
+
+	void addScalar(const std::string& name, const int64_t value)
+	{
+		scalars.push_back(std::make_pair(name, value));
+	}
+
+	template <typename T>
+	void addArray(const std::string& name, const amat::Matrix<T>& mat)
+	{
+		if(mat.rows() > 0 && mat.cols() > 0)
+			addRaw(name, snapshot_type<T>::code, sizeof(T), mat.rows(), mat.cols(), &mat(0,0));
+	}
+
+	template <typename T>
+	void addArray(const std::string& name, const std::vector<T>& vec)
+	{
+		if(vec.size() > 0)
+			addRaw(name, snapshot_type<T>::code, sizeof(T), vec.size(), 1, vec.data());
+	}
+
+	/// Writes the snapshot file; returns false if it could not be written
+	bool write(const std::string& filename) const;
+};
+
+/// Reads a snapshot file written by SnapshotWriter
+class SnapshotReader
+{
+	MappedFile file;
+	std::string fname;
+	uint32_t kind;
+	uint32_t nscalars;
+	uint32_t narrays;
+	const char* scalartable;
+	const char* arraytable;
+
+	/// Finds an array; returns a pointer to its data and its type and sizes, or nullptr if there is no array by that name
+	const char* findArray(const std::string& name, uint32_t& type, uint32_t& elsize, int64_t& rows, int64_t& cols) const;
+
+public:
+	SnapshotReader();
+
+	/// Maps the file and checks its header and tables; returns false (after printing a message) if it is not a valid snapshot
+	bool open(const std::string& filename);
+
+	uint32_t gkind() const { return kind; }
+
+	/// Reads the value of a named scalar into val, returning false if there is no such scalar
+	template <typename T>
+	bool getScalar(const std::string& name, T& val) const;
+
+	/// Copies a named array into mat; if the array is absent, mat is emptied and false is returned
+	template <typename T>
+	bool getArray(const std::string& name, amat::Matrix<T>& mat) const;
+
+	/// Copies a named array into vec; if the array is absent, vec is emptied and false is returned
+	template <typename T>
+	bool getArray(const std::string& name, std::vector<T>& vec) const;
+};
+
+template <typename T>
+bool SnapshotReader::getScalar(const std::string& name, T& val) const
+{
+	for(uint32_t i = 0; i < nscalars; i++)
+	{
+		const char* const entry = scalartable + i*(SNAPSHOT_NAME_LENGTH+8);
+		if(strncmp(entry, name.c_str(), SNAPSHOT_NAME_LENGTH) == 0) {
+			int64_t v;
+			memcpy(&v, entry+SNAPSHOT_NAME_LENGTH, 8);
+			val = (T)v;
+			return true;
+		}
+	}
+	return false;
+}
+
+template <typename T>
+bool SnapshotReader::getArray(const std::string& name, amat::Matrix<T>& mat) const
+{
+	uint32_t type, elsize; int64_t rows, cols;
+	const char* const data = findArray(name, type, elsize, rows, cols);
+	if(!data || type != snapshot_type<T>::code || elsize != sizeof(T)) {
+		if(data)
+			std::cout << "! SnapshotReader: getArray(): Array " << name << " in " << fname << " has the wrong type!" << std::endl;
+		mat = amat::Matrix<T>();
+		return false;
+	}
+	mat.setup(rows, cols);
+	memcpy(&mat(0,0), data, rows*cols*sizeof(T));
+	return true;
+}
+
+template <typename T>
+bool SnapshotReader::getArray(const std::string& name, std::vector<T>& vec) const
+{
+	uint32_t type, elsize; int64_t rows, cols;
+	const char* const data = findArray(name, type, elsize, rows, cols);
+	if(!data || type != snapshot_type<T>::code || elsize != sizeof(T)) {
+		if(data)
+			std::cout << "! SnapshotReader: getArray(): Array " << name << " in " << fname << " has the wrong type!" << std::endl;
+		vec.clear();
+		return false;
+	}
+	vec.resize(rows*cols);
+	memcpy(vec.data(), data, rows*cols*sizeof(T));
+	return true;
+}
+
+}
+#endif
@@ -33,6 +33,10 @@
 #include <vector>
 #endif
 
+#ifndef _GLIBCXX_ALGORITHM
+#include <algorithm>
+#endif
+
 #ifndef __AMATRIX_H
 #include "amatrix.hpp"
 #endif
@@ -102,13 +106,31 @@ public:
 	virtual void mprint() const = 0;
 
 	/// Multiplication of this sparse matrix with a row-major vector
-	virtual void multiply(const Mat& x, Mat* const a, const char paralel) const = 0;
+	virtual void multiply(const Mat& x, Mat* const a, const char paralel = 'n') const = 0;
 	virtual void multiply_parts(const Mat* x, const Mat* y, Mat* const ans, const int p) const = 0;
 	virtual double getelem_multiply_parts(const int rownum, const Mat* x, const Mat* y, const int p, const double num) const = 0;
+
+	/// D is returned as a column-vector containing the diagonal elements of this matrix
+	virtual void get_diagonal(Mat* D) const
+	{
+		for(int i = 0; i < nrows; i++)
+			(*D)(i) = get(i,i);
+	}
 };
 
 #define INITIAL_ROW_SIZE 20
 
+/// Number of rows in a slice of the SELL-C-sigma format; 4 doubles fill an AVX register
+#define SELL_CHUNK_SIZE 4
+
+/// Largest ratio of the padded size of a SELL-C-sigma copy to the number of non-zeros for which the copy is worth building
+/** Products with vectors are limited by memory bandwidth, so SELL-C-sigma is faster than plain CSR only if it reads little more data.
+ */
+#define SELL_MAX_FILL 1.1
+
+/// Products of matrices with fewer rows than this with vectors are not parallelized
+#define SPARSE_PARALLEL_MIN_ROWS 2000
+
 /** \brief Implements sparse matrix storage in row-storage format, but with separate arrays for each row of the matrix.
  */
 template<class T> class MatrixCRS : public SparseMatrix<T>
@@ -226,7 +248,28 @@ public:
 			nnz++;
 		}
 	}
-	
+
+	/// Replaces the contents of row x by the n entries in cols and vals
+	/** Different rows can be set concurrently from different threads. The number of non-zeros is not updated here;
+	 * call [update_nnz](@ref update_nnz) once all rows have been set.
+	 */
+	void setrow(const int x, const int n, const int* const cols, const T* const vals)
+	{
+		val[x].assign(vals, vals+n);
+		col_ind[x].assign(cols, cols+n);
+		rsize[x] = n;
+	}
+
+	/// Recomputes the number of non-zeros from the row sizes
+	void update_nnz()
+	{
+		nnz = 0;
+		for(int i = 0; i < nrows; i++)
+			nnz += rsize[i];
+	}
+
+	int getnnz() const { return nnz; }
+
 
 	T get(const int x, const int y) const
 	{
@@ -600,6 +643,7 @@ public:
 	Mat toDense() const
 	{
 		Matrix<T> dense(nrows, ncols);
+		dense.zeros();
 		for(int i = 0; i < nrows; i++)
 			for(int j = 0; j < rsize[i]; j++)
 				dense(i,col_ind[i][j]) = val[i][j];
@@ -748,6 +792,866 @@ public:
 	}*/
 };
 
+/** \brief Stores a sparse matrix in (flat) compressed row storage, for fast matrix-vector products.
+ *
+ * Unlike MatrixCRS, the non-zero pattern is fixed once the matrix is set up; [set](@ref set) can only change existing entries.
+ * The column indices in each row are sorted.
+ * Products with vectors are computed in parallel over rows with OpenMP. If x has several columns,
+ * all of them are multiplied in one sweep through the matrix.
+ *
+ * Optionally, a copy of the matrix can be kept in the SELL-C-sigma format (see [build_sell](@ref build_sell)), which is
+ * then used for products with single vectors. In it, the rows are sorted by length within windows of sigma rows and grouped
+ * into slices of SELL_CHUNK_SIZE rows, each stored column by column and padded to its longest row.
+ * The innermost loop then runs over the rows of a slice, which compilers vectorize.
+ * The copy is only built if there is little padding, as given by [SELL_MAX_FILL](@ref SELL_MAX_FILL).
+ */
+template <class T> class MatrixCSR : public SparseMatrix<T>
+{
+	std::vector<int> row_ptr;			///< Index into col_ind and val where each row begins
+	std::vector<int> col_ind;			///< Column indices of the non-zeros
+	std::vector<T> val;					///< Values of the non-zeros
+
+	// SELL-C-sigma copy of the matrix
+	std::vector<int> slice_ptr;			///< Index into sell_col and sell_val where each slice begins
+	std::vector<int> sell_perm;			///< Original row number of each row in the slices; -1 for padding rows
+	std::vector<int> sell_col;
+	std::vector<T> sell_val;
+
+	using SparseMatrix<T>::nnz;
+	using SparseMatrix<T>::nrows;
+	using SparseMatrix<T>::ncols;
+
+public:
+	MatrixCSR() : SparseMatrix<T>(0,0)
+	{
+		row_ptr.assign(1,0);
+	}
+
+	/// Copies a MatrixCRS
+	MatrixCSR(const MatrixCRS<T>& A) : SparseMatrix<T>(A.rows(),A.cols())
+	{
+		assign(A);
+	}
+
+	/// Copies a MatrixCRS into this matrix, sorting the entries of each row by column
+	void assign(const MatrixCRS<T>& A)
+	{
+		SMatrixCRS<T> c;
+		A.get_CRS_matrix(c);
+		nrows = A.rows(); ncols = A.cols(); nnz = c.nnz;
+		row_ptr.assign(c.row_ptr, c.row_ptr+nrows+1);
+		col_ind.resize(nnz);
+		val.resize(nnz);
+
+		int* const rp = row_ptr.data(); int* const ci = col_ind.data(); T* const v = val.data();
+		const int nr = nrows;
+		#pragma omp parallel default(none) shared(c, rp, ci, v, nr)
+		{
+			std::vector<int> ord;
+			#pragma omp for schedule(dynamic,256)
+			for(int i = 0; i < nr; i++)
+			{
+				ord.resize(rp[i+1]-rp[i]);
+				for(size_t k = 0; k < ord.size(); k++)
+					ord[k] = rp[i]+k;
+				std::sort(ord.begin(), ord.end(), [&c](const int a, const int b) { return c.col_ind[a] < c.col_ind[b]; });
+				for(size_t k = 0; k < ord.size(); k++) {
+					ci[rp[i]+k] = c.col_ind[ord[k]];
+					v[rp[i]+k] = c.val[ord[k]];
+				}
+			}
+		}
+		clear_sell();
+	}
+
+	/// Sets up the matrix from arrays in compressed row storage; the column indices of each row must be sorted
+	void assign(const int num_rows, const int num_cols, const int* const rowptr, const int* const colind, const T* const vals)
+	{
+		nrows = num_rows; ncols = num_cols; nnz = rowptr[num_rows];
+		row_ptr.assign(rowptr, rowptr+nrows+1);
+		col_ind.assign(colind, colind+nnz);
+		val.assign(vals, vals+nnz);
+		clear_sell();
+	}
+
+	/// Takes over arrays in compressed row storage, without copying them; the column indices of each row must be sorted
+	/** The arguments are left empty.
+	 */
+	void take(const int num_rows, const int num_cols, std::vector<int>& rowptr, std::vector<int>& colind, std::vector<T>& vals)
+	{
+		nrows = num_rows; ncols = num_cols;
+		row_ptr.swap(rowptr); col_ind.swap(colind); val.swap(vals);
+		rowptr.clear(); colind.clear(); vals.clear();
+		nnz = row_ptr[nrows];
+		clear_sell();
+	}
+
+	/// Discards the SELL-C-sigma copy, if any
+	void clear_sell()
+	{
+		slice_ptr.clear(); sell_perm.clear(); sell_col.clear(); sell_val.clear();
+	}
+
+	/// Builds the SELL-C-sigma copy of the matrix, which is used from then on for products with single vectors
+	/** \param sigma is the size of the windows of rows sorted by length; it is rounded up to a multiple of SELL_CHUNK_SIZE.
+	 * Larger windows mean less padding, but less locality in accessing x.
+	 * \param max_fill is the largest ratio of the padded size to the number of non-zeros for which the copy is built;
+	 *   otherwise plain CSR is cheaper, and is used.
+	 * The copy is not updated by [set](@ref set), so build it after the values are final.
+	 * \return true if the copy was built
+	 */
+	bool build_sell(int sigma = 32*SELL_CHUNK_SIZE, const double max_fill = SELL_MAX_FILL)
+	{
+		const int C = SELL_CHUNK_SIZE;
+		sigma = (std::max(sigma,C) + C-1)/C*C;
+		const int nslices = (nrows + C-1)/C;
+
+		// sort rows by decreasing length within each window
+		sell_perm.assign(nslices*C, -1);
+		for(int i = 0; i < nrows; i++)
+			sell_perm[i] = i;
+		for(int w = 0; w < nrows; w += sigma)
+			std::stable_sort(sell_perm.begin()+w, sell_perm.begin()+std::min(w+sigma,nrows), [this](const int a, const int b)
+				{ return row_ptr[a+1]-row_ptr[a] > row_ptr[b+1]-row_ptr[b]; });
+
+		slice_ptr.resize(nslices+1);
+		slice_ptr[0] = 0;
+		for(int is = 0; is < nslices; is++)
+		{
+			int len = 0;
+			for(int r = 0; r < C; r++) {
+				const int i = sell_perm[is*C+r];
+				if(i >= 0 && row_ptr[i+1]-row_ptr[i] > len)
+					len = row_ptr[i+1]-row_ptr[i];
+			}
+			slice_ptr[is+1] = slice_ptr[is] + len*C;
+		}
+		if(slice_ptr[nslices] > max_fill*nnz) {
+			clear_sell();
+			return false;
+		}
+
+		// padding entries are zeros in column 0
+		sell_col.assign(slice_ptr[nslices], 0);
+		sell_val.assign(slice_ptr[nslices], T(0));
+		for(int is = 0; is < nslices; is++)
+			for(int r = 0; r < C; r++)
+			{
+				const int i = sell_perm[is*C+r];
+				if(i < 0) continue;
+				for(int k = row_ptr[i]; k < row_ptr[i+1]; k++) {
+					sell_col[slice_ptr[is] + (k-row_ptr[i])*C + r] = col_ind[k];
+					sell_val[slice_ptr[is] + (k-row_ptr[i])*C + r] = val[k];
+				}
+			}
+		return true;
+	}
+
+	int getnnz() const { return nnz; }
+	const int* growptr() const { return row_ptr.data(); }
+	const int* gcolind() const { return col_ind.data(); }
+	const T* gval() const { return val.data(); }
+
+	/// Changes an existing entry; an entry outside the non-zero pattern cannot be set
+	void set(const int x, const int y, const double value)
+	{
+		const int* const pos = std::lower_bound(col_ind.data()+row_ptr[x], col_ind.data()+row_ptr[x+1], y);
+		if(pos == col_ind.data()+row_ptr[x+1] || *pos != y) {
+			if(dabs(value) > ZERO_TOL)
+				std::cout << "! MatrixCSR: set(): Entry (" << x << "," << y << ") is not in the non-zero pattern!" << std::endl;
+			return;
+		}
+		val[pos-col_ind.data()] = value;
+	}
+
+	T get(const int x, const int y) const
+	{
+		const int* const pos = std::lower_bound(col_ind.data()+row_ptr[x], col_ind.data()+row_ptr[x+1], y);
+		if(pos == col_ind.data()+row_ptr[x+1] || *pos != y)
+			return T(0);
+		return val[pos-col_ind.data()];
+	}
+
+	void mprint() const
+	{
+		std::cout << "\n";
+		for(int i = 0; i < nrows; i++)
+		{
+			for(int j = 0; j < ncols; j++)
+				std::cout << std::setw(WIDTH) << get(i,j);
+			std::cout << std::endl;
+		}
+	}
+
+	/// Computes a := this * x, where x can have any number of columns
+	/** The last argument is ignored; the product is computed in parallel if there are at least SPARSE_PARALLEL_MIN_ROWS rows.
+	 */
+	void multiply(const Mat& x, Mat* const a, const char paralel = 'n') const
+	{
+		const int nr = nrows;
+		const int nc = x.cols();
+		const int* const rp = row_ptr.data(); const int* const ci = col_ind.data(); const T* const v = val.data();
+		const T* const xp = &x(0,0);
+		T* const ap = &(*a)(0,0);
+
+		if(nc == 1 && slice_ptr.size() > 0)
+		{
+			const int C = SELL_CHUNK_SIZE;
+			const int nslices = slice_ptr.size()-1;
+			const int* const sp = slice_ptr.data(); const int* const perm = sell_perm.data();
+			const int* const sc = sell_col.data(); const T* const sv = sell_val.data();
+
+			#pragma omp parallel for default(none) shared(nr, nslices, sp, perm, sc, sv, xp, ap) schedule(static) if(nr >= SPARSE_PARALLEL_MIN_ROWS)
+			for(int is = 0; is < nslices; is++)
+			{
+				T sum[C];
+				for(int r = 0; r < C; r++)
+					sum[r] = 0;
+				for(int k = sp[is]; k < sp[is+1]; k += C)
+					for(int r = 0; r < C; r++)
+						sum[r] += sv[k+r]*xp[sc[k+r]];
+				for(int r = 0; r < C; r++)
+					if(perm[is*C+r] >= 0)
+						ap[perm[is*C+r]] = sum[r];
+			}
+			return;
+		}
+
+		if(nc == 1)
+		{
+			#pragma omp parallel for default(none) shared(nr, rp, ci, v, xp, ap) schedule(static) if(nr >= SPARSE_PARALLEL_MIN_ROWS)
+			for(int i = 0; i < nr; i++)
+			{
+				T sum = 0;
+				for(int k = rp[i]; k < rp[i+1]; k++)
+					sum += v[k]*xp[ci[k]];
+				ap[i] = sum;
+			}
+			return;
+		}
+
+		// all columns of x in one sweep; x and a are row-major, so the columns of one row are contiguous
+		#pragma omp parallel for default(none) shared(nr, nc, rp, ci, v, xp, ap) schedule(static) if(nr >= SPARSE_PARALLEL_MIN_ROWS)
+		for(int i = 0; i < nr; i++)
+		{
+			T* const ai = ap + (size_t)i*nc;
+			for(int l = 0; l < nc; l++)
+				ai[l] = 0;
+			for(int k = rp[i]; k < rp[i+1]; k++)
+			{
+				const T vk = v[k];
+				const T* const xj = xp + (size_t)ci[k]*nc;
+				for(int l = 0; l < nc; l++)
+					ai[l] += vk*xj[l];
+			}
+		}
+	}
+
+	/// Like the multiply() method, except the argument matrix is considered x for the first p-1 rows, 0 in the pth row and y for the remaining rows.
+	void multiply_parts(const Mat* x, const Mat* y, Mat* const ans, const int p) const
+	{
+		for(int k = 0; k < x->cols(); k++)
+			for(int i = 0; i < nrows; i++)
+			{
+				T sum = 0;
+				for(int j = row_ptr[i]; j < row_ptr[i+1]; j++)
+				{
+					if(col_ind[j] < p)
+						sum += val[j] * x->get(col_ind[j],k);
+					else if(col_ind[j] > p)
+						sum += val[j] * y->get(col_ind[j],k);
+				}
+				(*ans)(i,k) = sum;
+			}
+	}
+
+	/// Returns dot product of rownum'th row of this matrix with a vector that is x before position p, num at p and y after it
+	T getelem_multiply_parts(const int rownum, const Mat* x, const Mat* y, const int p, const T num) const
+	{
+		T ans = 0;
+		for(int k = 0; k < x->cols(); k++)
+			for(int j = row_ptr[rownum]; j < row_ptr[rownum+1]; j++)
+			{
+				if(col_ind[j] < p)
+					ans += val[j] * x->get(col_ind[j],k);
+				else if(col_ind[j] > p)
+					ans += val[j] * y->get(col_ind[j],k);
+				else
+					ans += val[j] * num;
+			}
+		return ans;
+	}
+
+	/// D is returned as a column-vector containing diagonal elements of this sparse matrix.
+	void get_diagonal(Mat* D) const
+	{
+		for(int i = 0; i < nrows; i++)
+			(*D)(i) = get(i,i);
+	}
+};
+
+/** \brief Stores a symmetric sparse matrix as its upper triangle (including the diagonal) in flat compressed row storage.
+ *
+ * Every row stores its diagonal entry, which is the first entry of the row; the column indices of each row are sorted.
+ *
+ * A serial product with a vector, and an SSOR sweep, read row i of the upper triangle once and use it both as row i and as column i
+ * of the matrix, scattering the column's contributions to other rows. So only about half the values and column indices of the full matrix
+ * are stored and read.
+ * Parallel products cannot scatter, so for them the strict lower triangle is also indexed by rows: for each row, the columns of its
+ * entries left of the diagonal and their positions in the upper-triangle values are stored (two integers per off-diagonal entry, no values).
+ * Each row of the result is then computed by one thread from its upper and lower parts. With this index, a product reads as many integers
+ * as one with the full matrix, and saves only the lower-triangle values. The index is built only if the matrix has at least
+ * SPARSE_PARALLEL_MIN_ROWS rows and OpenMP has more than one thread when the matrix is set up; otherwise all products are serial.
+ *
+ * The const methods do not modify the object, so they can be called concurrently on the same object.
+ */
+template <class T> class MatrixSymCSR : public SparseMatrix<T>
+{
+	std::vector<int> row_ptr;			///< Index into col_ind and val where each row begins
+	std::vector<int> col_ind;			///< Column indices of the non-zeros of the upper triangle
+	std::vector<T> val;					///< Values of the non-zeros of the upper triangle
+	std::vector<int> lrow_ptr;			///< Index into lcol_ind and lpos where the strict lower triangle of each row begins; empty if not built
+	std::vector<int> lcol_ind;			///< Column indices of the strict lower triangle, sorted in each row
+	std::vector<int> lpos;				///< Position in val of each entry of the strict lower triangle
+
+	using SparseMatrix<T>::nnz;
+	using SparseMatrix<T>::nrows;
+	using SparseMatrix<T>::ncols;
+
+	/// Indexes the strict lower triangle by rows, if products are to be computed in parallel
+	void index_lower()
+	{
+		lrow_ptr.clear(); lcol_ind.clear(); lpos.clear();
+		if(nrows < SPARSE_PARALLEL_MIN_ROWS || omp_get_max_threads() == 1)
+			return;
+
+		// going through the upper triangle by rows keeps each lower row sorted
+		lrow_ptr.assign(nrows+1, 0);
+		for(int i = 0; i < nrows; i++)
+			for(int k = row_ptr[i]+1; k < row_ptr[i+1]; k++)
+				lrow_ptr[col_ind[k]+1]++;
+		for(int i = 0; i < nrows; i++)
+			lrow_ptr[i+1] += lrow_ptr[i];
+		lcol_ind.resize(lrow_ptr[nrows]);
+		lpos.resize(lrow_ptr[nrows]);
+		std::vector<int> next(lrow_ptr.begin(), lrow_ptr.end()-1);
+		for(int i = 0; i < nrows; i++)
+			for(int k = row_ptr[i]+1; k < row_ptr[i+1]; k++) {
+				const int j = col_ind[k];
+				lcol_ind[next[j]] = i;
+				lpos[next[j]++] = k;
+			}
+	}
+
+public:
+	MatrixSymCSR() : SparseMatrix<T>(0,0)
+	{
+		row_ptr.assign(1,0);
+	}
+
+	/// Copies the upper triangle of a MatrixCRS; the lower triangle is ignored
+	MatrixSymCSR(const MatrixCRS<T>& A) : SparseMatrix<T>(A.rows(),A.cols())
+	{
+		assign(A);
+	}
+
+	/// Copies the upper triangle of a MatrixCRS into this matrix; the lower triangle is ignored
+	void assign(const MatrixCRS<T>& A)
+	{
+		const MatrixCSR<T> F(A);
+		assign(F.rows(), F.growptr(), F.gcolind(), F.gval());
+	}
+
+	/// Sets up the matrix from the arrays of a square matrix in compressed row storage, whose rows are sorted; only the upper triangle is copied
+	/** A zero diagonal entry is stored for rows that do not have one.
+	 */
+	void assign(const int num_rows, const int* const rowptr, const int* const colind, const T* const vals)
+	{
+		nrows = ncols = num_rows;
+		row_ptr.resize(nrows+1);
+		row_ptr[0] = 0;
+		for(int i = 0; i < nrows; i++)
+		{
+			const int* const diag = std::lower_bound(colind+rowptr[i], colind+rowptr[i+1], i);
+			row_ptr[i+1] = row_ptr[i] + (colind+rowptr[i+1] - diag) + ((diag == colind+rowptr[i+1] || *diag != i) ? 1 : 0);
+		}
+		nnz = row_ptr[nrows];
+		col_ind.resize(nnz);
+		val.resize(nnz);
+
+		for(int i = 0; i < nrows; i++)
+		{
+			int k = std::lower_bound(colind+rowptr[i], colind+rowptr[i+1], i) - colind;
+			int pos = row_ptr[i];
+			col_ind[pos] = i;
+			val[pos] = T(0);
+			if(k < rowptr[i+1] && colind[k] == i)
+				val[pos] = vals[k++];
+			for(pos++ ; k < rowptr[i+1]; k++, pos++) {
+				col_ind[pos] = colind[k];
+				val[pos] = vals[k];
+			}
+		}
+		index_lower();
+	}
+
+	/// Takes over the arrays of the upper triangle of a square matrix in compressed row storage, without copying them
+	/** Each row must begin with its diagonal entry, followed by the entries right of the diagonal sorted by column.
+	 * The arguments are left empty.
+	 */
+	void assign_upper(const int num_rows, std::vector<int>& rowptr, std::vector<int>& colind, std::vector<T>& vals)
+	{
+		nrows = ncols = num_rows;
+		row_ptr.swap(rowptr); col_ind.swap(colind); val.swap(vals);
+		rowptr.clear(); colind.clear(); vals.clear();
+		nnz = row_ptr[nrows];
+		index_lower();
+	}
+
+	int getnnz() const { return nnz; }
+	const int* growptr() const { return row_ptr.data(); }
+	const int* gcolind() const { return col_ind.data(); }
+	const T* gval() const { return val.data(); }
+
+	/// Changes an existing entry of either triangle; an entry outside the non-zero pattern cannot be set
+	void set(int x, int y, const double value)
+	{
+		if(x > y) std::swap(x,y);
+		const int* const pos = std::lower_bound(col_ind.data()+row_ptr[x], col_ind.data()+row_ptr[x+1], y);
+		if(pos == col_ind.data()+row_ptr[x+1] || *pos != y) {
+			if(dabs(value) > ZERO_TOL)
+				std::cout << "! MatrixSymCSR: set(): Entry (" << x << "," << y << ") is not in the non-zero pattern!" << std::endl;
+			return;
+		}
+		val[pos-col_ind.data()] = value;
+	}
+
+	T get(int x, int y) const
+	{
+		if(x > y) std::swap(x,y);
+		const int* const pos = std::lower_bound(col_ind.data()+row_ptr[x], col_ind.data()+row_ptr[x+1], y);
+		if(pos == col_ind.data()+row_ptr[x+1] || *pos != y)
+			return T(0);
+		return val[pos-col_ind.data()];
+	}
+
+	void mprint() const
+	{
+		std::cout << "\n";
+		for(int i = 0; i < nrows; i++)
+		{
+			for(int j = 0; j < ncols; j++)
+				std::cout << std::setw(WIDTH) << get(i,j);
+			std::cout << std::endl;
+		}
+	}
+
+	/// Computes a := this * x, where x can have any number of columns
+	/** The last argument is ignored; the product is computed in parallel if the strict lower triangle has been indexed (see the class description).
+	 */
+	void multiply(const Mat& x, Mat* const a, const char paralel = 'n') const
+	{
+		const int nr = nrows;
+		const int nc = x.cols();
+		const int* const rp = row_ptr.data(); const int* const ci = col_ind.data(); const T* const v = val.data();
+		const T* const xp = &x(0,0);
+		T* const ap = &(*a)(0,0);
+
+		const int nthreads = lrow_ptr.size() > 0 ? omp_get_max_threads() : 1;
+		// serially, a(i) only gets contributions of rows before i until row i is reached
+		if(nthreads == 1 && nc == 1)
+		{
+			for(int i = 0; i < nr; i++)
+				ap[i] = 0;
+			for(int i = 0; i < nr; i++)
+			{
+				const T xi = xp[i];
+				T sum = v[rp[i]]*xi;
+				for(int k = rp[i]+1; k < rp[i+1]; k++) {
+					sum += v[k]*xp[ci[k]];
+					ap[ci[k]] += v[k]*xi;
+				}
+				ap[i] += sum;
+			}
+			return;
+		}
+		if(nthreads == 1)
+		{
+			for(size_t i = 0; i < (size_t)nr*nc; i++)
+				ap[i] = 0;
+			for(int i = 0; i < nr; i++)
+			{
+				T* const ai = ap + (size_t)i*nc;
+				const T* const xi = xp + (size_t)i*nc;
+				for(int l = 0; l < nc; l++)
+					ai[l] += v[rp[i]]*xi[l];
+				for(int k = rp[i]+1; k < rp[i+1]; k++)
+				{
+					const T vk = v[k];
+					const T* const xj = xp + (size_t)ci[k]*nc;
+					T* const aj = ap + (size_t)ci[k]*nc;
+					for(int l = 0; l < nc; l++) {
+						ai[l] += vk*xj[l];
+						aj[l] += vk*xi[l];
+					}
+				}
+			}
+			return;
+		}
+
+		// each row gathers from its upper-triangle row and its lower-triangle row, so the rows are independent
+		const int* const lrp = lrow_ptr.data(); const int* const lci = lcol_ind.data(); const int* const lp = lpos.data();
+		#pragma omp parallel for default(none) shared(nr, nc, rp, ci, v, lrp, lci, lp, xp, ap) schedule(static) num_threads(nthreads)
+		for(int i = 0; i < nr; i++)
+		{
+			T* const ai = ap + (size_t)i*nc;
+			const T* const xi = xp + (size_t)i*nc;
+			for(int l = 0; l < nc; l++)
+				ai[l] = v[rp[i]]*xi[l];
+			for(int k = rp[i]+1; k < rp[i+1]; k++)
+			{
+				const T vk = v[k];
+				const T* const xj = xp + (size_t)ci[k]*nc;
+				for(int l = 0; l < nc; l++)
+					ai[l] += vk*xj[l];
+			}
+			for(int k = lrp[i]; k < lrp[i+1]; k++)
+			{
+				const T vk = v[lp[k]];
+				const T* const xj = xp + (size_t)lci[k]*nc;
+				for(int l = 0; l < nc; l++)
+					ai[l] += vk*xj[l];
+			}
+		}
+	}
+
+	/// Carries out one symmetric successive over-relaxation (SSOR) sweep for this*x = b, ie., a forward sweep followed by a backward sweep
+	/** x is a column vector containing the initial guess, and is overwritten by the result. For omega = 1, this is a symmetric Gauss-Seidel sweep.
+	 * One sweep starting from x = 0 applies the (symmetric) SSOR preconditioner to b.
+	 * In the forward sweep, once x(i) is updated, row i of the upper triangle is scattered into the lower-triangle sums of the rows below it.
+	 * The backward sweep needs the same sums, as the rows above row i still hold their values from the forward sweep.
+	 */
+	void ssor(const Mat& b, Mat& x, const T omega = 1.0) const
+	{
+		std::vector<T> lsum(nrows, T(0));		// product of the strict lower triangle of each row with x
+		for(int i = 0; i < nrows; i++)
+		{
+			T sum = b.get(i) - lsum[i];
+			for(int k = row_ptr[i]+1; k < row_ptr[i+1]; k++)
+				sum -= val[k]*x.get(col_ind[k]);
+			x(i) = (1.0-omega)*x.get(i) + omega*sum/val[row_ptr[i]];
+			const T xi = x.get(i);
+			for(int k = row_ptr[i]+1; k < row_ptr[i+1]; k++)
+				lsum[col_ind[k]] += val[k]*xi;
+		}
+		for(int i = nrows-1; i >= 0; i--)
+		{
+			T sum = b.get(i) - lsum[i];
+			for(int k = row_ptr[i]+1; k < row_ptr[i+1]; k++)
+				sum -= val[k]*x.get(col_ind[k]);
+			x(i) = (1.0-omega)*x.get(i) + omega*sum/val[row_ptr[i]];
+		}
+	}
+
+	/// Like the multiply() method, except the argument matrix is considered x for the first p-1 rows, 0 in the pth row and y for the remaining rows.
+	void multiply_parts(const Mat* x, const Mat* y, Mat* const ans, const int p) const
+	{
+		for(int k = 0; k < x->cols(); k++)
+			for(int i = 0; i < nrows; i++)
+				(*ans)(i,k) = getelem_multiply_parts(i, x, y, p, 0.0);
+	}
+
+	/// Returns dot product of rownum'th row of this matrix with a vector that is x before position p, num at p and y after it
+	/** Since only the upper triangle is stored, the lower part of the row is found by searching the rows above it.
+	 */
+	T getelem_multiply_parts(const int rownum, const Mat* x, const Mat* y, const int p, const T num) const
+	{
+		T ans = 0;
+		for(int k = 0; k < x->cols(); k++)
+			for(int j = 0; j < ncols; j++)
+			{
+				const T aij = get(rownum,j);
+				if(aij == T(0)) continue;
+				if(j < p)
+					ans += aij * x->get(j,k);
+				else if(j > p)
+					ans += aij * y->get(j,k);
+				else
+					ans += aij * num;
+			}
+		return ans;
+	}
+
+	/// D is returned as a column-vector containing diagonal elements of this sparse matrix.
+	void get_diagonal(Mat* D) const
+	{
+		for(int i = 0; i < nrows; i++)
+			(*D)(i) = val[row_ptr[i]];
+	}
+};
+
+/// Assembles a sparse matrix arising from a mesh, in two phases
+/** In the symbolic phase, the non-zero pattern of the matrix is computed once from the connectivity of the mesh and stored in
+ * compressed row storage. For each element, the positions in the value array of all entries of its element matrix are found
+ * beforehand, and the elements are coloured so that no two elements of the same colour share a point.
+ * In the numeric phase, element matrices are added directly at those positions; no searching or memory allocation takes place.
+ * Elements of one colour can be added concurrently from different threads. Re-assembling on the same mesh,
+ * for example after the coordinates have changed, only needs the numeric phase again.
+ *
+ * There can be nvar unknowns per point. Unknown ivar of point ip has global index ivar*npoin + ip, and the element matrices
+ * are ordered the same way: local unknown ivar of local node inode is numbered ivar*nnode + inode.
+ *
+ * The Mesh type needs gnpoin(), gnelem(), gnnode() and ginpoel(iel,inode), as UMesh2d and UMesh have.
+ */
+template <class T> class CRSAssembler
+{
+	int npoin;
+	int nvar;
+	int nelem;
+	int nnode;
+	std::vector<int> row_ptr;			///< Index into col_ind and val where each row begins
+	std::vector<int> col_ind;			///< Sorted column indices of each row
+	std::vector<T> val;					///< Values of the non-zero entries
+	std::vector<int> slots;				///< For each element, the positions in val of the entries of its element matrix
+	std::vector<int> colour_ptr;		///< Index into colour_elem where the elements of each colour begin
+	std::vector<int> colour_elem;		///< Elements, grouped by colour
+
+	/// Expands the pattern of points connected to points to nvar unknowns per point, and sets up the values
+	void expand(const std::vector<int>& ptr_n, const std::vector<int>& col_n)
+	{
+		const int nrows = nvar*npoin;
+		const int nnz_n = ptr_n[npoin];
+		row_ptr.resize(nrows+1);
+		col_ind.resize((size_t)nvar*nvar*nnz_n);
+		for(int ivar = 0; ivar < nvar; ivar++)
+			for(int ip = 0; ip < npoin; ip++)
+			{
+				const int start = ivar*nvar*nnz_n + nvar*ptr_n[ip];
+				const int len = ptr_n[ip+1]-ptr_n[ip];
+				row_ptr[ivar*npoin+ip] = start;
+				for(int jvar = 0; jvar < nvar; jvar++)
+					for(int k = 0; k < len; k++)
+						col_ind[start + jvar*len + k] = jvar*npoin + col_n[ptr_n[ip]+k];
+			}
+		row_ptr[nrows] = nvar*nvar*nnz_n;
+		val.assign(row_ptr[nrows], T(0));
+	}
+
+	/// Finds the slots of all element matrix entries and colours the elements; returns false if the pattern misses an entry
+	template <class Mesh>
+	bool element_slots(const Mesh& m, const std::vector<int>& ptr_n, const std::vector<int>& col_n,
+			const std::vector<int>& esup_p, const std::vector<int>& esup)
+	{
+		const int nd = nvar*nnode;
+		const int nnz_n = ptr_n[npoin];
+		slots.resize((size_t)nelem*nd*nd);
+		bool found = true;
+
+		for(int iel = 0; iel < nelem; iel++)
+			for(int inode = 0; inode < nnode; inode++)
+			{
+				const int ip = m.ginpoel(iel,inode);
+				const int len = ptr_n[ip+1]-ptr_n[ip];
+				for(int jnode = 0; jnode < nnode; jnode++)
+				{
+					const int jp = m.ginpoel(iel,jnode);
+					const int* const pos = std::lower_bound(&col_n[0]+ptr_n[ip], &col_n[0]+ptr_n[ip+1], jp);
+					if(pos == &col_n[0]+ptr_n[ip+1] || *pos != jp) {
+						found = false;
+						continue;
+					}
+					const int k = pos - &col_n[0];
+					for(int ivar = 0; ivar < nvar; ivar++)
+						for(int jvar = 0; jvar < nvar; jvar++)
+							slots[(size_t)iel*nd*nd + (ivar*nnode+inode)*nd + jvar*nnode+jnode] = ivar*nvar*nnz_n + nvar*ptr_n[ip] + jvar*len + k-ptr_n[ip];
+				}
+			}
+		if(!found) {
+			std::cout << "! CRSAssembler: The given points surrounding points do not contain all pairs of points of the elements!" << std::endl;
+			return false;
+		}
+
+		// greedy colouring: each element gets the lowest colour not taken by an element sharing a point with it
+		std::vector<int> colour(nelem, -1);
+		std::vector<int> taken;					// taken[c] == iel if colour c is used by a neighbour of element iel
+		int ncolours = 0;
+		for(int iel = 0; iel < nelem; iel++)
+		{
+			for(int inode = 0; inode < nnode; inode++)
+			{
+				const int ip = m.ginpoel(iel,inode);
+				for(int ie = esup_p[ip]; ie < esup_p[ip+1]; ie++)
+					if(colour[esup[ie]] >= 0)
+						taken[colour[esup[ie]]] = iel;
+			}
+			int c = 0;
+			while(c < ncolours && taken[c] == iel)
+				c++;
+			if(c == ncolours) {
+				ncolours++;
+				taken.push_back(-1);
+			}
+			colour[iel] = c;
+		}
+
+		colour_ptr.assign(ncolours+1, 0);
+		for(int iel = 0; iel < nelem; iel++)
+			colour_ptr[colour[iel]+1]++;
+		for(int c = 0; c < ncolours; c++)
+			colour_ptr[c+1] += colour_ptr[c];
+		colour_elem.resize(nelem);
+		std::vector<int> next(colour_ptr.begin(), colour_ptr.end()-1);
+		for(int iel = 0; iel < nelem; iel++)
+			colour_elem[next[colour[iel]]++] = iel;
+		return true;
+	}
+
+	/// Computes elements surrounding points
+	template <class Mesh>
+	void elements_surrounding_points(const Mesh& m, std::vector<int>& esup_p, std::vector<int>& esup) const
+	{
+		esup_p.assign(npoin+1, 0);
+		for(int iel = 0; iel < nelem; iel++)
+			for(int inode = 0; inode < nnode; inode++)
+				esup_p[m.ginpoel(iel,inode)+1]++;
+		for(int ip = 0; ip < npoin; ip++)
+			esup_p[ip+1] += esup_p[ip];
+		esup.resize(esup_p[npoin]);
+		std::vector<int> next(esup_p.begin(), esup_p.end()-1);
+		for(int iel = 0; iel < nelem; iel++)
+			for(int inode = 0; inode < nnode; inode++)
+				esup[next[m.ginpoel(iel,inode)]++] = iel;
+	}
+
+public:
+	CRSAssembler() : npoin(0), nvar(0), nelem(0), nnode(0) { }
+
+	/// Symbolic phase: computes the pattern from the nodes of the elements, so that every node of an element is coupled to every other
+	/** This works for elements of any order.
+	 */
+	template <class Mesh>
+	void symbolic(const Mesh& m, const int num_vars)
+	{
+		npoin = m.gnpoin(); nelem = m.gnelem(); nnode = m.gnnode(); nvar = num_vars;
+
+		std::vector<int> esup_p, esup;
+		elements_surrounding_points(m, esup_p, esup);
+
+		// points surrounding each point, including itself, found through the elements surrounding it
+		std::vector<int> ptr_n(npoin+1, 0), col_n;
+		std::vector<int> lpoin(npoin, -1);
+		for(int ip = 0; ip < npoin; ip++)
+		{
+			for(int ie = esup_p[ip]; ie < esup_p[ip+1]; ie++)
+				for(int jnode = 0; jnode < nnode; jnode++)
+				{
+					const int jp = m.ginpoel(esup[ie],jnode);
+					if(lpoin[jp] != ip) {
+						lpoin[jp] = ip;
+						col_n.push_back(jp);
+					}
+				}
+			if(lpoin[ip] != ip)			// a point in no element is still given a diagonal entry
+				col_n.push_back(ip);
+			ptr_n[ip+1] = col_n.size();
+			std::sort(col_n.begin()+ptr_n[ip], col_n.end());
+		}
+
+		expand(ptr_n, col_n);
+		element_slots(m, ptr_n, col_n, esup_p, esup);
+	}
+
+	/// Symbolic phase: computes the pattern from points surrounding points (psup) given in compressed row storage
+	/** The diagonal is added to the pattern. psup_p has npoin+1 entries; the points surrounding point ip are
+	 * psup[psup_p[ip]] to psup[psup_p[ip+1]-1]. The elements of the mesh are then only used to find slots and colours;
+	 * false is returned if two points of an element are not connected in psup (as is the case for the high-order nodes
+	 * of quadratic meshes, for which psup is only computed for the vertices). Use the other overload in that case.
+	 */
+	template <class Mesh>
+	bool symbolic(const Mesh& m, const int num_vars, const int* const psup_p, const int* const psup)
+	{
+		npoin = m.gnpoin(); nelem = m.gnelem(); nnode = m.gnnode(); nvar = num_vars;
+
+		std::vector<int> ptr_n(npoin+1, 0), col_n;
+		col_n.reserve(psup_p[npoin]+npoin);
+		for(int ip = 0; ip < npoin; ip++)
+		{
+			col_n.push_back(ip);
+			col_n.insert(col_n.end(), psup+psup_p[ip], psup+psup_p[ip+1]);
+			ptr_n[ip+1] = col_n.size();
+			std::sort(col_n.begin()+ptr_n[ip], col_n.end());
+		}
+
+		std::vector<int> esup_p, esup;
+		elements_surrounding_points(m, esup_p, esup);
+		expand(ptr_n, col_n);
+		return element_slots(m, ptr_n, col_n, esup_p, esup);
+	}
+
+	int gnrows() const { return nvar*npoin; }
+	int gnnz() const { return val.size(); }
+	int gncolours() const { return (int)colour_ptr.size()-1; }
+	/// Index into the list of elements grouped by colour at which the elements of colour icolour begin
+	int gcolourstart(const int icolour) const { return colour_ptr[icolour]; }
+	/// The kth element in the list of elements grouped by colour
+	int gcolourelem(const int k) const { return colour_elem[k]; }
+
+	/// Zeros all values, keeping the pattern
+	void zeros()
+	{
+		const int nnz = val.size();
+		T* const v = val.data();
+		#pragma omp parallel for default(none) shared(v, nnz)
+		for(int k = 0; k < nnz; k++)
+			v[k] = T(0);
+	}
+
+	/// Numeric phase: adds an element matrix of size nvar*nnode x nvar*nnode
+	void add_element(const int iel, const Matrix<T>& Ke)
+	{
+		const int nd = nvar*nnode;
+		const int* const sl = &slots[(size_t)iel*nd*nd];
+		for(int i = 0; i < nd; i++)
+			for(int j = 0; j < nd; j++)
+				val[sl[i*nd+j]] += Ke(i,j);
+	}
+
+	/// Numeric phase: adds the nnode x nnode block of an element matrix that couples unknown ivar to unknown jvar
+	/** If trans is true, the transpose of Ke is added instead.
+	 */
+	void add_element_block(const int iel, const int ivar, const int jvar, const Matrix<T>& Ke, const bool trans = false)
+	{
+		const int nd = nvar*nnode;
+		const int* const sl = &slots[(size_t)iel*nd*nd];
+		for(int i = 0; i < nnode; i++)
+			for(int j = 0; j < nnode; j++)
+				val[sl[(ivar*nnode+i)*nd + jvar*nnode+j]] += trans ? Ke(j,i) : Ke(i,j);
+	}
+
+	/// Copies the assembled matrix into A, which is set up with the right size
+	void get_matrix(MatrixCSR<T>& A) const
+	{
+		A.assign(nvar*npoin, nvar*npoin, row_ptr.data(), col_ind.data(), val.data());
+	}
+
+	/// Copies the upper triangle of the assembled matrix into A; only valid if the assembled matrix is symmetric
+	void get_matrix(MatrixSymCSR<T>& A) const
+	{
+		A.assign(nvar*npoin, row_ptr.data(), col_ind.data(), val.data());
+	}
+
+	/// Copies the assembled matrix into A, which is set up with the right size
+	void get_matrix(MatrixCRS<T>& A) const
+	{
+		const int nrows = nvar*npoin;
+		A.setup(nrows, nrows);
+		#pragma omp parallel for default(none) shared(A, nrows)
+		for(int i = 0; i < nrows; i++)
+			A.setrow(i, row_ptr[i+1]-row_ptr[i], &col_ind[row_ptr[i]], &val[row_ptr[i]]);
+		A.update_nnz();
+	}
+};
+
 class MatrixCRS_traditional : public SparseMatrix<double>
 {
 	double* val;
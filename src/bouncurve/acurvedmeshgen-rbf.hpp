@@ -205,13 +205,17 @@ public:
 		cout << "CurvedMeshGeneration: compute_boundary_displacement_comp(): bmotion calculated." << endl;
 	}
 
-	void generate()
+	/// Moves the mesh; returns false, leaving the mesh unchanged, if the RBF mesh movement fails
+	bool generate()
 	{
 		cout << "CurvedMeshGeneration: generate(): Setting up RBF mesh movement" << endl;
 		cout << nbpoin << endl;
 		rbfm.setup(&mipoints, &bpoints, &bmotion, rbf_c, srad, rbf_nsteps, 1e-8, 20000);
 		cout << "CurvedMeshGeneration: generate(): Moving the mesh" << endl;
-		rbfm.move();
+		if(!rbfm.move()) {
+			cout << "! CurvedMeshGeneration: generate(): RBF mesh movement failed!" << endl;
+			return false;
+		}
 		bpoints = rbfm.getBoundaryPoints();
 		mipoints = rbfm.getInteriorPoints();
 
@@ -242,5 +246,6 @@ public:
 		}
 		m->setcoords(&coord);
 		cout << "CurvedMeshGeneration: generate(): Done." << endl;
+		return true;
 	}
 };
@@ -20,7 +20,8 @@ int main()
 
 	CurvedMeshGeneration cmg(&m2, fixed_b_flags, 1, 2, 0.002);
 	cmg.compute_boundary_displacement_comp(mg);
-	cmg.generate();
+	if(!cmg.generate())
+		return -1;
 	m2.writeGmsh2("rans_bump_aditya-0.002.msh");
 
 	double norm = 0;
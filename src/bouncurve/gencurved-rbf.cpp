@@ -40,7 +40,8 @@ int main()
 
 	CurvedMeshGeneration cmg(&mq, bounflags, num_steps, 2, sup_rad);
 	cmg.compute_boundary_displacement();
-	cmg.generate();
+	if(!cmg.generate())
+		return -1;
 	mq.writeGmsh2(outmesh);
 	
 	//writeQuadraticMeshToVtu(outmesh.replace(outmesh.end()-3, outmesh.end(), "vtu"), mq);
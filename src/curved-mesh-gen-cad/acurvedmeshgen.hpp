@@ -49,7 +49,8 @@ public:
 
 	~CurvedMeshGen();
 
-	void generateCurvedMesh();
+	/// Moves the mesh; returns false, leaving the mesh unchanged, if the RBF mesh movement fails
+	bool generateCurvedMesh();
 };
 
 CurvedMeshGen::CurvedMeshGen(UMesh* mesh, const std::vector<int> rbf_boundaries, const int choice, const double param1, const double tol, const int maxiter, const std::string solver)
@@ -308,9 +309,12 @@ CurvedMeshGen::~CurvedMeshGen()
 	delete move;
 }
 
-void CurvedMeshGen::generateCurvedMesh()
+bool CurvedMeshGen::generateCurvedMesh()
 {
-	move->move();
+	if(!move->move()) {
+		std::cout << "! CurvedMeshGen: generateCurvedMesh(): RBF mesh movement failed!" << std::endl;
+		return false;
+	}
 
 	inpoints = move->getInteriorPoints();
 	bounpoints = move->getBoundaryPoints();
@@ -331,6 +335,7 @@ void CurvedMeshGen::generateCurvedMesh()
 				m->scoords(ipoin,idim, inpoints.get(l,idim));
 			l++;
 		}
+	return true;
 }
 
 } // end namespace
@@ -42,7 +42,8 @@ public:
 
 	~CurvedMeshGen();
 
-	void generateCurvedMesh();
+	/// Moves the mesh; returns false, leaving the mesh unchanged, if the RBF mesh movement fails
+	bool generateCurvedMesh();
 };
 
 CurvedMeshGen::CurvedMeshGen(UMesh2dh* mesh, const int choice, const double param1, const double tol, const int maxiter, const std::string solver)
@@ -129,9 +130,12 @@ CurvedMeshGen::~CurvedMeshGen()
 	delete move;
 }
 
-void CurvedMeshGen::generateCurvedMesh()
+bool CurvedMeshGen::generateCurvedMesh()
 {
-	move->move();
+	if(!move->move()) {
+		std::cout << "! CurvedMeshGen: generateCurvedMesh(): RBF mesh movement failed!" << std::endl;
+		return false;
+	}
 
 	inpoints = move->getInteriorPoints();
 	bounpoints = move->getBoundaryPoints();
@@ -152,6 +156,7 @@ void CurvedMeshGen::generateCurvedMesh()
 				m->scoords(ipoin,idim, inpoints.get(l,idim));
 			l++;
 		}
+	return true;
 }
 
 } // end namespace
@@ -42,7 +42,8 @@ int main(int argc, char* argv[])
 	CurvedMeshGen cmg(&m, rbf_choice, sup_rad, tol, maxiter, solver);
 
 	clock_t begin = clock();
-	cmg.generateCurvedMesh();
+	if(!cmg.generateCurvedMesh())
+		return -1;
 	clock_t end = clock() - begin;
 	cout << "Time taken by mesh movement is " << (double(end))/CLOCKS_PER_SEC << endl;
 	
@@ -48,7 +48,8 @@ public:
 
 	void compute_boundary_displacements();
 
-	void generate_curved_mesh();
+	/// Curves the mesh; returns false, leaving the mesh unchanged, if the mesh movement fails
+	bool generate_curved_mesh();
 };
 
 void Curvedmeshgen2d::setup(UMesh2d* mesh, UMesh2d* meshq, Meshmove* mmove, int num_parts, vector<vector<int>> boundarymarkers, double angle_threshold, double toler, double maxitera, int rbf_choice, double support_radius, int rbf_steps)
@@ -108,7 +109,7 @@ void Curvedmeshgen2d::compute_boundary_displacements()
 
 /** Uses the previously computed displacements of the face midpoints to curve the mesh.
 */
-void Curvedmeshgen2d::generate_curved_mesh()
+bool Curvedmeshgen2d::generate_curved_mesh()
 {
 	/** Note that this function works with the straight quadratic mesh.
 	 * We assume that the face numberings of the linear mesh and the quadratic mesh are the same.
@@ -164,7 +165,10 @@ void Curvedmeshgen2d::generate_curved_mesh()
 	//Call RBF functions here
 
 	mmv->setup(&inpoints, &bounpoints, &boundisps, rbfchoice, supportradius, nummovesteps, tol, maxiter);
-	mmv->move();
+	if(!mmv->move()) {
+		cout << "! Curvedmeshgen2d: generate_curved_mesh(): RBF mesh movement failed!" << endl;
+		return false;
+	}
 
 	bounpoints = mmv->getBoundaryPoints();
 	inpoints = mmv->getInteriorPoints();
@@ -189,6 +193,7 @@ void Curvedmeshgen2d::generate_curved_mesh()
 
 	// set it in mesh mq
 	mq->setcoords(&newcoords);
+	return true;
 }
 
 // ------------ end --------------------
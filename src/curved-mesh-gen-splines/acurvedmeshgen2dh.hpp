@@ -54,7 +54,8 @@ public:
 
 	void compute_boundary_displacements();
 
-	void generate_curved_mesh();
+	/// Curves the mesh; returns false, leaving the mesh unchanged, if the mesh movement fails
+	bool generate_curved_mesh();
 };
 
 void Curvedmeshgen2d::setup(UMesh2dh* mesh, UMesh2dh* meshq, Meshmove* mmove, int num_parts, vector<vector<int>> boundarymarkers, double angle_threshold, double _spltol, int _splmaxiter, double toler, int maxitera, int rbf_choice, double support_radius, int rbf_steps, string rbf_solver)
@@ -117,7 +118,7 @@ void Curvedmeshgen2d::compute_boundary_displacements()
 
 /** Uses the previously computed displacements of the face midpoints to curve the mesh.
 */
-void Curvedmeshgen2d::generate_curved_mesh()
+bool Curvedmeshgen2d::generate_curved_mesh()
 {
 	/** 
 	Note that this function works with the straight quadratic mesh.
@@ -239,7 +240,10 @@ void Curvedmeshgen2d::generate_curved_mesh()
 	//Call RBF functions here
 
 	mmv->setup(&inpoints, &bounpoints, &boundisps, rbfchoice, supportradius, nummovesteps, tol, maxiter, rbfsolver);
-	mmv->move();
+	if(!mmv->move()) {
+		cout << "! Curvedmeshgen2d: generate_curved_mesh(): RBF mesh movement failed!" << endl;
+		return false;
+	}
 
 	bounpoints = mmv->getBoundaryPoints();
 	inpoints = mmv->getInteriorPoints();
@@ -274,6 +278,7 @@ void Curvedmeshgen2d::generate_curved_mesh()
 
 	// set it in mesh mq
 	mq->setcoords(&newcoords);
+	return true;
 }
 
 // ------------ end --------------------
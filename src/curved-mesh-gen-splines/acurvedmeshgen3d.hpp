@@ -41,6 +41,8 @@ class CurvedMeshGen
 	amc_real supportradius;			///< Parameters for mesh movement - the support radius to be used, if applicable
 	int nummovesteps;				///< Number of steps in which to accomplish the total mesh movement.
 	std::string rbfsolver;				///< string describing the method to use for solving the RBF equations
+	bool frozencentres;				///< whether to keep RBF centres at their initial positions for all steps
+	double greedytol;				///< tolerance for greedy selection of RBF centres; zero means all boundary points are centres
 
 	amc_int nbounpoin;						///< Number if boundary points.
 	amc_int ninpoin;						///< Number of interior points.
@@ -54,17 +56,18 @@ class CurvedMeshGen
 
 public:
 	void setup(const UMesh* mesh, UMesh* meshq, std::string br_type, std::string stencil_type, double angle_threshold,
-			double toler, int maxitera, int rbf_choice, amc_real support_radius, int rbf_steps, std::string rbf_solver);
+			double toler, int maxitera, int rbf_choice, amc_real support_radius, int rbf_steps, std::string rbf_solver, bool frozen_centres = false, double greedy_tol = 0.0);
 
 	~CurvedMeshGen();
 
 	void compute_boundary_displacements();
 
-	void generate_curved_mesh();
+	/// Curves the mesh; returns false, leaving the mesh unchanged, if the mesh movement fails
+	bool generate_curved_mesh();
 };
 
 void CurvedMeshGen::setup(const UMesh* mesh, UMesh* meshq, std::string br_type, std::string stencil_type, double angle_threshold, 
-		double toler, int maxitera, int rbf_choice, amc_real support_radius, int rbf_steps, std::string rbf_solver)
+		double toler, int maxitera, int rbf_choice, amc_real support_radius, int rbf_steps, std::string rbf_solver, bool frozen_centres, double greedy_tol)
 {
 	degree = 2;
 	
@@ -82,6 +85,8 @@ void CurvedMeshGen::setup(const UMesh* mesh, UMesh* meshq, std::string br_type,
 	rbfchoice = rbf_choice; supportradius = support_radius;
 	nummovesteps = rbf_steps;
 	rbfsolver = rbf_solver;
+	frozencentres = frozen_centres;
+	greedytol = greedy_tol;
 	disps.setup(m->gnface(),m->gndim());
 	disps.zeros();
 	bflagg.setup(mq->gnpoin(),1);
@@ -223,7 +228,7 @@ void CurvedMeshGen::compute_boundary_displacements()
 
 /** Uses the previously computed displacements of the face midpoints to curve the mesh.
 */
-void CurvedMeshGen::generate_curved_mesh()
+bool CurvedMeshGen::generate_curved_mesh()
 {
 	/** 
 	Note that this function works with the straight quadratic mesh.
@@ -296,8 +301,12 @@ void CurvedMeshGen::generate_curved_mesh()
 	/// We now have all we need to call the mesh-movement functions and generate the curved mesh.
 	//Call RBF functions here
 
-	mmv = new RBFmove(&inpoints, &bounpoints, &boundisps, rbfchoice, supportradius, nummovesteps, tol, maxiter, rbfsolver);
-	mmv->move();
+	mmv = new RBFmove(&inpoints, &bounpoints, &boundisps, rbfchoice, supportradius, nummovesteps, tol, maxiter, rbfsolver, frozencentres, greedytol);
+	if(!mmv->move()) {
+		std::cout << "! CurvedMeshGen: generate_curved_mesh(): RBF mesh movement failed!" << std::endl;
+		delete mmv;
+		return false;
+	}
 
 	bounpoints = mmv->getBoundaryPoints();
 	inpoints = mmv->getInteriorPoints();
@@ -344,6 +353,7 @@ void CurvedMeshGen::generate_curved_mesh()
 	std::cout << "acmg3d: error in positions of low-order nodes: " << err[0] << " " << err[1] << " " << err[2] << std::endl;*/
 	
 	delete mmv;
+	return true;
 }
 
 // ------------ end --------------------
@@ -11,6 +11,10 @@
 	#include <alinalg.hpp>
 #endif
 
+#ifndef __AAMG_H
+	#include <aamg.hpp>
+#endif
+
 #ifndef __ALINELAST_P2_STIFFENED_H
 	#include <alinelast_p2_stiffened.hpp>
 #endif
@@ -37,7 +41,7 @@ class Curvedmeshgen2d
 	double mu;
 	double chi;						///< stiffening exponent for stiffened linear elasticity
 	std::string stiffscheme;				///< stiffening scheme used for stiffened linear elasticity
-	std::string linsolver;				///< linear solver to use
+	std::string linsolver;				///< linear solver to use: "CG", "BICGSTAB", "AMG", "AMGCG" or "EIGENLU"
 
 	int nbounpoin;					///< Number if boundary points.
 	int ninpoin;					///< Number of interior points.
@@ -201,9 +205,34 @@ void Curvedmeshgen2d::generate_curved_mesh()
 	fout.close();*/
 
 	if(linsolver == "CG")
-		alldisps = sparseCG_d(&A, b, xold, tol_e, maxiter);
+	{
+		// the stiffness matrix is symmetric (the Dirichlet BCs are imposed by penalty), so only its upper triangle is needed
+		amat::MatrixSymCSR<double> As(A);
+		alldisps = sparseCG_d(&As, b, xold, tol_e, maxiter);
+	}
 	else if(linsolver == "BICGSTAB")
-		alldisps = sparse_bicgstab(&A, b, xold, tol_e, maxiter);
+	{
+		// flat copy of the stiffness matrix for faster matrix-vector products; A is not needed any more
+		amat::MatrixCSR<double> Af(A);
+		A.setup(0,0);
+		Af.build_sell();
+		alldisps = sparse_bicgstab(&Af, b, xold, tol_e, maxiter);
+	}
+	else if(linsolver == "AMG" || linsolver == "AMGCG")
+	{
+		// AMGCG is conjugate gradient preconditioned by one AMG V-cycle; the iteration count hardly grows with the size of the mesh
+		amat::AMG amg;
+		const bool amgok = amg.setup(A, *mq->getcoords(), mq->gndim());
+		if(!amgok)
+			cout << "! Curvedmeshgen2d: generate_curved_mesh(): AMG setup failed; using CG with the diagonal preconditioner instead." << endl;
+		if(linsolver == "AMG" && amgok)
+			alldisps = amg.solve(b, xold, tol_e, maxiter);
+		else
+		{
+			amat::MatrixSymCSR<double> As(A);
+			alldisps = sparseCG_d(&As, b, xold, tol_e, maxiter, amgok ? &amg : nullptr);
+		}
+	}
 #ifdef EIGEN_LIBRARY
 	else if(linsolver == "EIGENLU")
 		alldisps = gausselim(A, b);
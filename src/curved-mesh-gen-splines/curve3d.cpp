@@ -14,8 +14,8 @@ int main(int argc, char* argv[])
 	cout << "DEBUG!\n";
 #endif
 	string confile = argv[1], linmesh, cmesh, solver, brtype, stenciltype, dum;
-	amc_real tol, angle_limit, suprad;
-	int maxiter, rbf_choice, rbf_steps;
+	amc_real tol, angle_limit, suprad, greedytol = 0;
+	int maxiter, rbf_choice, rbf_steps, frozen = 0;
 	ifstream conf(confile);
 
 	conf >> dum; conf >> linmesh;
@@ -29,6 +29,10 @@ int main(int argc, char* argv[])
 	conf >> dum; conf >> tol;
 	conf >> dum; conf >> maxiter;
 	conf >> dum; conf >> solver;
+	// optional: whether to freeze RBF centres at their initial positions for multi-step movement
+	if(conf >> dum) conf >> frozen;
+	// optional: tolerance for greedy selection of RBF centres (0 to use all boundary points)
+	if(conf >> dum) conf >> greedytol;
 	
 	conf.close();
 
@@ -43,9 +47,10 @@ int main(int argc, char* argv[])
 	UMesh mq = m.convertLinearToQuadratic();
 	
 	CurvedMeshGen cmg;
-	cmg.setup(&m, &mq, brtype, stenciltype, angle_limit, tol, maxiter, rbf_choice, suprad, rbf_steps, solver);
+	cmg.setup(&m, &mq, brtype, stenciltype, angle_limit, tol, maxiter, rbf_choice, suprad, rbf_steps, solver, frozen != 0, greedytol);
 	cmg.compute_boundary_displacements();
-	cmg.generate_curved_mesh();
+	if(!cmg.generate_curved_mesh())
+		return -1;
 	mq.writeGmsh2(cmesh);
 
 	// compute norm of error for unit ball case
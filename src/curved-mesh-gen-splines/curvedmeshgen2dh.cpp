@@ -65,7 +65,8 @@ int main(int argc, char* argv[])
 	cu.compute_boundary_displacements();
 	
 	clock_t begin = clock();
-	cu.generate_curved_mesh();
+	if(!cu.generate_curved_mesh())
+		return -1;
 	clock_t end = clock() - begin;
 	cout << "Time taken by RBF is " << (double(end))/CLOCKS_PER_SEC << endl;
 
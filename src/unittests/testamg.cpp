@@ -0,0 +1,192 @@
+/* @file testamg.cpp
+ * @brief Checks that AMG-preconditioned CG converges in a number of iterations independent of the mesh size for linear elasticity,
+ * that it gives the same solution as plain CG, and that a coarsest level too large to factor is handled.
+ * @author Aditya Kashi
+ */
+
+#include <aamg.hpp>
+
+using namespace amat;
+using namespace std;
+
+/// Assembles plane-strain linear elasticity (nvar = 2) or the Laplacian (nvar = 1) with P1 triangles on an m x m grid of the unit square
+/** The left side is clamped; the Dirichlet rows and columns are replaced by those of the identity. The load is a uniform body force.
+ * Unknown ivar of point ipoin is number ivar*npoin + ipoin, as AMG expects.
+ */
+void assemble(const int m, const int nvar, Matrix<double>& coords, MatrixCRS<double>& A, Matrix<double>& b)
+{
+	const int np1 = m+1, npoin = np1*np1, n = nvar*npoin;
+	coords.setup(npoin,2);
+	for(int j = 0; j < np1; j++)
+		for(int i = 0; i < np1; i++) {
+			coords(i+np1*j,0) = (double)i/m;
+			coords(i+np1*j,1) = (double)j/m;
+		}
+	A.setup(n,n);
+	b.setup(n,1);
+	b.zeros();
+
+	// plane strain, E = 1, nu = 0.3
+	const double nu = 0.3, c = 1.0/((1+nu)*(1-2*nu));
+	const double D[3][3] = {{c*(1-nu), c*nu, 0}, {c*nu, c*(1-nu), 0}, {0, 0, c*(1-2*nu)/2}};
+
+	for(int j = 0; j < m; j++)
+		for(int i = 0; i < m; i++)
+			for(int it = 0; it < 2; it++)
+			{
+				const int p0 = i+np1*j;
+				int p[3] = {p0, p0+1, p0+np1+1};
+				if(it == 1) { p[1] = p0+np1+1; p[2] = p0+np1; }
+				double dx[3], dy[3];
+				for(int k = 0; k < 3; k++) {
+					dy[k] = coords(p[(k+1)%3],1) - coords(p[(k+2)%3],1);
+					dx[k] = coords(p[(k+2)%3],0) - coords(p[(k+1)%3],0);
+				}
+				const double area = 0.5*(dx[2]*dy[1] - dx[1]*dy[2]);
+
+				// gradients of the basis functions are (dy, dx)/(2 area)
+				double Ke[6][6];
+				for(int a = 0; a < 3; a++)
+					for(int bb = 0; bb < 3; bb++)
+					{
+						const double ga[2] = {dy[a]/(2*area), dx[a]/(2*area)}, gb[2] = {dy[bb]/(2*area), dx[bb]/(2*area)};
+						if(nvar == 1)
+							Ke[a][bb] = area*(ga[0]*gb[0] + ga[1]*gb[1]);
+						else {
+							// B columns of node a: (ga0, 0, ga1) for u and (0, ga1, ga0) for v
+							const double Ba[2][3] = {{ga[0], 0, ga[1]}, {0, ga[1], ga[0]}}, Bb[2][3] = {{gb[0], 0, gb[1]}, {0, gb[1], gb[0]}};
+							for(int u = 0; u < 2; u++)
+								for(int v = 0; v < 2; v++)
+								{
+									double s = 0;
+									for(int r = 0; r < 3; r++)
+										for(int q = 0; q < 3; q++)
+											s += Ba[u][r]*D[r][q]*Bb[v][q];
+									Ke[u*3+a][v*3+bb] = area*s;
+								}
+						}
+					}
+
+				for(int u = 0; u < nvar; u++)
+					for(int a = 0; a < 3; a++)
+					{
+						const int r = u*npoin + p[a];
+						b(r) += (u == nvar-1 ? -1.0 : 0.0)*area/3.0;
+						for(int v = 0; v < nvar; v++)
+							for(int bb = 0; bb < 3; bb++)
+							{
+								const int col = v*npoin + p[bb];
+								A.set(r, col, A.get(r,col) + Ke[u*3+a][v*3+bb]);
+							}
+					}
+			}
+
+	// clamp the left side
+	MatrixCRS<double> Ac(n,n);
+	for(int r = 0; r < n; r++)
+	{
+		const bool rfixed = r%npoin % np1 == 0;
+		if(rfixed) {
+			Ac.set(r, r, 1.0);
+			b(r) = 0;
+			continue;
+		}
+		for(int u = 0; u < nvar; u++)
+			for(int k = -np1-1; k <= np1+1; k++)
+			{
+				const int ip = r%npoin + k;
+				if(ip < 0 || ip >= npoin || ip % np1 == 0) continue;
+				const double val = A.get(r, u*npoin+ip);
+				if(val != 0) Ac.set(r, u*npoin+ip, val);
+			}
+	}
+	A = Ac;
+}
+
+/// Returns the 2-norm of b - A x relative to that of b
+double relresidual(const SparseMatrix<double>& A, const Matrix<double>& x, const Matrix<double>& b)
+{
+	Matrix<double> r(b.rows(),1);
+	A.multiply(x, &r);
+	r.aypx(-1.0, b);
+	return r.l2norm()/b.l2norm();
+}
+
+int main()
+{
+	int nerr = 0;
+	const int iters = 12;
+
+	for(int nvar = 2; nvar >= 1; nvar--)
+		for(int m = 16; m <= 64; m *= 2)
+		{
+			Matrix<double> coords, b;
+			MatrixCRS<double> A;
+			assemble(m, nvar, coords, A, b);
+			const int n = A.rows();
+			MatrixSymCSR<double> As(A);
+			Matrix<double> x0(n,1);
+			x0.zeros();
+
+			AMG amg;
+			if(!amg.setup(A, coords, nvar)) {
+				cout << "! AMG setup failed for a " << m << " x " << m << " grid with " << nvar << " variables" << endl;
+				nerr++;
+				continue;
+			}
+
+			// a fixed number of iterations must reduce the residual by a large factor, bounded independently of the mesh size
+			const double eamg = relresidual(As, sparseCG_d(&As, b, x0, 1e-14, iters, &amg), b);
+			const double ediag = relresidual(As, sparseCG_d(&As, b, x0, 1e-14, iters), b);
+			cout << "testamg: " << m << " x " << m << " grid, " << nvar << " variables, " << amg.gnlevels() << " levels: residual after "
+				<< iters << " iterations " << eamg << " with AMG, " << ediag << " with diagonal preconditioner" << endl;
+			if(eamg > 1e-5 || eamg > 1e-3*ediag) {
+				cout << "! AMG-preconditioned CG does not converge fast enough" << endl;
+				nerr++;
+			}
+
+			// same solution as plain CG, and as V-cycle iterations
+			const Matrix<double> xa = sparseCG_d(&As, b, x0, 1e-10, 1000, &amg);
+			const Matrix<double> xc = sparseCG(&As, b, x0, 1e-10, 20000);
+			const Matrix<double> xv = amg.solve(b, x0, 1e-9, 200);
+			double diff = 0, diffv = 0, xmax = 0;
+			for(int i = 0; i < n; i++) {
+				diff = max(diff, fabs(xa.get(i)-xc.get(i)));
+				diffv = max(diffv, fabs(xv.get(i)-xc.get(i)));
+				xmax = max(xmax, fabs(xc.get(i)));
+			}
+			if(diff > 1e-6*xmax || diffv > 1e-6*xmax) {
+				cout << "! AMG solutions differ from the CG solution by " << diff/xmax << " and " << diffv/xmax << endl;
+				nerr++;
+			}
+		}
+
+	// with no strong connections nothing is aggregated, and the only level is too large to factor
+	{
+		Matrix<double> coords, b;
+		MatrixCRS<double> A;
+		assemble(40, 2, coords, A, b);
+		MatrixSymCSR<double> As(A);
+		Matrix<double> x0(A.rows(),1);
+		x0.zeros();
+		AMG amg(1e10);
+		if(!amg.setup(A, coords, 2) || amg.gnlevels() != 1) {
+			cout << "! AMG setup failed, or coarsened, with no strong connections" << endl;
+			nerr++;
+		}
+		else {
+			const double e = relresidual(As, sparseCG_d(&As, b, x0, 1e-10, 2000, &amg), b);
+			if(e > 1e-8) {
+				cout << "! CG preconditioned by smoother sweeps did not converge; residual " << e << endl;
+				nerr++;
+			}
+		}
+	}
+
+	if(nerr > 0) {
+		cout << "testamg: FAILED with " << nerr << " errors." << endl;
+		return 1;
+	}
+	cout << "testamg: passed." << endl;
+	return 0;
+}
@@ -0,0 +1,94 @@
+/* @file testdelaunay3d.cpp
+ * @brief Checks that parallel point insertion in Delaunay3d gives the same tetrahedralization as serial insertion,
+ * for each insertion ordering, and that the result is a valid mesh.
+ * @author Aditya Kashi
+ */
+
+#include <abowyerwatson3d.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <omp.h>
+
+using namespace amat;
+using namespace amc;
+using namespace std;
+
+typedef array<int,4> TetKey;
+
+/// Returns the sorted vertex lists of all tets, sorted
+vector<TetKey> tetset(const Delaunay3d& d)
+{
+	vector<TetKey> t(d.elems.size());
+	for(size_t i = 0; i < d.elems.size(); i++)
+	{
+		for(int j = 0; j < 4; j++)
+			t[i][j] = d.elems[i].p[j];
+		sort(t[i].begin(), t[i].end());
+	}
+	sort(t.begin(), t.end());
+	return t;
+}
+
+/// Checks orientation and neighbour symmetry of the tets; returns the number of errors
+int checkmesh(Delaunay3d& d)
+{
+	int nerr = 0;
+	d.compute_jacobians();
+	if(d.detect_negative_jacobians()) nerr++;
+	for(size_t i = 0; i < d.elems.size(); i++)
+		for(int j = 0; j < 4; j++)
+		{
+			const int nb = d.elems[i].surr[j];
+			if(nb < 0) continue;
+			bool found = false;
+			for(int k = 0; k < 4; k++)
+				if(d.elems[nb].surr[k] == (int)i) found = true;
+			if(!found) nerr++;
+		}
+	return nerr;
+}
+
+int main()
+{
+	int nerr = 0;
+	const int np = 30000;
+	Matrix<double> pts(np,3);
+	srand(7);
+	for(int i = 0; i < np; i++)
+		for(int j = 0; j < 3; j++)
+			pts(i,j) = (double)rand()/RAND_MAX;
+
+	const PointOrdering orders[3] = {ORDER_NONE, ORDER_HILBERT, ORDER_BRIO};
+	vector<TetKey> ref;
+	for(int iord = 0; iord < 3; iord++)
+		for(int nthreads = 1; nthreads <= 4; nthreads += 3)
+		{
+			omp_set_num_threads(nthreads);
+			Delaunay3d d(&pts);
+			d.set_ordering(orders[iord]);
+			d.bowyer_watson();
+
+			const int ne = checkmesh(d);
+			if(ne > 0) {
+				cout << "! Invalid mesh with ordering " << iord << " and " << nthreads << " threads: " << ne << " errors" << endl;
+				nerr++;
+			}
+
+			vector<TetKey> t = tetset(d);
+			if(ref.empty())
+				ref = t;
+			else if(t != ref) {
+				cout << "! Tetrahedralization with ordering " << iord << " and " << nthreads << " threads differs from the serial one: "
+					<< t.size() << " tets instead of " << ref.size() << endl;
+				nerr++;
+			}
+		}
+
+	if(nerr > 0) {
+		cout << "testdelaunay3d: FAILED with " << nerr << " errors." << endl;
+		return 1;
+	}
+	cout << "testdelaunay3d: passed, " << ref.size() << " tets." << endl;
+	return 0;
+}
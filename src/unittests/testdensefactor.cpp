@@ -0,0 +1,112 @@
+/* @file testdensefactor.cpp
+ * @brief Checks the dense LU and Cholesky factorizations with several right-hand sides, and their detection of singular or indefinite matrices.
+ * @author Aditya Kashi
+ */
+
+#include <alinalg.hpp>
+#include <cstdlib>
+
+using namespace amat;
+using namespace std;
+
+/// Returns the largest entry of |A x - b|, relative to the largest entry of b
+double relerror(const Matrix<double>& A, const Matrix<double>& x, const Matrix<double>& b)
+{
+	double err = 0, bmax = 0;
+	for(int i = 0; i < A.rows(); i++)
+		for(int l = 0; l < b.cols(); l++)
+		{
+			double s = 0;
+			for(int j = 0; j < A.cols(); j++)
+				s += A.get(i,j)*x.get(j,l);
+			err = max(err, fabs(s - b.get(i,l)));
+			bmax = max(bmax, fabs(b.get(i,l)));
+		}
+	return err/bmax;
+}
+
+int main()
+{
+	int nerr = 0;
+	const int n = 120, nrhs = 3;
+	srand(5);
+
+	// a non-symmetric matrix that needs pivoting, and an SPD matrix
+	Matrix<double> A(n,n), S(n,n), b(n,nrhs);
+	for(int i = 0; i < n; i++)
+		for(int j = 0; j < n; j++)
+			A(i,j) = (double)rand()/RAND_MAX - 0.5;
+	for(int i = 0; i < n; i++) {
+		A(i,i) = 0;
+		for(int j = 0; j <= i; j++)
+		{
+			double s = 0;
+			for(int k = 0; k < n; k++)
+				s += A.get(i,k)*A.get(j,k);
+			S(i,j) = S(j,i) = s;
+		}
+		S(i,i) += 1.0;
+	}
+	for(int i = 0; i < n; i++)
+		for(int l = 0; l < nrhs; l++)
+			b(i,l) = (double)rand()/RAND_MAX;
+
+	Matrix<double> LU(A), x;
+	Matrix<int> p;
+	if(!LUfactor(LU, p)) {
+		cout << "! LUfactor failed for a non-singular matrix!" << endl;
+		nerr++;
+	}
+	else {
+		LUsolve(LU, p, b, x);
+		double e = relerror(A, x, b);
+		cout << "testdensefactor: LU relative residual = " << e << endl;
+		if(e > 1e-10) nerr++;
+	}
+
+	Matrix<double> L(S);
+	if(!cholfactor(L)) {
+		cout << "! cholfactor failed for an SPD matrix!" << endl;
+		nerr++;
+	}
+	else {
+		cholsolve(L, b, x);
+		double e = relerror(S, x, b);
+		cout << "testdensefactor: Cholesky relative residual = " << e << endl;
+		if(e > 1e-10) nerr++;
+	}
+
+	// each column of a multi-column solve must equal the solve of that column alone
+	Matrix<double> b1(n,1), x1;
+	for(int i = 0; i < n; i++)
+		b1(i) = b.get(i,nrhs-1);
+	cholsolve(L, b1, x1);
+	for(int i = 0; i < n; i++)
+		if(fabs(x1.get(i) - x.get(i,nrhs-1)) > 1e-12*(1.0+fabs(x1.get(i)))) {
+			cout << "! Multi-column Cholesky solve differs from single-column solve at row " << i << endl;
+			nerr++;
+			break;
+		}
+
+	// a singular matrix (two equal rows) and an indefinite one must be rejected
+	Matrix<double> Z(A);
+	for(int j = 0; j < n; j++)
+		Z(1,j) = Z(0,j);
+	if(LUfactor(Z, p)) {
+		cout << "! LUfactor did not detect a singular matrix!" << endl;
+		nerr++;
+	}
+	Matrix<double> N(S);
+	N(n/2,n/2) = -1.0;
+	if(cholfactor(N)) {
+		cout << "! cholfactor did not detect an indefinite matrix!" << endl;
+		nerr++;
+	}
+
+	if(nerr > 0) {
+		cout << "testdensefactor: FAILED with " << nerr << " errors." << endl;
+		return 1;
+	}
+	cout << "testdensefactor: passed." << endl;
+	return 0;
+}
@@ -0,0 +1,211 @@
+/* @file testdgm.cpp
+ * @brief Checks the cached Delaunay graph mapping DGMapping: rigid motions of the DG points are reproduced exactly at the interior points,
+ * a mapping read back from a file is identical to the one written, truncated files are rejected,
+ * a mapping re-generated by update() agrees with a fresh build() in the last valid configuration,
+ * and DGmove moves the interior points it could locate while leaving the others in place.
+ * @author Aditya Kashi
+ */
+
+#include <adgm.hpp>
+#include <cstdio>
+#include <fstream>
+
+using namespace amat;
+using namespace amc;
+using namespace std;
+
+/// Rotates the points pts by the angle t about the origin, and translates them by (dx,dy), into rpts
+void rigidmotion(const Matrix<double>& pts, const double t, const double dx, const double dy, Matrix<double>& rpts)
+{
+	rpts.setup(pts.rows(), 2);
+	for(int i = 0; i < pts.rows(); i++) {
+		rpts(i,0) = cos(t)*pts.get(i,0) - sin(t)*pts.get(i,1) + dx;
+		rpts(i,1) = sin(t)*pts.get(i,0) + cos(t)*pts.get(i,1) + dy;
+	}
+}
+
+/// Returns the largest difference between the first two columns of a and b
+double maxdiff(const Matrix<double>& a, const Matrix<double>& b)
+{
+	double d = 0;
+	for(int i = 0; i < a.rows(); i++)
+		for(int j = 0; j < 2; j++)
+			d = max(d, fabs(a.get(i,j)-b.get(i,j)));
+	return d;
+}
+
+int main()
+{
+	int nerr = 0;
+	srand(5);
+
+	// DG points on a circle of radius 0.5 inside a square of side 4, as for a body in a far-field box; interior points in between
+	const int nbody = 48, nside = 12, nin = 2000;
+	Matrix<double> bpts(nbody + 4*nside, 2), ipts(nin, 2);
+	for(int i = 0; i < nbody; i++) {
+		bpts(i,0) = 0.5*cos(2*M_PI*i/nbody);
+		bpts(i,1) = 0.5*sin(2*M_PI*i/nbody);
+	}
+	for(int s = 0; s < 4; s++)
+		for(int i = 0; i < nside; i++)
+		{
+			const double a = -2.0 + 4.0*i/nside;
+			const double c[4][2] = {{a, -2.0}, {2.0, a}, {-a, 2.0}, {-2.0, -a}};
+			bpts(nbody + s*nside + i, 0) = c[s][0];
+			bpts(nbody + s*nside + i, 1) = c[s][1];
+		}
+	for(int i = 0; i < nin; )
+	{
+		const double x = 3.9*((double)rand()/RAND_MAX - 0.5), y = 3.9*((double)rand()/RAND_MAX - 0.5);
+		if(x*x + y*y < 0.3) continue;
+		ipts(i,0) = x; ipts(i,1) = y;
+		i++;
+	}
+
+	DGMapping dgm;
+	if(!dgm.build(bpts, ipts) || dgm.gnbpoin() != bpts.rows() || dgm.gninpoin() != nin) {
+		cout << "! Some interior points could not be located in the DG" << endl;
+		nerr++;
+	}
+
+	// 1. area coordinates reproduce linear functions, so rigid motions of the DG points move the interior points rigidly
+	{
+		Matrix<double> bnew, iexact, inew = ipts;
+		rigidmotion(bpts, 0.0, 0.0, 0.0, bnew);
+		dgm.map(bnew, inew);
+		const double e0 = maxdiff(inew, ipts);
+		rigidmotion(bpts, 0.7, 0.3, -1.1, bnew);
+		rigidmotion(ipts, 0.7, 0.3, -1.1, iexact);
+		dgm.map(bnew, inew);
+		const double e1 = maxdiff(inew, iexact);
+		if(e0 > 1e-12 || e1 > 1e-12 || dgm.check(bnew) != 0) {
+			cout << "! Rigid motion is not reproduced by the DG mapping; errors " << e0 << ", " << e1 << endl;
+			nerr++;
+		}
+	}
+
+	// 2. a mapping read back from a file is identical to the one written, and a truncated file is rejected
+	const string fname = "testdgm.dgmap";
+	{
+		DGMapping r;
+		if(!dgm.write(fname) || !r.read(fname)) {
+			cout << "! Could not write and read back the DG mapping" << endl;
+			nerr++;
+		}
+		else if(r.gnbpoin() != dgm.gnbpoin() || r.gninpoin() != dgm.gninpoin() || r.gnelem() != dgm.gnelem()) {
+			cout << "! Sizes of the DG mapping differ after reading it back" << endl;
+			nerr++;
+		}
+		else
+		{
+			int ndiff = 0;
+			for(int iel = 0; iel < dgm.gnelem(); iel++)
+				for(int i = 0; i < 3; i++)
+					if(r.ginpoel(iel,i) != dgm.ginpoel(iel,i)) ndiff++;
+			for(int ip = 0; ip < nin; ip++) {
+				if(r.ghost(ip) != dgm.ghost(ip)) ndiff++;
+				for(int i = 0; i < 3; i++)
+					if(r.garea(ip,i) != dgm.garea(ip,i)) ndiff++;
+			}
+			if(ndiff > 0) {
+				cout << "! " << ndiff << " entries of the DG mapping differ after reading it back" << endl;
+				nerr++;
+			}
+		}
+
+		ifstream fin(fname, ios::binary);
+		string contents((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+		fin.close();
+		ofstream fout(fname, ios::binary);
+		fout.write(contents.data(), contents.size()-8);
+		fout.close();
+		DGMapping t;
+		if(t.read(fname) || t.gnelem() != 0) {
+			cout << "! A truncated DG mapping file was accepted" << endl;
+			nerr++;
+		}
+		remove(fname.c_str());
+	}
+
+	// 3. rotate the body in steps large enough for DG elements between it and the box to invert
+	{
+		const int nsteps = 4;
+		const double dtheta = 0.6*M_PI/nsteps;
+		Matrix<double> bprev = bpts, iprev = ipts, inew = ipts, bnew = bpts;
+		int nregen = 0;
+		for(int istep = 1; istep <= nsteps; istep++)
+		{
+			for(int i = 0; i < nbody; i++) {
+				bnew(i,0) = 0.5*cos(2*M_PI*i/nbody + istep*dtheta);
+				bnew(i,1) = 0.5*sin(2*M_PI*i/nbody + istep*dtheta);
+			}
+			const bool regen = dgm.check(bnew) > 0;
+
+			// what update() should do: build the DG in the last valid configuration, with the interior points mapped there
+			DGMapping fresh;
+			Matrix<double> iexpect = iprev;
+			if(regen) {
+				fresh.build(bprev, iprev);
+				fresh.map(bnew, iexpect);
+				nregen++;
+			}
+			else
+				dgm.map(bnew, iexpect);
+
+			const int nbad = dgm.update(bnew, inew);
+			if(nbad != 0) {
+				cout << "! " << nbad << " DG elements are still inverted after re-generation in step " << istep << endl;
+				nerr++;
+			}
+			if(maxdiff(inew, iexpect) > 1e-12 || (regen && dgm.gnelem() != fresh.gnelem())) {
+				cout << "! update() differs from a fresh build() in step " << istep << " by " << maxdiff(inew, iexpect) << endl;
+				nerr++;
+			}
+			bprev = bnew;
+			iprev = inew;
+		}
+		if(nregen == 0) {
+			cout << "! The DG was never re-generated, so update() was not checked against build()" << endl;
+			nerr++;
+		}
+		cout << "testdgm: DG re-generated in " << nregen << " of " << nsteps << " steps" << endl;
+	}
+
+	// 4. DGmove must move the interior points it located, as DGMapping does, and leave a point outside the DG where it is
+	{
+		Matrix<double> inc(nin+1, 2), bmotion, bnew, iexpect = ipts;
+		for(int i = 0; i < nin; i++)
+			for(int j = 0; j < 2; j++)
+				inc(i,j) = ipts.get(i,j);
+		inc(nin,0) = 3.0; inc(nin,1) = 3.0;
+		rigidmotion(bpts, 0.2, 0.1, 0.0, bnew);
+		bmotion.setup(bpts.rows(), 2);
+		for(int i = 0; i < bpts.rows(); i++)
+			for(int j = 0; j < 2; j++)
+				bmotion(i,j) = bnew.get(i,j) - bpts.get(i,j);
+
+		DGMapping ref;
+		ref.build(bpts, ipts);
+		ref.map(bnew, iexpect);
+		DGmove d;
+		d.setup(2, &inc, &bpts, &bmotion);
+		d.generateDG();
+		const bool located = d.movemesh();
+		const Matrix<double> moved = d.getInteriorPoints();
+		double err = 0;
+		for(int i = 0; i < nin; i++)
+			for(int j = 0; j < 2; j++)
+				err = max(err, fabs(moved.get(i,j) - iexpect.get(i,j)));
+		if(located || moved.get(nin,0) != 3.0 || moved.get(nin,1) != 3.0 || err > 1e-12) {
+			cout << "! DGmove did not move exactly the points it located; error " << err << endl;
+			nerr++;
+		}
+	}
+
+	if(nerr > 0) {
+		cout << "testdgm: FAILED with " << nerr << " errors." << endl;
+		return 1;
+	}
+	cout << "testdgm: passed." << endl;
+	return 0;
+}
@@ -0,0 +1,157 @@
+/* @file testfacematch.cpp
+ * @brief Checks match_faces against a search with std::map, and the esuel computed by UMesh for a tet mesh of a cube.
+ * @author Aditya Kashi
+ */
+
+#include <afacematch.hpp>
+#include <amesh3d.hpp>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+using namespace amat;
+using namespace amc;
+using namespace std;
+
+typedef array<amc_int,3> FaceKey;
+
+FaceKey makekey(const amc_int a, const amc_int b, const amc_int c)
+{
+	FaceKey k = {{a,b,c}};
+	sort(k.begin(), k.end());
+	return k;
+}
+
+int main()
+{
+	int nerr = 0;
+
+	// Kuhn subdivision of an n x n x n grid of cubes into tets
+	const int n = 8, np1 = n+1;
+	const amc_int npoin = np1*np1*np1;
+	auto vid = [np1](const int i, const int j, const int k) { return (amc_int)(i + np1*(j + np1*k)); };
+	const int perms[6][3] = {{0,1,2},{0,2,1},{1,0,2},{1,2,0},{2,0,1},{2,1,0}};
+	vector<array<amc_int,4>> tets;
+	for(int i = 0; i < n; i++)
+		for(int j = 0; j < n; j++)
+			for(int k = 0; k < n; k++)
+				for(int ip = 0; ip < 6; ip++)
+				{
+					int c[3] = {i,j,k};
+					array<amc_int,4> t;
+					t[0] = vid(c[0],c[1],c[2]);
+					for(int s = 0; s < 3; s++) {
+						c[perms[ip][s]]++;
+						t[s+1] = vid(c[0],c[1],c[2]);
+					}
+					// odd permutations give negatively oriented tets
+					if(ip == 1 || ip == 2 || ip == 5)
+						swap(t[2], t[3]);
+					tets.push_back(t);
+				}
+	const amc_int nelem = tets.size();
+
+	// reference: faces found by a std::map of sorted vertex triples
+	map<FaceKey, vector<amc_int>> fmap;
+	for(amc_int ie = 0; ie < nelem; ie++)
+		for(int f = 0; f < 4; f++)
+			fmap[makekey(tets[ie][f], tets[ie][(f+1)%4], tets[ie][(f+2)%4])].push_back(ie*4+f);
+	vector<FaceKey> bfaces;
+	for(auto it = fmap.begin(); it != fmap.end(); ++it)
+		if(it->second.size() == 1)
+			bfaces.push_back(it->first);
+
+	// 1. match_faces directly, on the element faces followed by the boundary faces; a few faces are ignored, and one is triplicated
+	{
+		const amc_int nfac = 4*nelem + bfaces.size() + 2;
+		vector<amc_int> facepo(3*nfac);
+		for(amc_int ie = 0; ie < nelem; ie++)
+			for(int f = 0; f < 4; f++)
+				for(int j = 0; j < 3; j++)
+					facepo[3*(ie*4+f)+j] = tets[ie][(f+j)%4];
+		for(size_t ib = 0; ib < bfaces.size(); ib++)
+			for(int j = 0; j < 3; j++)
+				facepo[3*(4*nelem+ib)+j] = bfaces[ib][2-j];
+		// an ignored face, and a third copy of the first boundary face
+		facepo[3*(nfac-2)] = -1; facepo[3*(nfac-2)+1] = 0; facepo[3*(nfac-2)+2] = 1;
+		for(int j = 0; j < 3; j++)
+			facepo[3*(nfac-1)+j] = bfaces[0][j];
+
+		vector<amc_int> match;
+		const amc_int nmulti = match_faces(npoin, nfac, 3, facepo, match);
+		if(nmulti != 3) {
+			cout << "! match_faces reported " << nmulti << " faces in groups of more than two; expected 3" << endl;
+			nerr++;
+		}
+		for(amc_int ifac = 0; ifac < 4*nelem; ifac++)
+		{
+			const amc_int m = match[ifac];
+			const vector<amc_int>& same = fmap[makekey(facepo[3*ifac], facepo[3*ifac+1], facepo[3*ifac+2])];
+			bool ok = m >= 0 && match[m] == ifac;
+			if(ok && m < 4*nelem)
+				ok = same.size() == 2 && (same[0] == m || same[1] == m);
+			if(!ok) {
+				cout << "! Wrong match " << m << " for element face " << ifac << endl;
+				nerr++;
+				break;
+			}
+		}
+		if(match[nfac-2] != -1) {
+			cout << "! An ignored face was matched" << endl;
+			nerr++;
+		}
+	}
+
+	// 2. esuel of UMesh, read from a Gmsh file of the same mesh
+	{
+		const string fname = "testfacematch.msh";
+		ofstream fout(fname);
+		fout << "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n$Nodes\n" << npoin << '\n';
+		for(int k = 0; k < np1; k++)
+			for(int j = 0; j < np1; j++)
+				for(int i = 0; i < np1; i++)
+					fout << vid(i,j,k)+1 << ' ' << (double)i/n << ' ' << (double)j/n << ' ' << (double)k/n << '\n';
+		fout << "$EndNodes\n$Elements\n" << bfaces.size()+nelem << '\n';
+		amc_int ielm = 1;
+		for(size_t ib = 0; ib < bfaces.size(); ib++)
+			fout << ielm++ << " 2 2 1 1 " << bfaces[ib][0]+1 << ' ' << bfaces[ib][1]+1 << ' ' << bfaces[ib][2]+1 << '\n';
+		for(amc_int ie = 0; ie < nelem; ie++)
+			fout << ielm++ << " 4 2 1 1 " << tets[ie][0]+1 << ' ' << tets[ie][1]+1 << ' ' << tets[ie][2]+1 << ' ' << tets[ie][3]+1 << '\n';
+		fout << "$EndElements\n";
+		fout.close();
+
+		UMesh m;
+		m.readGmsh2(fname, 3);
+		m.compute_topological();
+		remove(fname.c_str());
+
+		if(m.gnelem() != nelem || m.gnbface() != (amc_int)bfaces.size()) {
+			cout << "! UMesh has " << m.gnelem() << " elements and " << m.gnbface() << " boundary faces; expected " << nelem << " and " << bfaces.size() << endl;
+			nerr++;
+		}
+		else
+			for(amc_int ie = 0; ie < nelem && nerr == 0; ie++)
+				for(int f = 0; f < 4; f++)
+				{
+					// face f of a tet has local nodes f, f+1 and f+2 (see lpofa)
+					FaceKey key = makekey(m.ginpoel(ie,f), m.ginpoel(ie,(f+1)%4), m.ginpoel(ie,(f+2)%4));
+					const vector<amc_int>& same = fmap[key];
+					const amc_int expected = same.size() == 2 ? (same[0]/4 == ie ? same[1]/4 : same[0]/4) : -1;
+					amc_int je = m.gesuel(ie,f);
+					if(je >= nelem) je = -1;
+					if(je != expected) {
+						cout << "! esuel(" << ie << "," << f << ") = " << m.gesuel(ie,f) << ", expected " << expected << endl;
+						nerr++;
+						break;
+					}
+				}
+	}
+
+	if(nerr > 0) {
+		cout << "testfacematch: FAILED with " << nerr << " errors." << endl;
+		return 1;
+	}
+	cout << "testfacematch: passed." << endl;
+	return 0;
+}
@@ -0,0 +1,84 @@
+/* @file testkdtree.cpp
+ * @brief Checks KDTree::radiusSearch against a brute-force search over random point clouds in 1, 2 and 3 dimensions.
+ * @author Aditya Kashi
+ */
+
+#include <akdtree.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace amat;
+using namespace amc;
+using namespace std;
+
+int main()
+{
+	int nerr = 0;
+	srand(3);
+	for(int ndim = 1; ndim <= 3; ndim++)
+	{
+		const int np = 2000, nq = 200;
+		Matrix<double> pts(np,ndim);
+		for(int i = 0; i < np; i++)
+			for(int j = 0; j < ndim; j++)
+				pts(i,j) = (double)rand()/RAND_MAX;
+
+		// a few coincident points, which must all be found
+		for(int j = 0; j < ndim; j++) {
+			pts(1,j) = pts(0,j);
+			pts(2,j) = pts(0,j);
+		}
+
+		KDTree tree(&pts, 8);
+		const double radius = ndim == 1 ? 0.01 : (ndim == 2 ? 0.05 : 0.15);
+
+		for(int iq = 0; iq < nq; iq++)
+		{
+			double x[3];
+			for(int j = 0; j < ndim; j++)
+				x[j] = iq == 0 ? pts(0,j) : 1.2*rand()/RAND_MAX - 0.1;
+
+			vector<amc_int> ind; vector<amc_real> dist;
+			const amc_int nfound = tree.radiusSearch(x, radius, ind, dist);
+
+			vector<amc_int> bf;
+			for(int i = 0; i < np; i++)
+			{
+				double d = 0;
+				for(int j = 0; j < ndim; j++)
+					d += (x[j]-pts(i,j))*(x[j]-pts(i,j));
+				if(d < radius*radius)
+					bf.push_back(i);
+			}
+
+			if(nfound != (amc_int)ind.size() || ind.size() != dist.size()) {
+				cout << "! Inconsistent output for query " << iq << " in " << ndim << "D" << endl;
+				nerr++;
+				continue;
+			}
+			for(size_t k = 0; k < ind.size(); k++)
+			{
+				double d = 0;
+				for(int j = 0; j < ndim; j++)
+					d += (x[j]-pts(ind[k],j))*(x[j]-pts(ind[k],j));
+				if(fabs(sqrt(d) - dist[k]) > 1e-14) {
+					cout << "! Wrong distance for query " << iq << " in " << ndim << "D" << endl;
+					nerr++;
+				}
+			}
+			sort(ind.begin(), ind.end());
+			if(ind != bf) {
+				cout << "! Query " << iq << " in " << ndim << "D: found " << ind.size() << " points, expected " << bf.size() << endl;
+				nerr++;
+			}
+		}
+		cout << "testkdtree: " << ndim << "D done." << endl;
+	}
+
+	if(nerr > 0) {
+		cout << "testkdtree: FAILED with " << nerr << " errors." << endl;
+		return 1;
+	}
+	cout << "testkdtree: passed." << endl;
+	return 0;
+}
@@ -0,0 +1,242 @@
+/* @file testprecon.cpp
+ * @brief Checks the IC0, ILU0 and ILUT preconditioners: exactness when there is no fill-in, their effect on the Krylov solvers,
+ * and the detection of matrices that cannot be factored, or whose factors are unstable; checks SSOR sweeps with the upper triangle against sweeps with the full matrix;
+ * and checks that a SELL-C-sigma copy is built only when it has little padding, and gives the same products.
+ * @author Aditya Kashi
+ */
+
+#include <aprecon.hpp>
+#include <cstdlib>
+
+using namespace amat;
+using namespace std;
+
+/// Finite-difference matrix of -Laplacian + c d/dy on an m x n grid; it is tridiagonal if m is 1
+MatrixCRS<double> griddiffusion(const int m, const int n, const double c)
+{
+	MatrixCRS<double> A(m*n, m*n);
+	for(int j = 0; j < n; j++)
+		for(int i = 0; i < m; i++)
+		{
+			const int r = i + m*j;
+			A.set(r, r, m > 1 ? 4.0 : 2.0);
+			if(i > 0) A.set(r, r-1, -1.0);
+			if(i < m-1) A.set(r, r+1, -1.0);
+			if(j > 0) A.set(r, r-m, -1.0-c);
+			if(j < n-1) A.set(r, r+m, -1.0+c);
+		}
+	return A;
+}
+
+/// Returns the largest entry of |A x - b|, relative to the largest entry of b
+double relresidual(const SparseMatrix<double>& A, const Matrix<double>& x, const Matrix<double>& b)
+{
+	Matrix<double> ax(b.rows(),1);
+	A.multiply(x, &ax);
+	double err = 0, bmax = 0;
+	for(int i = 0; i < b.rows(); i++) {
+		err = max(err, fabs(ax.get(i)-b.get(i)));
+		bmax = max(bmax, fabs(b.get(i)));
+	}
+	return err/bmax;
+}
+
+/// Returns the largest entry of |M^(-1) A x - x|; zero if the preconditioner M is an exact factorization of A
+double precerror(const SparseMatrix<double>& A, const Preconditioner& M, const Matrix<double>& x)
+{
+	Matrix<double> ax(x.rows(),1), z;
+	A.multiply(x, &ax);
+	M.apply(ax, z);
+	double err = 0;
+	for(int i = 0; i < x.rows(); i++)
+		err = max(err, fabs(z.get(i)-x.get(i)));
+	return err;
+}
+
+int main()
+{
+	int nerr = 0;
+	srand(11);
+
+	// 1. for tridiagonal matrices the incomplete factorizations are exact
+	{
+		const int n = 500;
+		MatrixCRS<double> S = griddiffusion(1, n, 0.0), N = griddiffusion(1, n, 0.4);
+		MatrixSymCSR<double> Ss(S);
+		MatrixCSR<double> Nf(N);
+		Matrix<double> x(n,1);
+		for(int i = 0; i < n; i++)
+			x(i) = (double)rand()/RAND_MAX;
+
+		IC0 ic; ILU0 ilu0; ILUT ilut;
+		if(!ic.setup(Ss) || precerror(S, ic, x) > 1e-10) {
+			cout << "! IC0 is not exact for a tridiagonal matrix" << endl;
+			nerr++;
+		}
+		if(!ilu0.setup(Nf) || precerror(N, ilu0, x) > 1e-10) {
+			cout << "! ILU0 is not exact for a tridiagonal matrix" << endl;
+			nerr++;
+		}
+		if(!ilut.setup(Nf, 0.0, 5) || precerror(N, ilut, x) > 1e-10) {
+			cout << "! ILUT is not exact for a tridiagonal matrix" << endl;
+			nerr++;
+		}
+	}
+
+	// 2. IC0 on a 2D Laplacian gets further than the diagonal preconditioner in the same number of CG iterations
+	{
+		const int m = 60, n = m*m, iters = 40;
+		MatrixCRS<double> A = griddiffusion(m, m, 0.0);
+		MatrixSymCSR<double> As(A);
+		Matrix<double> b(n,1), x0(n,1);
+		for(int i = 0; i < n; i++)
+			b(i) = (double)rand()/RAND_MAX;
+		x0.zeros();
+
+		IC0 ic;
+		if(!ic.setup(As)) {
+			cout << "! IC0 failed for a 2D Laplacian" << endl;
+			nerr++;
+		}
+		else
+		{
+			const double ejac = relresidual(A, sparseCG_d(&As, b, x0, 1e-14, iters), b);
+			const double eic = relresidual(A, sparseCG_d(&As, b, x0, 1e-14, iters, &ic), b);
+			const double econv = relresidual(A, sparseCG_d(&As, b, x0, 1e-10, 1000, &ic), b);
+			cout << "testprecon: residual after " << iters << " PCG iterations: diagonal " << ejac << ", IC0 " << eic << endl;
+			if(eic > 0.5*ejac || econv > 1e-7) {
+				cout << "! PCG-IC0 does not converge faster than diagonal PCG" << endl;
+				nerr++;
+			}
+		}
+	}
+
+	// 3. ILU0 and ILUT with BiCGSTAB on a convection-diffusion matrix, whose products use a SELL-C-sigma copy
+	{
+		const int m = 50, n = m*m;
+		MatrixCRS<double> A = griddiffusion(m, m, 0.6);
+		MatrixCSR<double> Af(A);
+		Matrix<double> b(n,1), x0(n,1), y(n,1), ys(n,1);
+		for(int i = 0; i < n; i++)
+			b(i) = (double)rand()/RAND_MAX;
+
+		Af.multiply(b, &y);
+		if(!Af.build_sell()) {
+			cout << "! SELL-C-sigma copy was not built for a matrix with rows of nearly equal length" << endl;
+			nerr++;
+		}
+		Af.multiply(b, &ys);
+		double dy = 0;
+		for(int i = 0; i < n; i++)
+			dy = max(dy, fabs(y.get(i)-ys.get(i)));
+		if(dy > 1e-14) {
+			cout << "! Products with the SELL-C-sigma copy differ from those with CSR by " << dy << endl;
+			nerr++;
+		}
+
+		// with one full row, the slice containing it would be mostly padding
+		MatrixCRS<double> W = griddiffusion(m, m, 0.0);
+		for(int j = 1; j < n; j++)
+			W.set(0, j, 1e-3);
+		MatrixCSR<double> Wf(W);
+		if(Wf.build_sell()) {
+			cout << "! SELL-C-sigma copy was built for a matrix with a full row" << endl;
+			nerr++;
+		}
+
+		ILU0 ilu0; ILUT ilut;
+		if(!ilu0.setup(Af) || !ilut.setup(Af)) {
+			cout << "! ILU0 or ILUT failed for a convection-diffusion matrix" << endl;
+			nerr++;
+		}
+		else
+		{
+			x0.zeros();
+			const double e0 = relresidual(A, sparse_bicgstab(&Af, b, x0, 1e-10, 1000, &ilu0), b);
+			x0.zeros();
+			const double et = relresidual(A, sparse_bicgstab(&Af, b, x0, 1e-10, 1000, &ilut), b);
+			cout << "testprecon: BiCGSTAB residual with ILU0 " << e0 << ", with ILUT " << et << endl;
+			if(e0 > 1e-7 || et > 1e-7) nerr++;
+		}
+	}
+
+	// 4. matrices that cannot be factored must be rejected
+	{
+		// a singular matrix whose second pivot is zero
+		MatrixCRS<double> Z(2,2);
+		Z.set(0,0,1.0); Z.set(0,1,1.0); Z.set(1,0,1.0); Z.set(1,1,1.0);
+		MatrixCSR<double> Zf(Z);
+		ILU0 ilu0;
+		if(ilu0.setup(Zf)) {
+			cout << "! ILU0 accepted a matrix with a zero pivot" << endl;
+			nerr++;
+		}
+		MatrixCRS<double> A = griddiffusion(1, 20, 0.0);
+		A.set(7, 7, -2.0);
+		MatrixSymCSR<double> As(A);
+		IC0 ic;
+		if(ic.setup(As)) {
+			cout << "! IC0 accepted a matrix with a negative diagonal entry" << endl;
+			nerr++;
+		}
+
+		// the matrix of Wendland's C2 RBF, with support radius 0.5, at 400 points on the unit circle: it is positive definite,
+		// but so ill-conditioned that dropping entries at the default tolerance makes the ILUT factors blow up
+		const int nc = 400;
+		MatrixCRS<double> R(nc,nc);
+		for(int i = 0; i < nc; i++)
+			for(int j = 0; j < nc; j++)
+			{
+				const double r = 2.0*sin(M_PI*abs(i-j)/nc)/0.5;
+				if(r < 1.0) R.set(i, j, pow(1.0-r,4)*(4.0*r+1.0));
+			}
+		MatrixCSR<double> Rf(R);
+		ILUT ilut;
+		if(ilut.setup(Rf)) {
+			cout << "! ILUT accepted unstable factors" << endl;
+			nerr++;
+		}
+	}
+
+	// 5. an SSOR sweep that scatters the upper triangle must match a sweep through the rows of the full matrix
+	{
+		const int m = 30, n = m*m;
+		const double omega = 1.3;
+		MatrixCRS<double> A = griddiffusion(m, m, 0.0);
+		MatrixSymCSR<double> As(A);
+		MatrixCSR<double> Af(A);
+		Matrix<double> b(n,1), x(n,1), xf(n,1);
+		for(int i = 0; i < n; i++) {
+			b(i) = (double)rand()/RAND_MAX;
+			x(i) = xf(i) = (double)rand()/RAND_MAX;
+		}
+		As.ssor(b, x, omega);
+
+		const int* const rp = Af.growptr(); const int* const ci = Af.gcolind(); const double* const v = Af.gval();
+		for(int sweep = 0; sweep < 2; sweep++)
+			for(int l = 0; l < n; l++)
+			{
+				const int i = sweep == 0 ? l : n-1-l;
+				double sum = b.get(i), diag = 0;
+				for(int k = rp[i]; k < rp[i+1]; k++) {
+					if(ci[k] == i) diag = v[k];
+					else sum -= v[k]*xf.get(ci[k]);
+				}
+				xf(i) = (1.0-omega)*xf.get(i) + omega*sum/diag;
+			}
+		double err = 0;
+		for(int i = 0; i < n; i++)
+			err = max(err, fabs(x.get(i)-xf.get(i)));
+		if(err > 1e-12) {
+			cout << "! SSOR sweep with the upper triangle differs from that with the full matrix by " << err << endl;
+			nerr++;
+		}
+	}
+
+	if(nerr > 0) {
+		cout << "testprecon: FAILED with " << nerr << " errors." << endl;
+		return 1;
+	}
+	cout << "testprecon: passed." << endl;
+	return 0;
+}
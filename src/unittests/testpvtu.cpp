@@ -0,0 +1,179 @@
+/* @file testpvtu.cpp
+ * @brief Checks that the pieces of a parallel VTU data set, put back together, give the same cells as the serial VTU file of the mesh,
+ * for ASCII and appended binary output, and that each piece contains only the points its cells use.
+ * @author Aditya Kashi
+ */
+
+#include <aoutput.hpp>
+#include <amesh3d.hpp>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace amat;
+using namespace amc;
+using namespace std;
+
+/// The arrays of a VTU file, in the order in which they are written
+enum VtuArray { VTU_POINTS, VTU_CONNECTIVITY, VTU_OFFSETS, VTU_TYPES };
+
+/// Reads the points and cells of a VTU file with ASCII or uncompressed appended data; all values are returned as doubles
+bool readvtu(const string fname, vector<double> arr[4])
+{
+	ifstream fin(fname, ios::binary);
+	const string s((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+	const string apptag = "<AppendedData encoding=\"raw\">\n_";
+	const size_t app = s.find(apptag);
+
+	size_t pos = 0;
+	for(int ia = 0; ia < 4; ia++)
+	{
+		arr[ia].clear();
+		pos = s.find("<DataArray", pos);
+		if(pos == string::npos) return false;
+		const size_t tagend = s.find('>', pos);
+		const string tag = s.substr(pos, tagend-pos);
+		if(tag.find("format=\"ascii\"") != string::npos)
+		{
+			istringstream in(s.substr(tagend+1, s.find("</DataArray>", tagend)-tagend-1));
+			double v;
+			while(in >> v)
+				arr[ia].push_back(v);
+		}
+		else
+		{
+			const size_t offpos = tag.find("offset=\"");
+			if(app == string::npos || offpos == string::npos) return false;
+			const char* const data = s.data() + app + apptag.size() + stoul(tag.substr(offpos+8));
+			uint64_t nbytes;
+			memcpy(&nbytes, data, sizeof(uint64_t));
+			const char* const vals = data + sizeof(uint64_t);
+			const size_t size = ia == VTU_POINTS ? sizeof(double) : (ia == VTU_TYPES ? sizeof(uint8_t) : sizeof(int));
+			for(size_t i = 0; i < nbytes/size; i++)
+			{
+				if(ia == VTU_POINTS) { double v; memcpy(&v, vals + i*size, size); arr[ia].push_back(v); }
+				else if(ia == VTU_TYPES) arr[ia].push_back((uint8_t)vals[i]);
+				else { int v; memcpy(&v, vals + i*size, size); arr[ia].push_back(v); }
+			}
+		}
+		pos = tagend;
+	}
+	return true;
+}
+
+/// Appends the type and the coordinates of the nodes of each cell of a VTU file to cells
+/** \return the number of points of the file that are not used by any cell, or -1 if the file could not be read
+ */
+int appendcells(const string fname, vector<double>& cells)
+{
+	vector<double> arr[4];
+	if(!readvtu(fname, arr) || arr[VTU_OFFSETS].size() != arr[VTU_TYPES].size()) {
+		cout << "! Could not read " << fname << endl;
+		return -1;
+	}
+	vector<bool> used(arr[VTU_POINTS].size()/3, false);
+	int start = 0;
+	for(size_t i = 0; i < arr[VTU_OFFSETS].size(); i++)
+	{
+		cells.push_back(arr[VTU_TYPES][i]);
+		for(int k = start; k < (int)arr[VTU_OFFSETS][i]; k++)
+		{
+			const int ip = (int)arr[VTU_CONNECTIVITY][k];
+			for(int j = 0; j < 3; j++)
+				cells.push_back(arr[VTU_POINTS][3*ip+j]);
+			used[ip] = true;
+		}
+		start = (int)arr[VTU_OFFSETS][i];
+	}
+	int nunused = 0;
+	for(size_t i = 0; i < used.size(); i++)
+		if(!used[i]) nunused++;
+	return nunused;
+}
+
+int main()
+{
+	int nerr = 0;
+
+	// a tet mesh of a cube, each small cube split into six tets around its main diagonal
+	const int n = 4, np1 = n+1;
+	auto vid = [np1](const int i, const int j, const int k) { return i + np1*(j + np1*k) + 1; };
+	const string mname = "testpvtu.msh";
+	ofstream fout(mname);
+	fout << "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n$Nodes\n" << np1*np1*np1 << '\n';
+	for(int k = 0; k < np1; k++)
+		for(int j = 0; j < np1; j++)
+			for(int i = 0; i < np1; i++)
+				fout << vid(i,j,k) << ' ' << (double)i/n << ' ' << (double)j/n << ' ' << (double)k/n << '\n';
+	const int perms[6][3] = {{0,1,2},{0,2,1},{1,0,2},{1,2,0},{2,0,1},{2,1,0}};
+	fout << "$EndNodes\n$Elements\n" << 6*n*n*n << '\n';
+	int ielm = 1;
+	for(int i = 0; i < n; i++)
+		for(int j = 0; j < n; j++)
+			for(int k = 0; k < n; k++)
+				for(int ip = 0; ip < 6; ip++)
+				{
+					int c[3] = {i,j,k};
+					int t[4];
+					t[0] = vid(c[0],c[1],c[2]);
+					for(int s = 0; s < 3; s++) {
+						c[perms[ip][s]]++;
+						t[s+1] = vid(c[0],c[1],c[2]);
+					}
+					if(ip == 1 || ip == 2 || ip == 5)
+						swap(t[2], t[3]);
+					fout << ielm++ << " 4 2 1 1 " << t[0] << ' ' << t[1] << ' ' << t[2] << ' ' << t[3] << '\n';
+				}
+	fout << "$EndElements\n";
+	fout.close();
+	UMesh m;
+	m.readGmsh2(mname, 3);
+	remove(mname.c_str());
+
+	const VtuFormat formats[2] = {VTU_ASCII, VTU_APPENDED};
+	for(int ifmt = 0; ifmt < 2; ifmt++)
+		for(int npieces = 1; npieces <= 7; npieces += 3)
+		{
+			writeMeshToVtu("testpvtu.vtu", m, formats[ifmt]);
+			writeMeshToPvtu("testpvtu_set.pvtu", m, npieces, formats[ifmt]);
+
+			vector<double> serial, pieces;
+			// a type and 4 nodes of 3 coordinates for each tet
+			if(appendcells("testpvtu.vtu", serial) != 0 || serial.size() != 13*(size_t)m.gnelem()) {
+				cout << "! The serial VTU file could not be read, has unused points or does not have all the cells" << endl;
+				nerr++;
+			}
+
+			// the pieces are listed in the PVTU file in the order of their elements
+			ifstream pin("testpvtu_set.pvtu");
+			const string p((istreambuf_iterator<char>(pin)), istreambuf_iterator<char>());
+			pin.close();
+			int nlisted = 0;
+			for(size_t pos = p.find("<Piece Source=\""); pos != string::npos; pos = p.find("<Piece Source=\"", pos+1))
+			{
+				const size_t start = pos+15;
+				const string piece = p.substr(start, p.find('"', start)-start);
+				if(piece != "testpvtu_set_" + to_string(nlisted) + ".vtu" || appendcells(piece, pieces) != 0) {
+					cout << "! Piece " << piece << " is misnamed, could not be read, or has unused points" << endl;
+					nerr++;
+				}
+				remove(piece.c_str());
+				nlisted++;
+			}
+			if(nlisted != npieces || pieces != serial) {
+				cout << "! The " << nlisted << " pieces written for " << npieces << " in format " << formats[ifmt]
+					<< " do not give the cells of the serial VTU file" << endl;
+				nerr++;
+			}
+			remove("testpvtu_set.pvtu");
+			remove("testpvtu.vtu");
+		}
+
+	if(nerr > 0) {
+		cout << "testpvtu: FAILED with " << nerr << " errors." << endl;
+		return 1;
+	}
+	cout << "testpvtu: passed." << endl;
+	return 0;
+}
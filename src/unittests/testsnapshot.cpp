@@ -0,0 +1,213 @@
+/* @file testsnapshot.cpp
+ * @brief Checks that snapshot files give back exactly what was written, both for raw arrays and for a 3D mesh with its connectivity,
+ * and that invalid snapshots are rejected.
+ * @author Aditya Kashi
+ */
+
+#include <asnapshot.hpp>
+#include <amesh3d.hpp>
+#include <cstdio>
+#include <fstream>
+
+using namespace amat;
+using namespace amc;
+using namespace std;
+
+int main()
+{
+	int nerr = 0;
+	const string sname = "testsnapshot.snap";
+
+	// 1. scalars and arrays of both types, as matrices and vectors
+	{
+		Matrix<double> a(37,3);
+		Matrix<int> ia(11,5);
+		vector<double> v(101);
+		vector<int> iv(7);
+		for(int i = 0; i < a.rows(); i++)
+			for(int j = 0; j < a.cols(); j++)
+				a(i,j) = 1.0/(i+j+1) - 0.3*i;
+		for(int i = 0; i < ia.rows(); i++)
+			for(int j = 0; j < ia.cols(); j++)
+				ia(i,j) = i*100 - j;
+		for(size_t i = 0; i < v.size(); i++)
+			v[i] = sqrt((double)i);
+		for(size_t i = 0; i < iv.size(); i++)
+			iv[i] = -(int)i;
+		vector<int> empty;
+
+		SnapshotWriter w(SNAPSHOT_UMESH3D);
+		w.addScalar("big", 1LL << 40); w.addScalar("neg", -5);
+		w.addArray("a", a); w.addArray("ia", ia); w.addArray("v", v); w.addArray("iv", iv); w.addArray("empty", empty);
+		if(!w.write(sname)) {
+			cout << "! Could not write " << sname << endl;
+			nerr++;
+		}
+
+		SnapshotReader r;
+		if(!r.open(sname)) {
+			cout << "! Could not open the snapshot just written" << endl;
+			nerr++;
+		}
+		else
+		{
+			int64_t big = 0; int neg = 0, missing = 7;
+			if(r.gkind() != SNAPSHOT_UMESH3D || !r.getScalar("big", big) || big != (1LL << 40) || !r.getScalar("neg", neg) || neg != -5) {
+				cout << "! Wrong kind or scalars read back" << endl;
+				nerr++;
+			}
+			if(r.getScalar("missing", missing)) {
+				cout << "! An absent scalar was found" << endl;
+				nerr++;
+			}
+
+			Matrix<double> ra; Matrix<int> ria; vector<double> rv; vector<int> riv, rempty(3);
+			if(!r.getArray("a", ra) || ra.rows() != a.rows() || ra.cols() != a.cols()) nerr++;
+			else
+				for(int i = 0; i < a.rows(); i++)
+					for(int j = 0; j < a.cols(); j++)
+						if(ra(i,j) != a(i,j)) { nerr++; i = a.rows(); break; }
+			if(!r.getArray("ia", ria) || ria.rows() != ia.rows() || ria.cols() != ia.cols()) nerr++;
+			else
+				for(int i = 0; i < ia.rows(); i++)
+					for(int j = 0; j < ia.cols(); j++)
+						if(ria(i,j) != ia(i,j)) { nerr++; i = ia.rows(); break; }
+			if(!r.getArray("v", rv) || rv != v) nerr++;
+			if(!r.getArray("iv", riv) || riv != iv) nerr++;
+			if(r.getArray("empty", rempty) || rempty.size() != 0) {
+				cout << "! An empty array was not read back as absent" << endl;
+				nerr++;
+			}
+			if(nerr > 0)
+				cout << "! Arrays were not read back correctly" << endl;
+		}
+	}
+
+	// 2. a truncated snapshot must be rejected
+	{
+		ifstream fin(sname, ios::binary);
+		string contents((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+		fin.close();
+		ofstream fout(sname, ios::binary);
+		fout.write(contents.data(), contents.size()/2);
+		fout.close();
+
+		SnapshotReader r;
+		if(r.open(sname)) {
+			cout << "! A truncated snapshot was accepted" << endl;
+			nerr++;
+		}
+	}
+
+	// 3. a tet mesh of a cube and its connectivity
+	{
+		const int n = 4, np1 = n+1;
+		auto vid = [np1](const int i, const int j, const int k) { return i + np1*(j + np1*k) + 1; };
+		const string fname = "testsnapshot.msh";
+		ofstream fout(fname);
+		fout << "$MeshFormat\n2.2 0 8\n$EndMeshFormat\n$Nodes\n" << np1*np1*np1 << '\n';
+		for(int k = 0; k < np1; k++)
+			for(int j = 0; j < np1; j++)
+				for(int i = 0; i < np1; i++)
+					fout << vid(i,j,k) << ' ' << (double)i/n << ' ' << (double)j/n << ' ' << (double)k/n << '\n';
+		// each cube is split into six tets around its main diagonal; the boundary faces are the halves of the boundary squares
+		const int perms[6][3] = {{0,1,2},{0,2,1},{1,0,2},{1,2,0},{2,0,1},{2,1,0}};
+		fout << "$EndNodes\n$Elements\n" << 12*n*n + 6*n*n*n << '\n';
+		int ielm = 1;
+		for(int d = 0; d < 3; d++)
+			for(int side = 0; side <= n; side += n)
+				for(int a = 0; a < n; a++)
+					for(int b = 0; b < n; b++)
+					{
+						int c0[3], c1[3], c2[3], c3[3];
+						const int d1 = (d+1)%3, d2 = (d+2)%3;
+						c0[d] = c1[d] = c2[d] = c3[d] = side;
+						c0[d1] = a; c0[d2] = b;  c1[d1] = a+1; c1[d2] = b;
+						c2[d1] = a; c2[d2] = b+1;  c3[d1] = a+1; c3[d2] = b+1;
+						fout << ielm++ << " 2 2 1 1 " << vid(c0[0],c0[1],c0[2]) << ' ' << vid(c1[0],c1[1],c1[2]) << ' ' << vid(c3[0],c3[1],c3[2]) << '\n';
+						fout << ielm++ << " 2 2 1 1 " << vid(c0[0],c0[1],c0[2]) << ' ' << vid(c3[0],c3[1],c3[2]) << ' ' << vid(c2[0],c2[1],c2[2]) << '\n';
+					}
+		for(int i = 0; i < n; i++)
+			for(int j = 0; j < n; j++)
+				for(int k = 0; k < n; k++)
+					for(int ip = 0; ip < 6; ip++)
+					{
+						int c[3] = {i,j,k};
+						int t[4];
+						t[0] = vid(c[0],c[1],c[2]);
+						for(int s = 0; s < 3; s++) {
+							c[perms[ip][s]]++;
+							t[s+1] = vid(c[0],c[1],c[2]);
+						}
+						if(ip == 1 || ip == 2 || ip == 5)
+							swap(t[2], t[3]);
+						fout << ielm++ << " 4 2 1 1 " << t[0] << ' ' << t[1] << ' ' << t[2] << ' ' << t[3] << '\n';
+					}
+		fout << "$EndElements\n";
+		fout.close();
+
+		UMesh m;
+		m.readGmsh2(fname, 3);
+		m.compute_topological();
+		remove(fname.c_str());
+		m.writeSnapshot(sname);
+
+		UMesh q;
+		if(!q.readSnapshot(sname)) {
+			cout << "! Could not read the mesh snapshot" << endl;
+			nerr++;
+		}
+		else if(q.gnpoin() != m.gnpoin() || q.gnelem() != m.gnelem() || q.gnface() != m.gnface() || q.gnaface() != m.gnaface()
+				|| q.gnedge() != m.gnedge() || q.gnbpoin() != m.gnbpoin() || q.gnbtag() != m.gnbtag() || q.gnnode() != m.gnnode()) {
+			cout << "! Mesh sizes differ after reading the snapshot" << endl;
+			nerr++;
+		}
+		else
+		{
+			int nmesh = 0;
+			for(amc_int i = 0; i < m.gnpoin(); i++) {
+				for(int j = 0; j < 3; j++)
+					if(q.gcoords(i,j) != m.gcoords(i,j)) nmesh++;
+				if(q.gpsupsize(i) != m.gpsupsize(i)) nmesh++;
+				else
+					for(int j = 0; j < m.gpsupsize(i); j++)
+						if(q.gpsup(i,j) != m.gpsup(i,j)) nmesh++;
+				if(q.gesup_p(i+1) != m.gesup_p(i+1) || q.gflag_bpoin(i) != m.gflag_bpoin(i)) nmesh++;
+			}
+			for(amc_int i = 0; i < m.gnelem(); i++)
+				for(int j = 0; j < m.gnnode(); j++)
+					if(q.ginpoel(i,j) != m.ginpoel(i,j) || q.gesuel(i,j) != m.gesuel(i,j)) nmesh++;
+			for(amc_int i = 0; i < m.gnface(); i++)
+				for(int j = 0; j < m.gnnofa()+m.gnbtag(); j++)
+					if(q.gbface(i,j) != m.gbface(i,j)) nmesh++;
+			for(amc_int i = 0; i < m.gnaface(); i++)
+				for(int j = 0; j < m.gnnofa()+2; j++)
+					if(q.gintfac(i,j) != m.gintfac(i,j)) nmesh++;
+			for(amc_int i = 0; i < m.gnedge(); i++)
+				for(int j = 0; j < 2; j++)
+					if(q.gedgepo(i,j) != m.gedgepo(i,j)) nmesh++;
+			if(nmesh > 0) {
+				cout << "! " << nmesh << " mesh entries differ after reading the snapshot" << endl;
+				nerr++;
+			}
+		}
+
+		// a 3D mesh must not be read from a snapshot of another kind
+		SnapshotWriter w(SNAPSHOT_UMESH2DH);
+		w.addScalar("npoin", 1);
+		w.write(sname);
+		UMesh z;
+		if(z.readSnapshot(sname)) {
+			cout << "! A 2D snapshot was read as a 3D mesh" << endl;
+			nerr++;
+		}
+	}
+	remove(sname.c_str());
+
+	if(nerr > 0) {
+		cout << "testsnapshot: FAILED with " << nerr << " errors." << endl;
+		return 1;
+	}
+	cout << "testsnapshot: passed." << endl;
+	return 0;
+}
@@ -0,0 +1,130 @@
+/* @file testtreecode.cpp
+ * @brief Checks that products computed by RBFTreecode, with the opening angle chosen by opening_angle(tol),
+ * agree with direct summation to within tol, and are symmetric to within tol, in 2D and 3D; with a zero opening angle, they must be exact.
+ * The asymmetry u^T A x - x^T A u is measured relative to |u| |A x| + |x| |A u|, which bounds the error of each term.
+ * @author Aditya Kashi
+ */
+
+#include <arbftreecode.hpp>
+#include <cstdlib>
+
+using namespace amat;
+using namespace amc;
+using namespace std;
+
+/// Direct summation of the RBFs of the sources at the targets
+void directsum(const Matrix<double>& src, const Matrix<double>& targ, const RBFKernelType type, const double scale, const double cutoff,
+		const Matrix<double>& x, Matrix<double>& y)
+{
+	const int ns = src.rows(), nt = targ.rows(), ndim = src.cols();
+	vector<double> r(ns), phi(ns);
+	y.setup(nt,1);
+	for(int i = 0; i < nt; i++)
+	{
+		for(int j = 0; j < ns; j++) {
+			double d = 0;
+			for(int k = 0; k < ndim; k++)
+				d += (targ.get(i,k)-src.get(j,k))*(targ.get(i,k)-src.get(j,k));
+			r[j] = sqrt(d);
+		}
+		rbf_batch(type, ns, r.data(), scale, phi.data());
+		double s = 0;
+		for(int j = 0; j < ns; j++)
+			if(r[j] < cutoff)
+				s += phi[j]*x.get(j);
+		y(i) = s;
+	}
+}
+
+/// Returns the 2-norm of a-b relative to that of b
+double relerror(const Matrix<double>& a, const Matrix<double>& b)
+{
+	double e = 0, nb = 0;
+	for(int i = 0; i < a.rows(); i++) {
+		e += (a.get(i)-b.get(i))*(a.get(i)-b.get(i));
+		nb += b.get(i)*b.get(i);
+	}
+	return sqrt(e/nb);
+}
+
+int main()
+{
+	int nerr = 0;
+	srand(17);
+	const int n = 2000, nt = 300;
+
+	for(int ndim = 2; ndim <= 3; ndim++)
+	{
+		// points near two concentric circles or spheres, like the boundary points of a mesh around a body
+		Matrix<double> pts(n,ndim), targ(nt,ndim), x(n,1), u(n,1);
+		for(int i = 0; i < n+nt; i++)
+		{
+			double p[3], norm = 0;
+			for(int k = 0; k < ndim; k++) {
+				p[k] = (double)rand()/RAND_MAX - 0.5;
+				norm += p[k]*p[k];
+			}
+			const double rad = i >= n ? 1.5 : (i%2 ? 1.0 : 2.0 + 0.1*rand()/RAND_MAX);
+			for(int k = 0; k < ndim; k++)
+				if(i < n) pts(i,k) = rad*p[k]/sqrt(norm);
+				else targ(i-n,k) = rad*p[k]/sqrt(norm);
+		}
+		for(int i = 0; i < n; i++) {
+			x(i) = (double)rand()/RAND_MAX - 0.5;
+			u(i) = sin(7.0*i);
+		}
+
+		const RBFKernelType types[2] = {RBF_C2, RBF_GAUSSIAN};
+		// wider RBFs in 3D, so that the far field is used for 2000 points
+		const double srad[2] = {ndim == 2 ? 1.5 : 3.0, 1e30};
+		for(int it = 0; it < 2; it++)
+		{
+			const double scale = it == 0 ? 1.0/srad[0] : (ndim == 2 ? 1.0 : 0.5);
+			Matrix<double> ye, yt, yeu;
+			directsum(pts, pts, types[it], scale, srad[it], x, ye);
+			directsum(pts, pts, types[it], scale, srad[it], u, yeu);
+			directsum(pts, targ, types[it], scale, srad[it], x, yt);
+
+			for(double tol = 1e-2; tol > 1e-5; tol *= 0.1)
+			{
+				RBFTreecode tc;
+				tc.setup(&pts, types[it], scale, srad[it], RBFTreecode::opening_angle(tol));
+				Matrix<double> y, yu, ytc;
+				tc.apply(x, y);
+				tc.apply(u, yu);
+				tc.evaluate(targ, x, ytc);
+
+				const double e = relerror(y, ye), et = relerror(ytc, yt);
+				double s1 = 0, s2 = 0;
+				for(int i = 0; i < n; i++) {
+					s1 += u.get(i)*y.get(i);
+					s2 += x.get(i)*yu.get(i);
+				}
+				const double asym = fabs(s1-s2)/(u.l2norm()*ye.l2norm() + x.l2norm()*yeu.l2norm());
+				cout << "testtreecode: " << ndim << "D, kernel " << types[it] << ", tol " << tol << ": error " << e << ", at targets " << et
+					<< ", asymmetry " << asym << endl;
+				if(e > tol || et > tol || asym > tol) {
+					cout << "! Tree-code error is larger than the tolerance" << endl;
+					nerr++;
+				}
+			}
+
+			// no expansions with a zero opening angle
+			RBFTreecode tc;
+			tc.setup(&pts, types[it], scale, srad[it], 0.0);
+			Matrix<double> ytc;
+			tc.evaluate(targ, x, ytc);
+			if(relerror(ytc, yt) > 1e-12) {
+				cout << "! Tree-code with zero opening angle is not exact; error " << relerror(ytc, yt) << endl;
+				nerr++;
+			}
+		}
+	}
+
+	if(nerr > 0) {
+		cout << "testtreecode: FAILED with " << nerr << " errors." << endl;
+		return 1;
+	}
+	cout << "testtreecode: passed." << endl;
+	return 0;
+}
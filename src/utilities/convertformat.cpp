@@ -26,6 +26,10 @@ int main(int argc, char* argv[])
 		m.readDomn(inmesh);
 	else if(informat == "msh")
 		m.readGmsh2(inmesh,2);
+	else if(informat == "amsh") {
+		if(!m.readSnapshot(inmesh))
+			return -1;
+	}
 	else {
 		cout << "Invalid format. Exiting." << endl;
 		return -1;
@@ -35,6 +39,8 @@ int main(int argc, char* argv[])
 		m.writeGmsh2(outmesh);
 	else if(outformat == "vtu")
 		writeMeshToVtu(outmesh, m);
+	else if(outformat == "amsh")
+		m.writeSnapshot(outmesh);
 	else {
 		cout << "Invalid format. Exiting." << endl;
 		return -1;
@@ -1,11 +1,34 @@
-/** @brief Converts a mesh file from Dr Luo's Domn format (containing no bface data) to Gmsh 2 format
+/** @brief Converts a 3D mesh file between Dr Luo's Domn format (containing no bface data), Gmsh 2 format and binary mesh snapshots,
+ * or writes it out as VTU for visualization.
+ *
+ * Usage: convertformat3d input-mesh output-mesh [topology | number-of-pieces]
+ *
+ * The formats are deduced from the file extensions: .domn, .msh (Gmsh 2, ASCII or binary), .amsh (snapshot, output or input),
+ * .vtu (output only; written with appended binary data, compressed if zlib is available)
+ * and .pvtu (output only; a parallel VTU data set of VTU pieces written as for .vtu).
+ * If the third argument 'topology' is given when writing a snapshot, the connectivity data computed by compute_topological()
+ * is stored in it as well, so that programs reading the snapshot need not compute it again.
+ * When writing PVTU, the third argument is the number of pieces; by default, there is one piece per OpenMP thread.
  */
 #include <amesh3d.hpp>
+#include <aoutput.hpp>
+
+#ifdef _OPENMP
+#ifndef OMP_H
+#include <omp.h>
+#endif
+#endif
 
 using namespace amat;
 using namespace amc;
 using namespace std;
 
+string extension(const string& fname)
+{
+	const size_t dot = fname.rfind('.');
+	return dot == string::npos ? "" : fname.substr(dot+1);
+}
+
 int main(int argc, char* argv[])
 {
 	if(argc < 3)
@@ -15,10 +38,39 @@ int main(int argc, char* argv[])
 	}
 	string inmeshname(argv[1]);
 	string outmeshname(argv[2]);
+	bool topology = (argc > 3 && string(argv[3]) == "topology");
 
 	UMesh m;
-	m.readDomn(inmeshname);
-	m.writeGmsh2(outmeshname);
+	const string inext = extension(inmeshname), outext = extension(outmeshname);
+	if(inext == "msh")
+		m.readGmsh2(inmeshname,3);
+	else if(inext == "amsh") {
+		if(!m.readSnapshot(inmeshname))
+			return -1;
+	}
+	else
+		m.readDomn(inmeshname);
+
+	if(outext == "amsh")
+	{
+		if(topology)
+			m.compute_topological();
+		m.writeSnapshot(outmeshname);
+	}
+	else if(outext == "vtu")
+		writeMeshToVtu(outmeshname, m, VTU_APPENDED, true);
+	else if(outext == "pvtu")
+	{
+		int npieces = 1;
+#ifdef _OPENMP
+		npieces = omp_get_max_threads();
+#endif
+		if(argc > 3)
+			npieces = atoi(argv[3]);
+		writeMeshToPvtu(outmeshname, m, npieces, VTU_APPENDED, true);
+	}
+	else
+		m.writeGmsh2(outmeshname);
 
 	cout << endl;
 	return 0;